@@ -651,27 +651,33 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 				check_track_for_svc = i+1;
 		}
 	} else {
+		u32 k, nb_sel;
+		u32 sel_idx[GF_IMPORT_MAX_TRACKS], sel_tracks[GF_IMPORT_MAX_TRACKS], sel_ids[GF_IMPORT_MAX_TRACKS];
+
+		/*gather all selected tracks first so that multiplexed sources are demuxed only once*/
+		nb_sel = 0;
 		for (i=0; i<import.nb_tracks; i++) {
-			import.trackID = import.tk_info[i].track_num;
 			if (prog_id) {
 				if (import.tk_info[i].prog_num!=prog_id) continue;
-				e = gf_media_import(&import);
-			}
-			else if (do_all) e = gf_media_import(&import);
-			else if (track_id && (track_id==import.trackID)) {
-				track_id = 0;
-				e = gf_media_import(&import);
-			}
-			else if (do_audio && (import.tk_info[i].type==GF_ISOM_MEDIA_AUDIO)) {
-				do_audio = 0;
-				e = gf_media_import(&import);
-			}
-			else if (do_video && (import.tk_info[i].type==GF_ISOM_MEDIA_VISUAL)) {
-				do_video = 0;
-				e = gf_media_import(&import);
 			}
+			else if (do_all) ;
+			else if (track_id && (track_id==import.tk_info[i].track_num)) track_id = 0;
+			else if (do_audio && (import.tk_info[i].type==GF_ISOM_MEDIA_AUDIO)) do_audio = 0;
+			else if (do_video && (import.tk_info[i].type==GF_ISOM_MEDIA_VISUAL)) do_video = 0;
 			else continue;
+			sel_idx[nb_sel] = i;
+			sel_tracks[nb_sel] = import.tk_info[i].track_num;
+			nb_sel++;
+		}
+		if (nb_sel) {
+			e = gf_media_import_tracks(&import, nb_sel, sel_tracks, sel_ids);
 			if (e) goto exit;
+		}
+
+		for (k=0; k<nb_sel; k++) {
+			i = sel_idx[k];
+			import.trackID = sel_tracks[k];
+			import.final_trackID = sel_ids[k];
 
 			timescale = gf_isom_get_timescale(dest);
 			track = gf_isom_get_track_by_id(import.dest, import.final_trackID);
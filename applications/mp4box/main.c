@@ -57,6 +57,10 @@
 
 #include "../../include/gpac/internal/mpd.h"
 
+#ifndef GPAC_DISABLE_MPEG2TS
+#include "../../include/gpac/mpegts.h"
+#endif
+
 #include <time.h>
 
 #include <mbstring.h>
@@ -193,6 +197,8 @@ void PrintGeneralUsage()
 			" -mem-track:  enables memory tracker\n"
 #endif
 			" -strict-error        exits after the first error is reported\n"
+			" -log-async           writes logs from a dedicated thread, messages being queued by the logging threads\n"
+			" -trace file          records import, demux and sample access timings and dumps them in file as Chrome trace JSON\n"
 			" -inter time_in_ms    interleaves file data (track chunks of time_in_ms)\n"
 			"                       * Note 1: Interleaving is 0.5s by default\n"
 			"                       * Note 2: Performs drift checking accross tracks\n"
@@ -209,6 +215,7 @@ void PrintGeneralUsage()
 			" -tmp dirname         specifies directory for temporary file creation\n"
 			"                       * Note: Default temp dir is OS-dependent\n"
 			" -write-buffer SIZE   specifies write buffer in bytes for ISOBMF files\n"
+			" -threads N           uses N worker threads when possible (ISMA encryption/decryption, TS DASH indexing)\n"
 			" -no-sys              removes all MPEG-4 Systems info except IOD (profiles)\n"
 			"                       * Note: Set by default whith '-add' and '-cat'\n"
 			" -no-iod              removes InitialObjectDescriptor from file\n"
@@ -288,6 +295,7 @@ void PrintDASHUsage()
 			" \":id=NAME\"         sets the representation ID to NAME\n"
 			" \":period=NAME\"     sets the representation's period to NAME. Multiple periods may be used\n"
 			"                       period appear in the MPD in the same order as specified with this option\n"
+			"                       in dynamic mode with a context, periods are segmented one after the other, the last one never ends\n"
 			" \":bandwidth=VALUE\" sets the representation's bandwidth to a given value\n"
 			" \":role=VALUE\"      sets the role of this representation (cf DASH spec).\n"
 			"                       media with different roles belong to different adaptation sets.\n"
@@ -309,6 +317,10 @@ void PrintDASHUsage()
 			" -cprt string         adds copyright string to MPD\n"
 			" -dash-live[=F] dur   generates a live DASH session using dur segment duration, optionnally writing live context to F\n"
 			"                       MP4Box will run the live session until \'q\' is pressed or a fatal error occurs.\n"
+			" -dash-follow         live session on growing inputs: segments are produced as media is appended to the inputs\n"
+			"                       instead of looping them, and the input to segment availability latency is reported.\n"
+			" -dash-chunk N        live session with low-latency chunked segments: fragments of N frames are written to the\n"
+			"                       segment file as soon as they are produced, the sidx being patched once the segment is done.\n"
 			" -dash-ctx FILE       stores/restore DASH timing from FILE.\n"
 			" -dynamic             uses dynamic MPD type instead of static.\n"
 			" -mpd-refresh TIME    specifies MPD update time in seconds.\n"
@@ -616,6 +628,9 @@ void PrintDumpUsage()
 			" -diso                scene IsoMedia file boxes in XML output\n"
 			" -drtp                rtp hint samples structure to XML output\n"
 			" -dts                 prints sample timing to text output\n"
+#ifndef GPAC_DISABLE_MPEG2TS
+			" -tsidx               builds random access index of MPEG-2 TS input in \"input.tsidx\" (eg file.ts.tsidx)\n"
+#endif
 			" -dnal trackID        prints NAL sample info of given track\n"
 			" -sdp                 dumps SDP description of hinted file\n"
 			" -dcr                 ISMACryp samples structure to XML output\n"
@@ -1365,6 +1380,17 @@ GF_DashSegmenterInput *set_dash_input(GF_DashSegmenterInput *dash_inputs, char *
 	return dash_inputs;
 }
 
+static char *trace_file = NULL;
+
+/*dumps recorded trace events if requested and closes libgpac*/
+static void mp4box_sys_close()
+{
+	if (trace_file) {
+		if (gf_trace_dump(trace_file) != GF_OK) fprintf(stderr, "Cannot write trace file %s\n", trace_file);
+		trace_file = NULL;
+	}
+	gf_sys_close();
+}
 
 int mp4boxMain(int argc, char **argv)
 {
@@ -1385,12 +1411,13 @@ int mp4boxMain(int argc, char **argv)
 	GF_DashSwitchingMode bitstream_switching_mode = GF_DASH_BSMODE_INBAND;
 	u32 i, stat_level, hint_flags, info_track_id, import_flags, nb_add, nb_cat, ismaCrypt, agg_samples, nb_sdp_ex, max_ptime, raw_sample_num, split_size, nb_meta_act, nb_track_act, rtp_rate, major_brand, nb_alt_brand_add, nb_alt_brand_rem, old_interleave, car_dur, minor_version, conv_type, nb_tsel_acts, program_number, dump_nal, time_shift_depth, dash_dynamic;
 	Bool HintIt, needSave, FullInter, Frag, HintInter, dump_std, dump_rtp, dump_mode, regular_iod, trackID, remove_sys_tracks, remove_hint, force_new, remove_root_od, import_subtitle, dump_chap;
-	Bool print_sdp, print_info, open_edit, track_dump_type, dump_isom, dump_cr, force_ocr, encode, do_log, do_flat, dump_srt, dump_ttxt, dump_timestamps, do_saf, dump_m2ts, dump_cart, do_hash, verbose, force_cat, align_cat, pack_wgt, single_group, dash_live;
+	Bool print_sdp, print_info, open_edit, track_dump_type, dump_isom, dump_cr, force_ocr, encode, do_log, do_flat, dump_srt, dump_ttxt, dump_timestamps, do_saf, dump_m2ts, build_tsidx, dump_cart, do_hash, verbose, force_cat, align_cat, pack_wgt, single_group, dash_live;
 	char *inName, *outName, *arg, *mediaSource, *tmpdir, *input_ctx, *output_ctx, *drm_file, *avi2raw, *cprt, *chap_file, *pes_dump, *itunes_tags, *pack_file, *raw_cat, *seg_name, *dash_ctx_file;
 	Double min_buffer = 1.5;
 	u32 ast_shift_sec = 1;
 	char **mpd_base_urls = NULL;
 	u32 nb_mpd_base_urls=0;
+	u32 nb_threads = 0;
 
 #ifndef GPAC_DISABLE_MPD
 	Bool do_mpd = 0;
@@ -1415,10 +1442,13 @@ int mp4boxMain(int argc, char **argv)
 	Bool use_url_template=0;
 	Bool seg_at_rap=0;
 	Bool frag_at_rap=0;
+	Bool dash_follow_inputs=0;
+	u32 dash_chunk_frames=0;
 	Bool adjust_split_end = 0;
 	GF_DashSegmenterInput *dash_inputs = NULL;
 	u32 nb_dash_inputs = 0;
 	char *gf_logs = NULL;
+	Bool log_async = 0;
 	char *seg_ext = NULL;
 	const char *dash_title = NULL;
 	const char *dash_source = NULL;
@@ -1442,7 +1472,7 @@ int mp4boxMain(int argc, char **argv)
 	dump_nal = 0;
 	FullInter = HintInter = encode = do_log = old_interleave = do_saf = do_hash = verbose = 0;
 	dump_mode = Frag = force_ocr = remove_sys_tracks = agg_samples = remove_hint = keep_sys_tracks = remove_root_od = single_group = 0;
-	conv_type = HintIt = needSave = print_sdp = print_info = regular_iod = dump_std = open_edit = dump_isom = dump_rtp = dump_cr = dump_chap = dump_srt = dump_ttxt = force_new = dump_timestamps = dump_m2ts = dump_cart = import_subtitle = force_cat = pack_wgt = dash_live = 0;
+	conv_type = HintIt = needSave = print_sdp = print_info = regular_iod = dump_std = open_edit = dump_isom = dump_rtp = dump_cr = dump_chap = dump_srt = dump_ttxt = force_new = dump_timestamps = dump_m2ts = build_tsidx = dump_cart = import_subtitle = force_cat = pack_wgt = dash_live = 0;
 	dash_dynamic = 0;
 	/*align cat is the new default behaviour for -cat*/
 	align_cat = 1;
@@ -1662,6 +1692,8 @@ int mp4boxMain(int argc, char **argv)
 			if (!stricmp(arg, "-ttxt")) dump_ttxt = 1;
 			else dump_srt = 1;
 			import_subtitle = 1;
+		} else if (!stricmp(arg, "-tsidx")) {
+			build_tsidx = 1;
 		} else if (!stricmp(arg, "-dm2ts")) {
 			dump_m2ts = 1;
 			if ( ((i+1<(u32) argc) && inName) || (i+2<(u32) argc) ) {
@@ -1701,6 +1733,9 @@ int mp4boxMain(int argc, char **argv)
 		else if (!stricmp(arg, "-tmp")) {
 			CHECK_NEXT_ARG tmpdir = argv[i+1]; i++;
 		}
+		else if (!stricmp(arg, "-threads")) {
+			CHECK_NEXT_ARG nb_threads = atoi(argv[i+1]); i++;
+		}
 		else if (!stricmp(arg, "-write-buffer")) {
 			CHECK_NEXT_ARG
 			gf_isom_set_output_buffering(NULL, atoi(argv[i+1]));
@@ -1716,6 +1751,12 @@ int mp4boxMain(int argc, char **argv)
 #endif
 		} else if (!strcmp(arg, "-strict-error")) {
 			gf_log_set_strict_error(1);
+		} else if (!strcmp(arg, "-log-async")) {
+			log_async = 1;
+		} else if (!strcmp(arg, "-trace")) {
+			CHECK_NEXT_ARG
+			trace_file = argv[i+1];
+			i++;
 		} else if (!stricmp(arg, "-inter") || !stricmp(arg, "-old-inter")) {
 			CHECK_NEXT_ARG
 			interleaving_time = atof(argv[i+1]) / 1000;
@@ -1802,6 +1843,14 @@ int mp4boxMain(int argc, char **argv)
 			i++;
 		}
 
+		else if (!stricmp(arg, "-dash-follow")) {
+			dash_follow_inputs = 1;
+		}
+		else if (!stricmp(arg, "-dash-chunk")) {
+			CHECK_NEXT_ARG
+			dash_chunk_frames = atoi(argv[i+1]);
+			i++;
+		}
 		else if (!stricmp(arg, "-dash-ctx")) {
 			CHECK_NEXT_ARG
 			dash_ctx_file = argv[i+1];
@@ -2501,6 +2550,8 @@ int mp4boxMain(int argc, char **argv)
 
 	/*init libgpac*/
 	gf_sys_init(enable_mem_tracker);
+	if (trace_file) gf_trace_enable(1);
+	if (log_async) gf_log_set_async(1);
 
 	if (gf_logs) {
 		gf_log_set_tools_levels(gf_logs);
@@ -2771,6 +2822,7 @@ int mp4boxMain(int argc, char **argv)
 	if (dash_duration) {
 		char szMPD[GF_MAX_PATH], *sep;
 		GF_Config *dash_ctx = NULL;
+		GF_DASHLiveSegmenter *dasher = NULL;
 		u32 do_abort = 0;
 		gf_log_set_tool_level(GF_LOG_DASH, GF_LOG_INFO);
 		strcpy(outfile, outName ? outName : gf_url_get_resource_name(inName) );
@@ -2789,6 +2841,8 @@ int mp4boxMain(int argc, char **argv)
 				gf_delete_file(dash_ctx_file);
 
 			dash_ctx = gf_cfg_force_new(NULL, dash_ctx_file);
+			/*context is saved after each cycle, only append segment updates*/
+			if (dash_live) gf_cfg_set_journaled(dash_ctx, 1);
 		}
 
 		if (dash_profile==GF_DASH_PROFILE_UNKNOWN)
@@ -2803,18 +2857,42 @@ int mp4boxMain(int argc, char **argv)
 			fprintf(stderr, "Using default MPD refresh of %d seconds\n", mpd_update_time);
 		}
 
+		gf_dasher_set_threads(nb_threads);
+		/*live session: keep inputs and segmenter state between cycles*/
+		if (dash_live) {
+			dasher = gf_dasher_live_new(szMPD, dash_inputs, nb_dash_inputs, dash_profile, dash_title, dash_source, cprt, dash_more_info,
+										(const char **) mpd_base_urls, nb_mpd_base_urls,
+									   use_url_template, single_segment, single_file, bitstream_switching_mode,
+									   seg_at_rap, dash_duration, seg_name, seg_ext,
+									   interleaving_time, subsegs_per_sidx, daisy_chain_sidx, frag_at_rap, tmpdir,
+									   dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, dash_subduration, min_buffer, ast_shift_sec, dash_follow_inputs);
+			if (!dasher) {
+				e = GF_OUT_OF_MEM;
+				do_abort = 1;
+			} else if (dash_chunk_frames) {
+				gf_dasher_live_set_chunk_mode(dasher, dash_chunk_frames, NULL, NULL);
+			}
+		} else if (dash_chunk_frames) {
+			fprintf(stderr, "Warning: -dash-chunk is only used in live sessions, ignoring\n");
+		}
 		while (!do_abort) {
-			e = gf_dasher_segment_files(szMPD, dash_inputs, nb_dash_inputs, dash_profile, dash_title, dash_source, cprt, dash_more_info,
+			if (dasher) {
+				e = gf_dasher_live_process(dasher);
+			} else {
+				e = gf_dasher_segment_files(szMPD, dash_inputs, nb_dash_inputs, dash_profile, dash_title, dash_source, cprt, dash_more_info,
 										(const char **) mpd_base_urls, nb_mpd_base_urls,
 									   use_url_template, single_segment, single_file, bitstream_switching_mode,
 									   seg_at_rap, dash_duration, seg_name, seg_ext,
 									   interleaving_time, subsegs_per_sidx, daisy_chain_sidx, frag_at_rap, tmpdir,
 									   dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, dash_subduration, min_buffer, ast_shift_sec);
+			}
 			if (e) break;
 
-			if (dash_live) {
-				u32 sleep_for = gf_dasher_next_update_time(dash_ctx, mpd_update_time);
-				fprintf(stderr, "sleep for %d ms\n", sleep_for);
+			if (dasher) {
+				u32 sleep_for;
+				if (dash_ctx_file) gf_cfg_save(dash_ctx);
+				sleep_for = gf_dasher_live_next_update_time(dasher);
+				if (!dash_follow_inputs) fprintf(stderr, "sleep for %d ms\n", sleep_for);
 				while (1) {
 					if (gf_prompt_has_input()) {
 						char c = (char) gf_prompt_get_char();
@@ -2826,12 +2904,20 @@ int mp4boxMain(int argc, char **argv)
 					if (dash_dynamic != 2) {
 						gf_sleep(100);
 					}
-					sleep_for = gf_dasher_next_update_time(dash_ctx, mpd_update_time);
+					sleep_for = gf_dasher_live_next_update_time(dasher);
 				}
 			} else {
 				break;
 			}
 		}
+		if (dasher) {
+			if (dash_follow_inputs) {
+				u32 nb_measures, last_ms, avg_ms, max_ms;
+				gf_dasher_live_get_latency(dasher, &nb_measures, &last_ms, &avg_ms, &max_ms);
+				fprintf(stderr, "Input to segment availability latency: %d measures - last %d ms - average %d ms - max %d ms\n", nb_measures, last_ms, avg_ms, max_ms);
+			}
+			gf_dasher_live_del(dasher);
+		}
 
 		if (dash_ctx) {
 			if (do_abort==2) {
@@ -2846,7 +2932,7 @@ int mp4boxMain(int argc, char **argv)
 		}
 		if (e) fprintf(stderr, "Error DASHing file: %s\n", gf_error_to_string(e));
 
-		gf_sys_close();
+		mp4box_sys_close();
 		MP4BOX_EXIT_WITH_CODE( (e!=GF_OK) ? 1 : 0 );
 	}
 
@@ -2926,6 +3012,22 @@ int mp4boxMain(int argc, char **argv)
 				if (dump_m2ts) {
 #ifndef GPAC_DISABLE_MPEG2TS
 					dump_mpeg2_ts(inName, pes_dump, program_number);
+#endif
+				} else if (build_tsidx) {
+#ifndef GPAC_DISABLE_MPEG2TS
+					GF_M2TS_Index *ts_idx;
+					char szIndex[GF_MAX_PATH];
+					sprintf(szIndex, "%s.tsidx", inName);
+					e = gf_m2ts_index_build(inName, &ts_idx);
+					if (!e) {
+						e = gf_m2ts_index_save(ts_idx, szIndex);
+						gf_m2ts_index_del(ts_idx);
+					}
+					if (e) {
+						fprintf(stderr, "Error indexing %s: %s\n", inName, gf_error_to_string(e));
+						MP4BOX_EXIT_WITH_CODE(1);
+					}
+					fprintf(stderr, "Index written to %s\n", szIndex);
 #endif
 				} else if (dump_timestamps) {
 #ifndef GPAC_DISABLE_MPEG2TS
@@ -3179,7 +3281,7 @@ int mp4boxMain(int argc, char **argv)
 	}
 	if (!open_edit && !needSave) {
 		if (file) gf_isom_delete(file);
-		gf_sys_close();
+		mp4box_sys_close();
 		MP4BOX_EXIT_WITH_CODE(0);
 	}
 
@@ -3243,7 +3345,7 @@ int mp4boxMain(int argc, char **argv)
 	if (!encode) {
 		if (!file) {
 			fprintf(stderr, "Nothing to do - exiting\n");
-			gf_sys_close();
+			mp4box_sys_close();
 			MP4BOX_EXIT_WITH_CODE(0);
 		}
 		if (outName) {
@@ -3349,6 +3451,7 @@ int mp4boxMain(int argc, char **argv)
 
 #ifndef GPAC_DISABLE_MCRYPT
 		if (ismaCrypt) {
+			gf_ismacryp_set_threads(nb_threads);
 			if (ismaCrypt == 1) {
 				if (!drm_file) {
 					fprintf(stderr, "Missing DRM file location - usage '-%s drm_file input_file\n", (ismaCrypt==1) ? "crypt" : "decrypt");
@@ -3588,7 +3691,7 @@ int mp4boxMain(int argc, char **argv)
 			if (gf_delete_file(inName)) fprintf(stderr, "Error removing file %s\n", inName);
 			else if (gf_move_file(outfile, inName)) fprintf(stderr, "Error renaming file %s to %s\n", outfile, inName);
 		}
-		gf_sys_close();
+		mp4box_sys_close();
 		MP4BOX_EXIT_WITH_CODE( (e!=GF_OK) ? 1 : 0 );
 	}
 #endif
@@ -3705,20 +3808,20 @@ int mp4boxMain(int argc, char **argv)
 		gf_isom_delete(file);
 	}
 	/*close libgpac*/
-	gf_sys_close();
+	mp4box_sys_close();
 
 	if (e) fprintf(stderr, "Error: %s\n", gf_error_to_string(e));
 	MP4BOX_EXIT_WITH_CODE( (e!=GF_OK) ? 1 : 0 );
 #else
 	/*close libgpac*/
-	gf_sys_close();
+	mp4box_sys_close();
 	gf_isom_delete(file);
 	fprintf(stderr, "Error: Read-only version of MP4Box.\n");
 	MP4BOX_EXIT_WITH_CODE(1);
 #endif
 err_exit:
 	/*close libgpac*/
-	gf_sys_close();
+	mp4box_sys_close();
 	if (file) gf_isom_delete(file);
 	fprintf(stderr, "\n\tError: %s\n", gf_error_to_string(e));
 	MP4BOX_EXIT_WITH_CODE(1);
@@ -577,7 +577,378 @@ void dump_frame(GF_Terminal *term, char *rad_name, u32 dump_type, u32 frameNum,
 	gf_sc_release_screen_buffer(term->compositor, &fb);
 }
 
-Bool dump_file(char *url, u32 dump_mode, Double fps, u32 width, u32 height, Float scale, u32 *times, u32 nb_times)
+/*offscreen frame sinks: frames are streamed as raw planar YUV 4:2:0 (I420) to a file, stdout or a pipe*/
+typedef struct _frame_sink FrameSink;
+struct _frame_sink
+{
+	GF_Err (*open)(FrameSink *sink, const char *dst);
+	GF_Err (*write_frame)(FrameSink *sink, char *data, u32 size);
+	void (*close)(FrameSink *sink);
+	FILE *out;
+};
+
+static GF_Err file_sink_open(FrameSink *sink, const char *dst)
+{
+	if (!strcmp(dst, "-")) {
+		sink->out = stdout;
+		return GF_OK;
+	}
+	sink->out = gf_f64_open(dst, "wb");
+	return sink->out ? GF_OK : GF_IO_ERR;
+}
+static GF_Err file_sink_write(FrameSink *sink, char *data, u32 size)
+{
+	if (fwrite(data, 1, size, sink->out) != size) return GF_IO_ERR;
+	return GF_OK;
+}
+static void file_sink_close(FrameSink *sink)
+{
+	if (!sink->out) return;
+	if (sink->out==stdout) fflush(stdout);
+	else fclose(sink->out);
+	sink->out = NULL;
+}
+
+#ifdef WIN32
+#define popen	_popen
+#define pclose	_pclose
+#endif
+
+/*dst is "|command", the command reads frames on its standard input*/
+static GF_Err pipe_sink_open(FrameSink *sink, const char *dst)
+{
+	sink->out = popen(dst+1, "w");
+	return sink->out ? GF_OK : GF_IO_ERR;
+}
+static void pipe_sink_close(FrameSink *sink)
+{
+	if (!sink->out) return;
+	pclose(sink->out);
+	sink->out = NULL;
+}
+
+static void setup_frame_sink(FrameSink *sink, const char *dst)
+{
+	memset(sink, 0, sizeof(FrameSink));
+	sink->write_frame = file_sink_write;
+	if (dst[0]=='|') {
+		sink->open = pipe_sink_open;
+		sink->close = pipe_sink_close;
+	} else {
+		sink->open = file_sink_open;
+		sink->close = file_sink_close;
+	}
+}
+
+/*RGB to YUV 4:2:0 conversion, BT.601 studio swing. Pairs of lines are converted in parallel on a task pool if more
+than one thread is used*/
+typedef struct
+{
+	u32 width, height;
+	GF_TaskPool *pool;
+	/*current frame*/
+	u8 *src;
+	u32 src_pitch, bpp, r_off, g_off, b_off;
+	u8 *y, *u, *v;
+} YUVConverter;
+
+#define RGB_TO_Y(_r, _g, _b)	(u8) ((( 66*(_r) + 129*(_g) +  25*(_b) + 128) >> 8) + 16)
+#define RGB_TO_U(_r, _g, _b)	(u8) (((-38*(_r) -  74*(_g) + 112*(_b) + 128) >> 8) + 128)
+#define RGB_TO_V(_r, _g, _b)	(u8) (((112*(_r) -  94*(_g) -  18*(_b) + 128) >> 8) + 128)
+
+static void yuv_convert_band(YUVConverter *conv, u32 first_row, u32 nb_rows)
+{
+	u32 i, j;
+	u32 uv_w = (conv->width+1)/2;
+	u32 bpp = conv->bpp;
+
+	for (j=first_row; j<first_row+nb_rows; j+=2) {
+		/*odd heights: last line is used twice*/
+		u32 j2 = (j+1<conv->height) ? j+1 : j;
+		u8 *s1 = conv->src + j*conv->src_pitch;
+		u8 *s2 = conv->src + j2*conv->src_pitch;
+		u8 *y1 = conv->y + j*conv->width;
+		u8 *y2 = conv->y + j2*conv->width;
+		u8 *pu = conv->u + (j/2)*uv_w;
+		u8 *pv = conv->v + (j/2)*uv_w;
+
+		for (i=0; i<conv->width; i+=2) {
+			s32 r, g, b, r_sum, g_sum, b_sum;
+			u32 n = (i+1<conv->width) ? 1 : 0;
+
+			r = s1[conv->r_off];
+			g = s1[conv->g_off];
+			b = s1[conv->b_off];
+			y1[i] = RGB_TO_Y(r, g, b);
+			r_sum = r;
+			g_sum = g;
+			b_sum = b;
+
+			r = s2[conv->r_off];
+			g = s2[conv->g_off];
+			b = s2[conv->b_off];
+			y2[i] = RGB_TO_Y(r, g, b);
+			r_sum += r;
+			g_sum += g;
+			b_sum += b;
+
+			r = s1[n*bpp + conv->r_off];
+			g = s1[n*bpp + conv->g_off];
+			b = s1[n*bpp + conv->b_off];
+			if (n) y1[i+1] = RGB_TO_Y(r, g, b);
+			r_sum += r;
+			g_sum += g;
+			b_sum += b;
+
+			r = s2[n*bpp + conv->r_off];
+			g = s2[n*bpp + conv->g_off];
+			b = s2[n*bpp + conv->b_off];
+			if (n) y2[i+1] = RGB_TO_Y(r, g, b);
+			r_sum += r;
+			g_sum += g;
+			b_sum += b;
+
+			r_sum = (r_sum+2)/4;
+			g_sum = (g_sum+2)/4;
+			b_sum = (b_sum+2)/4;
+			pu[i/2] = RGB_TO_U(r_sum, g_sum, b_sum);
+			pv[i/2] = RGB_TO_V(r_sum, g_sum, b_sum);
+
+			s1 += 2*bpp;
+			s2 += 2*bpp;
+		}
+	}
+}
+
+/*start and end are line pair indexes*/
+static GF_Err yuv_convert_rows(void *par, u32 start, u32 end)
+{
+	YUVConverter *conv = (YUVConverter *)par;
+	yuv_convert_band(conv, 2*start, MIN(2*end, conv->height) - 2*start);
+	return GF_OK;
+}
+
+static YUVConverter *yuv_converter_new(u32 width, u32 height, u32 nb_threads)
+{
+	YUVConverter *conv;
+	GF_SAFEALLOC(conv, YUVConverter);
+	if (!conv) return NULL;
+	conv->width = width;
+	conv->height = height;
+	if (nb_threads>1) conv->pool = gf_task_pool_new("YUVConvert", nb_threads);
+	return conv;
+}
+
+static void yuv_converter_del(YUVConverter *conv)
+{
+	if (conv->pool) gf_task_pool_del(conv->pool);
+	gf_free(conv);
+}
+
+static GF_Err yuv_converter_process(YUVConverter *conv, GF_VideoSurface *fb, char *dst)
+{
+	switch (fb->pixel_format) {
+	case GF_PIXEL_RGB_24:
+		conv->bpp = 3;
+		conv->r_off = 0;
+		conv->g_off = 1;
+		conv->b_off = 2;
+		break;
+	case GF_PIXEL_BGR_24:
+		conv->bpp = 3;
+		conv->r_off = 2;
+		conv->g_off = 1;
+		conv->b_off = 0;
+		break;
+	case GF_PIXEL_RGB_32:
+	case GF_PIXEL_ARGB:
+		conv->bpp = 4;
+		conv->r_off = 2;
+		conv->g_off = 1;
+		conv->b_off = 0;
+		break;
+	case GF_PIXEL_BGR_32:
+	case GF_PIXEL_RGBA:
+		conv->bpp = 4;
+		conv->r_off = 0;
+		conv->g_off = 1;
+		conv->b_off = 2;
+		break;
+	default:
+		return GF_NOT_SUPPORTED;
+	}
+	if ((fb->width != conv->width) || (fb->height != conv->height)) return GF_BAD_PARAM;
+
+	conv->src = (u8 *) fb->video_buffer;
+	conv->src_pitch = fb->pitch_y;
+	conv->y = (u8 *) dst;
+	conv->u = conv->y + conv->width*conv->height;
+	conv->v = conv->u + ((conv->width+1)/2) * ((conv->height+1)/2);
+
+	if (!conv->pool) return yuv_convert_rows(conv, 0, (conv->height+1)/2);
+	/*bands of 16 lines*/
+	return gf_task_pool_parallel_for(conv->pool, 0, (conv->height+1)/2, 8, yuv_convert_rows, conv);
+}
+
+/*called for each dumped frame once the scene is ready, frame_num starting at 1. Any error stops the dump*/
+typedef GF_Err (*DumpFrameCallback)(void *udta, u32 frame_num);
+
+/*deterministic offscreen rendering: the clocks are stepped by exactly one frame duration after each frame, and
+frames are produced as fast as the compositor can draw them. The time spent waiting for the scene is accumulated in
+render_time if set. Returns the number of dumped frames*/
+static u32 dump_frames(GF_Terminal *term, Double fps, u32 *times, u32 nb_times, DumpFrameCallback on_frame, void *udta, u64 *render_time)
+{
+	u32 time, prev_time, nb_frames;
+	u64 dump_dur, now;
+
+	time = prev_time = 0;
+	nb_frames = 0;
+	if (nb_times==2) {
+		dump_dur = times[1] - times[0];
+	} else {
+		dump_dur = times[0] ? times[0] : Duration;
+	}
+	if (!dump_dur) {
+		fprintf(stderr, "Warning: file has no duration, defaulting to 1 sec\n");
+		dump_dur = 1000;
+	}
+
+	/*step to first frame*/
+	if ((nb_times==2) && times[0]) gf_term_step_clocks(term, times[0]);
+
+	while (time < dump_dur) {
+		now = gf_sys_clock_high_res();
+		while ((gf_term_get_option(term, GF_OPT_PLAY_STATE) == GF_STATE_STEP_PAUSE)) {
+			gf_term_process_flush(term);
+		}
+		if (render_time) *render_time += gf_sys_clock_high_res() - now;
+
+		if (on_frame(udta, nb_frames+1) != GF_OK) break;
+
+		nb_frames++;
+		time = (u32) (nb_frames*1000/fps);
+		gf_term_step_clocks(term, time - prev_time);
+		prev_time = time;
+		fprintf(stderr, "Dumping %02d/100 %% - time %.02f sec\r", (u32) ((100.0*time)/dump_dur), time/1000.0);
+
+		if (gf_prompt_has_input() && (gf_prompt_get_char()=='q')) {
+			fprintf(stderr, "Aborting dump\n");
+			break;
+		}
+	}
+	return nb_frames;
+}
+
+typedef struct
+{
+	GF_Terminal *term;
+	YUVConverter *conv;
+	FrameSink *sink;
+	char *yuv_buf;
+	u32 frame_size;
+	u64 conv_time, write_time;
+} YUVDump;
+
+static GF_Err dump_yuv_frame(void *udta, u32 frame_num)
+{
+	GF_Err e;
+	GF_VideoSurface fb;
+	u64 now;
+	YUVDump *dump = (YUVDump *)udta;
+
+	now = gf_sys_clock_high_res();
+	e = gf_sc_get_screen_buffer(dump->term->compositor, &fb, 0);
+	if (!e) {
+		e = yuv_converter_process(dump->conv, &fb, dump->yuv_buf);
+		gf_sc_release_screen_buffer(dump->term->compositor, &fb);
+	}
+	dump->conv_time += gf_sys_clock_high_res() - now;
+	if (e) {
+		fprintf(stderr, "Error converting frame: %s\n", gf_error_to_string(e));
+		return e;
+	}
+
+	now = gf_sys_clock_high_res();
+	e = dump->sink->write_frame(dump->sink, dump->yuv_buf, dump->frame_size);
+	dump->write_time += gf_sys_clock_high_res() - now;
+	if (e) fprintf(stderr, "Error writing frame: %s\n", gf_error_to_string(e));
+	return e;
+}
+
+static Bool dump_yuv(GF_Terminal *term, char *szPath, const char *out_dst, u32 nb_threads, Double fps, u32 width, u32 height, u32 *times, u32 nb_times)
+{
+	GF_Err e;
+	FrameSink sink;
+	YUVDump dump;
+	char szOut[GF_MAX_PATH];
+	u32 nb_frames;
+	u64 start, now, render_time;
+
+	if (!fps) fps = GF_IMPORT_DEFAULT_FPS;
+	if (out_dst) {
+		strncpy(szOut, out_dst, GF_MAX_PATH-1);
+		szOut[GF_MAX_PATH-1] = 0;
+	} else {
+		snprintf(szOut, GF_MAX_PATH, "%s_%dx%d.yuv", szPath, width, height);
+		szOut[GF_MAX_PATH-1] = 0;
+	}
+	setup_frame_sink(&sink, szOut);
+	e = sink.open(&sink, szOut);
+	if (e) {
+		fprintf(stderr, "Error opening output %s: %s\n", szOut, gf_error_to_string(e));
+		return 1;
+	}
+
+	memset(&dump, 0, sizeof(YUVDump));
+	dump.term = term;
+	dump.sink = &sink;
+	dump.frame_size = width*height + 2 * ((width+1)/2) * ((height+1)/2);
+	dump.yuv_buf = (char *) gf_malloc(sizeof(char) * dump.frame_size);
+	dump.conv = yuv_converter_new(width, height, nb_threads);
+	fprintf(stderr, "Dumping %dx%d YUV 4:2:0 at %g FPS to %s (%d conversion thread%s)\n", width, height, fps, szOut, dump.conv->pool ? gf_task_pool_get_thread_count(dump.conv->pool) : 1, dump.conv->pool ? "s" : "");
+
+	render_time = 0;
+	start = gf_sys_clock_high_res();
+	nb_frames = dump_frames(term, fps, times, nb_times, dump_yuv_frame, &dump, &render_time);
+	now = gf_sys_clock_high_res() - start;
+	yuv_converter_del(dump.conv);
+	sink.close(&sink);
+	gf_free(dump.yuv_buf);
+
+	fprintf(stderr, "YUV Extraction 100/100\n");
+	fprintf(stderr, "%d frames in %.03f sec - %.02f FPS (render %.02f ms - convert %.02f ms - write %.02f ms per frame)\n",
+	        nb_frames, now/1000000.0, now ? nb_frames*1000000.0/now : 0,
+	        nb_frames ? render_time/1000.0/nb_frames : 0, nb_frames ? dump.conv_time/1000.0/nb_frames : 0, nb_frames ? dump.write_time/1000.0/nb_frames : 0);
+	return 0;
+}
+
+#ifndef GPAC_DISABLE_AVILIB
+typedef struct
+{
+	GF_Terminal *term;
+	u32 dump_mode;
+	char *szPath, *szPath_depth;
+	char *conv_buf;
+	avi_t *avi_out, *depth_avi_out;
+} AVIDump;
+
+static GF_Err dump_avi_frame(void *udta, u32 frame_num)
+{
+	AVIDump *dump = (AVIDump *)udta;
+	if (dump->dump_mode==8) {
+		/*we'll dump both buffers at once*/
+		gf_mx_p(dump->term->compositor->mx);
+		dump_depth(dump->term, dump->szPath_depth, dump->dump_mode, frame_num, dump->conv_buf, dump->depth_avi_out);
+		dump_frame(dump->term, dump->szPath, dump->dump_mode, frame_num, dump->conv_buf, dump->avi_out);
+		gf_mx_v(dump->term->compositor->mx);
+	} else {
+		dump_frame(dump->term, dump->szPath, dump->dump_mode, frame_num, dump->conv_buf, dump->avi_out);
+	}
+	return GF_OK;
+}
+#endif
+
+Bool dump_file(char *url, u32 dump_mode, Double fps, u32 width, u32 height, Float scale, u32 *times, u32 nb_times, const char *out_dst, u32 nb_threads)
 {
 	GF_Err e;
 	u32 i = 0;
@@ -649,14 +1020,16 @@ Bool dump_file(char *url, u32 dump_mode, Double fps, u32 width, u32 height, Floa
 		gf_sc_release_screen_buffer(term->compositor, &fb);
 	}
 
+	if (dump_mode==12) {
+		return dump_yuv(term, szPath, out_dst, nb_threads, fps, width, height, times, nb_times);
+	}
+
 	if (dump_mode==1 || dump_mode==5 || dump_mode==8 || dump_mode==10) {
 #ifdef GPAC_DISABLE_AVILIB
 		fprintf(stderr, "AVILib is disabled in this build of GPAC\n");
 		return 0;
 #else
-		u32 time, prev_time, nb_frames;
-		u64 dump_dur;
-		char *conv_buf;
+		AVIDump dump;
 		avi_t *avi_out = NULL;
 		avi_t *depth_avi_out = NULL;
 		char szPath_depth[GF_MAX_PATH];
@@ -678,57 +1051,26 @@ Bool dump_file(char *url, u32 dump_mode, Double fps, u32 width, u32 height, Floa
 		}
 
 		if (!fps) fps = GF_IMPORT_DEFAULT_FPS;
-		time = prev_time = 0;
-		nb_frames = 0;
-
-		if (nb_times==2) {
-			prev_time = times[0];
-			dump_dur = times[1] - times[0];
-		} else {
-			dump_dur = times[0] ? times[0] : Duration;
-		}
-		if (!dump_dur) {
-			fprintf(stderr, "Warning: file has no duration, defaulting to 1 sec\n");
-			dump_dur = 1000;
-		}
 
 		comp[0] = comp[1] = comp[2] = comp[3] = comp[4] = 0;
 		AVI_set_video(avi_out, width, height, fps, comp);
 		if (dump_mode==8) AVI_set_video(depth_avi_out, width, height, fps, comp);
-		if (dump_mode != 5 && dump_mode!=10) conv_buf = gf_malloc(sizeof(char) * width * height * 3);
-		else conv_buf = gf_malloc(sizeof(char) * width * height * 4);
-		/*step to first frame*/
-		if (prev_time) gf_term_step_clocks(term, prev_time);
-
-		while (time < dump_dur) {
-			while ((gf_term_get_option(term, GF_OPT_PLAY_STATE) == GF_STATE_STEP_PAUSE)) {
-				gf_term_process_flush(term);
-			}
-			fprintf(stderr, "Dumping %02d/100 %% - time %.02f sec\r", (u32) ((100.0*prev_time)/dump_dur), prev_time/1000.0 );
 
-			if (dump_mode==8) {
-				/*we'll dump both buffers at once*/
-				gf_mx_p(term->compositor->mx);
-				dump_depth(term, szPath_depth, dump_mode, i+1, conv_buf, depth_avi_out);
-				dump_frame(term, szPath, dump_mode, i+1, conv_buf, avi_out);
-				gf_mx_v(term->compositor->mx);
-
-			}
-			else dump_frame(term, szPath, dump_mode, i+1, conv_buf, avi_out);
+		memset(&dump, 0, sizeof(AVIDump));
+		dump.term = term;
+		dump.dump_mode = dump_mode;
+		dump.szPath = szPath;
+		dump.szPath_depth = szPath_depth;
+		dump.avi_out = avi_out;
+		dump.depth_avi_out = depth_avi_out;
+		if (dump_mode != 5 && dump_mode!=10) dump.conv_buf = gf_malloc(sizeof(char) * width * height * 3);
+		else dump.conv_buf = gf_malloc(sizeof(char) * width * height * 4);
 
-			nb_frames++;
-			time = (u32) (nb_frames*1000/fps);
-			gf_term_step_clocks(term, time - prev_time);
-			prev_time = time;
+		dump_frames(term, fps, times, nb_times, dump_avi_frame, &dump, NULL);
 
-			if (gf_prompt_has_input() && (gf_prompt_get_char()=='q')) {
-				fprintf(stderr, "Aborting dump\n");
-				break;
-			}
-		}
 		AVI_close(avi_out);
 		if (dump_mode==8) AVI_close(depth_avi_out);
-		gf_free(conv_buf);
+		gf_free(dump.conv_buf);
 		fprintf(stderr, "AVI Extraction 100/100\n");
 #endif /*GPAC_DISABLE_AVILIB*/
 	} else {
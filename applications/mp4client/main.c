@@ -107,7 +107,7 @@ u32 last_x, last_y;
 Bool right_down = 0;
 
 void dump_frame(GF_Terminal *term, char *rad_path, u32 dump_type, u32 frameNum);
-Bool dump_file(char *the_url, u32 dump_mode, Double fps, u32 width, u32 height, Float scale, u32 *times, u32 nb_times);
+Bool dump_file(char *the_url, u32 dump_mode, Double fps, u32 width, u32 height, Float scale, u32 *times, u32 nb_times, const char *out_dst, u32 nb_threads);
 
 
 void hide_shell(u32 cmd_type)
@@ -134,10 +134,12 @@ void PrintUsage()
 #endif
 		"\t-rti fileName:  logs run-time info (FPS, CPU, Mem usage) to file\n"
 		"\t-rtix fileName: same as -rti but driven by GPAC logs\n"
+		"\t-mem-tags file: dumps every second the memory used by each subsystem to file (requires --account-memory build)\n"
 		"\t-quiet:         removes script message, buffering and downloading status\n"
 		"\t-strict-error:  exit when the player reports its first error\n"
 		"\t-opt option:    Overrides an option in the configuration file. String format is section:key=value\n"
 		"\t-log-file file: sets output log file. Also works with -lf\n"
+		"\t-log-async:     writes logs from a dedicated thread, messages being queued by the logging threads\n"
 		"\t-logs log_args: sets log tools and levels, formatted as a ':'-separated list of toolX[:toolZ]@levelX\n"
 		"\t                 levelX can be one of:\n"
 		"\t        \"quiet\"      : skip logs\n"
@@ -175,6 +177,7 @@ void PrintUsage()
 		"\t        \"mutex\"      : mutex\n"
 		"\t        \"all\"        : all tools logged - other tools can be specified afterwards.\n"
 		"\n"
+		"\t-trace file:    records decoding, composition, demux and network timings and dumps them in file as Chrome trace JSON\n"
 		"\t-size WxH:      specifies visual size (default: scene size)\n"
 #if defined(__DARWIN__) || defined(__APPLE__)
 		"\t-thread:        enables thread usage for terminal and compositor \n"
@@ -206,6 +209,10 @@ void PrintUsage()
 		"\t-png [times]:   dumps given frames to png\n"
 		"\t-raw [times]:   dumps given frames to raw\n"
 		"\t-avi [times]:   dumps given file to raw avi\n"
+		"\t-yuv [times]:   renders given file offscreen to raw YUV 4:2:0, stepping clocks by one frame at a time\n"
+		"\t-out dst:       sets YUV output: file name, \"-\" for stdout or \"|command\" to pipe frames to command\n"
+		"                   (default: URL_WxH.yuv)\n"
+		"\t-yuv-threads N: uses N threads for RGB to YUV conversion (default: 1)\n"
 		"\t-rgbds:         dumps the RGBDS pixel format texture\n"
 		"                   with -avi [times]: dumps an rgbds-format .avi\n"
 		"\t-rgbd:          dumps the RGBD pixel format texture\n"
@@ -344,18 +351,37 @@ static void UpdateRTInfo(const char *legend)
 		}
 	}
 	if (rti_logs) {
-		fprintf(rti_logs, "% 8d\t% 8d\t% 8d\t% 4d\t% 8d\t%s",
+		fprintf(rti_logs, "% 8d\t% 8d\t% 8d\t% 4d\t% 8d\t% 8d\t% 8d\t%s",
 			gf_sys_clock(),
 			gf_term_get_time_in_ms(term),
 			rti.total_cpu_usage,
 			(u32) gf_term_get_framerate(term, 0),
 			(u32) (rti.gpac_memory / 1024),
+			rti.lock_contentions,
+			rti.lock_wait_time,
 			legend ? legend : ""
 			);
 		if (!legend) fprintf(rti_logs, "\n");
 	}
 }
 
+static FILE *mem_tags_logs = NULL;
+static u32 mem_tags_last_time = 0;
+
+/*dumps per-subsystem memory usage every second*/
+static void UpdateMemoryTags(Bool force)
+{
+	u32 now;
+	if (!mem_tags_logs) return;
+	now = gf_sys_clock();
+	if (!force && (now < mem_tags_last_time + 1000)) return;
+	mem_tags_last_time = now;
+	fprintf(mem_tags_logs, "At %d ms\n", now);
+	gf_sys_dump_memory_tags(mem_tags_logs);
+	fprintf(mem_tags_logs, "\n");
+	fflush(mem_tags_logs);
+}
+
 static void ResetCaption()
 {
 	GF_Event event;
@@ -852,7 +878,11 @@ static void on_gpac_log(void *cbk, u32 ll, u32 lm, const char *fmt, va_list list
 		vsprintf(szMsg, fmt, list);
 		UpdateRTInfo(szMsg + 6 /*"[RTI] "*/);
 	} else {
-		if (log_time_start) fprintf(logs, "[At %d]", gf_sys_clock() - log_time_start);
+		if (log_time_start) {
+			u32 log_time;
+			gf_log_get_record_info(&log_time, NULL);
+			fprintf(logs, "[At %d]", log_time - log_time_start);
+		}
 		vfprintf(logs, fmt, list);
 		fflush(logs);
 	}
@@ -866,7 +896,7 @@ static void init_rti_logs(char *rti_file, char *url, Bool use_rtix)
 		fprintf(rti_logs, "!! GPAC RunTime Info ");
 		if (url) fprintf(rti_logs, "for file %s", url);
 		fprintf(rti_logs, " !!\n");
-		fprintf(rti_logs, "SysTime(ms)\tSceneTime(ms)\tCPU\tFPS\tMemory(kB)\tObservation\n");
+		fprintf(rti_logs, "SysTime(ms)\tSceneTime(ms)\tCPU\tFPS\tMemory(kB)\tLockContentions\tLockWait(ms)\tObservation\n");
 
 		/*turn on RTI loging*/
 		if (use_rtix) {
@@ -912,7 +942,7 @@ int main (int argc, char **argv)
 {
 	char c;
 	const char *str;
-	u32 i, times[100], nb_times, dump_mode;
+	u32 i, times[100], nb_times, dump_mode, yuv_threads;
 	u32 simulation_time_in_ms = 0;
 	Bool auto_exit = 0;
 	Bool logs_set = 0;
@@ -927,7 +957,7 @@ int main (int argc, char **argv)
 #endif
 	Double fps = GF_IMPORT_DEFAULT_FPS;
 	Bool fill_ar, visible;
-	char *url_arg, *the_cfg, *rti_file, *views;
+	char *url_arg, *the_cfg, *rti_file, *views, *trace_file, *out_dst;
 	FILE *logfile = NULL;
 	Float scale = 1;
 #ifndef WIN32
@@ -941,7 +971,8 @@ int main (int argc, char **argv)
 
 	dump_mode = 0;
 	fill_ar = visible = 0;
-	url_arg = the_cfg = rti_file = views = NULL;
+	url_arg = the_cfg = rti_file = views = trace_file = out_dst = NULL;
+	yuv_threads = 1;
 	nb_times = 0;
 	times[0] = 0;
 
@@ -1037,6 +1068,15 @@ int main (int argc, char **argv)
 		} else if (!strcmp(arg, "-raw")) {
 			dump_mode = 3;
 			if ((url_arg || (i+2<(u32)argc)) && get_time_list(argv[i+1], times, &nb_times)) i++;
+		} else if (!strcmp(arg, "-yuv")) {
+			dump_mode = 12;
+			if ((url_arg || (i+2<(u32)argc)) && get_time_list(argv[i+1], times, &nb_times)) i++;
+		} else if (!strcmp(arg, "-out")) {
+			out_dst = argv[i+1];
+			i++;
+		} else if (!strcmp(arg, "-yuv-threads")) {
+			yuv_threads = atoi(argv[i+1]);
+			i++;
 
 		} else if (!stricmp(arg, "-size")) {
 			/*usage of %ud breaks sscanf on MSVC*/
@@ -1064,6 +1104,16 @@ int main (int argc, char **argv)
 			}
 			logs_set = 1;
 			i++;
+		} else if (!strcmp(arg, "-trace") ) {
+			trace_file = argv[i+1];
+			gf_trace_enable(1);
+			i++;
+		} else if (!strcmp(arg, "-mem-tags") ) {
+			mem_tags_logs = gf_f64_open(argv[i+1], "wt");
+			if (!mem_tags_logs) fprintf(stderr, "Cannot open memory tags file %s\n", argv[i+1]);
+			i++;
+		} else if (!strcmp(arg, "-log-async")) {
+			gf_log_set_async(1);
 		} else if (!strcmp(arg, "-log-clock") || !strcmp(arg, "-lc")) {
 			log_time_start = 1;
 		} else if (!strcmp(arg, "-align")) {
@@ -1240,7 +1290,7 @@ int main (int argc, char **argv)
 			times[0] = 0;
 			nb_times++;
 		}
-		dump_file(url_arg, dump_mode, fps, forced_width, forced_height, scale, times, nb_times);
+		dump_file(url_arg, dump_mode, fps, forced_width, forced_height, scale, times, nb_times, out_dst, yuv_threads);
 		Run = 0;
 	} else
 
@@ -1325,6 +1375,7 @@ int main (int argc, char **argv)
 				goto force_input;
 			}
 			if (!use_rtix || display_rti) UpdateRTInfo(NULL);
+			UpdateMemoryTags(0);
 			if (term_step) {
 				gf_term_process_step(term);
 				if (auto_exit && gf_term_get_option(term, GF_OPT_IS_OVER)) {
@@ -1669,6 +1720,7 @@ force_input:
 			GF_SystemRTInfo rti;
 			gf_sys_get_rti(rti_update_time_ms, &rti, 0);
 			fprintf(stderr, "GPAC allocated memory "LLD"\n", rti.gpac_memory);
+			fprintf(stderr, "Mutex contentions %d - %d ms spent waiting\n", rti.lock_contentions, rti.lock_wait_time);
 		}
 			break;
 		case 'M':
@@ -1779,18 +1831,24 @@ force_input:
 	i = gf_sys_clock();
 	gf_term_disconnect(term);
 	if (rti_file) UpdateRTInfo("Disconnected\n");
+	UpdateMemoryTags(1);
 
 	fprintf(stderr, "Deleting terminal... ");
 	if (playlist) fclose(playlist);
 	gf_term_del(term);
 	fprintf(stderr, "done (in %d ms)\n", gf_sys_clock() - i);
 
+	if (trace_file) {
+		if (gf_trace_dump(trace_file) != GF_OK) fprintf(stderr, "Cannot write trace file %s\n", trace_file);
+	}
+
 	fprintf(stderr, "GPAC cleanup ...\n");
 	gf_modules_del(user.modules);
 	gf_cfg_del(cfg_file);
 
 	gf_sys_close();
 	if (rti_logs) fclose(rti_logs);
+	if (mem_tags_logs) fclose(mem_tags_logs);
 	if (logfile) fclose(logfile);
 
 	if (gui_mode) {
@@ -2123,6 +2181,7 @@ void ViewOD(GF_Terminal *term, u32 OD_ID, u32 number)
 	else fprintf(stderr, "Not buffering - ");
 	fprintf(stderr, "Clock drift: %d ms\n", odi.clock_drift);
 	if (odi.db_unit_count) fprintf(stderr, "%d AU in DB\n", odi.db_unit_count);
+	if (odi.db_pool_hits + odi.db_pool_misses) fprintf(stderr, "DB pool: %d %% hits (%d AU buffers allocated)\n", 100*odi.db_pool_hits / (odi.db_pool_hits + odi.db_pool_misses), odi.db_pool_misses);
 	if (odi.cb_max_count) fprintf(stderr, "Composition Buffer: %d CU (%d max)\n", odi.cb_unit_count, odi.cb_max_count);
 	fprintf(stderr, "\n");
 
@@ -0,0 +1,1751 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2013
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / benchmark suite
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+/*
+	Reproducible benchmark of the main GPAC pipelines.
+
+	All test media (Annex B AVC, ADTS AAC, MPEG-2 TS, BT/XMT-A/SVG scenes, XML documents) is generated locally from a fixed
+	seed, so that results of two GPAC versions built on the same machine can be compared. Results are written as JSON, one
+	entry per benchmark with its duration, throughput and peak resident memory.
+*/
+
+#include "../../../include/gpac/tools.h"
+#include "../../../include/gpac/bitstream.h"
+#include "../../../include/gpac/config_file.h"
+#include "../../../include/gpac/constants.h"
+#include "../../../include/gpac/isomedia.h"
+#include "../../../include/gpac/media_tools.h"
+#include "../../../include/gpac/mpegts.h"
+#include "../../../include/gpac/scene_manager.h"
+#include "../../../include/gpac/scene_engine.h"
+#include "../../../include/gpac/terminal.h"
+#include "../../../include/gpac/thread.h"
+#include "../../../include/gpac/options.h"
+#include "../../../include/gpac/xml.h"
+#include "../../../include/gpac/modules/video_out.h"
+#include "../../../include/gpac/modules/raster2d.h"
+
+#if !defined(WIN32) && !defined(_WIN32_WCE)
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+typedef struct
+{
+	/*JSON output file, NULL for stdout*/
+	const char *out_file;
+	/*JSON entries of the benchmarks done so far*/
+	char *entries;
+	u32 entries_size;
+	char work_dir[GF_MAX_PATH];
+	const char *filter;
+	const char *mods_dir;
+	u32 duration;
+	u32 nb_nodes;
+	u32 nb_frames;
+	u32 nb_threads;
+	Bool keep;
+	u32 nb_done;
+	Bool rss_reset;
+	u32 max_rss;
+
+	/*current benchmark*/
+	const char *name;
+	u64 start;
+
+	/*synthetic media*/
+	char *avc;
+	u32 avc_size, nb_video;
+	u32 *video_offsets, *video_sizes;
+	char *aac;
+	u32 aac_size, nb_audio;
+	u32 *audio_offsets;
+} GF_Bench;
+
+#define BENCH_WIDTH		640
+#define BENCH_HEIGHT	480
+#define BENCH_FPS		25
+#define BENCH_GOP		25
+#define BENCH_AAC_SR	44100
+
+
+static u32 bench_seed = 1;
+/*deterministic LCG, we don't want libc rand() to change results across platforms*/
+static u32 bench_rand()
+{
+	bench_seed = bench_seed * 1103515245 + 12345;
+	return (bench_seed >> 8) & 0x00FFFFFF;
+}
+
+static void bench_path(GF_Bench *bench, char *path, const char *name)
+{
+	if (snprintf(path, GF_MAX_PATH, "%s%c%s", bench->work_dir, GF_PATH_SEPARATOR, name) >= GF_MAX_PATH) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_APP, ("[Bench] Working directory path too long for %s\n", name));
+	}
+	path[GF_MAX_PATH-1] = 0;
+}
+
+static u64 bench_file_size(const char *path)
+{
+	u64 size;
+	FILE *f = gf_f64_open(path, "rb");
+	if (!f) return 0;
+	gf_f64_seek(f, 0, SEEK_END);
+	size = gf_f64_tell(f);
+	fclose(f);
+	return size;
+}
+
+/*returns the peak resident memory in kB since the last reset*/
+static u32 bench_peak_rss()
+{
+#if defined(WIN32) || defined(_WIN32_WCE)
+	/*no peak info without psapi, use current usage*/
+	GF_SystemRTInfo rti;
+	if (!gf_sys_get_rti(0, &rti, GF_RTI_PROCESS_MEMORY)) return 0;
+	return (u32) (rti.process_memory / 1024);
+#else
+	struct rusage ru;
+#if defined(GPAC_CONFIG_LINUX) || defined(__linux__)
+	char line[256];
+	FILE *f = fopen("/proc/self/status", "rt");
+	if (f) {
+		u32 val = 0;
+		while (fgets(line, 256, f)) {
+			if (!strncmp(line, "VmHWM:", 6)) {
+				val = atoi(line+6);
+				break;
+			}
+		}
+		fclose(f);
+		if (val) return val;
+	}
+#endif
+	if (getrusage(RUSAGE_SELF, &ru)) return 0;
+#if defined(__DARWIN__) || defined(__APPLE__)
+	return (u32) (ru.ru_maxrss / 1024);
+#else
+	return (u32) ru.ru_maxrss;
+#endif
+
+#endif
+}
+
+/*resets the peak resident memory counter, only possible on linux*/
+static Bool bench_reset_peak_rss()
+{
+#if defined(GPAC_CONFIG_LINUX) || defined(__linux__)
+	FILE *f = fopen("/proc/self/clear_refs", "wt");
+	if (f) {
+		Bool ok = (fputs("5", f) >= 0) ? 1 : 0;
+		if (fclose(f)) ok = 0;
+		return ok;
+	}
+#endif
+	return 0;
+}
+
+static Bool bench_begin(GF_Bench *bench, const char *name)
+{
+	if (bench->filter && !strstr(bench->filter, name)) return 0;
+	bench->name = name;
+	bench->rss_reset = bench_reset_peak_rss();
+	bench->start = gf_sys_clock_high_res();
+	return 1;
+}
+
+/*writes the results of all benchmarks done so far, so that a crash in a later benchmark does not corrupt them*/
+static Bool bench_write_results(GF_Bench *bench, Bool done)
+{
+	FILE *json;
+	if (bench->out_file) {
+		json = gf_f64_open(bench->out_file, "wt");
+		if (!json) return 0;
+	} else {
+		/*stdout cannot be rewritten, only print final results*/
+		if (!done) return 1;
+		json = stdout;
+	}
+	fprintf(json, "{\n\t\"gpac_version\": \"%s\",\n\t\"media_duration\": %d,\n\t\"scene_nodes\": %d,\n\t\"complete\": %s,\n\t\"benchmarks\": [\n",
+	        GPAC_FULL_VERSION, bench->duration, bench->nb_nodes, done ? "true" : "false");
+	if (bench->entries) fprintf(json, "%s", bench->entries);
+	fprintf(json, "\n\t],\n\t\"peak_rss_reset\": %s,\n\t\"max_peak_rss_kb\": %d\n}\n", bench->rss_reset ? "true" : "false", bench->max_rss);
+	if (bench->out_file) fclose(json);
+	else fflush(json);
+	return 1;
+}
+
+static void bench_add_entry(GF_Bench *bench, const char *entry)
+{
+	u32 len = (u32) strlen(entry);
+	bench->entries = (char *) gf_realloc(bench->entries, bench->entries_size + len + 3);
+	if (!bench->entries) {
+		bench->entries_size = 0;
+		return;
+	}
+	if (bench->nb_done) {
+		strcpy(bench->entries + bench->entries_size, ",\n");
+		bench->entries_size += 2;
+	}
+	strcpy(bench->entries + bench->entries_size, entry);
+	bench->entries_size += len;
+	bench->nb_done++;
+	bench_write_results(bench, 0);
+}
+
+/*records a benchmark which cannot run in this build*/
+static void bench_skip(GF_Bench *bench, const char *reason)
+{
+	char szEntry[1024];
+	snprintf(szEntry, 1024, "\t\t{\"name\": \"%s\", \"status\": \"skipped\", \"reason\": \"%s\"}", bench->name, reason);
+	szEntry[1023] = 0;
+	bench_add_entry(bench, szEntry);
+	fprintf(stderr, "%-24s SKIPPED: %s\n", bench->name, reason);
+}
+
+static void bench_end(GF_Bench *bench, GF_Err e, u64 bytes, u64 items)
+{
+	char szEntry[1024];
+	Double dur_ms = (Double) (s64) (gf_sys_clock_high_res() - bench->start) / 1000;
+	u32 rss = bench_peak_rss();
+	Double mbps = 0, ips = 0;
+
+	if (rss > bench->max_rss) bench->max_rss = rss;
+
+	if (dur_ms > 0) {
+		mbps = ((Double) (s64) bytes) / 1000 / dur_ms;
+		ips = ((Double) (s64) items) * 1000 / dur_ms;
+	}
+
+	snprintf(szEntry, 1024, "\t\t{\"name\": \"%s\", \"status\": \"%s\", \"time_ms\": %.3f, \"bytes\": "LLU", \"items\": "LLU", \"mbytes_per_sec\": %.3f, \"items_per_sec\": %.1f, \"peak_rss_kb\": %d}",
+	         bench->name, e ? gf_error_to_string(e) : "ok", dur_ms, bytes, items, mbps, ips, rss);
+	szEntry[1023] = 0;
+	bench_add_entry(bench, szEntry);
+
+	if (e) {
+		fprintf(stderr, "%-24s FAILED: %s\n", bench->name, gf_error_to_string(e));
+	} else {
+		fprintf(stderr, "%-24s %10.2f ms %10.2f MB/s %12.1f items/s %8d kB peak\n", bench->name, dur_ms, mbps, ips, rss);
+	}
+}
+
+
+/*
+		Synthetic media generation
+*/
+
+/*writes an Annex B NAL unit, inserting emulation prevention bytes*/
+static void bench_write_nal(GF_BitStream *out, char *rbsp, u32 size)
+{
+	u32 i, nb_zero = 0;
+	gf_bs_write_u32(out, 1);
+	for (i=0; i<size; i++) {
+		u8 c = (u8) rbsp[i];
+		if ((nb_zero==2) && (c<=3)) {
+			gf_bs_write_u8(out, 3);
+			nb_zero = 0;
+		}
+		gf_bs_write_u8(out, c);
+		if (!c) nb_zero++;
+		else nb_zero = 0;
+	}
+}
+
+static void bench_write_nal_bs(GF_BitStream *out, GF_BitStream *nal)
+{
+	char *data;
+	u32 size;
+	/*rbsp trailing bits*/
+	gf_bs_write_int(nal, 1, 1);
+	gf_bs_align(nal);
+	gf_bs_get_content(nal, &data, &size);
+	bench_write_nal(out, data, size);
+	gf_free(data);
+}
+
+/*baseline profile SPS/PPS and slices made of a real slice header followed by random payload: importers and muxers
+only parse headers, so this exercises the same code paths as real content*/
+static void bench_gen_avc(GF_Bench *bench)
+{
+	u32 i, j, frame_num;
+	GF_BitStream *out = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+
+	bench->nb_video = bench->duration * BENCH_FPS;
+	bench->video_offsets = gf_malloc(sizeof(u32) * bench->nb_video);
+	bench->video_sizes = gf_malloc(sizeof(u32) * bench->nb_video);
+	frame_num = 0;
+
+	for (i=0; i<bench->nb_video; i++) {
+		GF_BitStream *nal;
+		Bool is_idr = (i % BENCH_GOP) ? 0 : 1;
+		u32 payload;
+		bench->video_offsets[i] = (u32) gf_bs_get_position(out);
+
+		if (is_idr) {
+			frame_num = 0;
+			/*SPS*/
+			nal = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+			gf_bs_write_u8(nal, 0x67);
+			gf_bs_write_u8(nal, 66);
+			gf_bs_write_u8(nal, 0xC0);
+			gf_bs_write_u8(nal, 30);
+			gf_bs_write_ue(nal, 0);	/*sps_id*/
+			gf_bs_write_ue(nal, 0);	/*log2_max_frame_num - 4*/
+			gf_bs_write_ue(nal, 0);	/*poc type*/
+			gf_bs_write_ue(nal, 2);	/*log2_max_poc_lsb - 4*/
+			gf_bs_write_ue(nal, 1);	/*num_ref_frames*/
+			gf_bs_write_int(nal, 0, 1);	/*gaps_in_frame_num_allowed*/
+			gf_bs_write_ue(nal, BENCH_WIDTH/16 - 1);
+			gf_bs_write_ue(nal, BENCH_HEIGHT/16 - 1);
+			gf_bs_write_int(nal, 1, 1);	/*frame_mbs_only*/
+			gf_bs_write_int(nal, 1, 1);	/*direct_8x8_inference*/
+			gf_bs_write_int(nal, 0, 1);	/*cropping*/
+			gf_bs_write_int(nal, 0, 1);	/*VUI*/
+			bench_write_nal_bs(out, nal);
+			gf_bs_del(nal);
+
+			/*PPS*/
+			nal = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+			gf_bs_write_u8(nal, 0x68);
+			gf_bs_write_ue(nal, 0);	/*pps_id*/
+			gf_bs_write_ue(nal, 0);	/*sps_id*/
+			gf_bs_write_int(nal, 0, 1);	/*CAVLC*/
+			gf_bs_write_int(nal, 0, 1);	/*pic_order_present*/
+			gf_bs_write_ue(nal, 0);	/*num_slice_groups - 1*/
+			gf_bs_write_ue(nal, 0);	/*num_ref_idx_l0 - 1*/
+			gf_bs_write_ue(nal, 0);	/*num_ref_idx_l1 - 1*/
+			gf_bs_write_int(nal, 0, 1);	/*weighted_pred*/
+			gf_bs_write_int(nal, 0, 2);	/*weighted_bipred*/
+			gf_bs_write_se(nal, 0);	/*pic_init_qp - 26*/
+			gf_bs_write_se(nal, 0);	/*pic_init_qs - 26*/
+			gf_bs_write_se(nal, 0);	/*chroma_qp_offset*/
+			gf_bs_write_int(nal, 1, 1);	/*deblocking_filter_control*/
+			gf_bs_write_int(nal, 0, 1);	/*constrained_intra_pred*/
+			gf_bs_write_int(nal, 0, 1);	/*redundant_pic_cnt*/
+			bench_write_nal_bs(out, nal);
+			gf_bs_del(nal);
+		}
+
+		/*slice*/
+		nal = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		gf_bs_write_u8(nal, is_idr ? 0x65 : 0x41);
+		gf_bs_write_ue(nal, 0);	/*first_mb_in_slice*/
+		gf_bs_write_ue(nal, is_idr ? 7 : 5);	/*slice type, I or P*/
+		gf_bs_write_ue(nal, 0);	/*pps_id*/
+		gf_bs_write_int(nal, frame_num % 16, 4);
+		if (is_idr) gf_bs_write_ue(nal, 0);	/*idr_pic_id*/
+		gf_bs_write_int(nal, (2*frame_num) % 64, 6);	/*poc lsb*/
+		gf_bs_align(nal);
+		payload = is_idr ? 20000 + bench_rand() % 10000 : 2000 + bench_rand() % 4000;
+		/*no zero byte in payload, no emulation prevention needed*/
+		for (j=0; j<payload; j++) gf_bs_write_u8(nal, 1 + bench_rand() % 255);
+		bench_write_nal_bs(out, nal);
+		gf_bs_del(nal);
+
+		bench->video_sizes[i] = (u32) gf_bs_get_position(out) - bench->video_offsets[i];
+		frame_num++;
+	}
+	gf_bs_get_content(out, &bench->avc, &bench->avc_size);
+	gf_bs_del(out);
+}
+
+/*AAC LC stereo 44.1 kHz ADTS frames with random payload*/
+static void bench_gen_aac(GF_Bench *bench)
+{
+	u32 i, j;
+	GF_BitStream *out = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+
+	bench->nb_audio = bench->duration * BENCH_AAC_SR / 1024;
+	bench->audio_offsets = gf_malloc(sizeof(u32) * (bench->nb_audio+1));
+	for (i=0; i<bench->nb_audio; i++) {
+		u32 size = 300 + bench_rand() % 200;
+		bench->audio_offsets[i] = (u32) gf_bs_get_position(out);
+		gf_bs_write_int(out, 0xFFF, 12);/*sync*/
+		gf_bs_write_int(out, 0, 1);/*mpeg4*/
+		gf_bs_write_int(out, 0, 2); /*layer*/
+		gf_bs_write_int(out, 1, 1); /* protection_absent*/
+		gf_bs_write_int(out, 1, 2); /*AAC LC*/
+		gf_bs_write_int(out, 4, 4); /*44100*/
+		gf_bs_write_int(out, 0, 1);
+		gf_bs_write_int(out, 2, 3); /*stereo*/
+		gf_bs_write_int(out, 0, 4);
+		gf_bs_write_int(out, 7+size, 13);
+		gf_bs_write_int(out, 0x7FF, 11);
+		gf_bs_write_int(out, 0, 2);
+		for (j=0; j<size; j++) gf_bs_write_u8(out, bench_rand() & 0xFF);
+	}
+	bench->audio_offsets[i] = (u32) gf_bs_get_position(out);
+	gf_bs_get_content(out, &bench->aac, &bench->aac_size);
+	gf_bs_del(out);
+}
+
+static GF_Err bench_write_file(const char *path, char *data, u32 size)
+{
+	FILE *f = gf_f64_open(path, "wb");
+	if (!f) return GF_IO_ERR;
+	if (gf_fwrite(data, 1, size, f) != size) {
+		fclose(f);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+	return GF_OK;
+}
+
+/*writes a 2D scene of nb_nodes shapes in BT, XMT-A or SVG. If animated, the whole scene is rotated by an interpolator*/
+enum
+{
+	BENCH_SCENE_BT = 0,
+	BENCH_SCENE_XMT,
+	BENCH_SCENE_SVG,
+};
+
+static GF_Err bench_gen_scene(const char *path, u32 type, u32 nb_nodes, Bool animated)
+{
+	u32 i;
+	FILE *f = gf_f64_open(path, "wt");
+	if (!f) return GF_IO_ERR;
+
+	if (type==BENCH_SCENE_BT) {
+		fprintf(f, "InitialObjectDescriptor { objectDescriptorID 1 ODProfileLevelIndication 0xFF sceneProfileLevelIndication 0xFE graphicsProfileLevelIndication 0xFE visualProfileLevelIndication 0xFE audioProfileLevelIndication 0xFE\n");
+		fprintf(f, " esDescr [ ES_Descriptor { ES_ID 1 decConfigDescr DecoderConfigDescriptor { streamType 3 decSpecificInfo BIFSConfig { isCommandStream true pixelMetric true pixelWidth %d pixelHeight %d } } } ]\n}\n", BENCH_WIDTH, BENCH_HEIGHT);
+		fprintf(f, "OrderedGroup { children [\n Background2D { backColor 1 1 1 }\n DEF ROOT Transform2D { children [\n");
+	} else if (type==BENCH_SCENE_XMT) {
+		fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<XMT-A xmlns=\"urn:mpeg:mpeg4:xmta:schema:2002\">\n<Header>\n<InitialObjectDescriptor objectDescriptorID=\"od1\">\n");
+		fprintf(f, "<Profiles audioProfileLevelIndication=\"254\" visualProfileLevelIndication=\"254\" sceneProfileLevelIndication=\"254\" graphicsProfileLevelIndication=\"254\" ODProfileLevelIndication=\"255\"/>\n");
+		fprintf(f, "<Descr><esDescr><ES_Descriptor ES_ID=\"BIFS\"><decConfigDescr><DecoderConfigDescriptor streamType=\"3\"><decSpecificInfo><BIFSConfig><commandStream pixelMetric=\"true\"><size pixelWidth=\"%d\" pixelHeight=\"%d\"/></commandStream></BIFSConfig></decSpecificInfo></DecoderConfigDescriptor></decConfigDescr></ES_Descriptor></esDescr></Descr>\n", BENCH_WIDTH, BENCH_HEIGHT);
+		fprintf(f, "</InitialObjectDescriptor>\n</Header>\n<Body>\n<Replace><Scene><OrderedGroup><children>\n<Transform2D DEF=\"ROOT\"><children>\n");
+	} else {
+		fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n<g id=\"ROOT\">\n", BENCH_WIDTH, BENCH_HEIGHT, BENCH_WIDTH, BENCH_HEIGHT);
+	}
+
+	for (i=0; i<nb_nodes; i++) {
+		s32 x = (s32) (bench_rand() % BENCH_WIDTH) - BENCH_WIDTH/2;
+		s32 y = (s32) (bench_rand() % BENCH_HEIGHT) - BENCH_HEIGHT/2;
+		u32 size = 5 + bench_rand() % 40;
+		Float r = (Float) (bench_rand() % 256) / 255;
+		Float g = (Float) (bench_rand() % 256) / 255;
+		Float b = (Float) (bench_rand() % 256) / 255;
+		Bool is_rect = (i%2) ? 0 : 1;
+
+		if (type==BENCH_SCENE_BT) {
+			fprintf(f, "  DEF T%d Transform2D { translation %d %d children [ Shape { appearance Appearance { material Material2D { emissiveColor %g %g %g filled TRUE } } geometry ", i, x, y, r, g, b);
+			if (is_rect) fprintf(f, "Rectangle { size %d %d } } ] }\n", size, size);
+			else fprintf(f, "Circle { radius %d } } ] }\n", size/2);
+		} else if (type==BENCH_SCENE_XMT) {
+			fprintf(f, "<Transform2D DEF=\"T%d\" translation=\"%d %d\"><children><Shape><appearance><Appearance><material><Material2D emissiveColor=\"%g %g %g\" filled=\"true\"/></material></Appearance></appearance><geometry>", i, x, y, r, g, b);
+			if (is_rect) fprintf(f, "<Rectangle size=\"%d %d\"/>", size, size);
+			else fprintf(f, "<Circle radius=\"%d\"/>", size/2);
+			fprintf(f, "</geometry></Shape></children></Transform2D>\n");
+		} else {
+			x += BENCH_WIDTH/2;
+			y += BENCH_HEIGHT/2;
+			if (is_rect) fprintf(f, " <rect id=\"T%d\" x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" fill=\"rgb(%d,%d,%d)\"/>\n", i, x, y, size, size, (u32) (r*255), (u32) (g*255), (u32) (b*255));
+			else fprintf(f, " <circle id=\"T%d\" cx=\"%d\" cy=\"%d\" r=\"%d\" fill=\"rgb(%d,%d,%d)\"/>\n", i, x, y, size/2, (u32) (r*255), (u32) (g*255), (u32) (b*255));
+		}
+	}
+
+	if (type==BENCH_SCENE_BT) {
+		fprintf(f, " ] }\n");
+		if (animated) {
+			fprintf(f, " DEF TS TimeSensor { cycleInterval 4 loop TRUE }\n DEF SI ScalarInterpolator { key [0 1] keyValue [0 6.283] }\n");
+		}
+		fprintf(f, "] }\n");
+		if (animated) {
+			fprintf(f, "ROUTE TS.fraction_changed TO SI.set_fraction\nROUTE SI.value_changed TO ROOT.rotationAngle\n");
+		}
+	} else if (type==BENCH_SCENE_XMT) {
+		fprintf(f, "</children></Transform2D>\n</children></OrderedGroup></Scene></Replace>\n</Body>\n</XMT-A>\n");
+	} else {
+		fprintf(f, "</g>\n</svg>\n");
+	}
+	fclose(f);
+	return GF_OK;
+}
+
+/*MPD-like document with a long SegmentTimeline*/
+static GF_Err bench_gen_xml(const char *path, u32 nb_entries)
+{
+	u32 i;
+	FILE *f = gf_f64_open(path, "wt");
+	if (!f) return GF_IO_ERR;
+	fprintf(f, "<?xml version=\"1.0\"?>\n<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\">\n");
+	fprintf(f, " <Period id=\"1\" start=\"PT0S\">\n  <AdaptationSet segmentAlignment=\"true\" mimeType=\"video/mp4\">\n");
+	fprintf(f, "   <SegmentTemplate timescale=\"90000\" media=\"seg_$Time$.m4s\" initialization=\"init.mp4\">\n    <SegmentTimeline>\n");
+	for (i=0; i<nb_entries; i++) {
+		fprintf(f, "     <S t=\"%d\" d=\"%d\"/>\n", i*180000, 180000 + (bench_rand() % 10) );
+	}
+	fprintf(f, "    </SegmentTimeline>\n   </SegmentTemplate>\n");
+	fprintf(f, "   <Representation id=\"1\" codecs=\"avc1.42c01e\" width=\"%d\" height=\"%d\" bandwidth=\"2000000\"/>\n", BENCH_WIDTH, BENCH_HEIGHT);
+	fprintf(f, "  </AdaptationSet>\n </Period>\n</MPD>\n");
+	fclose(f);
+	return GF_OK;
+}
+
+
+/*
+		Core tools
+*/
+
+/*100k segment entry updates of a live DASH context, saved every 10 updates*/
+static void bench_config(GF_Bench *bench)
+{
+	u32 i;
+	char szKey[100], szVal[100], szPath[GF_MAX_PATH];
+	GF_Config *cfg;
+	GF_Err e = GF_OK;
+	u32 nb_updates = 100000;
+
+	if (!bench_begin(bench, "config_journaled_update")) return;
+	bench_path(bench, szPath, "bench_ctx.cfg");
+	gf_delete_file(szPath);
+	cfg = gf_cfg_force_new(bench->work_dir, "bench_ctx.cfg");
+	gf_cfg_set_journaled(cfg, 1);
+	for (i=0; i<nb_updates; i++) {
+		sprintf(szKey, "Segment_%d", i);
+		sprintf(szVal, "%d,%d,seg_%d.m4s", i*2000, 2000, i);
+		gf_cfg_set_key(cfg, "Representation_1", szKey, szVal);
+		sprintf(szVal, "%d", i);
+		gf_cfg_set_key(cfg, "DASH", "LastSegmentNumber", szVal);
+		if (i%10 == 9) {
+			e = gf_cfg_save(cfg);
+			if (e) break;
+		}
+	}
+	/*lookups*/
+	for (i=0; i<nb_updates; i++) {
+		sprintf(szKey, "Segment_%d", bench_rand() % nb_updates);
+		if (!gf_cfg_get_key(cfg, "Representation_1", szKey)) e = GF_CORRUPTED_DATA;
+	}
+	gf_cfg_del(cfg);
+	bench_end(bench, e, bench_file_size(szPath), 2*nb_updates);
+	if (!bench->keep) gf_delete_file(szPath);
+}
+
+/*16 MB of mixed 1..29 bit fields, written then read from memory and file, plus exp-Golomb codes*/
+static void bench_bitstream(GF_Bench *bench)
+{
+	u32 i, nb_fields, size;
+	u8 *widths;
+	u32 *values;
+	char *buffer;
+	char szPath[GF_MAX_PATH];
+	GF_BitStream *bs;
+	GF_Err e;
+	FILE *f;
+	u64 nb_bits = 0;
+
+	size = 16*1024*1024;
+	nb_fields = size * 8 / 15;
+	widths = gf_malloc(sizeof(u8) * nb_fields);
+	values = gf_malloc(sizeof(u32) * nb_fields);
+	for (i=0; i<nb_fields; i++) {
+		widths[i] = 1 + bench_rand() % 29;
+		values[i] = bench_rand() & ((1<<widths[i]) - 1);
+		nb_bits += widths[i];
+	}
+	size = (u32) (nb_bits/8 + 1);
+	buffer = gf_malloc(size);
+	memset(buffer, 0, size);
+
+	if (bench_begin(bench, "bitstream_write")) {
+		bs = gf_bs_new(buffer, size, GF_BITSTREAM_WRITE);
+		for (i=0; i<nb_fields; i++) gf_bs_write_int(bs, values[i], widths[i]);
+		gf_bs_align(bs);
+		gf_bs_del(bs);
+		bench_end(bench, GF_OK, size, nb_fields);
+	} else {
+		bs = gf_bs_new(buffer, size, GF_BITSTREAM_WRITE);
+		for (i=0; i<nb_fields; i++) gf_bs_write_int(bs, values[i], widths[i]);
+		gf_bs_align(bs);
+		gf_bs_del(bs);
+	}
+
+	if (bench_begin(bench, "bitstream_read_mem")) {
+		e = GF_OK;
+		bs = gf_bs_new(buffer, size, GF_BITSTREAM_READ);
+		for (i=0; i<nb_fields; i++) {
+			if (gf_bs_read_int(bs, widths[i]) != values[i]) e = GF_CORRUPTED_DATA;
+		}
+		gf_bs_del(bs);
+		bench_end(bench, e, size, nb_fields);
+	}
+
+	bench_path(bench, szPath, "bench_bs.bin");
+	if (bench_begin(bench, "bitstream_read_file")) {
+		e = bench_write_file(szPath, buffer, size);
+		f = e ? NULL : gf_f64_open(szPath, "rb");
+		if (f) {
+			bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+			gf_bs_set_input_buffering(bs, 64*1024);
+			/*don't count file creation*/
+			bench->start = gf_sys_clock_high_res();
+			for (i=0; i<nb_fields; i++) {
+				if (gf_bs_read_int(bs, widths[i]) != values[i]) e = GF_CORRUPTED_DATA;
+			}
+			gf_bs_del(bs);
+			fclose(f);
+		} else if (!e) {
+			e = GF_IO_ERR;
+		}
+		bench_end(bench, e, size, nb_fields);
+		gf_delete_file(szPath);
+	}
+
+	if (bench_begin(bench, "bitstream_golomb")) {
+		char *data;
+		u32 data_size;
+		e = GF_OK;
+		bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		for (i=0; i<nb_fields; i++) {
+			if (i%2) gf_bs_write_se(bs, (s32) (values[i] & 0xFFFF) - 0x8000);
+			else gf_bs_write_ue(bs, values[i] & 0xFFFF);
+		}
+		gf_bs_get_content(bs, &data, &data_size);
+		gf_bs_del(bs);
+		bs = gf_bs_new(data, data_size, GF_BITSTREAM_READ);
+		for (i=0; i<nb_fields; i++) {
+			if (i%2) {
+				if (gf_bs_read_se(bs) != (s32) (values[i] & 0xFFFF) - 0x8000) e = GF_CORRUPTED_DATA;
+			} else {
+				if (gf_bs_read_ue(bs) != (values[i] & 0xFFFF)) e = GF_CORRUPTED_DATA;
+			}
+		}
+		gf_bs_del(bs);
+		gf_free(data);
+		bench_end(bench, e, data_size, 2*nb_fields);
+	}
+
+	/*dynamic write bitstreams, 64 MB in small chunks*/
+	if (bench_begin(bench, "bitstream_dyn_write")) {
+		char *data;
+		u32 data_size, done = 0, nb_writes = 0;
+		bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		while (done < 64*1024*1024) {
+			u32 chunk = 1 + (done % 61);
+			gf_bs_write_data(bs, buffer + (done % (size-64)), chunk);
+			gf_bs_write_u32(bs, done);
+			done += chunk + 4;
+			nb_writes += 2;
+		}
+		gf_bs_get_content(bs, &data, &data_size);
+		gf_bs_del(bs);
+		gf_free(data);
+		bench_end(bench, GF_OK, data_size, nb_writes);
+	}
+	if (bench_begin(bench, "bitstream_chained_write")) {
+		const GF_BitStreamBlock *blocks;
+		u32 nb_blocks, done = 0, nb_writes = 0;
+		u64 data_size = 0;
+		bs = gf_bs_new_chained(64*1024);
+		while (done < 64*1024*1024) {
+			u32 chunk = 1 + (done % 61);
+			gf_bs_write_data(bs, buffer + (done % (size-64)), chunk);
+			gf_bs_write_u32(bs, done);
+			done += chunk + 4;
+			nb_writes += 2;
+		}
+		nb_blocks = gf_bs_get_blocks(bs, &blocks);
+		for (i=0; i<nb_blocks; i++) data_size += blocks[i].size;
+		gf_bs_del(bs);
+		bench_end(bench, GF_OK, data_size, nb_writes);
+	}
+
+	gf_free(buffer);
+	gf_free(widths);
+	gf_free(values);
+}
+
+static void bench_xml(GF_Bench *bench)
+{
+	u32 pass, nb_entries = 30000;
+	char szPath[GF_MAX_PATH];
+	GF_Err e;
+
+	bench_path(bench, szPath, "bench_timeline.mpd");
+	if (bench->filter && !strstr(bench->filter, "xml_dom_parse")) return;
+	e = bench_gen_xml(szPath, nb_entries);
+
+	for (pass=0; pass<2; pass++) {
+		GF_DOMParser *dom;
+		if (!bench_begin(bench, pass ? "xml_dom_parse_arena" : "xml_dom_parse")) continue;
+		if (!e) {
+			dom = gf_xml_dom_new();
+			if (pass) gf_xml_dom_use_arena(dom, 1);
+			e = gf_xml_dom_parse(dom, szPath, NULL, NULL);
+			gf_xml_dom_del(dom);
+		}
+		bench_end(bench, e, bench_file_size(szPath), nb_entries);
+	}
+	if (!bench->keep) gf_delete_file(szPath);
+}
+
+
+/*
+		ISO Media
+*/
+
+static GF_Err bench_import(GF_ISOFile *file, char *src)
+{
+	GF_MediaImporter import;
+	memset(&import, 0, sizeof(GF_MediaImporter));
+	import.dest = file;
+	import.in_name = src;
+	return gf_media_import(&import);
+}
+
+/*number of times the ranges of the onDemand file are served*/
+#define BENCH_INDEX_ROUNDS	8
+
+typedef struct
+{
+	GF_Socket *sock;
+	char *data;
+	u64 *ranges;
+	u32 nb_ranges;
+	GF_Err e;
+	u64 received;
+} GF_BenchIndexReader;
+
+/*client side of the loopback connection: checks that received data matches the requested ranges*/
+static u32 bench_index_reader(void *par)
+{
+	char buffer[65536];
+	u32 i, nb_empty = 0;
+	GF_BenchIndexReader *rd = (GF_BenchIndexReader *)par;
+
+	for (i=0; i<rd->nb_ranges; i++) {
+		u64 pos = rd->ranges[2*i];
+		u64 end = rd->ranges[2*i+1] + 1;
+		while (pos < end) {
+			u32 read;
+			u32 to_read = (end - pos > sizeof(buffer)) ? sizeof(buffer) : (u32) (end - pos);
+			GF_Err e = gf_sk_receive_wait(rd->sock, buffer, to_read, 0, &read, 1);
+			if ((e==GF_IP_NETWORK_EMPTY) || (e==GF_IP_SOCK_WOULD_BLOCK)) {
+				nb_empty++;
+				if (nb_empty < 10) continue;
+				e = GF_IP_NETWORK_FAILURE;
+			}
+			if (e) {
+				rd->e = e;
+				return 0;
+			}
+			nb_empty = 0;
+			if (memcmp(buffer, rd->data + pos, read)) {
+				rd->e = GF_CORRUPTED_DATA;
+				return 0;
+			}
+			pos += read;
+			rd->received += read;
+		}
+	}
+	return 0;
+}
+
+static GF_Err bench_index_connect(GF_Socket **server, GF_Socket **client, GF_Socket **conn)
+{
+	u16 port;
+	u32 type, i;
+	GF_Err e;
+
+	*client = *conn = NULL;
+	*server = gf_sk_new(GF_SOCK_TYPE_TCP);
+	e = gf_sk_bind(*server, "127.0.0.1", 0, NULL, 0, GF_SOCK_REUSE_PORT);
+	if (!e) e = gf_sk_listen(*server, 1);
+	if (!e) e = gf_sk_get_local_info(*server, &port, &type);
+	if (e) return e;
+
+	*client = gf_sk_new(GF_SOCK_TYPE_TCP);
+	e = gf_sk_connect(*client, "127.0.0.1", port, NULL);
+	if (e) return e;
+	for (i=0; i<100; i++) {
+		e = gf_sk_accept(*server, conn);
+		if ((e!=GF_IP_NETWORK_EMPTY) && (e!=GF_IP_SOCK_WOULD_BLOCK)) break;
+		gf_sleep(10);
+	}
+	return e;
+}
+
+/*onDemand profile file indexing and serving of its segments and subsegments through a loopback connection*/
+/*generates a single segment of the whole media indexed by a hierarchical or daisy-chained sidx*/
+static GF_Err bench_gen_indexed_segment(GF_Bench *bench, char *szMP4, const char *name, s32 subsegs_per_sidx, Bool daisy_chain, char *szSeg)
+{
+	char szMPD[GF_MAX_PATH], szName[GF_MAX_PATH];
+	GF_DashSegmenterInput input;
+	GF_Err e;
+
+	sprintf(szName, "%s.mpd", name);
+	bench_path(bench, szMPD, szName);
+	sprintf(szName, "%s_1.m4s", name);
+	bench_path(bench, szSeg, szName);
+	sprintf(szName, "%s_", name);
+	memset(&input, 0, sizeof(GF_DashSegmenterInput));
+	input.file_name = szMP4;
+	e = gf_dasher_segment_files(szMPD, &input, 1, GF_DASH_PROFILE_MAIN, NULL, NULL, NULL, NULL, NULL, 0,
+	                            0, 1, 0, GF_DASH_BSMODE_NONE, 1, 2.0 * bench->duration, szName, NULL, 0.25, subsegs_per_sidx, daisy_chain, 0, bench->work_dir,
+	                            NULL, 0, 0, 0, 0, 1.5, 0);
+	if (!bench->keep) {
+		gf_delete_file(szMPD);
+		sprintf(szName, "%s_init.mp4", name);
+		bench_path(bench, szMPD, szName);
+		gf_delete_file(szMPD);
+	}
+	return e;
+}
+
+/*loads the index of a segment and checks that segments are ordered, end with the file and are found by their time*/
+static GF_Err bench_check_index(const char *file, u32 *nb_segments, u32 *nb_subsegments)
+{
+	GF_DASHSegmentIndex *index;
+	u64 file_size, end = 0;
+	u32 i, seg_idx, sub_idx;
+	GF_Err e;
+
+	*nb_segments = *nb_subsegments = 0;
+	index = gf_dasher_index_new(file, &e);
+	if (!index) return e;
+	gf_dasher_index_get_info(index, NULL, &file_size, NULL, NULL, NULL);
+	for (i=0; !e && (i<gf_dasher_index_get_segment_count(index)); i++) {
+		const GF_DASHIndexRange *seg = gf_dasher_index_get_segment(index, i);
+		if (seg->start_range <= end) e = GF_CORRUPTED_DATA;
+		end = seg->end_range;
+		*nb_subsegments += gf_dasher_index_get_subsegment_count(index, i);
+		if (!e) e = gf_dasher_index_find(index, seg->earliest_presentation_time, &seg_idx, &sub_idx);
+		if (!e && ((seg_idx != i) || sub_idx)) e = GF_CORRUPTED_DATA;
+	}
+	if (!e && (end + 1 != file_size)) e = GF_CORRUPTED_DATA;
+	*nb_segments = gf_dasher_index_get_segment_count(index);
+	gf_dasher_index_del(index);
+	return e;
+}
+
+/*a hierarchical index has one segment per sub-sidx, a daisy chain (longer than the max hierarchy depth) has one segment
+per media reference, both describe the same subsegments*/
+static GF_Err bench_check_index_layouts(GF_Bench *bench, char *szMP4)
+{
+	char szHier[GF_MAX_PATH], szDaisy[GF_MAX_PATH];
+	u32 nb_segs, nb_subsegs, nb_hier_subsegs;
+	GF_Err e;
+
+	szDaisy[0] = 0;
+	e = bench_gen_indexed_segment(bench, szMP4, "bench_hier", 4, 0, szHier);
+	if (!e) e = bench_check_index(szHier, &nb_segs, &nb_hier_subsegs);
+	if (!e && ((nb_segs != 4) || (nb_hier_subsegs <= nb_segs))) e = GF_CORRUPTED_DATA;
+	if (e) {
+		fprintf(stderr, "Hierarchical segment index check failed: %s\n", gf_error_to_string(e));
+	} else {
+		e = bench_gen_indexed_segment(bench, szMP4, "bench_daisy", 40, 1, szDaisy);
+		if (!e) e = bench_check_index(szDaisy, &nb_segs, &nb_subsegs);
+		if (!e && ((nb_segs != nb_subsegs) || (nb_subsegs != nb_hier_subsegs))) e = GF_CORRUPTED_DATA;
+		if (e) fprintf(stderr, "Daisy-chained segment index check failed: %s\n", gf_error_to_string(e));
+	}
+	if (!bench->keep) {
+		gf_delete_file(szHier);
+		if (szDaisy[0]) gf_delete_file(szDaisy);
+	}
+	return e;
+}
+
+static void bench_dash_index(GF_Bench *bench, char *szMP4)
+{
+	char szMPD[GF_MAX_PATH], szOD[GF_MAX_PATH];
+	GF_DashSegmenterInput input;
+	GF_DASHSegmentIndex *index = NULL;
+	GF_Err e, layouts_e = GF_OK;
+	u32 i, j;
+
+	if (bench->filter && !strstr(bench->filter, "dash_index")) return;
+
+	if (!bench->filter || strstr(bench->filter, "dash_index_build"))
+		layouts_e = bench_check_index_layouts(bench, szMP4);
+
+	bench_path(bench, szMPD, "bench_od.mpd");
+	bench_path(bench, szOD, "bench_odinit.mp4");
+	memset(&input, 0, sizeof(GF_DashSegmenterInput));
+	input.file_name = szMP4;
+	/*single indexed file, relative to the MPD*/
+	e = gf_dasher_segment_files(szMPD, &input, 1, GF_DASH_PROFILE_ONDEMAND, NULL, NULL, NULL, NULL, NULL, 0,
+	                            0, 1, 0, GF_DASH_BSMODE_NONE, 1, 1.0, "bench_od", NULL, 0.25, 0, 0, 0, bench->work_dir,
+	                            NULL, 0, 0, 0, 0, 1.5, 0);
+	if (e) {
+		fprintf(stderr, "Failed to generate onDemand file: %s\n", gf_error_to_string(e));
+		goto exit;
+	}
+
+	if (bench_begin(bench, "dash_index_build")) {
+		u64 nb_bytes = 0, idx_start, idx_end;
+		u32 nb_items = 0;
+		for (i=0; i<100; i++) {
+			if (index) gf_dasher_index_del(index);
+			index = gf_dasher_index_new(szOD, &e);
+			if (!index) break;
+			/*bytes are the parsed index boxes*/
+			gf_dasher_index_get_info(index, NULL, NULL, NULL, &idx_start, &idx_end);
+			nb_bytes += idx_end + 1 - idx_start;
+			nb_items += gf_dasher_index_get_segment_count(index);
+		}
+		/*check time lookups*/
+		for (i=0; index && (i<gf_dasher_index_get_segment_count(index)); i++) {
+			u32 seg_idx, sub_idx;
+			const GF_DASHIndexRange *seg = gf_dasher_index_get_segment(index, i);
+			e = gf_dasher_index_find(index, seg->earliest_presentation_time, &seg_idx, &sub_idx);
+			if (!e && ((seg_idx != i) || sub_idx)) e = GF_CORRUPTED_DATA;
+			if (e) break;
+		}
+		if (!e) e = layouts_e;
+		bench_end(bench, e, nb_bytes, nb_items);
+		if (e) goto exit;
+	}
+
+	if (bench_begin(bench, "dash_index_serve")) {
+		GF_BenchIndexReader rd;
+		GF_Socket *server = NULL, *client = NULL, *conn = NULL;
+		GF_Thread *th = NULL;
+		u64 file_size, init_end, idx_start, idx_end, sent = 0;
+		u32 nb_ranges = 0, nb_alloc = 0;
+		FILE *f;
+
+		memset(&rd, 0, sizeof(GF_BenchIndexReader));
+		if (!index) index = gf_dasher_index_new(szOD, &e);
+		if (!index) {
+			bench_end(bench, e, 0, 0);
+			goto exit;
+		}
+		gf_dasher_index_get_info(index, NULL, &file_size, &init_end, &idx_start, &idx_end);
+		f = gf_f64_open(szOD, "rb");
+		rd.data = (char *)gf_malloc(sizeof(char) * (size_t) file_size);
+		if (!f || (fread(rd.data, 1, (size_t) file_size, f) != file_size)) e = GF_IO_ERR;
+		if (f) fclose(f);
+
+		/*requests of a player: init and index, then all segments, all subsegments and arbitrary ranges*/
+		nb_alloc = 2 + 2*gf_dasher_index_get_segment_count(index) + 64;
+		for (i=0; i<gf_dasher_index_get_segment_count(index); i++)
+			nb_alloc += gf_dasher_index_get_subsegment_count(index, i);
+		rd.ranges = (u64 *)gf_malloc(sizeof(u64) * 2 * nb_alloc * BENCH_INDEX_ROUNDS);
+		bench_seed = 1;
+		for (j=0; j<BENCH_INDEX_ROUNDS; j++) {
+			u32 k;
+			rd.ranges[2*nb_ranges] = 0;
+			rd.ranges[2*nb_ranges+1] = init_end;
+			nb_ranges++;
+			rd.ranges[2*nb_ranges] = idx_start;
+			rd.ranges[2*nb_ranges+1] = idx_end;
+			nb_ranges++;
+			for (i=0; i<gf_dasher_index_get_segment_count(index); i++) {
+				const GF_DASHIndexRange *r = gf_dasher_index_get_segment(index, i);
+				rd.ranges[2*nb_ranges] = r->start_range;
+				rd.ranges[2*nb_ranges+1] = r->end_range;
+				nb_ranges++;
+				for (k=0; k<gf_dasher_index_get_subsegment_count(index, i); k++) {
+					r = gf_dasher_index_get_subsegment(index, i, k);
+					rd.ranges[2*nb_ranges] = r->start_range;
+					rd.ranges[2*nb_ranges+1] = r->end_range;
+					nb_ranges++;
+				}
+			}
+			for (i=0; i<64; i++) {
+				u64 start = bench_rand() % file_size;
+				u64 len = 1 + bench_rand() % 100000;
+				rd.ranges[2*nb_ranges] = start;
+				rd.ranges[2*nb_ranges+1] = (start + len > file_size) ? file_size - 1 : start + len - 1;
+				nb_ranges++;
+			}
+		}
+		rd.nb_ranges = nb_ranges;
+
+		if (!e) e = bench_index_connect(&server, &client, &conn);
+		if (!e) {
+			rd.sock = client;
+			th = gf_th_new("BenchIndexReader");
+			e = gf_th_run(th, bench_index_reader, &rd);
+		}
+		for (i=0; !e && (i<nb_ranges); i++) {
+			u64 start = rd.ranges[2*i];
+			while (!e) {
+				u64 done;
+				e = gf_dasher_index_send_range(index, start, rd.ranges[2*i+1], conn, &done);
+				start += done;
+				sent += done;
+				/*reader is late, resume*/
+				if (e==GF_IP_SOCK_WOULD_BLOCK) e = rd.e;
+				else break;
+			}
+		}
+		if (th) {
+			/*on error the reader gives up after its receive timeouts*/
+			gf_th_stop(th);
+			gf_th_del(th);
+		}
+		if (!e) e = rd.e;
+		if (!e && (rd.received != sent)) e = GF_CORRUPTED_DATA;
+		bench_end(bench, e, sent, nb_ranges);
+
+		if (conn) gf_sk_del(conn);
+		if (client) gf_sk_del(client);
+		if (server) gf_sk_del(server);
+		gf_free(rd.ranges);
+		gf_free(rd.data);
+	}
+
+exit:
+	if (index) gf_dasher_index_del(index);
+	if (!bench->keep) {
+		gf_delete_file(szMPD);
+		gf_delete_file(szOD);
+	}
+}
+
+static void bench_isom(GF_Bench *bench)
+{
+	char szAVC[GF_MAX_PATH], szAAC[GF_MAX_PATH], szMP4[GF_MAX_PATH], szOut[GF_MAX_PATH], szMPD[GF_MAX_PATH];
+	GF_ISOFile *file;
+	GF_Err e;
+	u32 i;
+	u64 in_size;
+
+	bench_path(bench, szAVC, "bench_video.264");
+	bench_path(bench, szAAC, "bench_audio.aac");
+	bench_path(bench, szMP4, "bench_av.mp4");
+	in_size = bench->avc_size + bench->aac_size;
+
+	e = bench_write_file(szAVC, bench->avc, bench->avc_size);
+	if (!e) e = bench_write_file(szAAC, bench->aac, bench->aac_size);
+
+	/*import is needed by all other ISO benchmarks*/
+	if (!bench_begin(bench, "isom_import")) {
+		bench->name = NULL;
+		bench->start = gf_sys_clock_high_res();
+	}
+	if (!e) {
+		file = gf_isom_open(szMP4, GF_ISOM_OPEN_WRITE, bench->work_dir);
+		if (!file) e = gf_isom_last_error(NULL);
+		else {
+			e = bench_import(file, szAVC);
+			if (!e) e = bench_import(file, szAAC);
+			if (e) gf_isom_delete(file);
+			else e = gf_isom_close(file);
+		}
+	}
+	if (bench->name) bench_end(bench, e, in_size, bench->nb_video + bench->nb_audio);
+	if (e) {
+		if (!bench->name) fprintf(stderr, "Failed to import synthetic media: %s\n", gf_error_to_string(e));
+		goto exit;
+	}
+
+	if (bench_begin(bench, "isom_read_samples")) {
+		u32 j;
+		u64 bytes = 0, items = 0;
+		file = gf_isom_open(szMP4, GF_ISOM_OPEN_READ, NULL);
+		if (!file) e = gf_isom_last_error(NULL);
+		for (i=0; file && i<gf_isom_get_track_count(file); i++) {
+			u32 count = gf_isom_get_sample_count(file, i+1);
+			for (j=0; j<count; j++) {
+				u32 di;
+				GF_ISOSample *samp = gf_isom_get_sample(file, i+1, j+1, &di);
+				if (!samp) {
+					e = gf_isom_last_error(file);
+					break;
+				}
+				bytes += samp->dataLength;
+				items++;
+				gf_isom_sample_del(&samp);
+			}
+		}
+		if (file) gf_isom_close(file);
+		bench_end(bench, e, bytes, items);
+	}
+
+#ifndef GPAC_DISABLE_MEDIA_EXPORT
+	if (bench_begin(bench, "isom_export")) {
+		file = gf_isom_open(szMP4, GF_ISOM_OPEN_READ, NULL);
+		if (!file) e = gf_isom_last_error(NULL);
+		for (i=0; file && i<gf_isom_get_track_count(file); i++) {
+			GF_MediaExporter dump;
+			memset(&dump, 0, sizeof(GF_MediaExporter));
+			dump.file = file;
+			dump.trackID = gf_isom_get_track_id(file, i+1);
+			snprintf(szOut, GF_MAX_PATH, "%s%cbench_export_%d", bench->work_dir, GF_PATH_SEPARATOR, dump.trackID);
+			dump.out_name = szOut;
+			dump.flags = GF_EXPORT_NATIVE;
+			e = gf_media_export(&dump);
+			if (e) break;
+		}
+		if (file) gf_isom_close(file);
+		bench_end(bench, e, in_size, bench->nb_video + bench->nb_audio);
+		snprintf(szOut, GF_MAX_PATH, "%s%cbench_export_1.h264", bench->work_dir, GF_PATH_SEPARATOR);
+		gf_delete_file(szOut);
+		snprintf(szOut, GF_MAX_PATH, "%s%cbench_export_2.aac", bench->work_dir, GF_PATH_SEPARATOR);
+		gf_delete_file(szOut);
+	}
+#endif
+
+	bench_path(bench, szMPD, "bench_dash.mpd");
+	if (bench_begin(bench, "dash_segment")) {
+		GF_DashSegmenterInput input;
+		memset(&input, 0, sizeof(GF_DashSegmenterInput));
+		input.file_name = szMP4;
+		/*relative to the MPD*/
+		strcpy(szOut, "bench_dash_seg");
+		e = gf_dasher_segment_files(szMPD, &input, 1, GF_DASH_PROFILE_LIVE, NULL, NULL, NULL, NULL, NULL, 0,
+		                            1, 0, 0, GF_DASH_BSMODE_INBAND, 1, 1.0, szOut, "m4s", 1.0, 0, 0, 0, bench->work_dir,
+		                            NULL, 0, 0, 0, 0, 1.5, 0);
+		bench_end(bench, e, bench_file_size(szMP4), bench->duration);
+	}
+
+	bench_dash_index(bench, szMP4);
+
+exit:
+	if (!bench->keep) {
+		gf_delete_file(szAVC);
+		gf_delete_file(szAAC);
+		gf_delete_file(szMP4);
+		gf_delete_file(szMPD);
+		bench_path(bench, szOut, "bench_dash_seginit.mp4");
+		gf_delete_file(szOut);
+		for (i=1; ; i++) {
+			snprintf(szOut, GF_MAX_PATH, "%s%cbench_dash_seg%d.m4s", bench->work_dir, GF_PATH_SEPARATOR, i);
+			if (gf_delete_file(szOut) != GF_OK) break;
+		}
+	}
+}
+
+
+/*
+		MPEG-2 TS
+*/
+
+typedef struct
+{
+	GF_ESInterface ifce;
+	GF_Bench *bench;
+	Bool is_video;
+	u32 au_idx;
+} GF_BenchESI;
+
+static GF_Err bench_esi_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
+{
+	GF_ESIPacket pck;
+	GF_BenchESI *esi = (GF_BenchESI *)ifce->input_udta;
+	GF_Bench *bench = esi->bench;
+
+	if (act_type != GF_ESI_INPUT_DATA_FLUSH) return GF_OK;
+	if (ifce->caps & GF_ESI_STREAM_IS_OVER) return GF_OK;
+
+	memset(&pck, 0, sizeof(GF_ESIPacket));
+	pck.flags = GF_ESI_DATA_AU_START | GF_ESI_DATA_AU_END | GF_ESI_DATA_HAS_CTS;
+	if (esi->is_video) {
+		if (esi->au_idx == bench->nb_video) {
+			ifce->caps |= GF_ESI_STREAM_IS_OVER;
+			return GF_OK;
+		}
+		pck.data = bench->avc + bench->video_offsets[esi->au_idx];
+		pck.data_len = bench->video_sizes[esi->au_idx];
+		pck.cts = esi->au_idx * 90000 / BENCH_FPS;
+		if (!(esi->au_idx % BENCH_GOP)) pck.flags |= GF_ESI_DATA_AU_RAP;
+	} else {
+		if (esi->au_idx == bench->nb_audio) {
+			ifce->caps |= GF_ESI_STREAM_IS_OVER;
+			return GF_OK;
+		}
+		pck.data = bench->aac + bench->audio_offsets[esi->au_idx];
+		pck.data_len = bench->audio_offsets[esi->au_idx+1] - bench->audio_offsets[esi->au_idx];
+		pck.cts = esi->au_idx * 1024;
+		pck.flags |= GF_ESI_DATA_AU_RAP;
+	}
+	pck.dts = pck.cts;
+	esi->au_idx++;
+	return ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
+}
+
+static u32 bench_nb_pes;
+
+static void bench_on_m2ts_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	if (evt_type == GF_M2TS_EVT_PMT_FOUND) {
+		u32 i;
+		GF_M2TS_Program *prog = (GF_M2TS_Program *)par;
+		for (i=0; i<gf_list_count(prog->streams); i++) {
+			GF_M2TS_ES *es = gf_list_get(prog->streams, i);
+			if (es->flags & GF_M2TS_ES_IS_SECTION) continue;
+			gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_DEFAULT);
+		}
+	}
+	else if (evt_type == GF_M2TS_EVT_PES_PCK) {
+		bench_nb_pes++;
+	}
+}
+
+static void bench_m2ts(GF_Bench *bench)
+{
+	char szTS[GF_MAX_PATH];
+	GF_Err e = GF_OK;
+	FILE *ts_out;
+	u64 nb_pck = 0;
+
+	bench_path(bench, szTS, "bench_av.ts");
+
+#ifndef GPAC_DISABLE_MPEG2TS_MUX
+	if (bench_begin(bench, "m2ts_mux")) {
+		GF_BenchESI video, audio;
+		GF_M2TS_Mux *muxer;
+		GF_M2TS_Mux_Program *prog;
+		const char *ts_pck;
+		u32 status;
+
+		memset(&video, 0, sizeof(GF_BenchESI));
+		video.bench = bench;
+		video.is_video = 1;
+		video.ifce.stream_id = 1;
+		video.ifce.stream_type = GF_STREAM_VISUAL;
+		video.ifce.object_type_indication = GPAC_OTI_VIDEO_AVC;
+		video.ifce.timescale = 90000;
+		video.ifce.info_video.width = BENCH_WIDTH;
+		video.ifce.info_video.height = BENCH_HEIGHT;
+		video.ifce.info_video.FPS = BENCH_FPS;
+		video.ifce.input_ctrl = bench_esi_ctrl;
+		video.ifce.input_udta = &video;
+
+		memset(&audio, 0, sizeof(GF_BenchESI));
+		audio.bench = bench;
+		audio.ifce.stream_id = 2;
+		audio.ifce.stream_type = GF_STREAM_AUDIO;
+		audio.ifce.object_type_indication = GPAC_OTI_AUDIO_AAC_MPEG4;
+		audio.ifce.timescale = BENCH_AAC_SR;
+		audio.ifce.info_audio.sample_rate = BENCH_AAC_SR;
+		audio.ifce.info_audio.nb_channels = 2;
+		audio.ifce.input_ctrl = bench_esi_ctrl;
+		audio.ifce.input_udta = &audio;
+
+		ts_out = gf_f64_open(szTS, "wb");
+		if (!ts_out) e = GF_IO_ERR;
+		else {
+			muxer = gf_m2ts_mux_new(0, GF_M2TS_PSI_DEFAULT_REFRESH_RATE, 0);
+			prog = gf_m2ts_mux_program_add(muxer, 1, 100, GF_M2TS_PSI_DEFAULT_REFRESH_RATE, 0, 0);
+			gf_m2ts_program_stream_add(prog, &video.ifce, 101, 1, 0);
+			gf_m2ts_program_stream_add(prog, &audio.ifce, 102, 0, 0);
+			gf_m2ts_mux_update_config(muxer, 1);
+
+			while (1) {
+				while ((ts_pck = gf_m2ts_mux_process(muxer, &status)) != NULL) {
+					gf_fwrite(ts_pck, 1, 188, ts_out);
+					nb_pck++;
+					if (status>=GF_M2TS_STATE_PADDING) break;
+				}
+				if (status==GF_M2TS_STATE_EOS) break;
+			}
+			gf_m2ts_mux_del(muxer);
+			fclose(ts_out);
+		}
+		bench_end(bench, e, nb_pck*188, bench->nb_video + bench->nb_audio);
+	}
+#endif
+
+	if (bench_begin(bench, "m2ts_demux")) {
+		GF_M2TS_Demuxer *ts;
+		char data[188*1000];
+		u64 size = 0;
+		FILE *src = gf_f64_open(szTS, "rb");
+		bench_nb_pes = 0;
+		if (!src) e = GF_URL_ERROR;
+		else {
+			ts = gf_m2ts_demux_new();
+			ts->on_event = bench_on_m2ts_event;
+			while (1) {
+				u32 read = (u32) fread(data, 1, 188*1000, src);
+				if (!read) break;
+				size += read;
+				gf_m2ts_process_data(ts, data, read);
+			}
+			gf_m2ts_demux_del(ts);
+			fclose(src);
+			if (!bench_nb_pes) e = GF_NON_COMPLIANT_BITSTREAM;
+		}
+		bench_end(bench, e, size, bench_nb_pes);
+	}
+	if (!bench->keep) gf_delete_file(szTS);
+}
+
+
+/*
+		Scenes
+*/
+
+static GF_Err bench_load_scene(const char *path, GF_ISOFile *isom, GF_SceneManager **out_ctx)
+{
+	GF_Err e;
+	GF_SceneLoader load;
+	GF_SceneGraph *sg = gf_sg_new();
+
+	memset(&load, 0, sizeof(GF_SceneLoader));
+	load.ctx = gf_sm_new(sg);
+	load.fileName = (char *) path;
+	load.isom = isom;
+	load.flags = GF_SM_LOAD_MPEG4_STRICT;
+	e = gf_sm_load_init(&load);
+	if (!e) e = gf_sm_load_run(&load);
+	gf_sm_load_done(&load);
+
+	/*progressive loaders signal the end of the document*/
+	if (e==GF_EOS) e = GF_OK;
+	if (!e && out_ctx) {
+		*out_ctx = load.ctx;
+		return GF_OK;
+	}
+	gf_sm_del(load.ctx);
+	gf_sg_del(sg);
+	return e;
+}
+
+static void bench_del_scene(GF_SceneManager *ctx)
+{
+	GF_SceneGraph *sg = ctx->scene_graph;
+	gf_sm_del(ctx);
+	gf_sg_del(sg);
+}
+
+static u64 bench_seng_bytes;
+static void bench_seng_callback(void *udta, u16 ESID, char *data, u32 size, u64 ts)
+{
+	bench_seng_bytes += size;
+}
+
+static void bench_scene(GF_Bench *bench)
+{
+	char szBT[GF_MAX_PATH], szXMT[GF_MAX_PATH], szSVG[GF_MAX_PATH], szMP4[GF_MAX_PATH];
+	GF_SceneManager *ctx = NULL;
+	GF_Err e;
+
+	bench_path(bench, szBT, "bench_scene.bt");
+	bench_path(bench, szXMT, "bench_scene.xmt");
+	bench_path(bench, szSVG, "bench_scene.svg");
+	bench_path(bench, szMP4, "bench_scene.mp4");
+
+	bench_seed = 1;
+	e = bench_gen_scene(szBT, BENCH_SCENE_BT, bench->nb_nodes, 0);
+
+	if (bench_begin(bench, "bt_load")) {
+		if (!e) e = bench_load_scene(szBT, NULL, NULL);
+		bench_end(bench, e, bench_file_size(szBT), bench->nb_nodes);
+	}
+
+#if !defined(GPAC_DISABLE_BIFS_ENC) && !defined(GPAC_DISABLE_SCENE_ENCODER)
+	if (bench_begin(bench, "bifs_encode")) {
+		if (!e) e = bench_load_scene(szBT, NULL, &ctx);
+		/*only count encoding*/
+		bench->start = gf_sys_clock_high_res();
+		if (!e) {
+			GF_ISOFile *mp4 = gf_isom_open(szMP4, GF_ISOM_WRITE_EDIT, bench->work_dir);
+			if (!mp4) e = gf_isom_last_error(NULL);
+			else {
+				e = gf_sm_encode_to_file(ctx, mp4, NULL);
+				if (e) gf_isom_delete(mp4);
+				else gf_isom_close(mp4);
+			}
+			bench_del_scene(ctx);
+		}
+		bench_end(bench, e, bench_file_size(szMP4), bench->nb_nodes);
+	}
+
+	if (bench_begin(bench, "bifs_decode")) {
+		GF_ISOFile *mp4 = gf_isom_open(szMP4, GF_ISOM_OPEN_READ, NULL);
+		if (!mp4) e = GF_URL_ERROR;
+		else {
+			e = bench_load_scene(NULL, mp4, NULL);
+			gf_isom_close(mp4);
+		}
+		bench_end(bench, e, bench_file_size(szMP4), bench->nb_nodes);
+	}
+#endif
+
+#ifndef GPAC_DISABLE_SENG
+	if (bench_begin(bench, "seng_rap_encode")) {
+		u32 i, nb_raps = 50;
+		GF_SceneEngine *seng = gf_seng_init(NULL, szBT, 0, NULL, 0);
+		bench_seng_bytes = 0;
+		e = seng ? GF_OK : GF_NOT_SUPPORTED;
+		/*only count RAP generation*/
+		bench->start = gf_sys_clock_high_res();
+		for (i=0; seng && i<nb_raps; i++) {
+			char szCom[100];
+			/*small update between RAPs, as a live scene carousel would*/
+			sprintf(szCom, "REPLACE T%d.translation BY %d %d", bench_rand() % bench->nb_nodes, i, i);
+			e = gf_seng_encode_from_string(seng, 0, 0, szCom, bench_seng_callback);
+			if (!e) e = gf_seng_encode_context(seng, bench_seng_callback);
+			if (e) break;
+		}
+		if (seng) gf_seng_terminate(seng);
+		bench_end(bench, e, bench_seng_bytes, nb_raps);
+	}
+#endif
+
+	bench_seed = 1;
+	if (bench_begin(bench, "xmt_load")) {
+		e = bench_gen_scene(szXMT, BENCH_SCENE_XMT, bench->nb_nodes, 0);
+		bench->start = gf_sys_clock_high_res();
+		if (!e) e = bench_load_scene(szXMT, NULL, NULL);
+		bench_end(bench, e, bench_file_size(szXMT), bench->nb_nodes);
+	}
+
+	bench_seed = 1;
+	if (bench_begin(bench, "svg_load")) {
+		e = bench_gen_scene(szSVG, BENCH_SCENE_SVG, bench->nb_nodes, 0);
+		bench->start = gf_sys_clock_high_res();
+		if (!e) e = bench_load_scene(szSVG, NULL, NULL);
+		bench_end(bench, e, bench_file_size(szSVG), bench->nb_nodes);
+	}
+
+	if (!bench->keep) {
+		gf_delete_file(szBT);
+		gf_delete_file(szXMT);
+		gf_delete_file(szSVG);
+		gf_delete_file(szMP4);
+	}
+}
+
+
+/*
+		Task pool
+*/
+
+#define BENCH_TASK_WORK	64
+
+typedef struct
+{
+	u32 *data;
+	u32 nb_items;
+	volatile u32 sum;
+} GF_BenchTasks;
+
+static u32 bench_task_work(u32 seed)
+{
+	u32 i;
+	for (i=0; i<BENCH_TASK_WORK; i++) seed = seed * 1103515245 + 12345;
+	return seed;
+}
+
+static GF_Err bench_task_run(void *par)
+{
+	GF_BenchTasks *bt = (GF_BenchTasks *)par;
+	gf_atomic_add(&bt->sum, bench_task_work(bt->nb_items) & 1);
+	return GF_OK;
+}
+
+static u32 bench_thread_run(void *par)
+{
+	bench_task_run(par);
+	return 0;
+}
+
+static GF_Err bench_range_run(void *par, u32 start, u32 end)
+{
+	u32 i, sum = 0;
+	GF_BenchTasks *bt = (GF_BenchTasks *)par;
+	for (i=start; i<end; i++) sum += bench_task_work(bt->data[i]) & 0xFF;
+	gf_atomic_add(&bt->sum, sum);
+	return GF_OK;
+}
+
+static void bench_tasks(GF_Bench *bench)
+{
+	GF_Err e;
+	u32 i, nb_tasks, check;
+	GF_TaskPool *pool;
+	GF_BenchTasks bt;
+
+	memset(&bt, 0, sizeof(GF_BenchTasks));
+	bt.nb_items = bench->duration * 100000;
+	bt.data = (u32 *)gf_malloc(sizeof(u32) * bt.nb_items);
+	bench_seed = 1;
+	for (i=0; i<bt.nb_items; i++) bt.data[i] = bench_rand();
+	nb_tasks = bench->duration * 2000;
+
+	/*reference: one thread per job, as done by most modules*/
+	if (bench_begin(bench, "thread_spawn")) {
+		u32 nb_threads = nb_tasks / 10;
+		e = GF_OK;
+		bt.sum = 0;
+		for (i=0; i<nb_threads; i++) {
+			GF_Thread *th = gf_th_new("BenchThread");
+			e = gf_th_run(th, bench_thread_run, &bt);
+			gf_th_stop(th);
+			gf_th_del(th);
+			if (e) break;
+		}
+		bench_end(bench, e, 0, i);
+	}
+
+	pool = gf_task_pool_new("BenchPool", bench->nb_threads);
+	if (bench_begin(bench, "task_pool_submit")) {
+		GF_TaskGroup *group = gf_task_group_new(pool);
+		e = GF_OK;
+		bt.sum = 0;
+		for (i=0; i<nb_tasks; i++) {
+			e = gf_task_pool_submit(pool, group, i%3, bench_task_run, &bt);
+			if (e) break;
+		}
+		if (!e) e = gf_task_group_wait(group);
+		gf_task_group_del(group);
+		if (!e && (bt.sum != nb_tasks * (bench_task_work(bt.nb_items) & 1))) e = GF_CORRUPTED_DATA;
+		bench_end(bench, e, 0, nb_tasks);
+	}
+
+	bt.sum = 0;
+	bench_range_run(&bt, 0, bt.nb_items);
+	check = bt.sum;
+	if (bench_begin(bench, "task_pool_parallel_for")) {
+		bt.sum = 0;
+		e = gf_task_pool_parallel_for(pool, 0, bt.nb_items, 0, bench_range_run, &bt);
+		if (!e && (bt.sum != check)) e = GF_CORRUPTED_DATA;
+		bench_end(bench, e, sizeof(u32) * bt.nb_items, bt.nb_items);
+	}
+	gf_task_pool_del(pool);
+	gf_free(bt.data);
+}
+
+
+/*
+		Compositor
+*/
+
+#ifndef GPAC_DISABLE_PLAYER
+static void bench_compositor(GF_Bench *bench)
+{
+	char szBT[GF_MAX_PATH];
+	GF_User user;
+	GF_Terminal *term;
+	GF_Err e = GF_OK;
+	u32 i;
+	u64 bytes = 0;
+
+	if (!bench_begin(bench, "compositor_offscreen")) return;
+
+	bench_path(bench, szBT, "bench_anim.bt");
+	bench_seed = 1;
+	e = bench_gen_scene(szBT, BENCH_SCENE_BT, bench->nb_nodes / 4, 1);
+
+	memset(&user, 0, sizeof(GF_User));
+	user.config = gf_cfg_force_new(bench->work_dir, "bench_gpac.cfg");
+	gf_cfg_set_key(user.config, "General", "ModulesDirectory", bench->mods_dir);
+	gf_cfg_set_key(user.config, "Video", "DriverName", "Raw Video Output");
+	gf_cfg_set_key(user.config, "Compositor", "Raster2D", "GPAC 2D Raster");
+	gf_cfg_set_key(user.config, "Compositor", "AntiAlias", "All");
+	gf_cfg_set_key(user.config, "Compositor", "FrameRate", "1000");
+	gf_cfg_set_key(user.config, "Compositor", "DrawMode", "immediate");
+	gf_cfg_set_key(user.config, "Systems", "FramePoolSize", "0");
+	user.modules = gf_modules_new(bench->mods_dir, user.config);
+	user.opaque = bench;
+	user.init_flags = GF_TERM_NO_AUDIO | GF_TERM_NO_DECODER_THREAD | GF_TERM_NO_VISUAL_THREAD | GF_TERM_NO_REGULATION;
+
+	term = NULL;
+	if (!e) {
+		/*the raw video output and the rasterizer are optional modules, don't let the terminal fall back to another one*/
+		GF_BaseInterface *ifce = gf_modules_load_interface_by_name(user.modules, "Raw Video Output", GF_VIDEO_OUTPUT_INTERFACE);
+		const char *missing = NULL;
+		if (ifce) gf_modules_close_interface(ifce);
+		else missing = "Raw Video Output module not available";
+		if (!missing) {
+			ifce = gf_modules_load_interface_by_name(user.modules, "GPAC 2D Raster", GF_RASTER_2D_INTERFACE);
+			if (ifce) gf_modules_close_interface(ifce);
+			else missing = "GPAC 2D Raster module not available";
+		}
+		if (missing) {
+			bench_skip(bench, missing);
+			goto exit;
+		}
+	}
+	if (!e) {
+		term = gf_term_new(&user);
+		if (!term) e = GF_NOT_SUPPORTED;
+	}
+	if (term) {
+		gf_term_connect(term, szBT);
+		/*wait for the scene to be loaded*/
+		for (i=0; i<1000; i++) {
+			GF_VideoSurface fb;
+			gf_term_process_step(term);
+			if (gf_term_get_screen_buffer(term, &fb) == GF_OK) {
+				gf_term_release_screen_buffer(term, &fb);
+				if (gf_term_get_option(term, GF_OPT_PLAY_STATE) == GF_STATE_PLAYING) break;
+			}
+		}
+		/*redraw everything at each frame, so that the load does not depend on timing*/
+		gf_term_set_option(term, GF_OPT_STRESS_MODE, 1);
+		for (i=0; i<10; i++) gf_term_process_step(term);
+
+		bench->start = gf_sys_clock_high_res();
+		for (i=0; i<bench->nb_frames; i++) {
+			GF_VideoSurface fb;
+			gf_term_process_step(term);
+			e = gf_term_get_screen_buffer(term, &fb);
+			if (e) break;
+			bytes += fb.height * ABS(fb.pitch_y);
+			gf_term_release_screen_buffer(term, &fb);
+		}
+		bench_end(bench, e, bytes, i);
+
+		gf_term_disconnect(term);
+		gf_term_del(term);
+	} else {
+		bench_end(bench, e, 0, 0);
+	}
+exit:
+	gf_modules_del(user.modules);
+	gf_cfg_del(user.config);
+
+	bench_path(bench, szBT, "bench_gpac.cfg");
+	gf_delete_file(szBT);
+	if (!bench->keep) {
+		bench_path(bench, szBT, "bench_anim.bt");
+		gf_delete_file(szBT);
+	}
+}
+#endif
+
+
+static void bench_on_progress(const void *cbck, const char *title, u64 done, u64 total)
+{
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr, "Usage: gpac_bench [options]\n"
+	        "\n"
+	        "Generates synthetic media and times the main GPAC pipelines. Results are written in JSON.\n"
+	        "\n"
+	        "\t-o file:      writes JSON results to file (default: stdout)\n"
+	        "\t-dir path:    existing working directory for generated media (default: current directory)\n"
+	        "\t-dur sec:     duration of the synthetic audio/video media (default: 60)\n"
+	        "\t-nodes N:     number of nodes of the synthetic scenes (default: 2000)\n"
+	        "\t-frames N:    number of frames rendered by the compositor benchmark (default: 200)\n"
+	        "\t-threads N:   number of task pool threads (default: one per CPU)\n"
+	        "\t-mods path:   GPAC modules directory, needed by the compositor benchmark (default: executable directory)\n"
+	        "\t-run names:   only runs benchmarks whose name is in the given list, eg \"m2ts_mux,m2ts_demux\"\n"
+	        "\t-logs args:   sets GPAC log tools and levels, same syntax as MP4Box\n"
+	        "\t-keep:        keeps generated files\n"
+	        "\t-h:           prints this message\n"
+	        "\n"
+	        "Benchmarks: config_journaled_update bitstream_write bitstream_read_mem bitstream_read_file bitstream_golomb\n"
+	        "  bitstream_dyn_write bitstream_chained_write xml_dom_parse xml_dom_parse_arena isom_import isom_read_samples\n"
+	        "  isom_export dash_segment dash_index_build dash_index_serve m2ts_mux m2ts_demux bt_load bifs_encode bifs_decode seng_rap_encode xmt_load\n"
+	        "  svg_load compositor_offscreen thread_spawn task_pool_submit task_pool_parallel_for\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i;
+	char *out_file = NULL;
+	char *logs = NULL;
+	char szMods[GF_MAX_PATH];
+	GF_Bench bench;
+
+	memset(&bench, 0, sizeof(GF_Bench));
+	strcpy(bench.work_dir, ".");
+	bench.duration = 60;
+	bench.nb_nodes = 2000;
+	bench.nb_frames = 200;
+
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		Bool has_next = (i+1 < (u32) argc) ? 1 : 0;
+		if (!strcmp(arg, "-o") && has_next) {
+			out_file = argv[++i];
+		} else if (!strcmp(arg, "-dir") && has_next) {
+			strcpy(bench.work_dir, argv[++i]);
+		} else if (!strcmp(arg, "-dur") && has_next) {
+			bench.duration = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-nodes") && has_next) {
+			bench.nb_nodes = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-frames") && has_next) {
+			bench.nb_frames = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-threads") && has_next) {
+			bench.nb_threads = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-mods") && has_next) {
+			bench.mods_dir = argv[++i];
+		} else if (!strcmp(arg, "-run") && has_next) {
+			bench.filter = argv[++i];
+		} else if (!strcmp(arg, "-logs") && has_next) {
+			logs = argv[++i];
+		} else if (!strcmp(arg, "-keep")) {
+			bench.keep = 1;
+		} else {
+			PrintUsage();
+			return (!strcmp(arg, "-h")) ? 0 : 1;
+		}
+	}
+	if (!bench.duration) bench.duration = 1;
+	if (!bench.nb_nodes) bench.nb_nodes = 1;
+
+	if (!bench.mods_dir) {
+		char *sep;
+		strcpy(szMods, argv[0]);
+		sep = strrchr(szMods, '/');
+		if (!sep) sep = strrchr(szMods, '\\');
+		if (sep) sep[0] = 0;
+		else strcpy(szMods, ".");
+		bench.mods_dir = szMods;
+	}
+
+	gf_sys_init(0);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_ERROR);
+	if (logs && (gf_log_set_tools_levels(logs) != GF_OK)) {
+		gf_sys_close();
+		return 1;
+	}
+	gf_set_progress_callback(NULL, bench_on_progress);
+
+	bench.out_file = out_file;
+	if (!bench_write_results(&bench, 0)) {
+		fprintf(stderr, "Cannot open output file %s\n", out_file);
+		gf_sys_close();
+		return 1;
+	}
+
+	/*generate media before any measure*/
+	bench_seed = 1;
+	bench_gen_avc(&bench);
+	bench_gen_aac(&bench);
+
+	bench_config(&bench);
+	bench_bitstream(&bench);
+	bench_xml(&bench);
+	bench_isom(&bench);
+	bench_m2ts(&bench);
+	bench_scene(&bench);
+#ifndef GPAC_DISABLE_PLAYER
+	bench_compositor(&bench);
+#endif
+	bench_tasks(&bench);
+
+	bench_write_results(&bench, 1);
+	if (bench.entries) gf_free(bench.entries);
+
+	gf_free(bench.avc);
+	gf_free(bench.video_offsets);
+	gf_free(bench.video_sizes);
+	gf_free(bench.aac);
+	gf_free(bench.audio_offsets);
+	gf_sys_close();
+	return 0;
+}
@@ -0,0 +1,451 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2013
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / bitstream regression test
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+/*
+	Bit-exact regression test of the bitstream tool.
+
+	Random sequences of gf_bs_read_int, gf_bs_read_long_int, gf_bs_peek_bits and gf_bs_seek are run on memory, file and
+	cached file bitstreams over the same random data, and every value is checked against a plain bit-by-bit reference
+	reader. Random sequences of gf_bs_write_int and gf_bs_write_long_int are written to memory (fixed, dynamic and
+	chained), file and buffered file bitstreams, and the produced bytes are checked against a bit-by-bit reference writer.
+	With -dir, the random read sequences are also run over the content of every file of a directory (such as the
+	regression_tests auxiliary files), so that real media data goes through the same checks.
+	Runs are reproducible from the seed; the program exits with 1 on the first mismatch.
+*/
+
+#include "../../../include/gpac/tools.h"
+#include "../../../include/gpac/bitstream.h"
+
+/*memory, file, cached file*/
+#define BST_NB_READERS	3
+/*fixed memory, dynamic memory, chained memory, file, buffered file*/
+#define BST_NB_WRITERS	5
+
+static const char *reader_names[BST_NB_READERS] = {"memory", "file", "cached file"};
+static const char *writer_names[BST_NB_WRITERS] = {"memory", "dynamic memory", "chained memory", "file", "buffered file"};
+
+/*only the beginning of larger files is checked in directory passes*/
+#define BST_MAX_FILE_SIZE	4000000
+
+static u32 bst_seed = 1;
+
+static u32 bst_rand()
+{
+	bst_seed = bst_seed * 1103515245 + 12345;
+	return (bst_seed >> 8) & 0x00FFFFFF;
+}
+
+static u64 bst_rand64()
+{
+	u64 v = bst_rand();
+	v = (v<<24) | bst_rand();
+	v = (v<<24) | bst_rand();
+	return v;
+}
+
+/*reference reader: nBits (<=64) from bit position pos, MSB first*/
+static u64 bst_ref_read(const u8 *data, u64 pos, u32 nBits)
+{
+	u64 ret = 0;
+	while (nBits) {
+		ret <<= 1;
+		ret |= (data[pos>>3] >> (7 - (pos & 7))) & 1;
+		pos++;
+		nBits--;
+	}
+	return ret;
+}
+
+/*reference writer: nBits (<=64) low bits of value at bit position pos, MSB first*/
+static void bst_ref_write(u8 *data, u64 pos, u64 value, u32 nBits)
+{
+	while (nBits) {
+		u8 bit = (u8) ((value >> (nBits-1)) & 1);
+		if (bit) data[pos>>3] |= 1 << (7 - (pos & 7));
+		else data[pos>>3] &= ~(1 << (7 - (pos & 7)));
+		pos++;
+		nBits--;
+	}
+}
+
+static FILE *bst_file_from_data(const u8 *data, u32 size)
+{
+	FILE *f = gf_temp_file_new();
+	if (!f) return NULL;
+	if (fwrite(data, 1, size, f) != size) {
+		fclose(f);
+		return NULL;
+	}
+	gf_f64_seek(f, 0, SEEK_SET);
+	return f;
+}
+
+static Bool bst_check(const char *op, u32 iter, u32 step, u32 reader, u64 got, u64 expected, u64 pos, u32 nBits)
+{
+	if (got == expected) return 1;
+	fprintf(stderr, "Iteration %d step %d: %s of %d bits at bit "LLU" on %s bitstream: got "LLX" expected "LLX"\n",
+	        iter, step, op, nBits, pos, reader_names[reader], got, expected);
+	return 0;
+}
+
+/*runs a random read sequence over data - size shall not be 0*/
+static Bool bst_test_read(u32 iter, u32 nb_ops, const u8 *data, u32 size)
+{
+	u32 i, j;
+	u64 pos, nb_bits;
+	FILE *files[BST_NB_READERS];
+	GF_BitStream *bs[BST_NB_READERS];
+	Bool ok = 1;
+
+	nb_bits = 8 * (u64) size;
+
+	memset(files, 0, sizeof(files));
+	bs[0] = gf_bs_new((char*)data, size, GF_BITSTREAM_READ);
+	files[1] = bst_file_from_data(data, size);
+	files[2] = bst_file_from_data(data, size);
+	if (!files[1] || !files[2]) {
+		fprintf(stderr, "Cannot create temporary files\n");
+		ok = 0;
+		bs[1] = bs[2] = NULL;
+		goto exit;
+	}
+	bs[1] = gf_bs_from_file(files[1], GF_BITSTREAM_READ);
+	bs[2] = gf_bs_from_file(files[2], GF_BITSTREAM_READ);
+	/*small odd windows stress the cache refills, large ones the in-window seeks*/
+	switch (iter % 4) {
+	case 0:
+		gf_bs_set_input_buffering(bs[2], 1);
+		break;
+	case 1:
+		gf_bs_set_input_buffering(bs[2], 7 + bst_rand() % 57);
+		break;
+	case 2:
+		gf_bs_set_input_buffering(bs[2], 4096);
+		break;
+	default:
+		gf_bs_set_input_buffering(bs[2], 2 * size);
+		break;
+	}
+
+	pos = 0;
+	for (i=0; ok && (i<nb_ops); i++) {
+		u32 nBits, byte_offset;
+		u64 expected;
+		switch (bst_rand() % 8) {
+		/*read_int*/
+		case 0:
+		case 1:
+		case 2:
+			nBits = bst_rand() % 33;
+			if (pos + nBits > nb_bits) nBits = (u32) (nb_bits - pos);
+			expected = bst_ref_read(data, pos, nBits);
+			for (j=0; ok && (j<BST_NB_READERS); j++) {
+				ok = bst_check("read_int", iter, i, j, gf_bs_read_int(bs[j], nBits), expected, pos, nBits);
+			}
+			pos += nBits;
+			break;
+		/*read_long_int*/
+		case 3:
+		case 4:
+			nBits = bst_rand() % 65;
+			if (pos + nBits > nb_bits) nBits = (u32) (nb_bits - pos);
+			expected = bst_ref_read(data, pos, nBits);
+			for (j=0; ok && (j<BST_NB_READERS); j++) {
+				ok = bst_check("read_long_int", iter, i, j, gf_bs_read_long_int(bs[j], nBits), expected, pos, nBits);
+			}
+			pos += nBits;
+			break;
+		/*peek_bits: from the current bit without offset, otherwise from the byte boundary following the current byte*/
+		case 5:
+		case 6:
+		{
+			u64 from;
+			nBits = 1 + bst_rand() % 32;
+			byte_offset = (bst_rand() % 3) ? 0 : bst_rand() % 16;
+			from = byte_offset ? 8 * ((pos + 7) / 8 + byte_offset) : pos;
+			if (from + nBits > nb_bits) break;
+			expected = bst_ref_read(data, from, nBits);
+			for (j=0; ok && (j<BST_NB_READERS); j++) {
+				ok = bst_check("peek_bits", iter, i, j, gf_bs_peek_bits(bs[j], nBits, byte_offset), expected, from, nBits);
+			}
+			break;
+		}
+		/*seek - memory read bitstreams reject seeking at the end of the buffer*/
+		default:
+			pos = 8 * (u64) (bst_rand() % size);
+			for (j=0; ok && (j<BST_NB_READERS); j++) {
+				ok = bst_check("seek", iter, i, j, gf_bs_seek(bs[j], pos / 8), GF_OK, pos, 0);
+			}
+			break;
+		}
+		/*state checks*/
+		for (j=0; ok && (j<BST_NB_READERS); j++) {
+			ok = bst_check("get_position", iter, i, j, gf_bs_get_position(bs[j]), (pos + 7) / 8, pos, 0);
+		}
+		if (ok) ok = bst_check("get_bit_offset", iter, i, 0, gf_bs_get_bit_offset(bs[0]), pos, pos, 0);
+	}
+
+	/*file handles are put back at the logical position*/
+	if (ok) {
+		gf_bs_set_input_buffering(bs[2], 0);
+		ok = bst_check("cache release", iter, i, 2, gf_f64_tell(files[2]), (pos + 7) / 8, pos, 0);
+	}
+
+exit:
+	for (j=0; j<BST_NB_READERS; j++) {
+		if (bs[j]) gf_bs_del(bs[j]);
+		if (files[j]) fclose(files[j]);
+	}
+	return ok;
+}
+
+static Bool bst_test_read_random(u32 iter, u32 nb_ops)
+{
+	u32 i, size;
+	u8 *data;
+	Bool ok;
+
+	size = 1 + bst_rand() % 20000;
+	data = (u8*)gf_malloc(sizeof(u8) * size);
+	for (i=0; i<size; i++) data[i] = (u8) bst_rand();
+	ok = bst_test_read(iter, nb_ops, data, size);
+	gf_free(data);
+	return ok;
+}
+
+typedef struct
+{
+	u32 nb_ops, nb_files;
+	Bool failed;
+} BSTDirPass;
+
+static Bool bst_test_file(void *cbck, char *item_name, char *item_path)
+{
+	BSTDirPass *pass = (BSTDirPass *)cbck;
+	u8 *data;
+	u32 size;
+	u64 file_size;
+	Bool ok;
+	FILE *f = gf_f64_open(item_path, "rb");
+	if (!f) {
+		fprintf(stderr, "Cannot open %s, skipping\n", item_path);
+		return 0;
+	}
+	gf_f64_seek(f, 0, SEEK_END);
+	file_size = gf_f64_tell(f);
+	gf_f64_seek(f, 0, SEEK_SET);
+	size = (file_size > BST_MAX_FILE_SIZE) ? BST_MAX_FILE_SIZE : (u32) file_size;
+	if (!size) {
+		fclose(f);
+		return 0;
+	}
+	data = (u8*)gf_malloc(sizeof(u8) * size);
+	if (fread(data, 1, size, f) != size) {
+		fprintf(stderr, "Cannot read %s, skipping\n", item_path);
+		gf_free(data);
+		fclose(f);
+		return 0;
+	}
+	fclose(f);
+
+	ok = bst_test_read(pass->nb_files, pass->nb_ops, data, size);
+	gf_free(data);
+	if (!ok) {
+		fprintf(stderr, "Read sequence failed on file %s\n", item_path);
+		pass->failed = 1;
+		return 1;
+	}
+	pass->nb_files++;
+	return 0;
+}
+
+static Bool bst_test_write(u32 iter, u32 nb_ops)
+{
+	u32 i, j, size;
+	u64 pos, capacity;
+	u8 *ref, *fixed;
+	FILE *files[BST_NB_WRITERS];
+	GF_BitStream *bs[BST_NB_WRITERS];
+	Bool ok = 1;
+
+	/*worst case is 64 bits per operation*/
+	capacity = 8 * (u64) nb_ops;
+	ref = (u8*)gf_malloc(sizeof(u8) * (size_t) capacity);
+	fixed = (u8*)gf_malloc(sizeof(u8) * (size_t) capacity);
+	memset(ref, 0, (size_t) capacity);
+	memset(files, 0, sizeof(files));
+
+	bs[0] = gf_bs_new((char*)fixed, capacity, GF_BITSTREAM_WRITE);
+	bs[1] = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	bs[2] = gf_bs_new_chained(1 + bst_rand() % 300);
+	files[3] = gf_temp_file_new();
+	files[4] = gf_temp_file_new();
+	if (!files[3] || !files[4]) {
+		fprintf(stderr, "Cannot create temporary files\n");
+		ok = 0;
+		bs[3] = bs[4] = NULL;
+		goto exit;
+	}
+	bs[3] = gf_bs_from_file(files[3], GF_BITSTREAM_WRITE);
+	bs[4] = gf_bs_from_file(files[4], GF_BITSTREAM_WRITE);
+	gf_bs_set_output_buffering(bs[4], 1 + bst_rand() % 5000);
+
+	pos = 0;
+	for (i=0; i<nb_ops; i++) {
+		/*values are not masked: only the low bits shall be written*/
+		u64 value = bst_rand64();
+		if (bst_rand() % 2) {
+			u32 nBits = bst_rand() % 33;
+			for (j=0; j<BST_NB_WRITERS; j++) gf_bs_write_int(bs[j], (s32) value, nBits);
+			bst_ref_write(ref, pos, value, nBits);
+			pos += nBits;
+		} else {
+			u32 nBits = bst_rand() % 65;
+			for (j=0; j<BST_NB_WRITERS; j++) gf_bs_write_long_int(bs[j], (s64) value, nBits);
+			bst_ref_write(ref, pos, value, nBits);
+			pos += nBits;
+		}
+	}
+	/*pending bits are flushed with zero padding*/
+	for (j=0; j<BST_NB_WRITERS; j++) gf_bs_align(bs[j]);
+	if (pos & 7) bst_ref_write(ref, pos, 0, 8 - (u32) (pos & 7));
+	size = (u32) ((pos + 7) / 8);
+
+	for (j=0; ok && (j<BST_NB_WRITERS); j++) {
+		char *out = NULL;
+		u32 out_size = 0;
+		Bool do_free = 0;
+		switch (j) {
+		case 0:
+			out = (char*)fixed;
+			out_size = (u32) gf_bs_get_position(bs[0]);
+			break;
+		case 1:
+		case 2:
+			gf_bs_get_content(bs[j], &out, &out_size);
+			do_free = 1;
+			break;
+		default:
+			gf_bs_del(bs[j]);
+			bs[j] = NULL;
+			out_size = (u32) gf_f64_tell(files[j]);
+			if (out_size) {
+				out = (char*)gf_malloc(sizeof(char) * out_size);
+				gf_f64_seek(files[j], 0, SEEK_SET);
+				if (fread(out, 1, out_size, files[j]) != out_size) out_size = 0;
+			}
+			do_free = 1;
+			break;
+		}
+		if (out_size != size) {
+			fprintf(stderr, "Iteration %d: %s bitstream wrote %d bytes, expected %d\n", iter, writer_names[j], out_size, size);
+			ok = 0;
+		} else if (size && memcmp(out, ref, size)) {
+			u32 k;
+			for (k=0; k<size; k++) {
+				if (((u8*)out)[k] != ref[k]) break;
+			}
+			fprintf(stderr, "Iteration %d: %s bitstream differs at byte %d: got %02X expected %02X\n", iter, writer_names[j], k, (u8) out[k], ref[k]);
+			ok = 0;
+		}
+		if (do_free && out) gf_free(out);
+	}
+
+exit:
+	for (j=0; j<BST_NB_WRITERS; j++) {
+		if (bs[j]) gf_bs_del(bs[j]);
+		if (files[j]) fclose(files[j]);
+	}
+	gf_free(fixed);
+	gf_free(ref);
+	return ok;
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr, "USAGE: gpac_bstest [options]\n"
+	        "\n"
+	        "Options:\n"
+	        "-iter N: number of random read and write sequences (default 200)\n"
+	        "-ops N: number of operations per sequence (default 5000)\n"
+	        "-seed N: random seed (default 1)\n"
+	        "-dir PATH: also runs the read sequences over the files of the given directory\n"
+	        "\n");
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, nb_iter = 200, nb_ops = 5000;
+	const char *dir = NULL;
+
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		Bool has_next = (i+1 < (u32) argc) ? 1 : 0;
+		if (!strcmp(arg, "-iter") && has_next) {
+			nb_iter = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-ops") && has_next) {
+			nb_ops = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-seed") && has_next) {
+			bst_seed = atoi(argv[++i]);
+		} else if (!strcmp(arg, "-dir") && has_next) {
+			dir = argv[++i];
+		} else {
+			PrintUsage();
+			return (!strcmp(arg, "-h")) ? 0 : 1;
+		}
+	}
+	if (!nb_ops) nb_ops = 1;
+
+	gf_sys_init(0);
+	for (i=0; i<nb_iter; i++) {
+		if (!bst_test_read_random(i, nb_ops) || !bst_test_write(i, nb_ops)) {
+			fprintf(stderr, "Bitstream test failed\n");
+			gf_sys_close();
+			return 1;
+		}
+	}
+	fprintf(stderr, "Bitstream test passed: %d sequences of %d operations\n", nb_iter, nb_ops);
+
+	if (dir) {
+		BSTDirPass pass;
+		GF_Err e;
+		memset(&pass, 0, sizeof(BSTDirPass));
+		pass.nb_ops = nb_ops;
+		e = gf_enum_directory(dir, 0, bst_test_file, &pass, NULL);
+		if (pass.failed) {
+			fprintf(stderr, "Bitstream test failed\n");
+			gf_sys_close();
+			return 1;
+		}
+		if (e) {
+			fprintf(stderr, "Cannot enumerate directory %s: %s\n", dir, gf_error_to_string(e));
+			gf_sys_close();
+			return 1;
+		}
+		fprintf(stderr, "Bitstream test passed on %d files of %s\n", pass.nb_files, dir);
+	}
+	gf_sys_close();
+	return 0;
+}
@@ -93,6 +93,13 @@ u8 gf_bifs_encoder_get_version(GF_BifsEncoder *codec, u16 ESID);
 /*Encodes current graph as a scene replace*/
 GF_Err gf_bifs_encoder_get_rap(GF_BifsEncoder *codec, char **out_data, u32 *out_data_length);
 
+/*enables/disables the RAP cache: when enabled, the encoded bits of each node subtree of a scene replace are kept
+and reused at the next scene replace encoding, until the subtree is invalidated. This speeds up carousel generation
+of large scenes, but the caller MUST invalidate every node modified or destroyed since the last encoding*/
+GF_Err gf_bifs_encoder_enable_rap_cache(GF_BifsEncoder *codec, Bool enable);
+/*invalidates the cached subtrees of the node and of all its parents - if @node is NULL, the whole cache is flushed*/
+void gf_bifs_encoder_invalidate_rap_cache(GF_BifsEncoder *codec, GF_Node *node);
+
 #endif /*GPAC_DISABLE_BIFS_ENC*/
 
 #endif /*GPAC_DISABLE_BIFS*/
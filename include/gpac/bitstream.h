@@ -68,6 +68,15 @@ typedef struct __tag_bitstream GF_BitStream;
  *	does not write more than possible.
  */
 GF_BitStream *gf_bs_new(const char *buffer, u64 size, u32 mode);
+/*!
+ *	\brief chained bitstream constructor
+ *
+ *	Constructs a write bitstream storing its data in a chain of memory blocks. Blocks are never reallocated, and can be sent
+ *	to another bitstream or to the network without being merged in a single buffer.
+ *	\param block_size the default size of each block in bytes. Writing a larger data chunk allocates a block of the chunk size.
+ *	\return new bitstream object
+ */
+GF_BitStream *gf_bs_new_chained(u32 block_size);
 /*!
  *	\brief bitstream constructor from file handle
  *
@@ -109,6 +118,26 @@ GF_Err gf_bs_set_output_buffering(GF_BitStream *bs, u32 size);
  */
 u32 gf_bs_get_output_buffering(GF_BitStream *bs);
 
+/*!
+ *	\brief flushes bitstream content to disk
+ *
+ * Writes any pending data of the write cache and flushes the underlying file, so that other readers of the file see all data written so far. Does nothing for memory bitstreams.
+ *	\param bs the target bitstream
+ */
+void gf_bs_flush(GF_BitStream *bs);
+
+/*!
+ *	\brief sets bitstream read cache size
+ *
+ * Sets the read cache size for file-based bitstreams. Data is fetched from the file by blocks of the given size.
+ *	\param bs the target bitstream
+ *	\param size size of the read cache in bytes, 0 disables the cache
+ *	\return error if any.
+ *	\warning the file handle position does not match the bitstream position while the cache is active; it is restored when the cache
+ *	is disabled or the bitstream is destroyed. The file handle shall not be accessed directly in between.
+ */
+GF_Err gf_bs_set_input_buffering(GF_BitStream *bs, u32 size);
+
 /*!
  *	\brief integer reading
  *
@@ -227,6 +256,23 @@ u16 gf_bs_read_u16_le(GF_BitStream *bs);
  */
 u32 gf_bs_read_vluimsbf5(GF_BitStream *bs);
 
+/*!
+ *	\brief Exp-Golomb unsigned integer reading
+ *
+ *	Reads an unsigned integer coded with Exp-Golomb (ue(v) in AVC/HEVC syntax).
+ *	\param bs the target bitstream
+ *	\return the integer value read.
+ */
+u32 gf_bs_read_ue(GF_BitStream *bs);
+/*!
+ *	\brief Exp-Golomb signed integer reading
+ *
+ *	Reads a signed integer coded with Exp-Golomb (se(v) in AVC/HEVC syntax).
+ *	\param bs the target bitstream
+ *	\return the integer value read.
+ */
+s32 gf_bs_read_se(GF_BitStream *bs);
+
 /*!
  *	\brief bit position
  *
@@ -264,6 +310,22 @@ void gf_bs_write_int(GF_BitStream *bs, s32 value, s32 nBits);
  *	\param nBits number of bits used to code the integer
  */
 void gf_bs_write_long_int(GF_BitStream *bs, s64 value, s32 nBits);
+/*!
+ *	\brief Exp-Golomb unsigned integer writing
+ *
+ *	Writes an unsigned integer with Exp-Golomb coding (ue(v) in AVC/HEVC syntax).
+ *	\param bs the target bitstream
+ *	\param value the integer to write
+ */
+void gf_bs_write_ue(GF_BitStream *bs, u32 value);
+/*!
+ *	\brief Exp-Golomb signed integer writing
+ *
+ *	Writes a signed integer with Exp-Golomb coding (se(v) in AVC/HEVC syntax).
+ *	\param bs the target bitstream
+ *	\param value the integer to write
+ */
+void gf_bs_write_se(GF_BitStream *bs, s32 value);
 /*!
  *	\brief float writing
  *
@@ -401,6 +463,38 @@ u64 gf_bs_available(GF_BitStream *bs);
 	* Once this function has been called, the internal bitstream buffer is reseted.
  */
 void gf_bs_get_content(GF_BitStream *bs, char **output, u32 *outSize);
+
+/*!
+ *	\brief memory block of a chained bitstream
+ */
+typedef struct
+{
+	/*! data of the block*/
+	char *data;
+	/*! size of the data written in the block*/
+	u32 size;
+} GF_BitStreamBlock;
+
+/*!
+ *	\brief chained blocks fetching
+ *
+ *	Gets the memory blocks of a chained bitstream, in stream order. The bitstream is aligned before this.
+ *	\param bs the target bitstream
+ *	\param blocks set to the array of blocks. The array and the blocks are owned by the bitstream and are only valid until the next modification of the bitstream.
+ *	\return the number of blocks, 0 if the bitstream is not a chained bitstream
+ */
+u32 gf_bs_get_blocks(GF_BitStream *bs, const GF_BitStreamBlock **blocks);
+
+/*!
+ *	\brief bitstream transfer
+ *
+ *	Writes the content of a memory write bitstream (dynamic or chained) at the current position of another bitstream, without
+ *	resetting the source bitstream. The source bitstream is aligned before this.
+ *	\param dst the destination bitstream
+ *	\param src the source bitstream
+ *	\return error if any.
+ */
+GF_Err gf_bs_transfer(GF_BitStream *dst, GF_BitStream *src);
 /*!
  *	\brief byte skipping
  *
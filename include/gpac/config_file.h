@@ -102,6 +102,17 @@ void gf_cfg_remove(GF_Config *cfgFile);
  *\param cfgFile the target configuration file
  */
 GF_Err gf_cfg_save(GF_Config *iniFile);
+/*!
+ *	\brief journaled save mode
+ *
+ *Enables or disables journaled saving. In journaled mode, \ref gf_cfg_save only appends the keys modified, added or removed
+ *since the last save at the end of the file rather than rewriting the whole file. The file is rewritten when sections are removed,
+ *when keys are inserted at a given position, or when the journal grows bigger than twice the number of keys in the configuration.
+ *This is typically used for large and frequently updated configurations such as live DASH contexts.
+ *\param cfgFile the target configuration file
+ *\param journaled if true, journaled mode is enabled
+ */
+void gf_cfg_set_journaled(GF_Config *cfgFile, Bool journaled);
 /*!
  *	\brief key value query
  *
@@ -162,6 +162,8 @@ GF_Err gf_bifs_flush_command_list(GF_BifsDecoder *codec);
 
 #ifndef GPAC_DISABLE_BIFS_ENC
 
+typedef struct _bifs_rap_cache GF_BIFSRAPCache;
+
 struct __tag_bifs_enc
 {
 	GF_Err LastError;
@@ -191,6 +193,11 @@ struct __tag_bifs_enc
 	/*keep track of DEF/USE*/
 	GF_List *encoded_nodes;
 	Bool is_encoding_command;
+
+	/*encoded subtrees reused across scene replace encodings, NULL if disabled*/
+	GF_BIFSRAPCache *rap_cache;
+	/*set while encoding the scene replace*/
+	Bool rap_cache_on;
 };
 
 GF_Err gf_bifs_enc_commands(GF_BifsEncoder *codec, GF_List *comList, GF_BitStream *bs);
@@ -202,6 +209,9 @@ GF_Err gf_bifs_enc_mf_field(GF_BifsEncoder *codec, GF_BitStream *bs, GF_Node *no
 GF_Err gf_bifs_enc_route(GF_BifsEncoder *codec, GF_Route *r, GF_BitStream *bs);
 void gf_bifs_enc_name(GF_BifsEncoder *codec, GF_BitStream *bs, char *name);
 GF_Node *gf_bifs_enc_find_node(GF_BifsEncoder *codec, u32 nodeID);
+void gf_bifs_enc_rap_cache_start(GF_BifsEncoder *codec);
+void gf_bifs_enc_rap_cache_stop(GF_BifsEncoder *codec);
+void gf_bifs_enc_rap_cache_del(GF_BifsEncoder *codec);
 
 #define GF_BIFS_WRITE_INT(codec, bs, val, nbBits, str, com)	{\
 		gf_bs_write_int(bs, val, nbBits);	\
@@ -246,6 +246,8 @@ struct __tag_compositor
 	/*options*/
 	u32 aspect_ratio, antiAlias, texture_text_mode;
 	Bool high_speed, stress_mode;
+	/*draws 2D text from per-size pre-rasterized glyph atlases*/
+	Bool glyph_atlas;
 	Bool force_opengl_2d, was_opengl;
 #ifdef OPENGL_RASTER
 	Bool opengl_raster;
@@ -1202,7 +1204,12 @@ struct _gf_font
 	/*fonts are linked within the font manager*/
 	GF_Font *next;
 	/*list of glyphs in the font*/
-	GF_Glyph *glyph;
+	GF_Glyph *glyph, *last_glyph;
+	/*glyph lookup table by glyph ID (open addressing, power of 2 size)*/
+	GF_Glyph **glyph_hash;
+	u32 glyph_hash_size, nb_hashed_glyphs;
+	/*pre-rasterized glyph atlases, one per pixel size, most recently used first*/
+	struct _glyph_atlas *atlas;
 
 	char *name;
 	u32 em_size;
@@ -1284,6 +1291,10 @@ void gf_font_manager_delete_span(GF_FontManager *fm, GF_TextSpan *tspan);
 GF_Err gf_font_manager_register_font(GF_FontManager *fm, GF_Font *font);
 GF_Err gf_font_manager_unregister_font(GF_FontManager *fm, GF_Font *font);
 
+/*adds/removes a glyph to/from the font glyph list and lookup table - used by embedded font engines (SVG fonts)*/
+void gf_font_register_glyph(GF_Font *font, GF_Glyph *glyph);
+void gf_font_unregister_glyph(GF_Font *font, GF_Glyph *glyph);
+
 void gf_font_manager_refresh_span_bounds(GF_TextSpan *span);
 GF_Path *gf_font_span_create_path(GF_TextSpan *span);
 
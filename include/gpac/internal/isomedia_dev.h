@@ -1024,6 +1024,10 @@ typedef struct
 	u32 sampleCount;
  	u32 alloc_size;
 	u32 *sizes;
+	/*compact in-memory size table used when importing, in which case sizes is NULL: sizes are stored on
+	packed_bits (8 or 16) bits, and the table is widened when a bigger sample is added*/
+	void *packed_sizes;
+	u32 packed_bits;
 } GF_SampleSizeBox;
 
 typedef struct
@@ -1040,8 +1044,14 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u64 *offsets;
+	/*compact in-memory offset table used when importing, in which case offsets is NULL: offsets are stored as
+	32 bit deltas to a 64 bit anchor, one anchor every (1<<CO64_ANCHOR_SHIFT) entries*/
+	u64 *anchors;
+	u32 *deltas;
 } GF_ChunkLargeOffsetBox;
 
+#define CO64_ANCHOR_SHIFT	8
+
 typedef struct
 {
 	u32 firstChunk;
@@ -2422,6 +2432,19 @@ struct __tag_isom {
 	u64 root_sidx_offset;
 	u32 root_sidx_index;
 
+#ifndef GPAC_DISABLE_ISOM_WRITE
+	/*low-latency chunked segments*/
+	Bool chunked_segments, chunk_write_sidx;
+	u32 chunk_ref_track;
+	gf_isom_segment_chunk_callback on_chunk;
+	void *on_chunk_udta;
+	/*chunked segment being written: set once its styp/sidx are written*/
+	Bool chunk_segment_open;
+	GF_SegmentIndexBox *chunk_sidx;
+	u64 chunk_sidx_start, chunk_sidx_end, chunk_start;
+	u32 chunk_earliest_cts, chunk_duration, chunk_nb_frags;
+#endif
+
 	Bool is_index_segment;
 #endif
 
@@ -2501,6 +2524,11 @@ GF_Err stbl_GetSampleDepType(GF_SampleDependencyTypeBox *stbl, u32 SampleNumber,
 
 /*unpack sample2chunk and chunk offset so that we have 1 sample per chunk (edition mode only)*/
 GF_Err stbl_UnpackOffsets(GF_SampleTableBox *stbl);
+
+/*size table access (0-based index), whether the table is packed or not - the table must exist*/
+u32 stsz_get_entry(GF_SampleSizeBox *stsz, u32 idx);
+/*chunk offset access (0-based index), whether the table is compact or not*/
+u64 co64_get_entry(GF_ChunkLargeOffsetBox *co64, u32 idx);
 GF_Err SetTrackDuration(GF_TrackBox *trak);
 GF_Err Media_SetDuration(GF_TrackBox *trak);
 
@@ -2569,6 +2597,10 @@ GF_Err stbl_RemovePaddingBits(GF_SampleTableBox *stbl, u32 SampleNumber);
 GF_Err stbl_RemoveSampleFragments(GF_SampleTableBox *stbl, u32 sampleNumber);
 GF_Err stbl_RemoveRedundant(GF_SampleTableBox *stbl, u32 SampleNumber);
 
+/*converts compact in-memory tables back to regular u32/u64 tables - needed before random edits of the tables*/
+GF_Err stsz_unpack(GF_SampleSizeBox *stsz);
+GF_Err co64_unpack(GF_ChunkLargeOffsetBox *co64);
+
 /*expands sampleGroup table for the given grouping type and sample_number. If sample_number is 0, just appends an entry at the end of the table*/
 GF_Err gf_isom_add_sample_group_entry(GF_List *sampleGroups, u32 sample_number, u32 grouping_type, u32 sampleGroupDescriptionIndex);
 
@@ -368,6 +368,8 @@ struct _tag_terminal
 	u32 cumulated_priority;
 	/*frame duration*/
 	u32 frame_duration;
+	/*pool of composition unit buffers shared by all decoders*/
+	struct _cm_frame_pool *frame_pool;
 
 	/*net services*/
 	GF_List *net_services;
@@ -573,6 +575,11 @@ enum
 	GF_ESM_CAROUSEL_MPEG2,
 };
 
+/*number of AU payload size classes in the channel pool - class k holds buffers of 256<<k bytes*/
+#define GF_ES_POOL_CLASSES	16
+/*max number of free payloads kept per size class*/
+#define GF_ES_POOL_DEPTH	8
+
 /*data channel (elementary stream)*/
 struct _es_channel
 {
@@ -680,6 +687,14 @@ struct _es_channel
 	u64 net_dts, net_cts;
 
 	Bool no_timestamps;
+
+	/*pool of decoding buffer units and AU payloads, filled when AUs are dropped and reused for new AUs*/
+	struct _decoding_buffer *db_pool;
+	u32 db_pool_count;
+	char *au_pool[GF_ES_POOL_CLASSES][GF_ES_POOL_DEPTH];
+	u8 au_pool_count[GF_ES_POOL_CLASSES];
+	/*number of AU payload allocations served by / missed in the pool*/
+	u32 pool_hits, pool_misses;
 };
 
 /*creates a new channel for this stream*/
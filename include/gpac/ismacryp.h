@@ -89,6 +89,11 @@ typedef struct
 
 #if !defined(GPAC_DISABLE_MCRYPT) && !defined(GPAC_DISABLE_ISOM_WRITE)
 
+/*sets the number of worker threads used to encrypt/decrypt the samples of a track. Samples are read and
+written back in order by the calling thread, only the encryption is parallelized. 0 or 1 (default) disables
+multithreading*/
+void gf_ismacryp_set_threads(u32 nb_threads);
+
 /*encrypts track - logs, progress: info callbacks, NULL for default*/
 GF_Err gf_ismacryp_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*progress)(void *cbk, u64 done, u64 total), void *cbk);
 
@@ -1221,6 +1221,18 @@ frags_per_sidx, daisy_chain_sidx and frags_per_segment are currently ignored and
 if not NULL, start_range and end_range will contain the byte range of the SIDX box in the movie*/
 GF_Err gf_isom_allocate_sidx(GF_ISOFile *movie, s32 subsegs_per_sidx, Bool daisy_chain_sidx, u32 nb_segs, u32 *frags_per_segment, u32 *start_range, u32 *end_range);
 
+/*callback used in chunked segment mode, called each time a chunk of the current segment is written to the segment file
+@data, @size: chunk content, which starts at @offset in the segment. The first chunk of a segment also carries the styp and the (blank) sidx
+@segment_end: set once the segment is closed. @data then holds the final sidx to be written at @offset (NULL if no sidx is used)*/
+typedef void (*gf_isom_segment_chunk_callback)(void *udta, char *data, u32 size, u64 offset, Bool segment_end);
+
+/*enables or disables low-latency chunked segments. In this mode, each fragment (moof+mdat) of a segment is written and flushed to the segment
+file as soon as the next fragment is started, rather than when the segment is closed. When write_sidx is set, a single-entry sidx for referenceTrackID
+is reserved at the start of each segment and patched by gf_isom_close_segment; subsegs_per_sidx and daisy_chain_sidx are then ignored.
+Chunked mode only applies to segments not appended to the movie file and not indexed by gf_isom_allocate_sidx, which are still written at close time.
+@on_chunk: optional callback receiving each chunk, for example to forward it on a pipe or an HTTP chunked connection*/
+GF_Err gf_isom_set_segment_chunk_mode(GF_ISOFile *movie, Bool enable, u32 referenceTrackID, Bool write_sidx, gf_isom_segment_chunk_callback on_chunk, void *udta);
+
 enum
 {
 	/*indicates that the track fragment has no samples but still has a duration
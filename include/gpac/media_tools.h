@@ -34,6 +34,7 @@ extern "C" {
 #include "isomedia.h"
 #include "avparse.h"
 #include "config_file.h"
+#include "network.h"
 
 /*computes file hash. If file is ISO-based, computre hash according to OMA (P)DCF (without MutableDRMInformation box)*/
 GF_Err gf_media_get_file_hash(const char *file, u8 hash[20]);
@@ -230,6 +231,13 @@ typedef struct __track_import
 
 GF_Err gf_media_import(GF_MediaImporter *importer);
 
+/*imports several tracks of a source in one call
+@track_nums: track numbers as returned by probing (tk_info[].track_num), imported in this order
+@final_trackIDs: if not NULL, filled with the ID of the track created for each imported track
+MPEG-2 TS sources are read and demultiplexed only once for all selected PIDs; other sources are imported
+one track after the other as with gf_media_import*/
+GF_Err gf_media_import_tracks(GF_MediaImporter *importer, u32 nb_tracks, u32 *track_nums, u32 *final_trackIDs);
+
 
 /*adds chapter info contained in file - import_fps is optional (most formats don't use it), defaults to 25*/
 GF_Err gf_media_import_chapters(GF_ISOFile *file, char *chap_file, Double import_fps);
@@ -300,6 +308,10 @@ typedef enum
 	GF_DASH_BSMODE_SINGLE
 } GF_DashSwitchingMode;
 
+/*sets the number of threads used to index the MPEG-2 TS representations of an adaptation set. 0 or 1 (default)
+indexes them one after the other*/
+void gf_dasher_set_threads(u32 nb_threads);
+
 GF_Err gf_dasher_segment_files(const char *mpd_name, GF_DashSegmenterInput *inputs, u32 nb_inputs, GF_DashProfile profile,
 							   const char *mpd_title, const char *mpd_source, const char *mpd_copyright,
 							   const char *mpd_moreInfoURL, const char **mpd_base_urls, u32 nb_mpd_base_urls,
@@ -311,6 +323,74 @@ GF_Err gf_dasher_segment_files(const char *mpd_name, GF_DashSegmenterInput *inpu
 /*returns time to wait until end of currently generated segments*/
 u32 gf_dasher_next_update_time(GF_Config *dash_ctx, u32 mpd_update_time);
 
+/*long-running (daemon) DASH segmenter. Inputs are probed once and kept open between update cycles together with the
+per-representation state stored in dash_ctx, expired segments are deleted by a background thread and the MPD is only
+republished when its content changes. All strings and the inputs array must stay valid until the segmenter is destroyed*/
+typedef struct __dash_live_segmenter GF_DASHLiveSegmenter;
+
+/*creates a live segmenter - parameters are the same as gf_dasher_segment_files. dash_ctx shall not be NULL in live mode.
+if follow_input_growth is set, inputs are considered as growing files (typically fragmented ISO files being recorded):
+instead of being looped, new segments are produced as media is appended to them*/
+GF_DASHLiveSegmenter *gf_dasher_live_new(const char *mpd_name, GF_DashSegmenterInput *inputs, u32 nb_inputs, GF_DashProfile profile,
+							   const char *mpd_title, const char *mpd_source, const char *mpd_copyright,
+							   const char *mpd_moreInfoURL, const char **mpd_base_urls, u32 nb_mpd_base_urls,
+							   Bool use_url_template, Bool single_segment, Bool single_file, GF_DashSwitchingMode bitstream_switching_mode,
+							   Bool segments_start_with_rap, Double dash_duration_sec, char *seg_rad_name, char *seg_ext,
+							   Double frag_duration_sec, s32 subsegs_per_sidx, Bool daisy_chain_sidx, Bool fragments_start_with_rap, const char *tmp_dir,
+							   GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec,
+							   Bool follow_input_growth);
+/*destroys the live segmenter, waiting for pending segment deletions*/
+void gf_dasher_live_del(GF_DASHLiveSegmenter *dasher);
+/*runs one update cycle: purges expired segments, produces the new segments and updates the MPD*/
+GF_Err gf_dasher_live_process(GF_DASHLiveSegmenter *dasher);
+/*returns time to wait in ms before the next update cycle. When following growing inputs, returns 0 as soon as an input is modified*/
+u32 gf_dasher_live_next_update_time(GF_DASHLiveSegmenter *dasher);
+/*gets statistics on the delay between the arrival of media in growing inputs and the availability of the segments containing it*/
+void gf_dasher_live_get_latency(GF_DASHLiveSegmenter *dasher, u32 *nb_measures, u32 *last_ms, u32 *avg_ms, u32 *max_ms);
+
+/*callback for chunked segments: called each time a chunk (moof+mdat) of segment_name is written, and with segment_end set once the
+segment is complete, in which case data holds the final sidx to be written at offset (NULL if no sidx)*/
+typedef void (*gf_dasher_chunk_callback)(void *udta, const char *segment_name, char *data, u32 size, u64 offset, Bool segment_end);
+/*enables low-latency chunked segments for ISO inputs: fragments are made of at most chunk_frames samples of the reference track and are
+written and flushed to the segment file as soon as they are produced, the segment index being patched once the segment is done.
+A chunk_frames value of 0 disables chunking. on_chunk is optional and can be used to forward chunks on pipes or HTTP chunked connections*/
+GF_Err gf_dasher_live_set_chunk_mode(GF_DASHLiveSegmenter *dasher, u32 chunk_frames, gf_dasher_chunk_callback on_chunk, void *udta);
+
+#ifndef GPAC_DISABLE_ISOM
+/*segment index of an indexed file (onDemand profile, single file with sidx), used by origin servers to answer byte range requests.
+The index is built once from the sidx hierarchy: segments are the references of the top-level sidx and subsegments the media
+references of the sidx below them (a segment described by a media reference is its own single subsegment)*/
+typedef struct __dash_segment_index GF_DASHSegmentIndex;
+
+typedef struct
+{
+	/*byte range in the file, end included*/
+	u64 start_range, end_range;
+	/*earliest presentation time and duration, in the index timescale*/
+	u64 earliest_presentation_time;
+	u32 duration;
+	u32 sap_type, sap_delta_time;
+	Bool starts_with_sap;
+} GF_DASHIndexRange;
+
+/*builds the index of the given file. Only box headers up to the first sidx and the sidx boxes are read.
+Returns NULL and sets out_err (GF_NOT_SUPPORTED if the file has no sidx) in case of failure*/
+GF_DASHSegmentIndex *gf_dasher_index_new(const char *file_name, GF_Err *out_err);
+void gf_dasher_index_del(GF_DASHSegmentIndex *index);
+/*gets index timescale, file size, end of the initialization segment (moov) and byte range of the top-level sidx*/
+void gf_dasher_index_get_info(GF_DASHSegmentIndex *index, u32 *timescale, u64 *file_size, u64 *init_end_range, u64 *index_start_range, u64 *index_end_range);
+u32 gf_dasher_index_get_segment_count(GF_DASHSegmentIndex *index);
+const GF_DASHIndexRange *gf_dasher_index_get_segment(GF_DASHSegmentIndex *index, u32 segment_idx);
+u32 gf_dasher_index_get_subsegment_count(GF_DASHSegmentIndex *index, u32 segment_idx);
+const GF_DASHIndexRange *gf_dasher_index_get_subsegment(GF_DASHSegmentIndex *index, u32 segment_idx, u32 subsegment_idx);
+/*locates the segment and subsegment containing the given time (in the index timescale). Returns GF_EOS if time is outside the indexed range*/
+GF_Err gf_dasher_index_find(GF_DASHSegmentIndex *index, u64 time, u32 *segment_idx, u32 *subsegment_idx);
+/*sends the given byte range (end included) of the indexed file on the socket. Uses zero-copy (sendfile) when available, otherwise
+copies the data through a buffer. If the socket stays unwritable for more than one second, GF_IP_SOCK_WOULD_BLOCK is returned and
+bytes_sent tells where to resume*/
+GF_Err gf_dasher_index_send_range(GF_DASHSegmentIndex *index, u64 start_range, u64 end_range, GF_Socket *sock, u64 *bytes_sent);
+#endif
+
 #ifndef GPAC_DISABLE_ISOM_WRITE
 
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
@@ -566,6 +566,8 @@ typedef struct tag_m2ts_pes
 	unsigned char *data;
 	/*amount of bytes received in the current PES packet (NOT INCLUDING ANY PENDING BYTES)*/
 	u32 data_len;
+	/*allocated size of the PES re-assembler, kept from one PES packet to the next*/
+	u32 data_alloc;
 	/*size of the PES packet being recevied*/
 	u32 pes_len;
 	Bool rap;
@@ -732,6 +734,58 @@ typedef struct
 	GF_M2TS_ES *stream;
 } GF_M2TS_SL_PCK;
 
+/*flags of a TS random access index entry*/
+enum
+{
+	/*entry is the first packet of a PES*/
+	GF_M2TS_INDEX_PES = 1,
+	/*the PES starts with a random access point*/
+	GF_M2TS_INDEX_RAP = 1<<1,
+	/*entry is a PCR*/
+	GF_M2TS_INDEX_PCR = 1<<2,
+};
+
+/*TS random access index entry*/
+typedef struct
+{
+	/*DTS of the PES (PTS if no DTS), or PCR base for PCR entries, in 90 kHz and unwrapped*/
+	u64 dts;
+	/*byte offset in the file of the TS packet carrying the PES start or the PCR*/
+	u64 byte_pos;
+	/*PTS - DTS of the PES, in 90 kHz*/
+	u16 cts_offset;
+	/*GF_M2TS_INDEX_* flags*/
+	u16 flags;
+} GF_M2TS_IndexEntry;
+
+/*TS random access index of a PID - PES and PCR entries of a same PID are stored in two separate tracks*/
+typedef struct
+{
+	u32 pid;
+	u32 stream_type;
+	/*set if entries are PCRs*/
+	Bool is_pcr;
+	u32 nb_entries, nb_alloc;
+	GF_M2TS_IndexEntry *entries;
+} GF_M2TS_IndexTrack;
+
+/*TS random access index, either built on the fly by the demuxer or loaded from a sidecar file. The index is only used
+for seeking in the demuxer, the DASH segmenter runs its own scan since it needs the positions of every PAT/PMT and PCR*/
+typedef struct __m2ts_index
+{
+	/*size of the indexed file*/
+	u64 file_size;
+	/*number of bytes indexed from the start of the file*/
+	u64 indexed_size;
+	/*set when the index covers the entire file*/
+	Bool complete;
+	/*list of GF_M2TS_IndexTrack*/
+	GF_List *tracks;
+	/*PID to track+1 maps for PES and PCR tracks*/
+	u16 pes_map[GF_M2TS_MAX_STREAMS];
+	u16 pcr_map[GF_M2TS_MAX_STREAMS];
+} GF_M2TS_Index;
+
 /*MPEG-2 TS demuxer*/
 struct tag_m2ts_demux
 {
@@ -808,6 +862,16 @@ struct tag_m2ts_demux
 	struct __gf_dvb_mpe_ip_platform *ip_platform;
 
 	u32 pck_number;
+	/*byte offset in the source of the next data passed to gf_m2ts_process_data, to be set by the user when not
+	processing the source contiguously from its start*/
+	u64 data_pos;
+	/*byte offset in the source of the packet being processed*/
+	u64 pck_pos;
+
+	/*random access index, destroyed with the demuxer. When set and not complete, it is extended while packets
+	are processed contiguously from the start of the file*/
+	GF_M2TS_Index *index;
+	Bool index_record;
 
 	/*remote file handling - created and destroyed by user*/
 	struct __gf_download_session *dnload;
@@ -837,6 +901,23 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size);
 u32 gf_dvb_get_freq_from_url(const char *channels_config_path, const char *url);
 void gf_m2ts_demux_dmscc_init(GF_M2TS_Demuxer *ts);
 
+GF_M2TS_Index *gf_m2ts_index_new();
+void gf_m2ts_index_del(GF_M2TS_Index *idx);
+/*builds the complete index of a TS file*/
+GF_Err gf_m2ts_index_build(const char *fileName, GF_M2TS_Index **out_idx);
+/*saves/loads the index in a sidecar file (usually "file.ts.tsidx"). When loading, @file_size is checked against
+the size of the indexed file and GF_BAD_PARAM is returned if they differ*/
+GF_Err gf_m2ts_index_save(GF_M2TS_Index *idx, const char *sidecar);
+GF_Err gf_m2ts_index_load(const char *sidecar, u64 file_size, GF_M2TS_Index **out_idx);
+/*gets the PTS of the first PES of the PID - if @pid is 0, the first indexed video PID is used, or the first indexed PID if no video*/
+GF_Err gf_m2ts_index_get_start(GF_M2TS_Index *idx, u32 pid, u64 *start_pts);
+/*locates the last random access point of the PID with PTS lower than or equal to @pts (90 kHz, unwrapped), or the first one if none.
+@pid is resolved as in gf_m2ts_index_get_start. Returns GF_EOS if @pts is beyond the indexed part of an incomplete index*/
+GF_Err gf_m2ts_index_find(GF_M2TS_Index *idx, u32 pid, u64 pts, u64 *byte_pos, u64 *rap_pts);
+/*resets the demuxer state for a seek to @pts using its index. @byte_pos is set to the file offset from which data shall
+be processed*/
+GF_Err gf_m2ts_demux_seek(GF_M2TS_Demuxer *ts, u64 pts, u64 *byte_pos);
+
 
 
 u32 gf_m2ts_crc32_check(char *data, u32 len);
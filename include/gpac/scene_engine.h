@@ -190,6 +190,15 @@ GF_Descriptor *gf_seng_get_iod(GF_SceneEngine *seng);
 
 GF_Err gf_seng_dump_rap_on(GF_SceneEngine *seng, Bool dump_rap);
 
+/**
+ * @seng, pointer to the GF_SceneEngine returned by gf_seng_init()
+ * @enable, if set, BIFS scene replace AUs (carousel) only re-encode the subtrees modified since the previous one
+ *
+ * enables or disables the RAP cache (enabled by default). The cache is only used for engines owning their scene graph
+ * (gf_seng_init, gf_seng_init_from_string), since the engine must be notified of all node modifications
+ */
+GF_Err gf_seng_enable_rap_cache(GF_SceneEngine *seng, Bool enable);
+
 #endif /*GPAC_DISABLE_SENG*/
 
 
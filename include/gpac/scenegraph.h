@@ -386,6 +386,13 @@ enum
 	/*function called when the a "set dirty" propagates to root node of the graph
 		ctxdata is not used*/
 	GF_SG_CALLBACK_GRAPH_DIRTY,
+	/*function called upon node destruction, once the node is no longer in the graph
+		ctxdata is not used*/
+	GF_SG_CALLBACK_NODE_DESTROY,
+	/*function called upon modification of a node handled by the scene graph itself (interpolators, scripts, ...),
+	for which GF_SG_CALLBACK_MODIFIED is not sent.
+		ctxdata is the fieldInfo pointer of the modified field*/
+	GF_SG_CALLBACK_MODIFIED_INTERNAL,
 };
 
 /*set node callback: function called upon node creation.
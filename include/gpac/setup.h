@@ -333,6 +333,29 @@ void gf_memory_print(void); /*prints the state of current allocations*/
 #define gf_strdup(s) gf_mem_strdup(s, __FILE__, __LINE__)
 #define gf_realloc(ptr1, size) gf_mem_realloc(ptr1, size, __FILE__, __LINE__)
 
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+
+/*lightweight accounting of live memory per subsystem: each translation unit resolves its subsystem once from its file name
+and caches it in gf_mem_file_tag. Blocks carry a header, so as with memory tracking, mixing gf_ and system allocators on the
+same block is not supported*/
+void *gf_mem_acc_malloc(size_t size, u32 *tag, const char *filename);
+void *gf_mem_acc_calloc(size_t num, size_t size_of, u32 *tag, const char *filename);
+void *gf_mem_acc_realloc(void *ptr, size_t size, u32 *tag, const char *filename);
+void gf_mem_acc_free(void *ptr);
+char *gf_mem_acc_strdup(const char *str, u32 *tag, const char *filename);
+
+#if defined(__GNUC__)
+static u32 gf_mem_file_tag __attribute__((unused)) = 0;
+#else
+static u32 gf_mem_file_tag = 0;
+#endif
+
+#define gf_free(ptr) gf_mem_acc_free(ptr)
+#define gf_malloc(size) gf_mem_acc_malloc(size, &gf_mem_file_tag, __FILE__)
+#define gf_calloc(num, size_of) gf_mem_acc_calloc(num, size_of, &gf_mem_file_tag, __FILE__)
+#define gf_strdup(s) gf_mem_acc_strdup(s, &gf_mem_file_tag, __FILE__)
+#define gf_realloc(ptr1, size) gf_mem_acc_realloc(ptr1, size, &gf_mem_file_tag, __FILE__)
+
 #else
 
 #define gf_malloc malloc
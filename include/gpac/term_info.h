@@ -88,6 +88,8 @@ typedef struct
 	s32 buffer;
 	/*number of AUs in DB (cumulated on all input channels)*/
 	u32 db_unit_count;
+	/*number of AU buffers served by / missed in the channels buffer pools (cumulated on all input channels)*/
+	u32 db_pool_hits, db_pool_misses;
 	/*number of CUs in composition memory (if any) and CM capacity*/
 	u16 cb_unit_count, cb_max_count;
 	/*clock drift in ms of object clock: this is the delay set by the audio renderer to keep AV in sync*/
@@ -226,6 +226,65 @@ Bool gf_mx_try_lock(GF_Mutex *mx);
  */
 s32 gf_mx_get_num_locks(GF_Mutex *mx);
 
+/*
+ *\brief get mutex contention statistics
+ *
+ *Returns the locking statistics of the mutex. Recursive locks by the holding thread are not counted.
+ *\param mx the mutex object
+ *\param nb_locks set to the number of times the mutex was grabbed
+ *\param nb_contentions set to the number of times the mutex was grabbed after waiting for another thread
+ *\param wait_time_us set to the total time spent waiting for the mutex, in microseconds
+ */
+void gf_mx_get_stats(GF_Mutex *mx, u32 *nb_locks, u32 *nb_contentions, u64 *wait_time_us);
+
+/*
+ *\brief get global contention statistics
+ *
+ *Returns the contention statistics of all mutexes (including lightweight ones) since startup. These are also reported in \ref GF_SystemRTInfo.
+ *\param nb_contentions set to the number of contended locks
+ *\param wait_time_ms set to the total time spent waiting for \ref GF_Mutex objects, in milliseconds
+ */
+void gf_mx_get_global_stats(u32 *nb_contentions, u32 *wait_time_ms);
+
+/*!
+ *\brief lightweight mutex object
+ *
+ *The lightweight mutex is a non-recursive lock meant for short critical sections on hot paths. It needs no allocation and
+ *locking it without contention is a single atomic operation. On Linux, waiting threads sleep on a futex, other platforms
+ *yield until the lock is released. A thread locking twice the same lightweight mutex deadlocks.
+ *The object shall be initialized with \ref gf_lmx_init or \ref GF_LIGHT_MUTEX_INIT.
+ */
+typedef struct
+{
+	volatile u32 state;
+	/*number of contended locks*/
+	u32 nb_contentions;
+} GF_LightMutex;
+
+#define GF_LIGHT_MUTEX_INIT	{0, 0}
+
+/*
+ *\brief lightweight mutex initialization
+ *\param lmx the lightweight mutex object
+ */
+void gf_lmx_init(GF_LightMutex *lmx);
+/*
+ *\brief lightweight mutex locking
+ *\param lmx the lightweight mutex object
+ */
+void gf_lmx_lock(GF_LightMutex *lmx);
+/*
+ *\brief lightweight mutex unlocking
+ *\param lmx the lightweight mutex object
+ */
+void gf_lmx_unlock(GF_LightMutex *lmx);
+/*
+ *\brief lightweight mutex non-blocking lock
+ *\param lmx the lightweight mutex object
+ *\return 1 if the mutex has been locked, 0 otherwise
+ */
+Bool gf_lmx_try_lock(GF_LightMutex *lmx);
+
 /*********************************************************************
 					Semaphore Object
 **********************************************************************/
@@ -279,6 +338,151 @@ void gf_sema_wait(GF_Semaphore *sm);
 */
 Bool gf_sema_wait_for(GF_Semaphore *sm, u32 time_out);
 
+
+/*!
+ *\brief atomic operations
+ *
+ *Atomic operations on 32 bit integers. All operations act as full memory barriers and return the new value of the integer,
+ *except gf_atomic_cas which returns 1 if the value was swapped, 0 otherwise.
+ */
+#if defined(__GNUC__)
+#define gf_atomic_inc(_ptr)	__sync_add_and_fetch((_ptr), 1)
+#define gf_atomic_dec(_ptr)	__sync_sub_and_fetch((_ptr), 1)
+#define gf_atomic_add(_ptr, _val)	__sync_add_and_fetch((_ptr), (_val))
+#define gf_atomic_get(_ptr)	__sync_add_and_fetch((_ptr), 0)
+#define gf_atomic_cas(_ptr, _old, _new)	__sync_bool_compare_and_swap((_ptr), (_old), (_new))
+#else
+u32 gf_atomic_add(volatile u32 *ptr, u32 val);
+Bool gf_atomic_cas(volatile u32 *ptr, u32 old_val, u32 new_val);
+#define gf_atomic_inc(_ptr)	gf_atomic_add((volatile u32 *) (_ptr), 1)
+#define gf_atomic_dec(_ptr)	gf_atomic_add((volatile u32 *) (_ptr), (u32) -1)
+#define gf_atomic_get(_ptr)	gf_atomic_add((volatile u32 *) (_ptr), 0)
+#endif
+
+
+/*********************************************************************
+					Task Pool
+**********************************************************************/
+/*!
+ *\brief task pool object
+ *
+ *The task pool runs short tasks on a fixed set of worker threads, so that loops can be parallelized without creating
+ *threads on the fly. Each worker has its own task queue; tasks submitted from a worker go to its own queue, other tasks
+ *are spread over all queues, and idle workers steal tasks from other queues. Threads waiting for a task group help
+ *running queued tasks instead of blocking.
+*/
+typedef struct __tag_task_pool GF_TaskPool;
+/*!
+ *\brief task group object
+ *
+ *A task group tracks completion of a set of tasks submitted to a task pool, and gathers their errors.
+*/
+typedef struct __tag_task_group GF_TaskGroup;
+
+/*!
+ *\brief task callback
+ *
+ *\param par user data passed when submitting the task
+ *\return error if any, reported by \ref gf_task_group_wait
+ */
+typedef GF_Err (*gf_task_run)(void *par);
+/*!
+ *\brief range task callback
+ *
+ *Processes the range [start, end[ of a parallel loop
+ *\param par user data passed to \ref gf_task_pool_parallel_for
+ *\param start first index of the range
+ *\param end index after the last index of the range
+ *\return error if any
+ */
+typedef GF_Err (*gf_task_range_run)(void *par, u32 start, u32 end);
+
+/*!
+ *\brief Task priorities
+ *
+ *Higher priority tasks are always picked before lower priority ones, whatever the queue they are in.
+ */
+enum
+{
+	GF_TASK_PRIORITY_HIGH = 0,
+	GF_TASK_PRIORITY_NORMAL,
+	GF_TASK_PRIORITY_LOW,
+};
+
+/*!
+ *\brief task pool constructor
+ *
+ *Constructs a new task pool and starts its worker threads.
+ *\param name name of the pool, used for thread names and logs
+ *\param nb_threads number of worker threads. If 0, one thread per CPU is used.
+ *\return the task pool object
+ */
+GF_TaskPool *gf_task_pool_new(const char *name, u32 nb_threads);
+/*!
+ *\brief task pool destructor
+ *
+ *Stops the worker threads and destroys the pool. Tasks still in queues are discarded: all task groups shall be waited for before.
+ *\param pool the task pool object
+ */
+void gf_task_pool_del(GF_TaskPool *pool);
+/*!
+ *\brief get number of workers
+ *
+ *\param pool the task pool object
+ *\return the number of worker threads of the pool
+ */
+u32 gf_task_pool_get_thread_count(GF_TaskPool *pool);
+/*!
+ *\brief task submission
+ *
+ *Queues a task for execution by the pool.
+ *\param pool the task pool object
+ *\param group the group the task belongs to, may be NULL
+ *\param priority the task priority, one of GF_TASK_PRIORITY_*
+ *\param run the task callback
+ *\param par user data passed to the task callback
+ *\return error if any
+ */
+GF_Err gf_task_pool_submit(GF_TaskPool *pool, GF_TaskGroup *group, u32 priority, gf_task_run run, void *par);
+/*!
+ *\brief parallel loop
+ *
+ *Splits the range [start, end[ in sub-ranges of grain indexes and runs them on the pool. The calling thread takes part in the processing
+ *and the function returns once the whole range has been processed.
+ *\param pool the task pool object
+ *\param start first index of the loop
+ *\param end index after the last index of the loop
+ *\param grain number of indexes per task. If 0, the range is split in 4 tasks per worker.
+ *\param run the range callback
+ *\param par user data passed to the range callback
+ *\return the first error returned by the range callback, or GF_OK
+ */
+GF_Err gf_task_pool_parallel_for(GF_TaskPool *pool, u32 start, u32 end, u32 grain, gf_task_range_run run, void *par);
+
+/*!
+ *\brief task group constructor
+ *
+ *\param pool the task pool object tasks of this group are submitted to
+ *\return the task group object
+ */
+GF_TaskGroup *gf_task_group_new(GF_TaskPool *pool);
+/*!
+ *\brief task group destructor
+ *
+ *Waits for all tasks of the group and destroys it.
+ *\param group the task group object
+ */
+void gf_task_group_del(GF_TaskGroup *group);
+/*!
+ *\brief task group wait
+ *
+ *Waits for completion of all tasks of the group submitted so far. While waiting, the calling thread runs queued tasks of the pool.
+ *The group can be reused once this function returns.
+ *\param group the task group object
+ *\return the first error returned by a task of the group since the last wait, or GF_OK
+ */
+GF_Err gf_task_group_wait(GF_TaskGroup *group);
+
 /*! @} */
 
 #ifdef __cplusplus
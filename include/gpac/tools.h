@@ -397,6 +397,33 @@ typedef void (*gf_log_cbk)(void *cbck, u32 log_level, u32 log_tool, const char*
 */
 gf_log_cbk gf_log_set_callback(void *usr_cbk, gf_log_cbk cbk);
 
+/*!
+ *	\brief Asynchronous logging
+ *
+ *	Enables or disables asynchronous logging. When enabled, log messages are formatted by the calling thread into a lock-free
+ *	queue and passed to the log callback by a dedicated thread, so that logging does not block on I/O in processing threads.
+ *	Messages are dropped when the queue is full. Disabling asynchronous logging flushes all pending messages.
+ *	\param enable if set, enables asynchronous logging, otherwise the log callback is called by the logging thread.
+ *	\return error if any
+ *	\note This should not be changed while other threads are logging. Asynchronous logging is disabled when closing the library.
+*/
+GF_Err gf_log_set_async(Bool enable);
+/*!
+ *	\brief Asynchronous logging drops
+ *
+ *	\return the number of messages dropped because the asynchronous log queue was full
+*/
+u32 gf_log_get_async_dropped();
+/*!
+ *	\brief Log record info
+ *
+ *	Gets the time and thread of the message being logged, to be called from a log callback. In asynchronous mode, these are
+ *	the time and thread at which the message was emitted, otherwise the current time and thread.
+ *	\param time_ms set to the system clock (as returned by \ref gf_sys_clock) of the message - optional
+ *	\param thread_id set to the ID of the emitting thread - optional
+*/
+void gf_log_get_record_info(u32 *time_ms, u32 *thread_id);
+
 
 /*!
  \cond DUMMY_DOXY_SECTION
@@ -651,6 +678,14 @@ void gf_sys_close();
  */
 u32 gf_sys_clock();
 
+/*!
+ *	\brief High resolution system clock query
+ *
+ *	Gets the system clock time with microsecond resolution.
+ *	\return System clock value since initialization in microseconds.
+ */
+u64 gf_sys_clock_high_res();
+
 /*!
  *	\brief Sleeps thread/process
  *
@@ -730,6 +765,10 @@ typedef struct
 	u64 physical_memory_avail;
 	/*!total memory currently allocated by gpac*/
 	u64 gpac_memory;
+	/*!number of contended mutex locks since startup*/
+	u32 lock_contentions;
+	/*!total time spent by threads waiting for mutexes since startup*/
+	u32 lock_wait_time;
 } GF_SystemRTInfo;
 
 /*!
@@ -761,9 +800,121 @@ enum
  */
 Bool gf_sys_get_rti(u32 refresh_time_ms, GF_SystemRTInfo *rti, u32 flags);
 
+/*!
+ * Subsystems for memory accounting
+ *	\hideinitializer
+ */
+enum
+{
+	/*!allocations not attributed to any other subsystem*/
+	GF_MEM_TAG_OTHER = 0,
+	/*!core tools (utils)*/
+	GF_MEM_TAG_CORE,
+	/*!ISO base media file format*/
+	GF_MEM_TAG_ISOM,
+	/*!MPEG-2 TS demuxer and muxer*/
+	GF_MEM_TAG_MPEGTS,
+	/*!DASH client and segmenter*/
+	GF_MEM_TAG_DASH,
+	/*!other media tools (import, export, parsers)*/
+	GF_MEM_TAG_MEDIA,
+	/*!scene graph, scene manager and scene codecs*/
+	GF_MEM_TAG_SCENE,
+	/*!compositor*/
+	GF_MEM_TAG_COMPOSITOR,
+	/*!terminal*/
+	GF_MEM_TAG_TERMINAL,
+	/*!network protocols (RTP, RTSP, SDP)*/
+	GF_MEM_TAG_NETWORK,
+	/*!GPAC modules*/
+	GF_MEM_TAG_MODULES,
+	/*!number of subsystems*/
+	GF_MEM_TAG_MAX
+};
+
+/*!
+ *\brief Memory accounting info
+ *
+ *The Memory accounting info structure holds the allocation counters of one subsystem.
+ */
+typedef struct
+{
+	/*!name of the subsystem*/
+	const char *name;
+	/*!amount of memory currently allocated*/
+	u32 bytes_live;
+	/*!maximum amount of memory allocated at once*/
+	u32 bytes_peak;
+	/*!number of blocks currently allocated*/
+	u32 nb_blocks;
+	/*!total number of allocations*/
+	u32 nb_allocs;
+	/*!allocations per second since the previous query of this subsystem*/
+	u32 allocs_per_sec;
+} GF_MemoryTagInfo;
+
+/*!
+ *\brief Gets memory accounting info
+ *
+ *Gets the allocation counters of a subsystem. Counters are only maintained when GPAC is built with GPAC_MEMORY_ACCOUNTING (configure --account-memory).
+ *\param tag the subsystem to query, one of GF_MEM_TAG_*
+ *\param info holder to the accounting info structure to update
+ *\return 1 if info has been updated, 0 otherwise.
+ */
+Bool gf_sys_get_memory_tag_info(u32 tag, GF_MemoryTagInfo *info);
+/*!
+ *\brief Dumps memory accounting info
+ *
+ *Writes the allocation counters of all subsystems as a text table.
+ *\param out the output file
+ */
+void gf_sys_dump_memory_tags(FILE *out);
+
 
 Bool gf_sys_get_battery_state(Bool *onBattery, u32 *onCharge, u32 *level, u32 *batteryLifeTime, u32 *batteryFullLifeTime);
 
+/*!
+ *	\brief Trace recorder enabling
+ *
+ *	Enables or disables recording of trace events. Events are stored in a fixed-size ring per thread, oldest events
+ *	being overwritten. Recording an event does not lock nor allocate once the ring of the calling thread is created.
+ *	Disabling the recorder returns once the events being recorded by other threads are written. Recorded events are
+ *	released by \ref gf_sys_close, which must not be called while other threads still record events.
+ *	\param enable if set, events are recorded. Disabling the recorder keeps the recorded events.
+ */
+void gf_trace_enable(Bool enable);
+/*!
+ *	\brief Trace recorder state
+ *
+ *	\return 1 if trace events are being recorded, 0 otherwise.
+ */
+Bool gf_trace_enabled();
+/*!
+ *	\brief Trace event begin
+ *
+ *	Records the beginning of a traced section for the calling thread. Does nothing if the recorder is not enabled.
+ *	\param cat category of the event (static string)
+ *	\param name name of the event (static string)
+ */
+void gf_trace_begin(const char *cat, const char *name);
+/*!
+ *	\brief Trace event end
+ *
+ *	Records the end of the last section opened with \ref gf_trace_begin by the calling thread.
+ *	\param cat category of the event (static string)
+ *	\param name name of the event (static string)
+ */
+void gf_trace_end(const char *cat, const char *name);
+/*!
+ *	\brief Trace dump
+ *
+ *	Writes all recorded events in the Chrome trace event JSON format (chrome://tracing, Perfetto). The recorder may be
+ *	enabled, events overwritten while dumping are dropped.
+ *	\param filename name of the output file
+ *	\return error if any
+ */
+GF_Err gf_trace_dump(const char *filename);
+
 typedef struct _GF_GlobalLock_opaque GF_GlobalLock;
 
 /*!
@@ -826,6 +977,14 @@ void gf_sha1_finish(GF_SHA1Context *ctx, u8 digest[20] );
  */
 int gf_sha1_file(const char *filename, u8 digest[20]);
 
+/*
+ * Computes the SHA-1 of each chunk_size bytes of the file (the last chunk may be smaller) using nb_threads threads.
+ * chunk_digests is allocated by the function and holds nb_chunks 20-byte digests, to be freed by the caller.
+ * If tree_digest is not NULL, it is set to the SHA-1 of the concatenated chunk digests.
+ * Chunk digests allow verifying or resuming the verification of large files chunk by chunk.
+ */
+GF_Err gf_sha1_file_chunks(const char *filename, u64 chunk_size, u32 nb_threads, u8 **chunk_digests, u32 *nb_chunks, u8 tree_digest[20]);
+
 /*
  * Output SHA-1(buf)
  */
@@ -78,6 +78,8 @@ typedef struct _xml_node
 	char *ns;	/*namespace*/
 	GF_List *attributes;
 	GF_List *content;
+	/*set if the node, its strings and attributes are allocated in the DOM parser arena*/
+	Bool in_arena;
 } GF_XMLNode;
 
 
@@ -145,9 +147,16 @@ u32 gf_xml_dom_get_line(GF_DOMParser *parser);
 char *gf_xml_dom_serialize(GF_XMLNode *node, Bool content_only);
 
 
+/*detaches the root node from the parser, NULL in arena mode*/
 GF_XMLNode *gf_xml_dom_detach_root(GF_DOMParser *parser);
 void gf_xml_dom_node_del(GF_XMLNode *node);
 
+/*enables arena mode for the next parse: all nodes, attributes and strings of the document are allocated from
+a bump allocator owned by the parser and released at once when the parser is reset or destroyed. In this mode,
+nodes are only valid during the parser lifetime and the root cannot be detached. gf_xml_dom_node_del may still be
+called to remove nodes from the tree*/
+void gf_xml_dom_use_arena(GF_DOMParser *parser, Bool use_arena);
+
 /*! @} */
 
 #ifdef __cplusplus
@@ -327,6 +327,7 @@ void gf_bifs_encoder_del(GF_BifsEncoder *codec)
 	}
 	gf_list_del(codec->streamInfo);
 	gf_list_del(codec->encoded_nodes);
+	gf_bifs_enc_rap_cache_del(codec);
 //	gf_mx_del(codec->mx);
 	gf_free(codec);
 }
@@ -755,7 +755,9 @@ GF_Err BE_SceneReplaceEx(GF_BifsEncoder *codec, GF_Command *com, GF_BitStream *b
 	}
 
 	/*NULL root is valid for ProtoLibraries*/
+	gf_bifs_enc_rap_cache_start(codec);
 	e = gf_bifs_enc_node(codec, com->node, NDT_SFTopNode, bs);
+	gf_bifs_enc_rap_cache_stop(codec);
 	if (e || !gf_list_count(routes) ) {
 		GF_BIFS_WRITE_INT(codec, bs, 0, 1, "hasRoute", NULL);
 		return codec->LastError = e;
@@ -802,7 +804,9 @@ GF_Err BE_SceneReplace(GF_BifsEncoder *codec, GF_SceneGraph *graph, GF_BitStream
 	if (e) goto exit;
 
 	/*NULL root is valid for ProtoLibraries*/
+	gf_bifs_enc_rap_cache_start(codec);
 	e = gf_bifs_enc_node(codec, graph ? graph->RootNode : NULL, NDT_SFTopNode, bs);
+	gf_bifs_enc_rap_cache_stop(codec);
 	if (e || !graph || !gf_list_count(graph->Routes) ) {
 		GF_BIFS_WRITE_INT(codec, bs, 0, 1, "hasRoute", NULL);
 		return codec->LastError = e;
@@ -32,6 +32,8 @@
 
 #ifndef GPAC_DISABLE_BIFS_ENC
 
+static void rap_cache_discard_records(GF_BifsEncoder *codec);
+
 GF_Err gf_bifs_field_index_by_mode(GF_Node *node, u32 all_ind, u8 indexMode, u32 *outField)
 {
 	GF_Err e;
@@ -177,9 +179,14 @@ GF_Err gf_bifs_enc_sf_field(GF_BifsEncoder *codec, GF_BitStream *bs, GF_Node *no
 		cb->bufferSize = 0;
 		if (gf_list_count(cb->commandList)) {
 			u32 i, nbBits;
+			Bool rap_cache_on = codec->rap_cache_on;
 			GF_BitStream *bs_cond = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CODING, ("[BIFS] /*SFCommandBuffer*/\n" ));
+			/*commands have their own encoding context, don't cache them nor the subtrees holding them*/
+			if (rap_cache_on) rap_cache_discard_records(codec);
+			codec->rap_cache_on = 0;
 			e = gf_bifs_enc_commands(codec, cb->commandList, bs_cond);
+			codec->rap_cache_on = rap_cache_on;
 			if (!e) gf_bs_get_content(bs_cond, (char**)&cb->buffer, &cb->bufferSize);
 			gf_bs_del(bs_cond);
 			if (e) return e;
@@ -522,10 +529,253 @@ exit:
 	return e;
 }
 
+/*RAP cache: the encoded bits of node subtrees are kept across scene replace encodings, so that a carousel only
+re-encodes the subtrees modified since the last RAP. A subtree's bits only depend on the node fields, the DEF/USE
+context and the quantization state, hence an entry records the DEF'd nodes it introduces and the nodes it USEs from
+outside, and is only created and reused when no quantization is active*/
+
+/*max nesting of cached subtrees - each level holds a copy of its children bits*/
+#define RAP_CACHE_MAX_DEPTH		6
+/*subtrees smaller than this are cheaper to re-encode than to cache*/
+#define RAP_CACHE_MIN_BITS		64
+
+typedef struct _rap_cache_entry
+{
+	struct _rap_cache_entry *next;
+	GF_Node *node;
+	u32 NDT_Tag;
+	BIFSStreamInfo *info;
+	Bool use_names;
+	char *data;
+	u32 nb_bits;
+	/*DEF'd nodes encoded in the subtree, and nodes from outside the subtree encoded as USE*/
+	GF_Node **defs, **uses;
+	u32 nb_defs, nb_uses;
+} RAPCacheEntry;
+
+typedef struct _rap_cache_rec
+{
+	struct _rap_cache_rec *parent;
+	u32 start_count;
+	GF_List *uses;
+	Bool discard;
+} RAPCacheRecord;
+
+struct _bifs_rap_cache
+{
+	RAPCacheEntry **buckets;
+	u32 nb_buckets, nb_entries;
+	/*subtrees being recorded, innermost first*/
+	RAPCacheRecord *rec;
+	u32 depth;
+	u32 nb_hits, nb_miss;
+	/*index of the encoded_nodes list while encoding the scene replace, to avoid linear DEF/USE lookups*/
+	GF_Node **enc_nodes;
+	u32 *enc_idx;
+	u32 enc_alloc, nb_enc;
+	Bool enc_indexed;
+};
+
+static u32 rap_cache_hash(GF_Node *node, u32 nb_buckets)
+{
+	u32 h = (u32) ((PTR_TO_U_CAST node) >> 4);
+	h *= 2654435761U;
+	return (h >> 8) & (nb_buckets - 1);
+}
+
+static void rap_cache_entry_del(RAPCacheEntry *ent)
+{
+	if (ent->data) gf_free(ent->data);
+	if (ent->defs) gf_free(ent->defs);
+	if (ent->uses) gf_free(ent->uses);
+	gf_free(ent);
+}
+
+static RAPCacheEntry *rap_cache_find(GF_BIFSRAPCache *cache, GF_Node *node)
+{
+	RAPCacheEntry *ent = cache->buckets[rap_cache_hash(node, cache->nb_buckets)];
+	while (ent) {
+		if (ent->node==node) return ent;
+		ent = ent->next;
+	}
+	return NULL;
+}
+
+static Bool rap_cache_remove(GF_BIFSRAPCache *cache, GF_Node *node)
+{
+	RAPCacheEntry *ent, *prev;
+	u32 idx = rap_cache_hash(node, cache->nb_buckets);
+	prev = NULL;
+	ent = cache->buckets[idx];
+	while (ent) {
+		if (ent->node==node) {
+			if (prev) prev->next = ent->next;
+			else cache->buckets[idx] = ent->next;
+			rap_cache_entry_del(ent);
+			cache->nb_entries--;
+			return 1;
+		}
+		prev = ent;
+		ent = ent->next;
+	}
+	return 0;
+}
+
+static void rap_cache_add(GF_BIFSRAPCache *cache, RAPCacheEntry *ent)
+{
+	u32 idx;
+	if (cache->nb_entries >= 2*cache->nb_buckets) {
+		u32 i, nb_buckets = 2*cache->nb_buckets;
+		RAPCacheEntry **buckets = (RAPCacheEntry **)gf_malloc(sizeof(RAPCacheEntry *) * nb_buckets);
+		if (buckets) {
+			memset(buckets, 0, sizeof(RAPCacheEntry *) * nb_buckets);
+			for (i=0; i<cache->nb_buckets; i++) {
+				RAPCacheEntry *an_ent = cache->buckets[i];
+				while (an_ent) {
+					RAPCacheEntry *next = an_ent->next;
+					idx = rap_cache_hash(an_ent->node, nb_buckets);
+					an_ent->next = buckets[idx];
+					buckets[idx] = an_ent;
+					an_ent = next;
+				}
+			}
+			gf_free(cache->buckets);
+			cache->buckets = buckets;
+			cache->nb_buckets = nb_buckets;
+		}
+	}
+	idx = rap_cache_hash(ent->node, cache->nb_buckets);
+	ent->next = cache->buckets[idx];
+	cache->buckets[idx] = ent;
+	cache->nb_entries++;
+}
+
+static void rap_cache_reset(GF_BIFSRAPCache *cache)
+{
+	u32 i;
+	for (i=0; i<cache->nb_buckets; i++) {
+		while (cache->buckets[i]) {
+			RAPCacheEntry *ent = cache->buckets[i];
+			cache->buckets[i] = ent->next;
+			rap_cache_entry_del(ent);
+		}
+	}
+	cache->nb_entries = 0;
+}
+
+static s32 rap_cache_encoded_index(GF_BifsEncoder *codec, GF_Node *node)
+{
+	u32 h;
+	GF_BIFSRAPCache *cache = codec->rap_cache;
+	if (!cache->enc_indexed) return gf_list_find(codec->encoded_nodes, node);
+	if (!cache->nb_enc) return -1;
+	h = rap_cache_hash(node, cache->enc_alloc);
+	while (cache->enc_nodes[h]) {
+		if (cache->enc_nodes[h]==node) return (s32) cache->enc_idx[h];
+		h = (h+1) & (cache->enc_alloc-1);
+	}
+	return -1;
+}
+
+static void rap_cache_index_node(GF_BIFSRAPCache *cache, GF_Node *node, u32 idx)
+{
+	u32 h;
+	if (2*(cache->nb_enc+1) > cache->enc_alloc) {
+		u32 i, old_alloc = cache->enc_alloc;
+		GF_Node **old_nodes = cache->enc_nodes;
+		u32 *old_idx = cache->enc_idx;
+		cache->enc_alloc = old_alloc ? 2*old_alloc : 256;
+		cache->enc_nodes = (GF_Node **)gf_malloc(sizeof(GF_Node *) * cache->enc_alloc);
+		cache->enc_idx = (u32 *)gf_malloc(sizeof(u32) * cache->enc_alloc);
+		if (!cache->enc_nodes || !cache->enc_idx) {
+			if (cache->enc_nodes) gf_free(cache->enc_nodes);
+			if (cache->enc_idx) gf_free(cache->enc_idx);
+			cache->enc_nodes = old_nodes;
+			cache->enc_idx = old_idx;
+			cache->enc_alloc = old_alloc;
+			cache->enc_indexed = 0;
+			return;
+		}
+		memset(cache->enc_nodes, 0, sizeof(GF_Node *) * cache->enc_alloc);
+		cache->nb_enc = 0;
+		for (i=0; i<old_alloc; i++) {
+			if (old_nodes[i]) rap_cache_index_node(cache, old_nodes[i], old_idx[i]);
+		}
+		if (old_nodes) gf_free(old_nodes);
+		if (old_idx) gf_free(old_idx);
+	}
+	h = rap_cache_hash(node, cache->enc_alloc);
+	while (cache->enc_nodes[h]) h = (h+1) & (cache->enc_alloc-1);
+	cache->enc_nodes[h] = node;
+	cache->enc_idx[h] = idx;
+	cache->nb_enc++;
+}
+
+static void rap_cache_add_encoded(GF_BifsEncoder *codec, GF_Node *node)
+{
+	gf_list_add(codec->encoded_nodes, node);
+	if (codec->rap_cache->enc_indexed)
+		rap_cache_index_node(codec->rap_cache, node, gf_list_count(codec->encoded_nodes) - 1);
+}
+
+void gf_bifs_enc_rap_cache_start(GF_BifsEncoder *codec)
+{
+	u32 i, count;
+	GF_BIFSRAPCache *cache = codec->rap_cache;
+	if (!cache) return;
+	codec->rap_cache_on = 1;
+	cache->enc_indexed = 1;
+	cache->nb_enc = 0;
+	if (cache->enc_alloc) memset(cache->enc_nodes, 0, sizeof(GF_Node *) * cache->enc_alloc);
+	/*nodes already DEF'd by the proto list*/
+	count = gf_list_count(codec->encoded_nodes);
+	for (i=0; i<count; i++) {
+		rap_cache_index_node(cache, (GF_Node *)gf_list_get(codec->encoded_nodes, i), i);
+	}
+}
+
+void gf_bifs_enc_rap_cache_stop(GF_BifsEncoder *codec)
+{
+	codec->rap_cache_on = 0;
+	if (codec->rap_cache) codec->rap_cache->enc_indexed = 0;
+}
+
+/*a node encoded as USE inside the subtrees being recorded is an external dependency of all subtrees started after its DEF*/
+static void rap_cache_record_use(GF_BIFSRAPCache *cache, GF_Node *node, u32 def_idx)
+{
+	RAPCacheRecord *rec = cache->rec;
+	while (rec) {
+		if (def_idx >= rec->start_count) break;
+		if (!rec->uses) rec->uses = gf_list_new();
+		gf_list_add(rec->uses, node);
+		rec = rec->parent;
+	}
+}
+
+static void rap_cache_discard_records(GF_BifsEncoder *codec)
+{
+	RAPCacheRecord *rec = codec->rap_cache->rec;
+	while (rec) {
+		rec->discard = 1;
+		rec = rec->parent;
+	}
+	/*command buffers may reset the DEF/USE context*/
+	codec->rap_cache->enc_indexed = 0;
+}
+
 Bool BE_NodeIsUSE(GF_BifsEncoder * codec, GF_Node *node)
 {
 	u32 i, count;
 	if (!node || !gf_node_get_id(node) ) return 0;
+	if (codec->rap_cache_on) {
+		s32 idx = rap_cache_encoded_index(codec, node);
+		if (idx>=0) {
+			if (codec->rap_cache->rec) rap_cache_record_use(codec->rap_cache, node, (u32) idx);
+			return 1;
+		}
+		rap_cache_add_encoded(codec, node);
+		return 0;
+	}
 	count = gf_list_count(codec->encoded_nodes);
 	for (i=0; i<count; i++) {
 		if (gf_list_get(codec->encoded_nodes, i) == node) return 1;
@@ -534,7 +784,7 @@ Bool BE_NodeIsUSE(GF_BifsEncoder * codec, GF_Node *node)
 	return 0;
 }
 
-GF_Err gf_bifs_enc_node(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
+static GF_Err BE_EncNode(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
 {
 	u32 NDTBits, node_type, node_tag, BVersion, node_id;
 	const char *node_name;
@@ -636,5 +886,186 @@ GF_Err gf_bifs_enc_node(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_B
 	return GF_OK;
 }
 
+static void rap_cache_write_bits(GF_BitStream *bs, char *data, u32 nb_bits)
+{
+	u32 nb_bytes = nb_bits / 8;
+	if (nb_bytes) gf_bs_write_data(bs, data, nb_bytes);
+	nb_bits %= 8;
+	if (nb_bits) gf_bs_write_int(bs, ((u8) data[nb_bytes]) >> (8 - nb_bits), nb_bits);
+}
+
+static Bool rap_cache_entry_valid(GF_BifsEncoder *codec, RAPCacheEntry *ent, GF_Node *node, u32 NDT_Tag)
+{
+	u32 i;
+	if ((ent->NDT_Tag != NDT_Tag) || (ent->info != codec->info) || (ent->use_names != codec->UseName)) return 0;
+	/*DEF'd nodes of the subtree must not have been encoded yet, otherwise they would now be coded as USE*/
+	for (i=0; i<ent->nb_defs; i++) {
+		if (rap_cache_encoded_index(codec, ent->defs[i]) >= 0) return 0;
+	}
+	/*and all USEs must still point to nodes already encoded*/
+	for (i=0; i<ent->nb_uses; i++) {
+		if (rap_cache_encoded_index(codec, ent->uses[i]) < 0) return 0;
+	}
+	return 1;
+}
+
+static GF_Err BE_EncNodeCached(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
+{
+	u32 i, nb_qps, nb_bits, size;
+	char *data;
+	GF_Err e;
+	GF_BitStream *sub_bs;
+	RAPCacheEntry *ent;
+	RAPCacheRecord rec;
+	GF_BIFSRAPCache *cache = codec->rap_cache;
+
+	/*cached bits are only valid without quantization*/
+	if (!node || codec->ActiveQP || codec->coord_stored || codec->storing_coord)
+		return BE_EncNode(codec, node, NDT_Tag, bs);
+
+	/*USE of an already encoded node - only DEF'd nodes are in the encoded list*/
+	if (rap_cache_encoded_index(codec, node) >= 0)
+		return BE_EncNode(codec, node, NDT_Tag, bs);
+
+	ent = rap_cache_find(cache, node);
+	if (ent) {
+		if (rap_cache_entry_valid(codec, ent, node, NDT_Tag)) {
+			rap_cache_write_bits(bs, ent->data, ent->nb_bits);
+			for (i=0; i<ent->nb_defs; i++) rap_cache_add_encoded(codec, ent->defs[i]);
+			if (cache->rec) {
+				for (i=0; i<ent->nb_uses; i++) {
+					rap_cache_record_use(cache, ent->uses[i], (u32) rap_cache_encoded_index(codec, ent->uses[i]));
+				}
+			}
+			cache->nb_hits++;
+			return GF_OK;
+		}
+		rap_cache_remove(cache, node);
+	}
+	if (cache->depth >= RAP_CACHE_MAX_DEPTH)
+		return BE_EncNode(codec, node, NDT_Tag, bs);
+
+	cache->nb_miss++;
+	nb_qps = gf_list_count(codec->QPs);
+	rec.parent = cache->rec;
+	rec.start_count = gf_list_count(codec->encoded_nodes);
+	rec.uses = NULL;
+	rec.discard = 0;
+	cache->rec = &rec;
+	cache->depth++;
+
+	sub_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	e = BE_EncNode(codec, node, NDT_Tag, sub_bs);
+
+	cache->depth--;
+	cache->rec = rec.parent;
+
+	nb_bits = gf_bs_get_bit_offset(sub_bs);
+	gf_bs_align(sub_bs);
+	data = NULL;
+	size = 0;
+	gf_bs_get_content(sub_bs, &data, &size);
+	gf_bs_del(sub_bs);
+
+	/*on error, still output what was encoded as done without cache*/
+	if (nb_bits) rap_cache_write_bits(bs, data, nb_bits);
+
+	/*quantization state changed by the subtree (global QP), don't cache*/
+	if (e || rec.discard || codec->ActiveQP || codec->coord_stored || codec->storing_coord || (nb_qps != gf_list_count(codec->QPs)) || (nb_bits < RAP_CACHE_MIN_BITS)) {
+		if (data) gf_free(data);
+		if (rec.uses) gf_list_del(rec.uses);
+		return e;
+	}
+
+	GF_SAFEALLOC(ent, RAPCacheEntry);
+	if (!ent) {
+		gf_free(data);
+		if (rec.uses) gf_list_del(rec.uses);
+		return GF_OK;
+	}
+	ent->node = node;
+	ent->NDT_Tag = NDT_Tag;
+	ent->info = codec->info;
+	ent->use_names = codec->UseName;
+	ent->data = data;
+	ent->nb_bits = nb_bits;
+	ent->nb_defs = gf_list_count(codec->encoded_nodes) - rec.start_count;
+	if (ent->nb_defs) {
+		ent->defs = (GF_Node **)gf_malloc(sizeof(GF_Node *) * ent->nb_defs);
+		for (i=0; i<ent->nb_defs; i++) ent->defs[i] = (GF_Node *)gf_list_get(codec->encoded_nodes, rec.start_count + i);
+	}
+	if (rec.uses) {
+		ent->nb_uses = gf_list_count(rec.uses);
+		ent->uses = (GF_Node **)gf_malloc(sizeof(GF_Node *) * ent->nb_uses);
+		for (i=0; i<ent->nb_uses; i++) ent->uses[i] = (GF_Node *)gf_list_get(rec.uses, i);
+		gf_list_del(rec.uses);
+	}
+	rap_cache_add(cache, ent);
+	return GF_OK;
+}
+
+GF_Err gf_bifs_enc_node(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
+{
+	assert(codec->info);
+	/*proto bodies are encoded in their own DEF/USE context*/
+	if (codec->rap_cache_on && !codec->encoding_proto && !codec->current_proto_graph)
+		return BE_EncNodeCached(codec, node, NDT_Tag, bs);
+	return BE_EncNode(codec, node, NDT_Tag, bs);
+}
+
+static void rap_cache_invalidate(GF_BIFSRAPCache *cache, GF_Node *node)
+{
+	u32 i, count;
+	rap_cache_remove(cache, node);
+	/*the subtree bits are part of all parent subtrees*/
+	count = gf_node_get_parent_count(node);
+	for (i=0; i<count; i++) {
+		GF_Node *par = gf_node_get_parent(node, i);
+		if (par) rap_cache_invalidate(cache, par);
+	}
+}
+
+GF_EXPORT
+GF_Err gf_bifs_encoder_enable_rap_cache(GF_BifsEncoder *codec, Bool enable)
+{
+	if (!codec) return GF_BAD_PARAM;
+	if (!enable) {
+		gf_bifs_enc_rap_cache_del(codec);
+		return GF_OK;
+	}
+	if (codec->rap_cache) return GF_OK;
+	GF_SAFEALLOC(codec->rap_cache, GF_BIFSRAPCache);
+	if (!codec->rap_cache) return GF_OUT_OF_MEM;
+	codec->rap_cache->nb_buckets = 256;
+	codec->rap_cache->buckets = (RAPCacheEntry **)gf_malloc(sizeof(RAPCacheEntry *) * codec->rap_cache->nb_buckets);
+	if (!codec->rap_cache->buckets) {
+		gf_free(codec->rap_cache);
+		codec->rap_cache = NULL;
+		return GF_OUT_OF_MEM;
+	}
+	memset(codec->rap_cache->buckets, 0, sizeof(RAPCacheEntry *) * codec->rap_cache->nb_buckets);
+	return GF_OK;
+}
+
+GF_EXPORT
+void gf_bifs_encoder_invalidate_rap_cache(GF_BifsEncoder *codec, GF_Node *node)
+{
+	if (!codec || !codec->rap_cache) return;
+	if (!node) rap_cache_reset(codec->rap_cache);
+	else rap_cache_invalidate(codec->rap_cache, node);
+}
+
+void gf_bifs_enc_rap_cache_del(GF_BifsEncoder *codec)
+{
+	if (!codec->rap_cache) return;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CODING, ("[BIFS] RAP cache: %d subtrees reused - %d encoded\n", codec->rap_cache->nb_hits, codec->rap_cache->nb_miss));
+	rap_cache_reset(codec->rap_cache);
+	gf_free(codec->rap_cache->buckets);
+	if (codec->rap_cache->enc_nodes) gf_free(codec->rap_cache->enc_nodes);
+	if (codec->rap_cache->enc_idx) gf_free(codec->rap_cache->enc_idx);
+	gf_free(codec->rap_cache);
+	codec->rap_cache = NULL;
+}
+
 
 #endif /*GPAC_DISABLE_BIFS_ENC*/
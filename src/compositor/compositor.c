@@ -201,7 +201,9 @@ static void gf_sc_reconfig_task(GF_Compositor *compositor)
 
 Bool gf_sc_draw_frame(GF_Compositor *compositor)
 {
+	gf_trace_begin("compositor", "simulation_tick");
 	gf_sc_simulation_tick(compositor);
+	gf_trace_end("compositor", "simulation_tick");
 	if (compositor->frame_draw_type) return 1;
 	if (compositor->fonts_pending) return 1;
 	return 0;
@@ -444,8 +446,11 @@ static u32 gf_sc_proc(void *par)
 	while (compositor->video_th_state == GF_COMPOSITOR_THREAD_RUN) {
 		if (compositor->is_hidden==1)
 			gf_sleep(compositor->frame_duration);
-		else
+		else {
+			gf_trace_begin("compositor", "simulation_tick");
 			gf_sc_simulation_tick(compositor);
+			gf_trace_end("compositor", "simulation_tick");
+		}
 	}
 	/*destroy video out here if we're using openGL, to avoid threading issues*/
 	compositor->video_out->Shutdown(compositor->video_out);
@@ -1113,6 +1118,10 @@ void gf_sc_reload_config(GF_Compositor *compositor)
 	else if (sOpt && !stricmp(sOpt, "Never")) compositor->texture_text_mode = GF_TEXTURE_TEXT_NEVER;
 	else compositor->texture_text_mode = GF_TEXTURE_TEXT_DEFAULT;
 
+	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "GlyphAtlas");
+	if (!sOpt) gf_cfg_set_key(compositor->user->config, "Compositor", "GlyphAtlas", "no");
+	compositor->glyph_atlas = (sOpt && !stricmp(sOpt, "yes")) ? 1 : 0;
+
 	if (compositor->audio_renderer) {
 		sOpt = gf_cfg_get_key(compositor->user->config, "Audio", "NoResync");
 		compositor->audio_renderer->disable_resync = (sOpt && !stricmp(sOpt, "yes")) ? 1 : 0;
@@ -2189,7 +2198,9 @@ void gf_sc_simulation_tick(GF_Compositor *compositor)
 		} else {
 			compositor->frame_draw_type = 0;
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_COMPOSE, ("[Compositor] Redrawing scene - OTB %d\n", sim_time));
+			gf_trace_begin("compositor", "draw_scene");
 			gf_sc_draw_scene(compositor);
+			gf_trace_end("compositor", "draw_scene");
 #ifndef GPAC_DISABLE_LOG
 			traverse_time = gf_sys_clock() - traverse_time;
 #endif
@@ -2215,7 +2226,9 @@ void gf_sc_simulation_tick(GF_Compositor *compositor)
 			rc.x = rc.y = 0;
 			rc.w = compositor->display_width;
 			rc.h = compositor->display_height;
+			gf_trace_begin("compositor", "flush");
 			compositor->video_out->Flush(compositor->video_out, &rc);
+			gf_trace_end("compositor", "flush");
 		} else {
 			compositor->skip_flush = 0;
 		}
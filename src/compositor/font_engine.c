@@ -41,8 +41,207 @@ struct _gf_ft_mgr
 	u32 id_buffer_size;
 
 	Bool wait_font_load;
+
+	/*rectangle path used to blit glyph atlas cells*/
+	GF_Path *cell_path;
 };
 
+/*glyph atlas page size in pixels*/
+#define GLYPH_ATLAS_PAGE_SIZE	512
+/*max pages per atlas - the atlas is flushed when full*/
+#define GLYPH_ATLAS_MAX_PAGES	4
+/*max atlases (pixel sizes) per font - the least recently used one is discarded*/
+#define GLYPH_ATLAS_MAX_SIZES	4
+/*glyphs outside this pixel size range are drawn as paths*/
+#define GLYPH_ATLAS_MIN_PIXEL_SIZE	4
+#define GLYPH_ATLAS_MAX_PIXEL_SIZE	128
+
+typedef struct
+{
+	GF_TextureHandler txh;
+	GF_SURFACE surface;
+	/*shelf packing state*/
+	u32 shelf_x, shelf_y, shelf_height;
+} GF_GlyphAtlasPage;
+
+typedef struct
+{
+	/*cached glyph, NULL for empty slots*/
+	GF_Glyph *glyph;
+	GF_GlyphAtlasPage *page;
+	/*top-left corner of the cell in the page*/
+	u32 x, y;
+	/*glyph pixel bounds (y-up) at the atlas size*/
+	s32 left, top;
+	u32 width, height;
+} GF_GlyphCell;
+
+typedef struct _glyph_atlas
+{
+	struct _glyph_atlas *next;
+	/*font size in pixels and matching font units to pixels scale*/
+	u32 pixel_size;
+	Fixed scale;
+	GF_List *pages;
+	/*cell lookup table by glyph (open addressing, power of 2 size)*/
+	GF_GlyphCell *cells;
+	u32 cells_size, nb_cells;
+} GF_GlyphAtlas;
+
+/*glyph lookup tables start with this size and grow by 2 when half full*/
+#define GLYPH_HASH_MIN_SIZE	64
+
+static GFINLINE u32 glyph_hash_slot(u32 key, u32 size)
+{
+	key ^= key >> 16;
+	key *= 0x45d9f3b;
+	key ^= key >> 16;
+	return key & (size-1);
+}
+
+static GF_Glyph *font_find_glyph(GF_Font *font, u32 ID)
+{
+	u32 i;
+	if (!font->glyph_hash) return NULL;
+	i = glyph_hash_slot(ID, font->glyph_hash_size);
+	while (font->glyph_hash[i]) {
+		if (font->glyph_hash[i]->ID==ID) return font->glyph_hash[i];
+		i = (i+1) & (font->glyph_hash_size-1);
+	}
+	return NULL;
+}
+
+static void font_hash_glyph(GF_Font *font, GF_Glyph *glyph)
+{
+	u32 i;
+	if (2*(font->nb_hashed_glyphs+1) > font->glyph_hash_size) {
+		u32 j, old_size = font->glyph_hash_size;
+		GF_Glyph **old_hash = font->glyph_hash;
+
+		font->glyph_hash_size = old_size ? 2*old_size : GLYPH_HASH_MIN_SIZE;
+		font->glyph_hash = (GF_Glyph **) gf_malloc(sizeof(GF_Glyph *) * font->glyph_hash_size);
+		memset(font->glyph_hash, 0, sizeof(GF_Glyph *) * font->glyph_hash_size);
+		for (j=0; j<old_size; j++) {
+			if (!old_hash[j]) continue;
+			i = glyph_hash_slot(old_hash[j]->ID, font->glyph_hash_size);
+			while (font->glyph_hash[i]) i = (i+1) & (font->glyph_hash_size-1);
+			font->glyph_hash[i] = old_hash[j];
+		}
+		if (old_hash) gf_free(old_hash);
+	}
+	i = glyph_hash_slot(glyph->ID, font->glyph_hash_size);
+	while (font->glyph_hash[i]) {
+		/*first registered glyph wins, as with linear lookup*/
+		if (font->glyph_hash[i]->ID==glyph->ID) return;
+		i = (i+1) & (font->glyph_hash_size-1);
+	}
+	font->glyph_hash[i] = glyph;
+	font->nb_hashed_glyphs++;
+}
+
+static void font_unhash_glyph(GF_Font *font, GF_Glyph *glyph)
+{
+	u32 i, j, k, mask;
+	if (!font->glyph_hash) return;
+	mask = font->glyph_hash_size-1;
+	i = glyph_hash_slot(glyph->ID, font->glyph_hash_size);
+	while (font->glyph_hash[i] != glyph) {
+		if (!font->glyph_hash[i]) return;
+		i = (i+1) & mask;
+	}
+	font->glyph_hash[i] = NULL;
+	font->nb_hashed_glyphs--;
+
+	/*backward shift: move back entries whose probe sequence crosses the freed slot*/
+	j = i;
+	while (1) {
+		j = (j+1) & mask;
+		if (!font->glyph_hash[j]) break;
+		k = glyph_hash_slot(font->glyph_hash[j]->ID, font->glyph_hash_size);
+		if ((i<=j) ? ((i<k) && (k<=j)) : ((i<k) || (k<=j))) continue;
+		font->glyph_hash[i] = font->glyph_hash[j];
+		font->glyph_hash[j] = NULL;
+		i = j;
+	}
+}
+
+static void glyph_atlas_reset(GF_GlyphAtlas *atlas)
+{
+	while (gf_list_count(atlas->pages)) {
+		GF_GlyphAtlasPage *page = gf_list_last(atlas->pages);
+		GF_Raster2D *raster = page->txh.compositor->rasterizer;
+		gf_list_rem_last(atlas->pages);
+		if (page->surface) raster->surface_delete(page->surface);
+		gf_sc_texture_destroy(&page->txh);
+		if (page->txh.data) gf_free(page->txh.data);
+		gf_free(page);
+	}
+	if (atlas->cells) memset(atlas->cells, 0, sizeof(GF_GlyphCell) * atlas->cells_size);
+	atlas->nb_cells = 0;
+}
+
+static void glyph_atlas_del(GF_GlyphAtlas *atlas)
+{
+	glyph_atlas_reset(atlas);
+	gf_list_del(atlas->pages);
+	if (atlas->cells) gf_free(atlas->cells);
+	gf_free(atlas);
+}
+
+static void font_del_atlases(GF_Font *font)
+{
+	while (font->atlas) {
+		GF_GlyphAtlas *next = font->atlas->next;
+		glyph_atlas_del(font->atlas);
+		font->atlas = next;
+	}
+}
+
+void gf_font_register_glyph(GF_Font *font, GF_Glyph *glyph)
+{
+	glyph->next = NULL;
+	if (!font->glyph) font->glyph = glyph;
+	else font->last_glyph->next = glyph;
+	font->last_glyph = glyph;
+	font_hash_glyph(font, glyph);
+}
+
+void gf_font_unregister_glyph(GF_Font *font, GF_Glyph *glyph)
+{
+	GF_Glyph *prev_glyph, *a_glyph;
+
+	prev_glyph = NULL;
+	a_glyph = font->glyph;
+	while (a_glyph) {
+		if (a_glyph == glyph) break;
+		prev_glyph = a_glyph;
+		a_glyph = a_glyph->next;
+	}
+	if (!a_glyph) return;
+
+	if (prev_glyph) {
+		prev_glyph->next = glyph->next;
+	} else {
+		font->glyph = glyph->next;
+	}
+	if (font->last_glyph == glyph) font->last_glyph = prev_glyph;
+
+	if (font_find_glyph(font, glyph->ID) == glyph) {
+		font_unhash_glyph(font, glyph);
+		/*a glyph with the same ID may have been registered after this one*/
+		a_glyph = font->glyph;
+		while (a_glyph) {
+			if (a_glyph->ID == glyph->ID) {
+				font_hash_glyph(font, a_glyph);
+				break;
+			}
+			a_glyph = a_glyph->next;
+		}
+	}
+	/*atlas cells are keyed by glyph, drop them*/
+	font_del_atlases(font);
+}
+
 
 GF_FontManager *gf_font_manager_new(GF_User *user)
 {
@@ -91,6 +290,7 @@ GF_FontManager *gf_font_manager_new(GF_User *user)
 	gf_path_add_line_to(font_mgr->line_path, FIX_ONE/2, -FIX_ONE/2);
 	gf_path_add_line_to(font_mgr->line_path, -FIX_ONE/2, -FIX_ONE/2);
 	gf_path_close(font_mgr->line_path);
+	font_mgr->cell_path = gf_path_new();
 
 	opt = gf_cfg_get_key(user->config, "FontEngine", "WaitForFontLoad");
 	if (!opt) gf_cfg_set_key(user->config, "FontEngine", "WaitForFontLoad", "no");
@@ -126,6 +326,8 @@ void gf_font_del(GF_Font *font)
 			glyph = next;
 		}
 	}
+	font_del_atlases(font);
+	if (font->glyph_hash) gf_free(font->glyph_hash);
 	gf_free(font->name);
 	gf_free(font);
 }
@@ -147,6 +349,7 @@ void gf_font_manager_del(GF_FontManager *fm)
 	}
 	gf_free(fm->id_buffer);
 	gf_path_del(fm->line_path);
+	gf_path_del(fm->cell_path);
 	gf_free(fm);
 }
 
@@ -329,11 +532,8 @@ GF_Font *gf_font_manager_set_font(GF_FontManager *fm, char **alt_fonts, u32 nb_f
 
 static GF_Glyph *gf_font_get_glyph(GF_FontManager *fm, GF_Font *font, u32 name)
 {
-	GF_Glyph *glyph = font->glyph;
-	while (glyph) {
-		if (glyph->ID==name) return glyph;
-		glyph = glyph->next;
-	}
+	GF_Glyph *glyph = font_find_glyph(font, name);
+	if (glyph) return glyph;
 
 	if (name==GF_CARET_CHAR) {
 		GF_SAFEALLOC(glyph, GF_Glyph);
@@ -369,12 +569,9 @@ static GF_Glyph *gf_font_get_glyph(GF_FontManager *fm, GF_Font *font, u32 name)
 	}
 	if (!glyph) return NULL;
 
-	if (!font->glyph) font->glyph = glyph;
-	else {
-		GF_Glyph *a_glyph = font->glyph;
-		while (a_glyph->next) a_glyph = a_glyph->next;
-		a_glyph->next = glyph;
-	}
+	/*glyphs of embedded font engines are already registered*/
+	if (font_find_glyph(font, glyph->ID) != glyph)
+		gf_font_register_glyph(font, glyph);
 	/*space character - this may need adjustment for other empty glyphs*/
 	if (glyph->path && !glyph->path->n_points) {
 		glyph->path->bbox.x = 0;
@@ -978,12 +1175,246 @@ void gf_font_spans_draw_3d(GF_List *spans, GF_TraverseState *tr_state, DrawAspec
 
 #endif
 
+static GF_GlyphAtlas *font_get_atlas(GF_Font *font, u32 pixel_size)
+{
+	u32 count;
+	GF_GlyphAtlas *atlas, *prev;
+
+	prev = NULL;
+	atlas = font->atlas;
+	while (atlas) {
+		if (atlas->pixel_size == pixel_size) {
+			/*move to front*/
+			if (prev) {
+				prev->next = atlas->next;
+				atlas->next = font->atlas;
+				font->atlas = atlas;
+			}
+			return atlas;
+		}
+		prev = atlas;
+		atlas = atlas->next;
+	}
+
+	GF_SAFEALLOC(atlas, GF_GlyphAtlas);
+	if (!atlas) return NULL;
+	atlas->pixel_size = pixel_size;
+	atlas->scale = gf_divfix(INT2FIX(pixel_size), INT2FIX(font->em_size));
+	atlas->pages = gf_list_new();
+	atlas->next = font->atlas;
+	font->atlas = atlas;
+
+	/*discard least recently used atlases*/
+	count = 1;
+	prev = atlas;
+	while (prev->next) {
+		if (count == GLYPH_ATLAS_MAX_SIZES) {
+			GF_GlyphAtlas *next = prev->next->next;
+			glyph_atlas_del(prev->next);
+			prev->next = next;
+			continue;
+		}
+		count++;
+		prev = prev->next;
+	}
+	return atlas;
+}
+
+static GF_GlyphAtlasPage *glyph_atlas_new_page(GF_Compositor *compositor, GF_GlyphAtlas *atlas)
+{
+	GF_STENCIL stencil;
+	GF_GlyphAtlasPage *page;
+	GF_Raster2D *raster = compositor->rasterizer;
+
+	GF_SAFEALLOC(page, GF_GlyphAtlasPage);
+	if (!page) return NULL;
+	gf_sc_texture_setup(&page->txh, compositor, NULL);
+	gf_sc_texture_allocate(&page->txh);
+	stencil = gf_sc_texture_get_stencil(&page->txh);
+	if (!stencil) stencil = raster->stencil_new(raster, GF_STENCIL_TEXTURE);
+
+	/*same format as span textures: black glyphs, coverage in alpha*/
+	page->txh.width = GLYPH_ATLAS_PAGE_SIZE;
+	page->txh.height = GLYPH_ATLAS_PAGE_SIZE;
+	page->txh.stride = 4*GLYPH_ATLAS_PAGE_SIZE;
+	page->txh.pixelformat = GF_PIXEL_RGBA;
+	page->txh.transparent = 1;
+	page->txh.flags |= GF_SR_TEXTURE_NO_GL_FLIP;
+	page->txh.data = (char *) gf_malloc(sizeof(char)*page->txh.stride*page->txh.height);
+	memset(page->txh.data, 0, sizeof(char)*page->txh.stride*page->txh.height);
+
+	page->surface = raster->surface_new(raster, 1);
+	if (!page->surface) {
+		raster->stencil_delete(stencil);
+		gf_sc_texture_destroy(&page->txh);
+		gf_free(page->txh.data);
+		gf_free(page);
+		return NULL;
+	}
+	raster->stencil_set_texture(stencil, page->txh.data, page->txh.width, page->txh.height, page->txh.stride, page->txh.pixelformat, page->txh.pixelformat, 1);
+	raster->surface_attach_to_texture(page->surface, stencil);
+	raster->surface_set_raster_level(page->surface, GF_RASTER_HIGH_QUALITY);
+	gf_sc_texture_set_stencil(&page->txh, stencil);
+	gf_sc_texture_set_data(&page->txh);
+
+	gf_list_add(atlas->pages, page);
+	return page;
+}
+
+static GF_GlyphCell *glyph_atlas_find_cell(GF_GlyphAtlas *atlas, GF_Glyph *glyph)
+{
+	u32 i;
+	if (!atlas->cells) return NULL;
+	i = glyph_hash_slot((u32) (PTR_TO_U_CAST glyph), atlas->cells_size);
+	while (atlas->cells[i].glyph) {
+		if (atlas->cells[i].glyph == glyph) return &atlas->cells[i];
+		i = (i+1) & (atlas->cells_size-1);
+	}
+	/*free slot for this glyph*/
+	return &atlas->cells[i];
+}
+
+static GF_GlyphCell *glyph_atlas_get_cell(GF_Compositor *compositor, GF_GlyphAtlas *atlas, GF_Glyph *glyph)
+{
+	s32 right, bottom;
+	u32 w, h;
+	GF_Rect rc;
+	GF_Matrix2D mx;
+	GF_STENCIL brush;
+	GF_GlyphCell *cell;
+	GF_GlyphAtlasPage *page;
+	GF_Raster2D *raster = compositor->rasterizer;
+
+	cell = glyph_atlas_find_cell(atlas, glyph);
+	if (cell && cell->glyph) return cell;
+
+	/*pixel bounds of the glyph with one pixel of padding for antialiasing*/
+	gf_path_get_bounds(glyph->path, &rc);
+	rc.x = gf_mulfix(rc.x, atlas->scale);
+	rc.y = gf_mulfix(rc.y, atlas->scale);
+	rc.width = gf_mulfix(rc.width, atlas->scale);
+	rc.height = gf_mulfix(rc.height, atlas->scale);
+	right = FIX2INT( gf_ceil(rc.x + rc.width) ) + 1;
+	bottom = FIX2INT( gf_floor(rc.y - rc.height) ) - 1;
+	rc.x = INT2FIX( FIX2INT( gf_floor(rc.x) ) - 1);
+	rc.y = INT2FIX( FIX2INT( gf_ceil(rc.y) ) + 1);
+	w = right - FIX2INT(rc.x);
+	h = FIX2INT(rc.y) - bottom;
+	if ((w>GLYPH_ATLAS_PAGE_SIZE) || (h>GLYPH_ATLAS_PAGE_SIZE)) return NULL;
+
+	/*find room in the last page, using shelf packing*/
+	page = gf_list_last(atlas->pages);
+	if (page && (page->shelf_x + w > GLYPH_ATLAS_PAGE_SIZE)) {
+		page->shelf_x = 0;
+		page->shelf_y += page->shelf_height;
+		page->shelf_height = 0;
+	}
+	if (!page || (page->shelf_y + h > GLYPH_ATLAS_PAGE_SIZE)) {
+		/*atlas is full, flush it - cells are only used while drawing so this is safe*/
+		if (gf_list_count(atlas->pages) == GLYPH_ATLAS_MAX_PAGES) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_COMPOSE, ("[Font] Glyph atlas for size %d full, flushing\n", atlas->pixel_size));
+			glyph_atlas_reset(atlas);
+		}
+		page = glyph_atlas_new_page(compositor, atlas);
+		if (!page) return NULL;
+	}
+
+	/*grow lookup table when half full*/
+	if (2*(atlas->nb_cells+1) > atlas->cells_size) {
+		u32 i, old_size = atlas->cells_size;
+		GF_GlyphCell *old_cells = atlas->cells;
+		atlas->cells_size = old_size ? 2*old_size : GLYPH_HASH_MIN_SIZE;
+		atlas->cells = (GF_GlyphCell *) gf_malloc(sizeof(GF_GlyphCell) * atlas->cells_size);
+		memset(atlas->cells, 0, sizeof(GF_GlyphCell) * atlas->cells_size);
+		for (i=0; i<old_size; i++) {
+			if (!old_cells[i].glyph) continue;
+			cell = glyph_atlas_find_cell(atlas, old_cells[i].glyph);
+			*cell = old_cells[i];
+		}
+		if (old_cells) gf_free(old_cells);
+	}
+	cell = glyph_atlas_find_cell(atlas, glyph);
+	cell->glyph = glyph;
+	cell->page = page;
+	cell->x = page->shelf_x;
+	cell->y = page->shelf_y;
+	cell->left = FIX2INT(rc.x);
+	cell->top = FIX2INT(rc.y);
+	cell->width = w;
+	cell->height = h;
+	atlas->nb_cells++;
+
+	page->shelf_x += w;
+	if (h > page->shelf_height) page->shelf_height = h;
+
+	/*rasterize the glyph in its cell - the page surface uses centered coordinates*/
+	gf_mx2d_init(mx);
+	gf_mx2d_add_scale(&mx, atlas->scale, atlas->scale);
+	gf_mx2d_add_translation(&mx, INT2FIX((s32) cell->x - cell->left - GLYPH_ATLAS_PAGE_SIZE/2), INT2FIX(GLYPH_ATLAS_PAGE_SIZE/2 - (s32) cell->y - cell->top));
+
+	brush = raster->stencil_new(raster, GF_STENCIL_SOLID);
+	raster->stencil_set_brush_color(brush, 0xFF000000);
+	raster->surface_set_matrix(page->surface, &mx);
+	raster->surface_set_path(page->surface, glyph->path);
+	raster->surface_fill(page->surface, brush);
+	raster->surface_set_path(page->surface, NULL);
+	raster->stencil_delete(brush);
+	gf_sc_texture_set_data(&page->txh);
+	return cell;
+}
+
+/*draws a glyph from the atlas of the current pixel size - returns 0 if the glyph must be drawn as a path*/
+static Bool gf_font_draw_glyph_atlas(GF_TraverseState *tr_state, GF_Font *font, GF_Glyph *glyph, DrawableContext *ctx)
+{
+	u32 pixel_size;
+	Fixed sx, sy;
+	GF_Rect tx_bounds;
+	GF_GlyphAtlas *atlas;
+	GF_GlyphCell *cell;
+	GF_Path *path;
+
+	/*only axis-aligned, uniformly scaled glyphs*/
+	if (ctx->transform.m[1] || ctx->transform.m[3]) return 0;
+	sx = ABS(ctx->transform.m[0]);
+	sy = ABS(ctx->transform.m[4]);
+	if (ABS(sx - sy) > sx/100) return 0;
+	if (!font->em_size) return 0;
+
+	pixel_size = FIX2INT( gf_mulfix(sx, INT2FIX(font->em_size)) + FIX_ONE/2);
+	if ((pixel_size<GLYPH_ATLAS_MIN_PIXEL_SIZE) || (pixel_size>GLYPH_ATLAS_MAX_PIXEL_SIZE)) return 0;
+
+	atlas = font_get_atlas(font, pixel_size);
+	if (!atlas) return 0;
+	cell = glyph_atlas_get_cell(tr_state->visual->compositor, atlas, glyph);
+	if (!cell) return 0;
+
+	/*switch to pixel units for the glyph*/
+	ctx->transform.m[0] = gf_divfix(ctx->transform.m[0], atlas->scale);
+	ctx->transform.m[4] = gf_divfix(ctx->transform.m[4], atlas->scale);
+	/*snap glyph origin to the pixel grid so that cells are blitted 1:1*/
+	ctx->transform.m[2] = gf_floor(ctx->transform.m[2] + FIX_ONE/2);
+	ctx->transform.m[5] = gf_floor(ctx->transform.m[5] + FIX_ONE/2);
+
+	path = font->ft_mgr->cell_path;
+	gf_path_reset(path);
+	gf_path_add_rect(path, INT2FIX(cell->left), INT2FIX(cell->top), INT2FIX(cell->width), INT2FIX(cell->height));
+
+	/*map the whole page so that the cell lands on the glyph rectangle*/
+	tx_bounds.x = INT2FIX(cell->left - (s32) cell->x);
+	tx_bounds.y = INT2FIX(cell->top + (s32) cell->y);
+	tx_bounds.width = tx_bounds.height = INT2FIX(GLYPH_ATLAS_PAGE_SIZE);
+
+	visual_2d_texture_path_text(tr_state->visual, ctx, path, &tx_bounds, &cell->page->txh, tr_state);
+	return 1;
+}
+
 static void gf_font_span_draw_2d(GF_TraverseState *tr_state, GF_TextSpan *span, DrawableContext *ctx, GF_Rect *bounds)
 {
 	u32 flags, i;
 	Bool flip_text;
 	Fixed dx, dy, sx, sy, lscale, bline;
 	Bool needs_texture = (ctx->aspect.fill_texture || ctx->aspect.line_texture) ? 1 : 0;
+	Bool use_atlas = 0;
 	GF_Matrix2D mx, tx;
 
 	gf_mx2d_copy(mx, ctx->transform);
@@ -996,6 +1427,12 @@ static void gf_font_span_draw_2d(GF_TraverseState *tr_state, GF_TextSpan *span,
 
 	flip_text = (ctx->flags & CTX_FLIPED_COORDS) ? tr_state->visual->center_coords : !tr_state->visual->center_coords;
 
+	/*plain filled text can be blitted from glyph atlases*/
+	if (tr_state->visual->compositor->glyph_atlas && !needs_texture && !(ctx->flags & (CTX_PATH_FILLED | CTX_NO_ANTIALIAS))
+	        && GF_COL_A(ctx->aspect.fill_color) && (!ctx->aspect.pen_props.width || (ctx->flags & CTX_PATH_STROKE)) ) {
+		use_atlas = 1;
+	}
+
 	bline = span->font->baseline*span->font_scale;
 	lscale = ctx->aspect.line_scale;
 	ctx->aspect.line_scale = gf_divfix(ctx->aspect.line_scale, span->font_scale);
@@ -1029,7 +1466,11 @@ static void gf_font_span_draw_2d(GF_TraverseState *tr_state, GF_TextSpan *span,
 
 		gf_mx2d_add_matrix(&ctx->transform, &mx);
 
-		if (needs_texture) {
+		if (use_atlas && (span->glyphs[i]->ID!=GF_CARET_CHAR) && span->glyphs[i]->path) {
+			/*nothing to draw for empty glyphs*/
+			if (span->glyphs[i]->path->n_points && !gf_font_draw_glyph_atlas(tr_state, span->font, span->glyphs[i], ctx))
+				visual_2d_draw_path(tr_state->visual, span->glyphs[i]->path, ctx, NULL, NULL, tr_state);
+		} else if (needs_texture) {
 			tx.m[0] = sx;
 			tx.m[4] = sy;
 			tx.m[1] = tx.m[3] = 0;
@@ -295,24 +295,10 @@ void compositor_init_svg_font(GF_Compositor *compositor, GF_Node *node)
 static void svg_traverse_glyph(GF_Node *node, void *rs, Bool is_destroy)
 {
 	if (is_destroy) {
-		GF_Font *font;
-		GF_Glyph *prev_glyph, *a_glyph;
 		SVG_GlyphStack *st = gf_node_get_private(node);
 		if (st->unicode) gf_free(st->unicode);
 
-		font = st->font;
-		prev_glyph = NULL;
-		a_glyph = font->glyph;
-		while (a_glyph) {
-			if (a_glyph == &st->glyph) break;
-			prev_glyph = a_glyph;
-			a_glyph = a_glyph->next;
-		}
-		if (prev_glyph) {
-			prev_glyph->next = st->glyph.next;
-		} else {
-			font->glyph = st->glyph.next;
-		}
+		gf_font_unregister_glyph(st->font, &st->glyph);
 		gf_free(st);
 	}
 }
@@ -323,7 +309,6 @@ void compositor_init_svg_glyph(GF_Compositor *compositor, GF_Node *node)
 	u8 *utf8;
 	u32 len;
 	GF_Rect rc;
-	GF_Glyph *glyph;
 	GF_Font *font;
 	SVG_GlyphStack *st;
 	SVGAllAttributes atts;
@@ -374,13 +359,7 @@ reg_common:
 		st->glyph.vert_advance = font->max_advance_v;
 
 	/*register glyph*/
-	if (!font->glyph) {
-		font->glyph = &st->glyph;
-	} else {
-		glyph = font->glyph;
-		while (glyph->next) glyph = glyph->next;
-		glyph->next = &st->glyph;
-	}
+	gf_font_register_glyph(font, &st->glyph);
 
 	gf_node_set_private(node, st);
 	gf_node_set_callback_function(node, svg_traverse_glyph);
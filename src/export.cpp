@@ -47,8 +47,16 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_rmdir) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cleanup_dir) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sys_clock) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sys_clock_high_res) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sys_get_rti) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sys_get_memory_tag_info) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sys_dump_memory_tags) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sys_get_battery_state) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_trace_enable) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_trace_enabled) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_trace_begin) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_trace_end) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_trace_dump) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_get_default_cache_directory) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_4cc_to_str) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_error_to_string) )
@@ -62,6 +70,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_log_set_tool_level) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_log_set_strict_error) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_log_set_callback) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_log_set_async) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_log_get_async_dropped) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_log_get_record_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_log_get_tools_levels) )
 
 #ifndef GPAC_DISABLE_LOG
@@ -98,6 +109,12 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_mem_strdup) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_memory_print) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_memory_size) )
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+#pragma comment (linker, EXPORT_SYMBOL(gf_mem_acc_malloc) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mem_acc_calloc) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mem_acc_realloc) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mem_acc_free) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mem_acc_strdup) )
 #else
 #pragma comment (linker, EXPORT_SYMBOL(gf_malloc) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_calloc) )
@@ -170,6 +187,15 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_size) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_refreshed_size) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_set_output_buffering) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_flush) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_set_input_buffering) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_ue) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_se) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_write_ue) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_write_se) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_new_chained) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_blocks) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_transfer) )
 
 /* Thread */
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_new) )
@@ -186,11 +212,27 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_mx_v) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mx_p) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mx_try_lock) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mx_get_stats) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mx_get_global_stats) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_lmx_init) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_lmx_lock) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_lmx_unlock) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_lmx_try_lock) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_notify) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_wait) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_wait_for) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_atomic_add) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_atomic_cas) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_pool_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_pool_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_pool_get_thread_count) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_pool_submit) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_pool_parallel_for) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_group_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_group_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_task_group_wait) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_global_resource_lock) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_global_resource_unlock) )
 
@@ -343,6 +385,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_get_line) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_serialize) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_node_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_use_arena) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_parse_string) )
 
 
@@ -888,6 +931,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_setup_track_fragment) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_finalize_for_fragment) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_start_fragment) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_segment_chunk_mode) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_fragment_option) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_fragment_add_sample) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_fragment_append_data) )
@@ -1087,6 +1131,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_media_make_3gpp) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_media_make_psp) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_media_import) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_media_import_tracks) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_media_import_chapters) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_media_change_pl) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_media_avc_rewrite_samples) )
@@ -1121,6 +1166,7 @@
 #endif /*GPAC_DISABLE_MCRYPT*/
 #pragma comment (linker, EXPORT_SYMBOL(gf_sha1_csum) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sha1_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sha1_file_chunks) )
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 #pragma comment (linker, EXPORT_SYMBOL(gf_m4v_parser_new) )
@@ -1170,6 +1216,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_ismacryp_decrypt_file) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_ismacryp_encrypt_track) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_ismacryp_decrypt_track) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_ismacryp_set_threads) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_ismacryp_gpac_get_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_ismacryp_mpeg4ip_get_info) )
 
@@ -1248,6 +1295,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_terminate) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_get_stream_carousel_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_dump_rap_on) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_seng_enable_rap_cache) )
 #endif
 
 /*bifs.h exports*/
@@ -1271,6 +1319,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_get_config) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_get_version) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_get_rap) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_enable_rap_cache) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_invalidate_rap_cache) )
 #endif
 #endif /*GPAC_DISABLE_BIFS*/
 
@@ -1626,6 +1676,14 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_demux_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_process_data) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_reset_parsers) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_demux_seek) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_build) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_save) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_load) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_get_start) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_index_find) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_set_pes_framing) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_get_stream_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_crc32_check) )
@@ -1701,7 +1759,23 @@
 #endif
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_dasher_segment_files) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_set_threads) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dasher_next_update_time) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_live_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_live_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_live_process) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_live_next_update_time) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_live_get_latency) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_live_set_chunk_mode) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_get_info) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_get_segment_count) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_get_segment) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_get_subsegment_count) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_get_subsegment) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_find) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_index_send_range) )
 
 /* dvb_mpe.h */
 #ifdef GPAC_ENST_PRIVATE
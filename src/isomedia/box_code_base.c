@@ -33,6 +33,8 @@ void co64_del(GF_Box *s)
 	ptr = (GF_ChunkLargeOffsetBox *) s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	if (ptr->anchors) gf_free(ptr->anchors);
+	if (ptr->deltas) gf_free(ptr->deltas);
 	gf_free(ptr);
 }
 
@@ -73,7 +75,7 @@ GF_Err co64_Write(GF_Box *s, GF_BitStream *bs)
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
 	for (i = 0; i < ptr->nb_entries; i++ ) {
-		gf_bs_write_u64(bs, ptr->offsets[i]);
+		gf_bs_write_u64(bs, co64_get_entry(ptr, i));
 	}
 	return GF_OK;
 }
@@ -3371,8 +3373,9 @@ GF_Box *mp4a_New()
 
 GF_Box *enca_New()
 {
-	ISOM_DECL_BOX_ALLOC(GF_Box, GF_ISOM_BOX_TYPE_ENCA);
-	return tmp;
+	ISOM_DECL_BOX_ALLOC(GF_MPEGAudioSampleEntryBox, GF_ISOM_BOX_TYPE_ENCA);
+	gf_isom_audio_sample_entry_init((GF_AudioSampleEntryBox*)tmp);
+	return (GF_Box *)tmp;
 }
 
 
@@ -5311,6 +5314,7 @@ void stsz_del(GF_Box *s)
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->sizes) gf_free(ptr->sizes);
+	if (ptr->packed_sizes) gf_free(ptr->packed_sizes);
 	gf_free(ptr);
 }
 
@@ -5430,16 +5434,16 @@ GF_Err stsz_Write(GF_Box *s, GF_BitStream *bs)
 	if (ptr->type == GF_ISOM_BOX_TYPE_STSZ) {
 		if (! ptr->sampleSize) {
 			for (i = 0; i < ptr->sampleCount; i++) {
-				gf_bs_write_u32(bs, ptr->sizes[i]);
+				gf_bs_write_u32(bs, stsz_get_entry(ptr, i));
 			}
 		}
 	} else {
 		for (i = 0; i < ptr->sampleCount; ) {
 			switch (ptr->sampleSize) {
 			case 4:
-				gf_bs_write_int(bs, ptr->sizes[i], 4);
+				gf_bs_write_int(bs, stsz_get_entry(ptr, i), 4);
 				if (i+1 < ptr->sampleCount) {
-					gf_bs_write_int(bs, ptr->sizes[i+1], 4);
+					gf_bs_write_int(bs, stsz_get_entry(ptr, i+1), 4);
 				} else {
 					//0 padding in odd sample count
 					gf_bs_write_int(bs, 0, 4);
@@ -5447,7 +5451,7 @@ GF_Err stsz_Write(GF_Box *s, GF_BitStream *bs)
 				i += 2;
 				break;
 			default:
-				gf_bs_write_int(bs, ptr->sizes[i], ptr->sampleSize);
+				gf_bs_write_int(bs, stsz_get_entry(ptr, i), ptr->sampleSize);
 				i += 1;
 				break;
 			}
@@ -5475,32 +5479,36 @@ GF_Err stsz_Size(GF_Box *s)
 	}
 
 	fieldSize = 4;
-	size = ptr->sizes[0];
+	size = stsz_get_entry(ptr, 0);
 
 	for (i=0; i < ptr->sampleCount; i++) {
-		if (ptr->sizes[i] <= 0xF) continue;
-		//switch to 8-bit table
-		else if (ptr->sizes[i] <= 0xFF) {
-			fieldSize = 8;
+		u32 s_size = stsz_get_entry(ptr, i);
+		//switch to 32-bit table
+		if (s_size > 0xFFFF) {
+			fieldSize = 32;
 		}
 		//switch to 16-bit table
-		else if (ptr->sizes[i] <= 0xFFFF) {
-			fieldSize = 16;
+		else if (s_size > 0xFF) {
+			if (fieldSize < 16) fieldSize = 16;
 		}
-		//switch to 32-bit table
-		else {
-			fieldSize = 32;
+		//switch to 8-bit table
+		else if (s_size > 0xF) {
+			if (fieldSize < 8) fieldSize = 8;
 		}
 
 		//check the size
-		if (size != ptr->sizes[i]) size = 0;
+		if (size != s_size) size = 0;
 	}
 	//if all samples are of the same size, switch to regular (more compact)
 	if (size) {
 		ptr->type = GF_ISOM_BOX_TYPE_STSZ;
 		ptr->sampleSize = size;
-		gf_free(ptr->sizes);
+		if (ptr->sizes) gf_free(ptr->sizes);
 		ptr->sizes = NULL;
+		if (ptr->packed_sizes) gf_free(ptr->packed_sizes);
+		ptr->packed_sizes = NULL;
+		ptr->packed_bits = 0;
+		return GF_OK;
 	}
 
 	if (fieldSize == 32) {
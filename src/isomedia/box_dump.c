@@ -1239,11 +1239,11 @@ GF_Err stsz_dump(GF_Box *a, FILE * trace)
 	gf_full_box_dump(a, trace);
 
 	if ((a->type != GF_ISOM_BOX_TYPE_STSZ) || !p->sampleSize) {
-		if (!p->sizes) {
+		if (!p->sizes && !p->packed_sizes) {
 			fprintf(trace, "<!--WARNING: No Sample Size indications-->\n");
 		} else {
 			for (i=0; i<p->sampleCount; i++) {
-				fprintf(trace, "<SampleSizeEntry Size=\"%d\"/>\n", p->sizes[i]);
+				fprintf(trace, "<SampleSizeEntry Size=\"%d\"/>\n", stsz_get_entry(p, i));
 			}
 		}
 	}
@@ -1366,11 +1366,11 @@ GF_Err co64_dump(GF_Box *a, FILE * trace)
 	DumpBox(a, trace);
 	gf_full_box_dump(a, trace);
 
-	if (!p->offsets) {
+	if (!p->offsets && !p->deltas) {
 		fprintf(trace, "<Warning: No Chunk Offsets indications/>\n");
 	} else {
 		for (i=0; i<p->nb_entries; i++)
-			fprintf(trace, "<ChunkOffsetEntry offset=\""LLD"\"/>\n", LLD_CAST p->offsets[i]);
+			fprintf(trace, "<ChunkOffsetEntry offset=\""LLD"\"/>\n", LLD_CAST co64_get_entry(p, i));
 	}
 	gf_box_dump_done("ChunkLargeOffsetBox", a, trace);
 	return GF_OK;
@@ -31,6 +31,9 @@
 
 static u32 default_write_buffering_size = 0;
 
+/*read cache used for file-based read data maps*/
+#define ISOM_DATA_MAP_READ_CACHE_SIZE	32768
+
 GF_EXPORT
 GF_Err gf_isom_set_output_buffering(GF_ISOFile *movie, u32 size)
 {
@@ -398,7 +401,9 @@ GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode)
 		gf_free(tmp);
 		return NULL;
 	}
-	if (default_write_buffering_size) {
+	if (bs_mode == GF_BITSTREAM_READ) {
+		gf_bs_set_input_buffering(tmp->bs, ISOM_DATA_MAP_READ_CACHE_SIZE);
+	} else if (default_write_buffering_size) {
 		gf_bs_set_output_buffering(tmp->bs, default_write_buffering_size);
 	}
 	return (GF_DataMap *)tmp;
@@ -461,6 +461,9 @@ void gf_isom_delete_movie(GF_ISOFile *mov)
 	gf_isom_box_array_del(mov->TopBoxes);
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 	gf_isom_box_array_del(mov->moof_list);
+#ifndef GPAC_DISABLE_ISOM_WRITE
+	if (mov->chunk_sidx) gf_isom_box_del((GF_Box *) mov->chunk_sidx);
+#endif
 #endif
 
 	if (mov->fileName) gf_free(mov->fileName);
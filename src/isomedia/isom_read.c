@@ -2398,14 +2398,15 @@ GF_Err gf_isom_get_track_layout_info(GF_ISOFile *movie, u32 trackNumber, u32 *wi
 GF_EXPORT
 u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 {
-	u32 i, size;
+	u32 i;
+	u64 size;
 	GF_SampleSizeBox *stsz;
 	GF_TrackBox *tk = gf_isom_get_track_from_file(movie, trackNumber);
 	if (!tk) return 0;
 	stsz = tk->Media->information->sampleTable->SampleSize;
-	if (stsz->sampleSize) return stsz->sampleSize*stsz->sampleCount;
+	if (stsz->sampleSize) return (u64) stsz->sampleSize*stsz->sampleCount;
 	size = 0;
-	for (i=0; i<stsz->sampleCount;i++) size += stsz->sizes[i];
+	for (i=0; i<stsz->sampleCount;i++) size += stsz_get_entry(stsz, i);
 	return size;
 }
 
@@ -118,10 +118,15 @@ void ResetWriters(GF_List *writers)
 			((GF_ChunkOffsetBox *)writer->stco)->nb_entries = 0;
 			((GF_ChunkOffsetBox *)writer->stco)->alloc_size = 0;
 		} else {
-			gf_free(((GF_ChunkLargeOffsetBox *)writer->stco)->offsets);
-			((GF_ChunkLargeOffsetBox *)writer->stco)->offsets = NULL;
-			((GF_ChunkLargeOffsetBox *)writer->stco)->nb_entries = 0;
-			((GF_ChunkLargeOffsetBox *)writer->stco)->alloc_size = 0;
+			GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *)writer->stco;
+			if (co64->offsets) gf_free(co64->offsets);
+			co64->offsets = NULL;
+			if (co64->anchors) gf_free(co64->anchors);
+			co64->anchors = NULL;
+			if (co64->deltas) gf_free(co64->deltas);
+			co64->deltas = NULL;
+			co64->nb_entries = 0;
+			co64->alloc_size = 0;
 		}
 	}
 }
@@ -733,7 +733,8 @@ GF_Err gf_isom_set_sample_rap(GF_ISOFile *movie, u32 trackNumber)
 	trak = gf_isom_get_track_from_file(movie, trackNumber);
 	if (!trak) return GF_BAD_PARAM;
 	stbl = trak->Media->information->sampleTable;
-	if (!stbl->SyncSample) stbl->SyncSample = (GF_SyncSampleBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_STSS);
+	/*no sync sample table: all samples are already sync samples*/
+	if (!stbl->SyncSample) return GF_OK;
 	return stbl_AddRAP(stbl->SyncSample, stbl->SampleSize->sampleCount);
 
 }
@@ -1990,6 +1991,8 @@ GF_Err gf_isom_use_compact_size(GF_ISOFile *movie, u32 trackNumber, u8 Compactio
 		return GF_ISOM_INVALID_FILE;
 
 	stsz = trak->Media->information->sampleTable->SampleSize;
+	e = stsz_unpack(stsz);
+	if (e) return e;
 
 	//switch to regular table
 	if (!CompactionOn) {
@@ -270,7 +270,7 @@ Bool Media_IsSampleSyncShadow(GF_ShadowSyncBox *stsh, u32 sampleNumber)
 	return 0;
 }
 
-GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset)
+static GF_Err Media_FetchSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset)
 {
 	GF_Err e;
 	u32 bytesRead;
@@ -397,6 +397,15 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 	return GF_OK;
 }
 
+GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset)
+{
+	GF_Err e;
+	gf_trace_begin("isomedia", "get_sample");
+	e = Media_FetchSample(mdia, sampleNumber, samp, sIDX, no_data, out_offset);
+	gf_trace_end("isomedia", "get_sample");
+	return e;
+}
+
 
 
 GF_Err Media_CheckDataEntry(GF_MediaBox *mdia, u32 dataEntryIndex)
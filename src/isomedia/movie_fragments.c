@@ -29,6 +29,9 @@
 
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 
+/*block size of the chained bitstreams caching sample data of track runs*/
+#define TRUN_CACHE_BLOCK_SIZE	16384
+
 GF_TrackExtendsBox *GetTrex(GF_MovieBox *moov, u32 TrackID)
 {
 	u32 i;
@@ -684,7 +687,7 @@ GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_offset_dif
 {
 	GF_Err e;
 	u64 moof_start;
-	u32 size, i, s_count, mdat_size;
+	u32 i, s_count, mdat_size;
 	s32 offset;
 	char *buffer;
 	GF_TrackFragmentBox *traf;
@@ -707,10 +710,9 @@ GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_offset_dif
 		//update offset
 		trun->data_offset = (u32) (gf_bs_get_position(bs) - movie->moof->fragment_offset - 8);
 		//write cache
-		gf_bs_get_content(trun->cache, &buffer, &size);
-		gf_bs_write_data(bs, buffer, size);
+		e = gf_bs_transfer(bs, trun->cache);
+		if (e) return e;
 		gf_bs_del(trun->cache);
-		gf_free(buffer);
 		trun->cache = NULL;
 		traf->DataCache=0;
 	}
@@ -848,6 +850,166 @@ static GF_Err sidx_rewrite(GF_SegmentIndexBox *sidx, GF_BitStream *bs, u64 start
 	return e;
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_segment_chunk_mode(GF_ISOFile *movie, Bool enable, u32 referenceTrackID, Bool write_sidx, gf_isom_segment_chunk_callback on_chunk, void *udta)
+{
+	if (!movie) return GF_BAD_PARAM;
+	if (movie->openMode != GF_ISOM_OPEN_WRITE) return GF_ISOM_INVALID_MODE;
+	/*cannot switch mode in the middle of a segment*/
+	if (movie->chunk_segment_open || gf_list_count(movie->moof_list)) return GF_BAD_PARAM;
+	if (write_sidx && !gf_isom_get_track_from_id(movie->moov, referenceTrackID)) return GF_BAD_PARAM;
+
+	movie->chunked_segments = enable;
+	movie->chunk_write_sidx = write_sidx;
+	movie->chunk_ref_track = referenceTrackID;
+	movie->on_chunk = on_chunk;
+	movie->on_chunk_udta = udta;
+	return GF_OK;
+}
+
+static Bool segment_is_chunked(GF_ISOFile *movie)
+{
+	if (!movie->use_segments || !movie->chunked_segments) return 0;
+	/*appended segments are copied at close time, and pre-allocated sidx need all fragments of the segment*/
+	if (movie->append_segment || movie->root_sidx) return 0;
+	return 1;
+}
+
+/*sends data written since the last chunk to the user*/
+static void segment_notify_chunk(GF_ISOFile *movie, u64 start, u64 end, Bool segment_end)
+{
+	char *data;
+	u32 size = (u32) (end - start);
+	GF_BitStream *bs = movie->editFileMap->bs;
+
+	if (!movie->on_chunk) return;
+	if (!size) {
+		movie->on_chunk(movie->on_chunk_udta, NULL, 0, start - movie->segment_start, segment_end);
+		return;
+	}
+	data = gf_malloc(sizeof(char) * size);
+	if (!data) return;
+	gf_bs_seek(bs, start);
+	if (gf_bs_read_data(bs, data, size) == size) {
+		movie->on_chunk(movie->on_chunk_udta, data, size, start - movie->segment_start, segment_end);
+	} else {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[isom] Segment file cannot be read back, chunk not forwarded\n"));
+	}
+	gf_bs_seek(bs, end);
+	gf_free(data);
+}
+
+/*writes styp and blank sidx of a chunked segment, before its first fragment*/
+static GF_Err segment_open_chunked(GF_ISOFile *movie)
+{
+	GF_Err e;
+	GF_BitStream *bs = movie->editFileMap->bs;
+
+	movie->chunk_start = gf_bs_get_position(bs);
+	if (!movie->segment_start) {
+		/*"lmsg" cannot be signaled since the segment is sent before we know whether it is the last one*/
+		gf_isom_modify_alternate_brand(movie, GF_4CC('m','s','i','x'), 1);
+		movie->brand->type = GF_ISOM_BOX_TYPE_STYP;
+		e = gf_isom_box_size((GF_Box *) movie->brand);
+		if (e) return e;
+		e = gf_isom_box_write((GF_Box *) movie->brand, bs);
+		if (e) return e;
+	}
+	if (movie->chunk_write_sidx) {
+		GF_TrackBox *trak = gf_isom_get_track_from_id(movie->moov, movie->chunk_ref_track);
+		if (!trak) return GF_BAD_PARAM;
+		movie->chunk_sidx = (GF_SegmentIndexBox *)gf_isom_box_new(GF_ISOM_BOX_TYPE_SIDX);
+		movie->chunk_sidx->reference_ID = movie->chunk_ref_track;
+		movie->chunk_sidx->timescale = trak->Media->mediaHeader->timeScale;
+		/*we don't know how many fragments the segment will have: the whole segment is a single subsegment*/
+		movie->chunk_sidx->nb_refs = 1;
+		movie->chunk_sidx->refs = gf_malloc(sizeof(GF_SIDXReference));
+		memset(movie->chunk_sidx->refs, 0, sizeof(GF_SIDXReference));
+
+		movie->chunk_sidx_start = gf_bs_get_position(bs);
+		e = gf_isom_box_size((GF_Box *) movie->chunk_sidx);
+		if (e) return e;
+		e = gf_isom_box_write((GF_Box *) movie->chunk_sidx, bs);
+		if (e) return e;
+		movie->chunk_sidx_end = gf_bs_get_position(bs);
+	}
+	movie->chunk_earliest_cts = 0;
+	movie->chunk_duration = 0;
+	movie->chunk_nb_frags = 0;
+	movie->chunk_segment_open = 1;
+	return GF_OK;
+}
+
+/*writes the current fragment of a chunked segment and flushes it*/
+static GF_Err segment_flush_chunk(GF_ISOFile *movie)
+{
+	GF_Err e;
+	u64 end;
+	GF_BitStream *bs = movie->editFileMap->bs;
+
+	e = StoreFragment(movie, 0, 0, NULL);
+	if (e) return e;
+
+	if (movie->chunk_sidx) {
+		GF_SIDXReference *ref = &movie->chunk_sidx->refs[0];
+		if (!movie->chunk_nb_frags)
+			movie->chunk_earliest_cts = moof_get_earliest_cts(movie->moof, movie->chunk_ref_track);
+		if (!ref->SAP_type) {
+			ref->SAP_type = moof_get_sap_info(movie->moof, movie->chunk_ref_track, &ref->SAP_delta_time, &ref->starts_with_SAP);
+			/*SAP in a later chunk, make its delta relative to the start of the segment*/
+			if (ref->SAP_type && movie->chunk_nb_frags) {
+				ref->SAP_delta_time += movie->chunk_duration;
+				ref->starts_with_SAP = 0;
+			}
+		}
+		movie->chunk_duration += moof_get_duration(movie->moof, movie->chunk_ref_track);
+	}
+	movie->chunk_nb_frags++;
+	gf_isom_box_del((GF_Box *) movie->moof);
+	movie->moof = NULL;
+
+	end = gf_bs_get_position(bs);
+	gf_bs_flush(bs);
+	segment_notify_chunk(movie, movie->chunk_start, end, 0);
+	movie->chunk_start = end;
+	return GF_OK;
+}
+
+/*flushes the last fragment of a chunked segment and patches its sidx*/
+static GF_Err segment_close_chunked(GF_ISOFile *movie, u64 ref_track_decode_time, u64 ref_track_next_cts, u64 *index_start_range, u64 *index_end_range)
+{
+	GF_Err e;
+	u64 end;
+	GF_BitStream *bs = movie->editFileMap->bs;
+
+	if (movie->moof) {
+		e = segment_flush_chunk(movie);
+		if (e) return e;
+	}
+	end = gf_bs_get_position(bs);
+	movie->chunk_segment_open = 0;
+	if (!movie->chunk_sidx) {
+		segment_notify_chunk(movie, end, end, 1);
+		return GF_OK;
+	}
+
+	movie->chunk_sidx->earliest_presentation_time = ref_track_decode_time + movie->chunk_earliest_cts;
+	movie->chunk_sidx->refs[0].reference_type = 0;
+	movie->chunk_sidx->refs[0].reference_size = (u32) (end - movie->chunk_sidx_end);
+	movie->chunk_sidx->refs[0].subsegment_duration = (u32) (ref_track_next_cts - movie->chunk_sidx->earliest_presentation_time);
+	e = sidx_rewrite(movie->chunk_sidx, bs, movie->chunk_sidx_start);
+	gf_isom_box_del((GF_Box *) movie->chunk_sidx);
+	movie->chunk_sidx = NULL;
+	if (e) return e;
+
+	gf_bs_flush(bs);
+	segment_notify_chunk(movie, movie->chunk_sidx_start, movie->chunk_sidx_end, 1);
+
+	if (index_start_range) *index_start_range = movie->chunk_sidx_start;
+	if (index_end_range) *index_end_range = movie->chunk_sidx_end;
+	return GF_OK;
+}
+
 GF_Err gf_isom_allocate_sidx(GF_ISOFile *movie, s32 subsegs_per_sidx, Bool daisy_chain_sidx, u32 nb_segs, u32 *frags_per_segment, u32 *start_range, u32 *end_range)
 {
 	GF_BitStream *bs;
@@ -927,6 +1089,10 @@ GF_Err gf_isom_close_segment(GF_ISOFile *movie, s32 subsegments_per_sidx, u32 re
 	count = gf_list_count(movie->moov->mvex->TrackExList);
 	if (!count) return GF_BAD_PARAM;
 
+	/*fragments already written*/
+	if (movie->chunk_segment_open)
+		return segment_close_chunked(movie, ref_track_decode_time, ref_track_next_cts, index_start_range, index_end_range);
+
 	count = gf_list_count(movie->moof_list);
 	if (!count) return GF_OK;
 	/*store fragment*/
@@ -1347,7 +1513,7 @@ GF_Err gf_isom_start_segment(GF_ISOFile *movie, char *SegName)
 	if (!movie || !(movie->FragmentsFlags & GF_ISOM_FRAG_WRITE_READY) ) return GF_BAD_PARAM;
 	if (movie->openMode != GF_ISOM_OPEN_WRITE) return GF_ISOM_INVALID_MODE;
 
-	if (gf_list_count(movie->moof_list))
+	if (gf_list_count(movie->moof_list) || movie->chunk_segment_open)
 		return GF_BAD_PARAM;
 
 	movie->append_segment = 0;
@@ -1388,17 +1554,27 @@ GF_Err gf_isom_start_fragment(GF_ISOFile *movie, Bool moof_first)
 	movie->moof_first = moof_first;
 
 	//store existing fragment
-	if (movie->moof) {
+	if (movie->chunk_segment_open) {
+		if (movie->moof) {
+			e = segment_flush_chunk(movie);
+			if (e) return e;
+		}
+	} else if (movie->moof) {
 		e = StoreFragment(movie, movie->use_segments ? 1 : 0, 0, NULL);
 		if (e) return e;
 	}
+	/*first fragment of a chunked segment*/
+	if (!movie->chunk_segment_open && segment_is_chunked(movie)) {
+		e = segment_open_chunked(movie);
+		if (e) return e;
+	}
 
 	//create new fragment
 	movie->moof = (GF_MovieFragmentBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_MOOF);
 	movie->moof->mfhd = (GF_MovieFragmentHeaderBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_MFHD);
 	movie->moof->mfhd->sequence_number = movie->NextMoofNumber;
 	movie->NextMoofNumber ++;
-	if (movie->use_segments)
+	if (movie->use_segments && !movie->chunk_segment_open)
 		gf_list_add(movie->moof_list, movie->moof);
 
 
@@ -1438,8 +1614,7 @@ u32 GetRunSize(GF_TrackFragmentRunBox *trun)
 GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, GF_ISOSample *sample, u32 DescIndex,
 								 u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundant_coding)
 {
-	u32 count, buffer_size;
-	char *buffer;
+	u32 count;
 	u64 pos;
 	GF_ISOSample *od_sample = NULL;
 	GF_TrunEntry *ent;
@@ -1465,11 +1640,9 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, GF_ISOSample
 			if (count) {
 				trun = (GF_TrackFragmentRunBox *)gf_list_get(traf->TrackRuns, count-1);
 				trun->data_offset = (u32) (pos - movie->moof->fragment_offset - 8);
-				gf_bs_get_content(trun->cache, &buffer, &buffer_size);
-				gf_bs_write_data(movie->editFileMap->bs, buffer, buffer_size);
+				gf_bs_transfer(movie->editFileMap->bs, trun->cache);
 				gf_bs_del(trun->cache);
 				trun->cache = NULL;
-				gf_free(buffer);
 			}
 		}
 		traf_2 = (GF_TrackFragmentBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_TRAF);
@@ -1509,11 +1682,9 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, GF_ISOSample
 		//if data cache is on and we're changing TRUN, store the cache and update data offset
 		if (!count && traf->DataCache) {
 			trun->data_offset = (u32) (pos - movie->moof->fragment_offset - 8);
-			gf_bs_get_content(trun->cache, &buffer, &buffer_size);
-			gf_bs_write_data(movie->editFileMap->bs, buffer, buffer_size);
+			gf_bs_transfer(movie->editFileMap->bs, trun->cache);
 			gf_bs_del(trun->cache);
 			trun->cache = NULL;
-			gf_free(buffer);
 		}
 	}
 
@@ -1526,7 +1697,7 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, GF_ISOSample
 
 		//if we use data caching, create a bitstream
 		if (traf->DataCache)
-			trun->cache = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+			trun->cache = gf_bs_new_chained(TRUN_CACHE_BLOCK_SIZE);
 	}
 
 	GF_SAFEALLOC(ent, GF_TrunEntry);
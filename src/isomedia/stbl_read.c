@@ -120,6 +120,19 @@ entry_found:
 	return GF_OK;
 }
 
+u32 stsz_get_entry(GF_SampleSizeBox *stsz, u32 idx)
+{
+	if (stsz->sizes) return stsz->sizes[idx];
+	if (stsz->packed_bits==8) return ((u8 *)stsz->packed_sizes)[idx];
+	return ((u16 *)stsz->packed_sizes)[idx];
+}
+
+u64 co64_get_entry(GF_ChunkLargeOffsetBox *co64, u32 idx)
+{
+	if (co64->offsets) return co64->offsets[idx];
+	return co64->anchors[idx >> CO64_ANCHOR_SHIFT] + co64->deltas[idx];
+}
+
 //Get the Size of a given sample
 GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 {
@@ -130,7 +143,7 @@ GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 	if (stsz->sampleSize && (stsz->type != GF_ISOM_BOX_TYPE_STZ2)) {
 		(*Size) = stsz->sampleSize;
 	} else {
-		(*Size) = stsz->sizes[SampleNumber - 1];
+		(*Size) = stsz_get_entry(stsz, SampleNumber - 1);
 	}
 	return GF_OK;
 }
@@ -403,7 +416,7 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 			(*offset) = (u64) stco->offsets[sampleNumber - 1];
 		} else {
 			co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
-			(*offset) = co64->offsets[sampleNumber - 1];
+			(*offset) = co64_get_entry(co64, sampleNumber - 1);
 		}
 		return GF_OK;
 	}
@@ -478,7 +491,7 @@ sample_found:
 	} else {
 		co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
 		if (co64->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = co64->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
+		(*offset) = co64_get_entry(co64, (*chunkNumber) - 1) + (u64) offsetInChunk;
 	}
 	return GF_OK;
 }
@@ -33,31 +33,174 @@ gf_realloc low, which greatly impacts performances for large files*/
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 
-GF_ChunkLargeOffsetBox *stco_to_co64(GF_ChunkOffsetBox *stco, u32 alloc_size);
+GF_ChunkLargeOffsetBox *stco_to_co64(GF_ChunkOffsetBox *stco);
 GF_Err stbl_ShiftOffset(GF_Box **a, u64 offset, u32 start, u32 end);
 
-GF_ChunkLargeOffsetBox *stco_to_co64(GF_ChunkOffsetBox *stco, u32 alloc_size)
+/*size tables created while importing are packed on 8 or 16 bits, and widened when a bigger size is set*/
+static u32 stsz_get_bits(u32 size)
+{
+	if (size <= 0xFF) return 8;
+	if (size <= 0xFFFF) return 16;
+	return 32;
+}
+
+GF_Err stsz_unpack(GF_SampleSizeBox *stsz)
+{
+	u32 i, *sizes;
+	if (!stsz->packed_sizes) return GF_OK;
+	if (stsz->alloc_size < stsz->sampleCount) stsz->alloc_size = stsz->sampleCount;
+	sizes = (u32 *)gf_malloc(sizeof(u32) * (stsz->alloc_size ? stsz->alloc_size : 1));
+	if (!sizes) return GF_OUT_OF_MEM;
+	for (i=0; i<stsz->sampleCount; i++) sizes[i] = stsz_get_entry(stsz, i);
+	gf_free(stsz->packed_sizes);
+	stsz->packed_sizes = NULL;
+	stsz->packed_bits = 0;
+	stsz->sizes = sizes;
+	return GF_OK;
+}
+
+/*sets the size of the sample at idx (0-based, at most sampleCount to append), creating the table from the
+constant sample size if needed, and growing or widening the table if needed*/
+static GF_Err stsz_set_entry(GF_SampleSizeBox *stsz, u32 idx, u32 size)
+{
+	u32 i, cur_bits, nb_bits, alloc_size;
+	Bool has_table = (stsz->sizes || stsz->packed_sizes) ? 1 : 0;
+
+	if (has_table) {
+		cur_bits = stsz->sizes ? 32 : stsz->packed_bits;
+		nb_bits = stsz_get_bits(size);
+		if (nb_bits < cur_bits) nb_bits = cur_bits;
+		alloc_size = stsz->alloc_size;
+	} else {
+		cur_bits = 0;
+		nb_bits = stsz_get_bits(MAX(size, stsz->sampleSize));
+		alloc_size = 0;
+	}
+	if (alloc_size < stsz->sampleCount) alloc_size = stsz->sampleCount;
+	while (alloc_size <= idx) {
+		ALLOC_INC(alloc_size);
+	}
+
+	if ((nb_bits != cur_bits) || (alloc_size != stsz->alloc_size)) {
+		if (nb_bits == cur_bits) {
+			if (stsz->sizes) {
+				stsz->sizes = (u32 *)gf_realloc(stsz->sizes, sizeof(u32) * alloc_size);
+				if (!stsz->sizes) return GF_OUT_OF_MEM;
+			} else {
+				stsz->packed_sizes = gf_realloc(stsz->packed_sizes, alloc_size * nb_bits / 8);
+				if (!stsz->packed_sizes) return GF_OUT_OF_MEM;
+			}
+		} else {
+			void *table = gf_malloc(alloc_size * nb_bits / 8);
+			if (!table) return GF_OUT_OF_MEM;
+			for (i=0; i<stsz->sampleCount; i++) {
+				u32 s_size = has_table ? stsz_get_entry(stsz, i) : stsz->sampleSize;
+				if (nb_bits==8) ((u8 *)table)[i] = (u8) s_size;
+				else if (nb_bits==16) ((u16 *)table)[i] = (u16) s_size;
+				else ((u32 *)table)[i] = s_size;
+			}
+			if (stsz->sizes) gf_free(stsz->sizes);
+			if (stsz->packed_sizes) gf_free(stsz->packed_sizes);
+			stsz->sizes = NULL;
+			stsz->packed_sizes = NULL;
+			stsz->packed_bits = 0;
+			if (nb_bits==32) stsz->sizes = (u32 *)table;
+			else {
+				stsz->packed_sizes = table;
+				stsz->packed_bits = nb_bits;
+			}
+		}
+		stsz->alloc_size = alloc_size;
+	}
+
+	if (stsz->sizes) stsz->sizes[idx] = size;
+	else if (stsz->packed_bits==8) ((u8 *)stsz->packed_sizes)[idx] = (u8) size;
+	else ((u16 *)stsz->packed_sizes)[idx] = (u16) size;
+	return GF_OK;
+}
+
+GF_Err co64_unpack(GF_ChunkLargeOffsetBox *co64)
 {
 	u32 i;
-	GF_ChunkLargeOffsetBox *co64;
+	u64 *offsets;
+	if (!co64->deltas) return GF_OK;
+	if (co64->alloc_size < co64->nb_entries) co64->alloc_size = co64->nb_entries;
+	offsets = (u64 *)gf_malloc(sizeof(u64) * (co64->alloc_size ? co64->alloc_size : 1));
+	if (!offsets) return GF_OUT_OF_MEM;
+	for (i=0; i<co64->nb_entries; i++) offsets[i] = co64_get_entry(co64, i);
+	gf_free(co64->anchors);
+	gf_free(co64->deltas);
+	co64->anchors = NULL;
+	co64->deltas = NULL;
+	co64->offsets = offsets;
+	return GF_OK;
+}
+
+/*sets the offset of the chunk at idx (0-based, at most nb_entries to append), growing the table if needed.
+Empty tables are created in compact mode, and switch to regular mode if an offset cannot be delta-coded*/
+static GF_Err co64_set_entry(GF_ChunkLargeOffsetBox *co64, u32 idx, u64 offset)
+{
+	u64 anchor;
+	Bool is_new = (!co64->offsets && !co64->deltas) ? 1 : 0;
+
+	if (is_new || (idx >= co64->alloc_size)) {
+		u32 alloc_size = is_new ? 0 : co64->alloc_size;
+		if (alloc_size < co64->nb_entries) alloc_size = co64->nb_entries;
+		while (alloc_size <= idx) {
+			ALLOC_INC(alloc_size);
+		}
+		if (co64->offsets) {
+			co64->offsets = (u64 *)gf_realloc(co64->offsets, sizeof(u64) * alloc_size);
+			if (!co64->offsets) return GF_OUT_OF_MEM;
+		} else {
+			co64->deltas = (u32 *)gf_realloc(co64->deltas, sizeof(u32) * alloc_size);
+			co64->anchors = (u64 *)gf_realloc(co64->anchors, sizeof(u64) * ((alloc_size >> CO64_ANCHOR_SHIFT) + 1));
+			if (!co64->deltas || !co64->anchors) return GF_OUT_OF_MEM;
+		}
+		co64->alloc_size = alloc_size;
+	}
+	if (co64->offsets) {
+		co64->offsets[idx] = offset;
+		return GF_OK;
+	}
+	/*first entry of a new anchor period*/
+	if ((idx == co64->nb_entries) && !(idx & ((1<<CO64_ANCHOR_SHIFT) - 1)))
+		co64->anchors[idx >> CO64_ANCHOR_SHIFT] = offset;
+
+	anchor = co64->anchors[idx >> CO64_ANCHOR_SHIFT];
+	if ((offset >= anchor) && (offset - anchor <= 0xFFFFFFFF)) {
+		co64->deltas[idx] = (u32) (offset - anchor);
+		return GF_OK;
+	}
+	/*offset cannot be coded, switch to regular table*/
+	if (co64_unpack(co64) != GF_OK) return GF_OUT_OF_MEM;
+	co64->offsets[idx] = offset;
+	return GF_OK;
+}
+
+static GF_Err co64_append(GF_ChunkLargeOffsetBox *co64, u64 offset)
+{
+	GF_Err e = co64_set_entry(co64, co64->nb_entries, offset);
+	if (e) return e;
+	co64->nb_entries++;
+	return GF_OK;
+}
 
-	if (stco->nb_entries > alloc_size)
-		alloc_size = stco->nb_entries;
+GF_ChunkLargeOffsetBox *stco_to_co64(GF_ChunkOffsetBox *stco)
+{
+	u32 i;
+	GF_ChunkLargeOffsetBox *co64;
 
 	co64 = (GF_ChunkLargeOffsetBox *)gf_isom_box_new(GF_ISOM_BOX_TYPE_CO64);
 	if (!co64)
 		return NULL;
 
-	co64->offsets = (u64 *)gf_malloc(alloc_size * sizeof(u64));
-	if (!co64->offsets) {
-		gf_isom_box_del((GF_Box *)co64);
-		return NULL;
+	for (i=0; i<stco->nb_entries; i++) {
+		if (co64_append(co64, (u64)stco->offsets[i]) != GF_OK) {
+			gf_isom_box_del((GF_Box *)co64);
+			return NULL;
+		}
 	}
-
-	for (i=0; i<stco->nb_entries; i++)
-		co64->offsets[i] = (u64)stco->offsets[i];
-	co64->nb_entries = stco->nb_entries;
-	co64->alloc_size = alloc_size;
 	gf_isom_box_del((GF_Box *)stco);
 	return co64;
 }
@@ -74,7 +217,7 @@ restart:
 		stco = (GF_ChunkOffsetBox *) *a;
 		for (k=start; k < end; k++) {
 			if (stco->offsets[k-1] + offset > 0xFFFFFFFF) {
-				co64 = stco_to_co64((GF_ChunkOffsetBox *) *a, 0);
+				co64 = stco_to_co64((GF_ChunkOffsetBox *) *a);
 				if (!co64) return GF_OUT_OF_MEM;
 				*a = (GF_Box *)co64;
 				start = k;
@@ -85,7 +228,8 @@ restart:
 	} else {
 		co64 = (GF_ChunkLargeOffsetBox *) *a;
 		for (k = start; k < end; k++) {
-			co64->offsets[k-1] += offset;
+			GF_Err e = co64_set_entry(co64, k-1, co64_get_entry(co64, k-1) + offset);
+			if (e) return e;
 		}
 	}
 	return GF_OK;
@@ -396,12 +540,13 @@ GF_Err stbl_AddSize(GF_SampleSizeBox *stsz, u32 sampleNumber, u32 size)
 {
 	u32 i, k;
 	u32 *newSizes;
+	GF_Err e;
 	if (!stsz || !size || !sampleNumber) return GF_BAD_PARAM;
 
 	if (sampleNumber > stsz->sampleCount + 1) return GF_BAD_PARAM;
 
 	//all samples have the same size
-	if (stsz->sizes == NULL) {
+	if (!stsz->sizes && !stsz->packed_sizes) {
 		//1 first sample added in NON COMPACT MODE
 		if (! stsz->sampleCount && (stsz->type != GF_ISOM_BOX_TYPE_STZ2) ) {
 			stsz->sampleCount = 1;
@@ -413,7 +558,14 @@ GF_Err stbl_AddSize(GF_SampleSizeBox *stsz, u32 sampleNumber, u32 size)
 			stsz->sampleCount++;
 			return GF_OK;
 		}
-		//3- no, need to alloc a size table
+		//3- no, need to alloc a size table - compact one if appending
+		if (stsz->sampleCount + 1 == sampleNumber) {
+			e = stsz_set_entry(stsz, stsz->sampleCount, size);
+			if (e) return e;
+			stsz->sampleSize = 0;
+			stsz->sampleCount++;
+			return GF_OK;
+		}
 		stsz->sizes = (u32*)gf_malloc(sizeof(u32) * (stsz->sampleCount + 1));
 		if (!stsz->sizes) return GF_OUT_OF_MEM;
 		stsz->alloc_size = stsz->sampleCount + 1;
@@ -438,15 +590,11 @@ GF_Err stbl_AddSize(GF_SampleSizeBox *stsz, u32 sampleNumber, u32 size)
 
 	/*append*/
 	if (stsz->sampleCount + 1 == sampleNumber) {
-		if (!stsz->alloc_size) stsz->alloc_size = stsz->sampleCount;
-		if (stsz->sampleCount == stsz->alloc_size) {
-			ALLOC_INC(stsz->alloc_size);
-			stsz->sizes = gf_realloc(stsz->sizes, sizeof(u32)*(stsz->alloc_size) );
-			if (!stsz->sizes) return GF_OUT_OF_MEM;
-			memset(&stsz->sizes[stsz->sampleCount], 0, sizeof(u32)*(stsz->alloc_size - stsz->sampleCount) );
-		}
-		stsz->sizes[stsz->sampleCount] = size;
+		e = stsz_set_entry(stsz, stsz->sampleCount, size);
+		if (e) return e;
 	} else {
+		e = stsz_unpack(stsz);
+		if (e) return e;
 		newSizes = (u32*)gf_malloc(sizeof(u32)*(1 + stsz->sampleCount) );
 		if (!newSizes) return GF_OUT_OF_MEM;
 		k = 0;
@@ -592,7 +740,7 @@ GF_Err stbl_AddChunkOffset(GF_MediaBox *mdia, u32 sampleNumber, u32 StreamDescIn
 
 	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 		if (offset > 0xFFFFFFFF) {
-			co64 = stco_to_co64((GF_ChunkOffsetBox *)stbl->ChunkOffset, 0);
+			co64 = stco_to_co64((GF_ChunkOffsetBox *)stbl->ChunkOffset);
 			if (!co64) return GF_OUT_OF_MEM;
 			stbl->ChunkOffset = (GF_Box *)co64;
 		}
@@ -634,17 +782,11 @@ GF_Err stbl_AddChunkOffset(GF_MediaBox *mdia, u32 sampleNumber, u32 StreamDescIn
 		//use large offset...
 		co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
 		if (sampleNumber > co64->nb_entries) {
-			if (!co64->alloc_size) co64->alloc_size = co64->nb_entries;
-			if (co64->nb_entries == co64->alloc_size) {
-				ALLOC_INC(co64->alloc_size);
-				co64->offsets = (u64*)gf_realloc(co64->offsets, sizeof(u64) * co64->alloc_size);
-				if (!co64->offsets) return GF_OUT_OF_MEM;
-				memset(&co64->offsets[co64->nb_entries], 0, sizeof(u64) * (co64->alloc_size - co64->nb_entries) );
-			}
-			co64->offsets[co64->nb_entries] = offset;
-			co64->nb_entries += 1;
+			GF_Err e = co64_append(co64, offset);
+			if (e) return e;
 		} else {
 			//nope. we're inserting
+			if (co64_unpack(co64) != GF_OK) return GF_OUT_OF_MEM;
 			newLarge = (u64*)gf_malloc(sizeof(u64) * (co64->nb_entries + 1));
 			if (!newLarge) return GF_OUT_OF_MEM;
 			k=0;
@@ -721,21 +863,17 @@ GF_Err stbl_SetChunkOffset(GF_MediaBox *mdia, u32 sampleNumber, u64 offset)
 
 	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 		if (offset > 0xFFFFFFFF) {
-			co64 = stco_to_co64((GF_ChunkOffsetBox *)stbl->ChunkOffset, 0);
+			co64 = stco_to_co64((GF_ChunkOffsetBox *)stbl->ChunkOffset);
 			if (!co64) return GF_OUT_OF_MEM;
 			stbl->ChunkOffset = (GF_Box *)co64;
 		}
-		co64->offsets[ent->firstChunk - 1] = offset;
-		gf_isom_box_del(stbl->ChunkOffset);
-		stbl->ChunkOffset = (GF_Box *) co64;
-		return GF_OK;
 	}
 
 	//and we change our offset
 	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 		((GF_ChunkOffsetBox *)stbl->ChunkOffset)->offsets[ent->firstChunk - 1] = (u32) offset;
 	} else {
-		((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset)->offsets[ent->firstChunk - 1] = offset;
+		return co64_set_entry((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset, ent->firstChunk - 1, offset);
 	}
 	return GF_OK;
 }
@@ -761,22 +899,20 @@ GF_Err stbl_SetSampleCTS(GF_SampleTableBox *stbl, u32 sampleNumber, u32 offset)
 
 GF_Err stbl_SetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 size)
 {
-	u32 i;
+	GF_Err e;
 	if (!SampleNumber || (stsz->sampleCount < SampleNumber)) return GF_BAD_PARAM;
 
-	if (stsz->sampleSize) {
+	if (stsz->sampleSize && !stsz->sizes && !stsz->packed_sizes) {
 		if (stsz->sampleSize == size) return GF_OK;
 		if (stsz->sampleCount == 1) {
 			stsz->sampleSize = size;
 			return GF_OK;
 		}
-		//nope, we have to rewrite a table
-		stsz->sizes = (u32*)gf_malloc(sizeof(u32)*stsz->sampleCount);
-		if (!stsz->sizes) return GF_OUT_OF_MEM;
-		for (i=0; i<stsz->sampleCount; i++) stsz->sizes[i] = stsz->sampleSize;
-		stsz->sampleSize = 0;
 	}
-	stsz->sizes[SampleNumber - 1] = size;
+	//nope, we have to rewrite a table
+	e = stsz_set_entry(stsz, SampleNumber - 1, size);
+	if (e) return e;
+	stsz->sampleSize = 0;
 	return GF_OK;
 }
 
@@ -899,6 +1035,15 @@ GF_Err stbl_RemoveDTS(GF_SampleTableBox *stbl, u32 sampleNumber, u32 LastAUDefDu
 				sampNum ++;
 			}
 		}
+		//removing a sample in a run may split it in up to 3 entries
+		if (stts->alloc_size < stts->nb_entries + 2) {
+			stts->alloc_size = stts->nb_entries + 2;
+			stts->entries = gf_realloc(stts->entries, sizeof(GF_SttsEntry)*stts->alloc_size);
+			if (!stts->entries) {
+				gf_free(DTSs);
+				return GF_OUT_OF_MEM;
+			}
+		}
 		j=0;
 		stts->nb_entries = 1;
 		stts->entries[0].sampleCount = 1;
@@ -964,6 +1109,10 @@ GF_Err stbl_RemoveSize(GF_SampleSizeBox *stsz, u32 sampleNumber)
 	if (stsz->sampleCount == 1) {
 		if (stsz->sizes) gf_free(stsz->sizes);
 		stsz->sizes = NULL;
+		if (stsz->packed_sizes) gf_free(stsz->packed_sizes);
+		stsz->packed_sizes = NULL;
+		stsz->packed_bits = 0;
+		stsz->alloc_size = 0;
 		stsz->sampleCount = 0;
 		return GF_OK;
 	}
@@ -973,7 +1122,13 @@ GF_Err stbl_RemoveSize(GF_SampleSizeBox *stsz, u32 sampleNumber)
 		return GF_OK;
 	}
 	if (sampleNumber < stsz->sampleCount) {
-		memcpy(stsz->sizes + sampleNumber - 1, stsz->sizes + sampleNumber, sizeof(u32) * (stsz->sampleCount - sampleNumber));
+		if (stsz->packed_sizes) {
+			u32 bpe = stsz->packed_bits / 8;
+			u8 *table = (u8 *)stsz->packed_sizes;
+			memmove(table + bpe * (sampleNumber - 1), table + bpe * sampleNumber, bpe * (stsz->sampleCount - sampleNumber));
+		} else {
+			memmove(stsz->sizes + sampleNumber - 1, stsz->sizes + sampleNumber, sizeof(u32) * (stsz->sampleCount - sampleNumber));
+		}
 	}
 	stsz->sampleCount--;
 	return GF_OK;
@@ -1026,6 +1181,7 @@ GF_Err stbl_RemoveChunk(GF_SampleTableBox *stbl, u32 sampleNumber)
 		((GF_ChunkOffsetBox *)stbl->ChunkOffset)->alloc_size = stbl->SampleSize->sampleCount;
 		((GF_ChunkOffsetBox *)stbl->ChunkOffset)->nb_entries -= 1;
 	} else {
+		if (co64_unpack((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset) != GF_OK) return GF_OUT_OF_MEM;
 		if (!stbl->SampleSize->sampleCount) {
 			gf_free(((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset)->offsets);
 			((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset)->offsets = NULL;
@@ -1277,17 +1433,17 @@ exit:
 
 GF_Err stbl_SampleSizeAppend(GF_SampleSizeBox *stsz, u32 data_size)
 {
-	u32 i;
+	GF_Err e;
+	u32 size;
 	if (!stsz || !stsz->sampleCount) return GF_BAD_PARAM;
 
-	//we must realloc our table
-	if (stsz->sampleSize) {
-		stsz->sizes = (u32*)gf_malloc(sizeof(u32)*stsz->sampleCount);
-		if (!stsz->sizes) return GF_OUT_OF_MEM;
-		for (i=0; i<stsz->sampleCount; i++) stsz->sizes[i] = stsz->sampleSize;
-		stsz->sampleSize = 0;
-	}
-	stsz->sizes[stsz->sampleCount-1] += data_size;
+	//we must realloc our table if all samples have the same size
+	if (stsz->sizes || stsz->packed_sizes) size = stsz_get_entry(stsz, stsz->sampleCount-1);
+	else size = stsz->sampleSize;
+
+	e = stsz_set_entry(stsz, stsz->sampleCount-1, size + data_size);
+	if (e) return e;
+	stsz->sampleSize = 0;
 	return GF_OK;
 }
 
@@ -1318,8 +1474,6 @@ void stbl_AppendTime(GF_SampleTableBox *stbl, u32 duration)
 
 void stbl_AppendSize(GF_SampleTableBox *stbl, u32 size)
 {
-	u32 i;
-
 	if (!stbl->SampleSize->sampleCount) {
 		stbl->SampleSize->sampleSize = size;
 		stbl->SampleSize->sampleCount = 1;
@@ -1329,23 +1483,8 @@ void stbl_AppendSize(GF_SampleTableBox *stbl, u32 size)
 		stbl->SampleSize->sampleCount += 1;
 		return;
 	}
-	if (!stbl->SampleSize->sizes || (stbl->SampleSize->sampleCount==stbl->SampleSize->alloc_size)) {
-		Bool init_table = (stbl->SampleSize->sizes==NULL) ? 1 : 0;
-		ALLOC_INC(stbl->SampleSize->alloc_size);
-		if (stbl->SampleSize->sampleCount>stbl->SampleSize->alloc_size)
-			stbl->SampleSize->alloc_size = stbl->SampleSize->sampleCount+1;
-
-		stbl->SampleSize->sizes = (u32 *)gf_realloc(stbl->SampleSize->sizes, sizeof(u32)*stbl->SampleSize->alloc_size);
-		if (!stbl->SampleSize->sizes) return;
-		memset(&stbl->SampleSize->sizes[stbl->SampleSize->sampleCount], 0, sizeof(u32) * (stbl->SampleSize->alloc_size - stbl->SampleSize->sampleCount) );
-
-		if (init_table) {
-			for (i=0; i<stbl->SampleSize->sampleCount;i++)
-				stbl->SampleSize->sizes[i] = stbl->SampleSize->sampleSize;
-		}
-	}
+	if (stsz_set_entry(stbl->SampleSize, stbl->SampleSize->sampleCount, size) != GF_OK) return;
 	stbl->SampleSize->sampleSize = 0;
-	stbl->SampleSize->sizes[stbl->SampleSize->sampleCount] = size;
 	stbl->SampleSize->sampleCount += 1;
 }
 
@@ -1353,12 +1492,10 @@ void stbl_AppendChunk(GF_SampleTableBox *stbl, u64 offset)
 {
 	GF_ChunkOffsetBox *stco;
 	GF_ChunkLargeOffsetBox *co64;
-	u32 *new_offsets, i;
-	u64 *off_64;
 
 	if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 		if (offset > 0xFFFFFFFF) {
-			co64 = stco_to_co64((GF_ChunkOffsetBox *)stbl->ChunkOffset, 0);
+			co64 = stco_to_co64((GF_ChunkOffsetBox *)stbl->ChunkOffset);
 			if (!co64) return; // !!!!error!!!!
 			stbl->ChunkOffset = (GF_Box *)co64;
 		}
@@ -1369,26 +1506,18 @@ void stbl_AppendChunk(GF_SampleTableBox *stbl, u64 offset)
 		stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
 
 		//we're fine
-		new_offsets = (u32*)gf_malloc(sizeof(u32)*(stco->nb_entries+1));
-		if (!new_offsets) return;
-		for (i=0; i<stco->nb_entries; i++) new_offsets[i] = stco->offsets[i];
-		new_offsets[i] = (u32) offset;
-		if (stco->offsets) gf_free(stco->offsets);
-		stco->offsets = new_offsets;
+		if (stco->alloc_size < stco->nb_entries) stco->alloc_size = stco->nb_entries;
+		if (stco->nb_entries == stco->alloc_size) {
+			ALLOC_INC(stco->alloc_size);
+			stco->offsets = (u32*)gf_realloc(stco->offsets, sizeof(u32) * stco->alloc_size);
+			if (!stco->offsets) return;
+		}
+		stco->offsets[stco->nb_entries] = (u32) offset;
 		stco->nb_entries += 1;
-		stco->alloc_size = stco->nb_entries;
 	}
 	//large offsets
 	else {
-		co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
-		off_64 = (u64*)gf_malloc(sizeof(u32)*(co64->nb_entries+1));
-		if (!off_64) return;
-		for (i=0; i<co64->nb_entries; i++) off_64[i] = co64->offsets[i];
-		off_64[i] = offset;
-		if (co64->offsets) gf_free(co64->offsets);
-		co64->offsets = off_64;
-		co64->nb_entries += 1;
-		co64->alloc_size = co64->nb_entries;
+		co64_append((GF_ChunkLargeOffsetBox *)stbl->ChunkOffset, offset);
 	}
 }
 
@@ -1633,7 +1762,7 @@ static GFINLINE GF_Err stbl_AddOffset(GF_Box **a, u64 offset)
 
 	if ((*a)->type == GF_ISOM_BOX_TYPE_STCO) {
 		if (offset > 0xFFFFFFFF) {
-			co64 = stco_to_co64((GF_ChunkOffsetBox *)*a, 0);
+			co64 = stco_to_co64((GF_ChunkOffsetBox *)*a);
 			if (!co64) return GF_OUT_OF_MEM;
 			*a = (GF_Box *)co64;
 		}
@@ -1652,15 +1781,7 @@ static GFINLINE GF_Err stbl_AddOffset(GF_Box **a, u64 offset)
 		stco->nb_entries += 1;
 	} else {
 		//this is a large offset
-		co64 = (GF_ChunkLargeOffsetBox *) *a;
-		if (co64->nb_entries==co64->alloc_size) {
-			ALLOC_INC(co64->alloc_size);
-			co64->offsets = (u64*)gf_realloc(co64->offsets, co64->alloc_size * sizeof(u64));
-			if (!co64->offsets) return GF_OUT_OF_MEM;
-			memset(&co64->offsets[co64->nb_entries], 0, (co64->alloc_size - co64->nb_entries) * sizeof(u64) );
-		}
-		co64->offsets[co64->nb_entries] = offset;
-		co64->nb_entries += 1;
+		return co64_append((GF_ChunkLargeOffsetBox *) *a, offset);
 	}
 	return GF_OK;
 }
@@ -1759,16 +1880,20 @@ GF_Err gf_isom_refresh_size_info(GF_ISOFile *file, u32 trackNumber)
 	stsz = trak->Media->information->sampleTable->SampleSize;
 	if (stsz->sampleSize || !stsz->sampleCount) return GF_OK;
 
-	size = stsz->sizes[0];
+	size = stsz_get_entry(stsz, 0);
 	for (i=1; i<stsz->sampleCount; i++) {
-		if (stsz->sizes[i] != size) {
+		if (stsz_get_entry(stsz, i) != size) {
 			size = 0;
 			break;
 		}
 	}
 	if (size) {
-		gf_free(stsz->sizes);
+		if (stsz->sizes) gf_free(stsz->sizes);
 		stsz->sizes = NULL;
+		if (stsz->packed_sizes) gf_free(stsz->packed_sizes);
+		stsz->packed_sizes = NULL;
+		stsz->packed_bits = 0;
+		stsz->alloc_size = 0;
 		stsz->sampleSize = size;
 	}
 	return GF_OK;
@@ -1445,49 +1445,6 @@ const char *gf_avc_get_profile_name(u8 video_prof)
 #ifndef GPAC_DISABLE_AV_PARSERS
 
 
-static u8 avc_golomb_bits[256] = {
-	8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4, 3,
-	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 2,
-	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0
-};
-
-static u32 bs_get_ue(GF_BitStream *bs)
-{
-	u8 coded;
-	u32 bits = 0, read = 0;
-	while (1) {
-		if (!gf_bs_available(bs)) break;
-		read = gf_bs_peek_bits(bs, 8, 0);
-		if (read) break;
-		gf_bs_read_int(bs, 8);
-		bits += 8;
-	}
-	coded = avc_golomb_bits[read];
-	gf_bs_read_int(bs, coded);
-	bits += coded;
-	return gf_bs_read_int(bs, bits + 1) - 1;
-}
-
-static s32 bs_get_se(GF_BitStream *bs)
-{
-	u32 v = bs_get_ue(bs);
-	if ((v & 0x1) == 0) return (s32) (0 - (v>>1));
-	return (v + 1) >> 1;
-}
-
 u32 gf_media_nalu_is_start_code(GF_BitStream *bs)
 {
 	u8 s1, s2, s3, s4;
@@ -1611,7 +1568,7 @@ static void avc_parse_hrd_parameters(GF_BitStream *bs, AVC_HRD *hrd)
 {
 	int i, cpb_cnt_minus1;
 
-	cpb_cnt_minus1 = bs_get_ue(bs);		/*cpb_cnt_minus1*/
+	cpb_cnt_minus1 = gf_bs_read_ue(bs);		/*cpb_cnt_minus1*/
 	if (cpb_cnt_minus1 > 31)
 		GF_LOG(GF_LOG_WARNING, GF_LOG_CODING, ("[avc-h264] invalid cpb_cnt_minus1 value: %d (expected in [0;31])\n", cpb_cnt_minus1));
 	gf_bs_read_int(bs, 4);				/*bit_rate_scale*/
@@ -1619,8 +1576,8 @@ static void avc_parse_hrd_parameters(GF_BitStream *bs, AVC_HRD *hrd)
 
 	/*for( SchedSelIdx = 0; SchedSelIdx <= cpb_cnt_minus1; SchedSelIdx++ ) {*/
 	for (i=0; i<=cpb_cnt_minus1; i++) {
-		bs_get_ue(bs);					/*bit_rate_value_minus1[ SchedSelIdx ]*/
-		bs_get_ue(bs);					/*cpb_size_value_minus1[ SchedSelIdx ]*/
+		gf_bs_read_ue(bs);					/*bit_rate_value_minus1[ SchedSelIdx ]*/
+		gf_bs_read_ue(bs);					/*cpb_size_value_minus1[ SchedSelIdx ]*/
 		gf_bs_read_int(bs, 1);			/*cbr_flag[ SchedSelIdx ]*/
 	}
 	gf_bs_read_int(bs, 5);											/*initial_cpb_removal_delay_length_minus1*/
@@ -1802,7 +1759,7 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 	/*SubsetSps is used to be sure that AVC SPS are not going to be scratched
 	by subset SPS. According to the SVC standard, subset SPS can have the same sps_id
 	than its base layer, but it does not refer to the same SPS. */
-	sps_id = bs_get_ue(bs) + GF_SVC_SSPS_ID_SHIFT * subseq_sps;
+	sps_id = gf_bs_read_ue(bs) + GF_SVC_SSPS_ID_SHIFT * subseq_sps;
 	if (sps_id >=32) {
 		sps_id = -1;
 		goto exit;
@@ -1826,7 +1783,7 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 	case 86:
 	case 118:
 	case 128:
-		chroma_format_idc = bs_get_ue(bs);
+		chroma_format_idc = gf_bs_read_ue(bs);
 		ChromaArrayType = chroma_format_idc;
 		if (chroma_format_idc == 3) {
 			u8 separate_colour_plane_flag = gf_bs_read_int(bs, 1);
@@ -1837,8 +1794,8 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 			*/
 			if (separate_colour_plane_flag) ChromaArrayType = 0;
 		}
-		luma_bd = bs_get_ue(bs);
-		chroma_bd = bs_get_ue(bs);
+		luma_bd = gf_bs_read_ue(bs);
+		chroma_bd = gf_bs_read_ue(bs);
 		/*qpprime_y_zero_transform_bypass_flag = */ gf_bs_read_int(bs, 1);
 		/*seq_scaling_matrix_present_flag*/
 		if (gf_bs_read_int(bs, 1)) {
@@ -1849,7 +1806,7 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 					u32 sl = k<6 ? 16 : 64;
 					for (z=0; z<sl; z++) {
 						if (next) {
-							s32 delta = bs_get_se(bs);
+							s32 delta = gf_bs_read_se(bs);
 							next = (last + delta + 256) % 256;
 						}
 						last = next ? next : last;
@@ -1866,29 +1823,29 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 	sps->profile_idc = profile_idc;
 	sps->level_idc = level_idc;
 	sps->prof_compat = pcomp;
-	sps->log2_max_frame_num = bs_get_ue(bs) + 4;
-	sps->poc_type = bs_get_ue(bs);
+	sps->log2_max_frame_num = gf_bs_read_ue(bs) + 4;
+	sps->poc_type = gf_bs_read_ue(bs);
 	sps->chroma_format = chroma_format_idc;
 	sps->luma_bit_depth_m8 = luma_bd;
 	sps->chroma_bit_depth_m8 = chroma_bd;
 
 	if (sps->poc_type == 0) {
-		sps->log2_max_poc_lsb = bs_get_ue(bs) + 4;
+		sps->log2_max_poc_lsb = gf_bs_read_ue(bs) + 4;
 	} else if(sps->poc_type == 1) {
 		sps->delta_pic_order_always_zero_flag = gf_bs_read_int(bs, 1);
-		sps->offset_for_non_ref_pic = bs_get_se(bs);
-		sps->offset_for_top_to_bottom_field = bs_get_se(bs);
-		sps->poc_cycle_length = bs_get_ue(bs);
-		for(i=0; i<sps->poc_cycle_length; i++) sps->offset_for_ref_frame[i] = bs_get_se(bs);
+		sps->offset_for_non_ref_pic = gf_bs_read_se(bs);
+		sps->offset_for_top_to_bottom_field = gf_bs_read_se(bs);
+		sps->poc_cycle_length = gf_bs_read_ue(bs);
+		for(i=0; i<sps->poc_cycle_length; i++) sps->offset_for_ref_frame[i] = gf_bs_read_se(bs);
 	}
 	if (sps->poc_type > 2) {
 		sps_id = -1;
 		goto exit;
 	}
-	bs_get_ue(bs); /*ref_frame_count*/
+	gf_bs_read_ue(bs); /*ref_frame_count*/
 	gf_bs_read_int(bs, 1); /*gaps_in_frame_num_allowed_flag*/
-	mb_width = bs_get_ue(bs) + 1;
-	mb_height= bs_get_ue(bs) + 1;
+	mb_width = gf_bs_read_ue(bs) + 1;
+	mb_height= gf_bs_read_ue(bs) + 1;
 
 	sps->frame_mbs_only_flag = gf_bs_read_int(bs, 1);
 
@@ -1911,10 +1868,10 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 			CropUnitX = SubWidthC [chroma_format_idc];
 			CropUnitY = SubHeightC[chroma_format_idc] * (2 - sps->frame_mbs_only_flag);
 		}
-		cl = bs_get_ue(bs); /*crop_left*/
-		cr = bs_get_ue(bs); /*crop_right*/
-		ct = bs_get_ue(bs); /*crop_top*/
-		cb = bs_get_ue(bs); /*crop_bottom*/
+		cl = gf_bs_read_ue(bs); /*crop_left*/
+		cr = gf_bs_read_ue(bs); /*crop_right*/
+		ct = gf_bs_read_ue(bs); /*crop_top*/
+		cb = gf_bs_read_ue(bs); /*crop_bottom*/
 
 		sps->width = 16*mb_width - CropUnitX*(cl + cr);
 		sps->height -= CropUnitY*(ct + cb);
@@ -1950,8 +1907,8 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 		}
 
 		if (gf_bs_read_int(bs, 1)) {	/* chroma_location_info_present_flag */
-			bs_get_ue(bs);				/* chroma_sample_location_type_top_field */
-			bs_get_ue(bs);				/* chroma_sample_location_type_bottom_field */
+			gf_bs_read_ue(bs);				/* chroma_sample_location_type_top_field */
+			gf_bs_read_ue(bs);				/* chroma_sample_location_type_bottom_field */
 		}
 
 		sps->vui.timing_info_present_flag = gf_bs_read_int(bs, 1);
@@ -1994,10 +1951,10 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 					/*seq_ref_layer_chroma_phase_x_plus1_flag*/gf_bs_read_int(bs, 1);
 					/*seq_ref_layer_chroma_phase_y_plus1*/gf_bs_read_int(bs, 2);
 				}
-				/*seq_scaled_ref_layer_left_offset*/ bs_get_se(bs);
-				/*seq_scaled_ref_layer_top_offset*/bs_get_se(bs);
-				/*seq_scaled_ref_layer_right_offset*/bs_get_se(bs);
-				/*seq_scaled_ref_layer_bottom_offset*/bs_get_se(bs);
+				/*seq_scaled_ref_layer_left_offset*/ gf_bs_read_se(bs);
+				/*seq_scaled_ref_layer_top_offset*/gf_bs_read_se(bs);
+				/*seq_scaled_ref_layer_right_offset*/gf_bs_read_se(bs);
+				/*seq_scaled_ref_layer_bottom_offset*/gf_bs_read_se(bs);
 			}
 			if (/*seq_tcoeff_level_prediction_flag*/gf_bs_read_int(bs, 1)) {
 				/*adaptive_tcoeff_level_prediction_flag*/ gf_bs_read_int(bs, 1);
@@ -2007,7 +1964,7 @@ s32 gf_media_avc_read_sps(char *sps_data, u32 sps_size, AVCState *avc, u32 subse
 			/*svc_vui_parameters_present*/
 			if (gf_bs_read_int(bs, 1)) {
 				u32 i, vui_ext_num_entries_minus1;
-				vui_ext_num_entries_minus1 = bs_get_ue(bs);
+				vui_ext_num_entries_minus1 = gf_bs_read_ue(bs);
 
 				for (i=0; i <= vui_ext_num_entries_minus1; i++) {
 					u8 vui_ext_nal_hrd_parameters_present_flag, vui_ext_vcl_hrd_parameters_present_flag, vui_ext_timing_info_present_flag;
@@ -2071,7 +2028,7 @@ s32 gf_media_avc_read_pps(char *pps_data, u32 pps_size, AVCState *avc)
 	/*nal hdr*/gf_bs_read_u8(bs);
 
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>=255) {
 		pps_id = -1;
 		goto exit;
@@ -2079,7 +2036,7 @@ s32 gf_media_avc_read_pps(char *pps_data, u32 pps_size, AVCState *avc)
 	pps = &avc->pps[pps_id];
 
 	if (!pps->status) pps->status = 1;
-	pps->sps_id = bs_get_ue(bs);
+	pps->sps_id = gf_bs_read_ue(bs);
 	if (pps->sps_id >= 32) {
 		pps->sps_id = 0;
 		pps_id = -1;
@@ -2093,19 +2050,19 @@ s32 gf_media_avc_read_pps(char *pps_data, u32 pps_size, AVCState *avc)
 	avc->sps_active_idx = pps->sps_id; /*set active sps*/
 	/*pps->cabac = */gf_bs_read_int(bs, 1);
 	pps->pic_order_present= gf_bs_read_int(bs, 1);
-	pps->slice_group_count= bs_get_ue(bs) + 1;
-	if (pps->slice_group_count > 1 ) /*pps->mb_slice_group_map_type = */bs_get_ue(bs);
-	/*pps->ref_count[0]= */bs_get_ue(bs) /*+ 1*/;
-	/*pps->ref_count[1]= */bs_get_ue(bs) /*+ 1*/;
+	pps->slice_group_count= gf_bs_read_ue(bs) + 1;
+	if (pps->slice_group_count > 1 ) /*pps->mb_slice_group_map_type = */gf_bs_read_ue(bs);
+	/*pps->ref_count[0]= */gf_bs_read_ue(bs) /*+ 1*/;
+	/*pps->ref_count[1]= */gf_bs_read_ue(bs) /*+ 1*/;
 	/*
 	if ((pps->ref_count[0] > 32) || (pps->ref_count[1] > 32)) goto exit;
 	*/
 
 	/*pps->weighted_pred = */gf_bs_read_int(bs, 1);
 	/*pps->weighted_bipred_idc = */gf_bs_read_int(bs, 2);
-	/*pps->init_qp = */bs_get_se(bs) /*+ 26*/;
-	/*pps->init_qs= */bs_get_se(bs) /*+ 26*/;
-	/*pps->chroma_qp_index_offset = */bs_get_se(bs);
+	/*pps->init_qp = */gf_bs_read_se(bs) /*+ 26*/;
+	/*pps->init_qs= */gf_bs_read_se(bs) /*+ 26*/;
+	/*pps->chroma_qp_index_offset = */gf_bs_read_se(bs);
 	/*pps->deblocking_filter_parameters_present = */gf_bs_read_int(bs, 1);
 	/*pps->constrained_intra_pred = */gf_bs_read_int(bs, 1);
 	pps->redundant_pic_cnt_present = gf_bs_read_int(bs, 1);
@@ -2130,7 +2087,7 @@ s32 gf_media_avc_read_sps_ext(char *spse_data, u32 spse_size)
 
 	/*nal header*/gf_bs_read_u8(bs);
 
-	sps_id = bs_get_ue(bs);
+	sps_id = gf_bs_read_ue(bs);
 
 	gf_bs_del(bs);
 	gf_free(spse_data_without_emulation_bytes);
@@ -2158,11 +2115,11 @@ static s32 avc_parse_slice(GF_BitStream *bs, AVCState *avc, Bool svc_idr_flag, A
 	s32 pps_id;
 
 	/*s->current_picture.reference= h->nal_ref_idc != 0;*/
-	/*first_mb_in_slice = */bs_get_ue(bs);
-	si->slice_type = bs_get_ue(bs);
+	/*first_mb_in_slice = */gf_bs_read_ue(bs);
+	si->slice_type = gf_bs_read_ue(bs);
 	if (si->slice_type > 9) return -1;
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>255) return -1;
 	si->pps = &avc->pps[pps_id];
 	if (!si->pps->slice_group_count) return -2;
@@ -2179,20 +2136,20 @@ static s32 avc_parse_slice(GF_BitStream *bs, AVCState *avc, Bool svc_idr_flag, A
 			si->bottom_field_flag = gf_bs_read_int(bs, 1);
 	}
 	if ((si->nal_unit_type==GF_AVC_NALU_IDR_SLICE) || svc_idr_flag)
-		si->idr_pic_id = bs_get_ue(bs);
+		si->idr_pic_id = gf_bs_read_ue(bs);
 
 	if (si->sps->poc_type==0) {
 		si->poc_lsb = gf_bs_read_int(bs, si->sps->log2_max_poc_lsb);
 		if (si->pps->pic_order_present && !si->field_pic_flag) {
-			si->delta_poc_bottom = bs_get_se(bs);
+			si->delta_poc_bottom = gf_bs_read_se(bs);
 		}
 	} else if ((si->sps->poc_type==1) && !si->sps->delta_pic_order_always_zero_flag) {
-		si->delta_poc[0] = bs_get_se(bs);
+		si->delta_poc[0] = gf_bs_read_se(bs);
 		if ((si->pps->pic_order_present==1) && !si->field_pic_flag)
-			si->delta_poc[1] = bs_get_se(bs);
+			si->delta_poc[1] = gf_bs_read_se(bs);
 	}
 	if (si->pps->redundant_pic_cnt_present) {
-		si->redundant_pic_cnt = bs_get_ue(bs);
+		si->redundant_pic_cnt = gf_bs_read_ue(bs);
 	}
 	return 0;
 }
@@ -2203,11 +2160,11 @@ static s32 svc_parse_slice(GF_BitStream *bs, AVCState *avc, AVCSliceInfo *si)
 	s32 pps_id;
 
 	/*s->current_picture.reference= h->nal_ref_idc != 0;*/
-	/*first_mb_in_slice = */bs_get_ue(bs);
-	si->slice_type = bs_get_ue(bs);
+	/*first_mb_in_slice = */gf_bs_read_ue(bs);
+	si->slice_type = gf_bs_read_ue(bs);
 	if (si->slice_type > 9) return -1;
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>255)
 		return -1;
 	si->pps = &avc->pps[pps_id];
@@ -2228,20 +2185,20 @@ static s32 svc_parse_slice(GF_BitStream *bs, AVCState *avc, AVCSliceInfo *si)
 		if (si->field_pic_flag) si->bottom_field_flag = gf_bs_read_int(bs, 1);
 	}
 	if (si->nal_unit_type == GF_AVC_NALU_IDR_SLICE || si ->NalHeader.idr_pic_flag)
-		si->idr_pic_id = bs_get_ue(bs);
+		si->idr_pic_id = gf_bs_read_ue(bs);
 
 	if (si->sps->poc_type==0) {
 		si->poc_lsb = gf_bs_read_int(bs, si->sps->log2_max_poc_lsb);
  	if (si->pps->pic_order_present && !si->field_pic_flag) {
-			si->delta_poc_bottom = bs_get_se(bs);
+			si->delta_poc_bottom = gf_bs_read_se(bs);
 		}
 	} else if ((si->sps->poc_type==1) && !si->sps->delta_pic_order_always_zero_flag) {
-		si->delta_poc[0] = bs_get_se(bs);
+		si->delta_poc[0] = gf_bs_read_se(bs);
 		if ((si->pps->pic_order_present==1) && !si->field_pic_flag)
-			si->delta_poc[1] = bs_get_se(bs);
+			si->delta_poc[1] = gf_bs_read_se(bs);
 	}
 	if (si->pps->redundant_pic_cnt_present) {
-		si->redundant_pic_cnt = bs_get_ue(bs);
+		si->redundant_pic_cnt = gf_bs_read_ue(bs);
 	}
 	return 0;
 }
@@ -2251,7 +2208,7 @@ static s32 avc_parse_recovery_point_sei(GF_BitStream *bs, AVCState *avc)
 {
 	AVCSeiRecoveryPoint *rp = &avc->sei.recovery_point;
 
-	rp->frame_cnt = bs_get_ue(bs);
+	rp->frame_cnt = gf_bs_read_ue(bs);
 	rp->exact_match_flag = gf_bs_read_int(bs, 1);
 	rp->broken_link_flag = gf_bs_read_int(bs, 1);
 	rp->changing_slice_group_idc = gf_bs_read_int(bs, 2);
@@ -3028,8 +2985,8 @@ GF_Err gf_avc_get_pps_info(char *pps_data, u32 pps_size, u32 *pps_id, u32 *sps_i
 	}
 	/*nal hdr*/ gf_bs_read_int(bs, 8);
 
-	*pps_id = bs_get_ue(bs);
-	*sps_id = bs_get_ue(bs);
+	*pps_id = gf_bs_read_ue(bs);
+	*sps_id = gf_bs_read_ue(bs);
 
 exit:
 	gf_bs_del(bs);
@@ -3100,7 +3057,7 @@ static s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSlice
 	if (RapPicFlag) {
 		/*Bool no_output_of_prior_pics_flag = */gf_bs_read_int(bs, 1);
 	}
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 	if (pps_id>=64) return -1;
 
 	pps = &hevc->pps[pps_id];
@@ -3121,7 +3078,7 @@ static s32 hevc_parse_slice_segment(GF_BitStream *bs, HEVCState *hevc, HEVCSlice
 	if( !dependent_slice_segment_flag ) {
 		gf_bs_read_int(bs, pps->num_extra_slice_header_bits);
 
-		si->slice_type = bs_get_ue(bs);
+		si->slice_type = gf_bs_read_ue(bs);
 
 		if(pps->output_flag_present_flag)
 			/*pic_output_flag = */gf_bs_read_int(bs, 1);
@@ -3274,12 +3231,12 @@ static Bool parse_short_term_ref_pic_set(GF_BitStream *bs, HEVC_SPS *sps, u32 id
 		s32 deltaRPS;
 	    u32 k = 0, k0 = 0, k1 = 0;
 		if (idx_rps == sps->num_short_term_ref_pic_sets)
-			delta_idx_minus1 = bs_get_ue(bs);
+			delta_idx_minus1 = gf_bs_read_ue(bs);
 
 		assert(delta_idx_minus1 <= idx_rps - 1);
 		ref_idx = idx_rps - 1 - delta_idx_minus1;
 		delta_rps_sign = gf_bs_read_int(bs, 1);
-		abs_delta_rps_minus1 = bs_get_ue(bs);
+		abs_delta_rps_minus1 = gf_bs_read_ue(bs);
 		deltaRPS = (1 - (delta_rps_sign<<1)) * (abs_delta_rps_minus1 + 1);
 
 		rps = &sps->rps[idx_rps];
@@ -3310,17 +3267,17 @@ static Bool parse_short_term_ref_pic_set(GF_BitStream *bs, HEVC_SPS *sps, u32 id
 		rps->num_positive_pics = k1;
 	} else {
 		s32 prev = 0, poc = 0;
-		sps->rps[idx_rps].num_negative_pics = bs_get_ue(bs);
-		sps->rps[idx_rps].num_positive_pics = bs_get_ue(bs);
+		sps->rps[idx_rps].num_negative_pics = gf_bs_read_ue(bs);
+		sps->rps[idx_rps].num_positive_pics = gf_bs_read_ue(bs);
 		for (i=0; i<sps->rps[idx_rps].num_negative_pics; i++) {
-			u32 delta_poc_s0_minus1 = bs_get_ue(bs);
+			u32 delta_poc_s0_minus1 = gf_bs_read_ue(bs);
 			poc = prev - delta_poc_s0_minus1 - 1;
 			prev = poc;
 			sps->rps[idx_rps].delta_poc[i] = poc;
 			/*used_by_curr_pic_s1_flag[ i ] = */gf_bs_read_int(bs, 1);
 		}
 		for (i=0; i<sps->rps[idx_rps].num_positive_pics; i++) {
-			u32 delta_poc_s1_minus1 = bs_get_ue(bs);
+			u32 delta_poc_s1_minus1 = gf_bs_read_ue(bs);
 			poc = prev + delta_poc_s1_minus1 + 1;
 			prev = poc;
 			sps->rps[idx_rps].delta_poc[i] = poc;
@@ -3361,7 +3318,7 @@ s32 gf_media_hevc_read_sps(char *data, u32 size, HEVCState *hevc)
 	memset(&ptl, 0, sizeof(ptl));
 	profile_tier_level(bs, 1, max_sub_layers_minus1, &ptl);
 
-	sps_id = bs_get_ue(bs);
+	sps_id = gf_bs_read_ue(bs);
 	if (sps_id>=16) goto exit;
 	sps = &hevc->sps[sps_id];
 	if (!sps->state) {
@@ -3371,40 +3328,40 @@ s32 gf_media_hevc_read_sps(char *data, u32 size, HEVCState *hevc)
 	}
 	sps->ptl = ptl;
 
-	sps->chroma_format_idc = bs_get_ue(bs);
+	sps->chroma_format_idc = gf_bs_read_ue(bs);
 	if (sps->chroma_format_idc==3)
 		sps->separate_colour_plane_flag = gf_bs_read_int(bs, 1);
-	sps->width = bs_get_ue(bs);
-	sps->height = bs_get_ue(bs);
+	sps->width = gf_bs_read_ue(bs);
+	sps->height = gf_bs_read_ue(bs);
 	if (gf_bs_read_int(bs, 1)) {
-		sps->cw_left = bs_get_ue(bs);
-		sps->cw_right = bs_get_ue(bs);
-		sps->cw_top = bs_get_ue(bs);
-		sps->cw_bottom = bs_get_ue(bs);
+		sps->cw_left = gf_bs_read_ue(bs);
+		sps->cw_right = gf_bs_read_ue(bs);
+		sps->cw_top = gf_bs_read_ue(bs);
+		sps->cw_bottom = gf_bs_read_ue(bs);
 	}
-	sps->bit_depth_luma = 8 + bs_get_ue(bs);
-	sps->bit_depth_chroma = 8 + bs_get_ue(bs);
+	sps->bit_depth_luma = 8 + gf_bs_read_ue(bs);
+	sps->bit_depth_chroma = 8 + gf_bs_read_ue(bs);
 
-	sps->log2_max_pic_order_cnt_lsb = 4 + bs_get_ue(bs);
+	sps->log2_max_pic_order_cnt_lsb = 4 + gf_bs_read_ue(bs);
 
 	sps_sub_layer_ordering_info_present_flag = gf_bs_read_int(bs, 1);
 	for(i= sps_sub_layer_ordering_info_present_flag ? 0 : max_sub_layers_minus1; i<=max_sub_layers_minus1; i++) {
-		/*max_dec_pic_buffering = */ bs_get_ue(bs);
-		/*num_reorder_pics = */ bs_get_ue(bs);
-		/*max_latency_increase = */ bs_get_ue(bs);
+		/*max_dec_pic_buffering = */ gf_bs_read_ue(bs);
+		/*num_reorder_pics = */ gf_bs_read_ue(bs);
+		/*max_latency_increase = */ gf_bs_read_ue(bs);
 	}
 
-	log2_min_luma_coding_block_size = 3 + bs_get_ue(bs);
-	log2_diff_max_min_luma_coding_block_size = bs_get_ue(bs);
+	log2_min_luma_coding_block_size = 3 + gf_bs_read_ue(bs);
+	log2_diff_max_min_luma_coding_block_size = gf_bs_read_ue(bs);
 	sps->max_CU_width = ( 1<<(log2_min_luma_coding_block_size + log2_diff_max_min_luma_coding_block_size) );
 	sps->max_CU_height = ( 1<<(log2_min_luma_coding_block_size + log2_diff_max_min_luma_coding_block_size) );
 
-	log2_min_transform_block_size = 2 + bs_get_ue(bs);
-	/*log2_max_transform_block_size = log2_min_transform_block_size  + */bs_get_ue(bs);
+	log2_min_transform_block_size = 2 + gf_bs_read_ue(bs);
+	/*log2_max_transform_block_size = log2_min_transform_block_size  + */gf_bs_read_ue(bs);
 
 	depth = 0;
-	/*u32 max_transform_hierarchy_depth_inter = */bs_get_ue(bs);
-	/*u32 max_transform_hierarchy_depth_intra = */bs_get_ue(bs);
+	/*u32 max_transform_hierarchy_depth_inter = */gf_bs_read_ue(bs);
+	/*u32 max_transform_hierarchy_depth_intra = */gf_bs_read_ue(bs);
 	while( (u32) ( sps->max_CU_width >> log2_diff_max_min_luma_coding_block_size ) > (u32) ( 1 << ( log2_min_transform_block_size + depth )  ) )
 	{
 		depth++;
@@ -3427,18 +3384,18 @@ s32 gf_media_hevc_read_sps(char *data, u32 size, HEVCState *hevc)
 	if (/*pcm_enabled_flag= */ gf_bs_read_int(bs, 1) ) {
 		/*pcm_sample_bit_depth_luma_minus1=*/gf_bs_read_int(bs, 4);
 		/*pcm_sample_bit_depth_chroma_minus1=*/gf_bs_read_int(bs, 4);
-		/*log2_min_pcm_luma_coding_block_size_minus3= */ bs_get_ue(bs);
-		/*log2_diff_max_min_pcm_luma_coding_block_size = */ bs_get_ue(bs);
+		/*log2_min_pcm_luma_coding_block_size_minus3= */ gf_bs_read_ue(bs);
+		/*log2_diff_max_min_pcm_luma_coding_block_size = */ gf_bs_read_ue(bs);
 		/*pcm_loop_filter_disable_flag=*/gf_bs_read_int(bs, 1);
 	}
-	sps->num_short_term_ref_pic_sets = bs_get_ue(bs);
+	sps->num_short_term_ref_pic_sets = gf_bs_read_ue(bs);
 	for (i=0;i<sps->num_short_term_ref_pic_sets; i++) {
 		Bool ret = parse_short_term_ref_pic_set(bs, sps, i);
 		/*cannot parse short_term_ref_pic_set, skip VUI parsing*/
 		if (!ret) goto exit;
 	}
 	if (/*long_term_ref_pics_present_flag */ gf_bs_read_int(bs, 1) ) {
-		sps->num_long_term_ref_pic_sps = bs_get_ue(bs);
+		sps->num_long_term_ref_pic_sps = gf_bs_read_ue(bs);
 		for (i=0; i<sps->num_long_term_ref_pic_sps; i++) {
 			/*lt_ref_pic_poc_lsb_sps=*/gf_bs_read_int(bs, sps->log2_max_pic_order_cnt_lsb);
 			/*used_by_curr_pic_lt_sps_flag*/gf_bs_read_int(bs, 1);
@@ -3477,7 +3434,7 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 
 	gf_bs_read_u16(bs);
 
-	pps_id = bs_get_ue(bs);
+	pps_id = gf_bs_read_ue(bs);
 
 	if (pps_id>=64) goto exit;
 	pps = &hevc->pps[pps_id];
@@ -3486,22 +3443,22 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 		pps->id = pps_id;
 		pps->state = 1;
 	}
-	pps->sps_id = bs_get_ue(bs);
+	pps->sps_id = gf_bs_read_ue(bs);
 	hevc->sps_active_idx = pps->sps_id; /*set active sps*/
 	pps->dependent_slice_segments_enabled_flag = gf_bs_read_int(bs, 1);
 
 	/*sign_data_hiding_flag = */gf_bs_read_int(bs, 1);
 	/*cabac_init_present_flag = */gf_bs_read_int(bs, 1);
-	/*num_ref_idx_l0_default_active_minus1 = */bs_get_ue(bs);
-	/*num_ref_idx_l1_default_active_minus1 = */bs_get_ue(bs);
-	/*pic_init_qp_minus26 = */bs_get_se(bs);
+	/*num_ref_idx_l0_default_active_minus1 = */gf_bs_read_ue(bs);
+	/*num_ref_idx_l1_default_active_minus1 = */gf_bs_read_ue(bs);
+	/*pic_init_qp_minus26 = */gf_bs_read_se(bs);
 	/*constrained_intra_pred_flag = */gf_bs_read_int(bs, 1);
 	/*transform_skip_enabled_flag = */gf_bs_read_int(bs, 1);
 	if (/*cu_qp_delta_enabled_flag = */gf_bs_read_int(bs, 1) )
-		/*diff_cu_qp_delta_depth = */bs_get_ue(bs);
+		/*diff_cu_qp_delta_depth = */gf_bs_read_ue(bs);
 
-	/*pic_cb_qp_offset = */bs_get_se(bs);
-	/*pic_cr_qp_offset = */bs_get_se(bs);
+	/*pic_cb_qp_offset = */gf_bs_read_se(bs);
+	/*pic_cr_qp_offset = */gf_bs_read_se(bs);
 	/*pic_slice_chroma_qp_offsets_present_flag = */gf_bs_read_int(bs, 1);
 	/*weighted_pred_flag = */gf_bs_read_int(bs, 1);
 	/*weighted_bipred_flag = */gf_bs_read_int(bs, 1);
@@ -3510,15 +3467,15 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 	pps->tiles_enabled_flag = gf_bs_read_int(bs, 1);
 	/*entropy_coding_sync_enabled_flag = */gf_bs_read_int(bs, 1);
 	if (pps->tiles_enabled_flag) {
-		u32 num_tile_columns_minus1 = bs_get_ue(bs);
-		u32 num_tile_rows_minus1 = bs_get_ue(bs);
+		u32 num_tile_columns_minus1 = gf_bs_read_ue(bs);
+		u32 num_tile_rows_minus1 = gf_bs_read_ue(bs);
 		pps->uniform_spacing_flag = gf_bs_read_int(bs, 1);
 		if (!pps->uniform_spacing_flag ) {
 			for( i = 0; i < num_tile_columns_minus1; i++ ) {
-				/*column_width_minus1[ i ] = */bs_get_ue(bs);
+				/*column_width_minus1[ i ] = */gf_bs_read_ue(bs);
 			}
 			for( i = 0; i < num_tile_rows_minus1; i++ ) {
-				/*row_height_minus1[ i ] = */bs_get_ue(bs);
+				/*row_height_minus1[ i ] = */gf_bs_read_ue(bs);
 			}
 		}
 		/*loop_filter_across_tiles_enabled_flag	 = */gf_bs_read_int(bs, 1);
@@ -3527,8 +3484,8 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 	if( /*deblocking_filter_control_present_flag = */gf_bs_read_int(bs, 1)  ) {
 		/*deblocking_filter_override_enabled_flag= */gf_bs_read_int(bs, 1);
 		if (/*pic_disable_deblocking_filter_flag= */gf_bs_read_int(bs, 1) ) {
-			/*beta_offset_div2 = */bs_get_se(bs);
-			/*tc_offset_div2 = */bs_get_se(bs);
+			/*beta_offset_div2 = */gf_bs_read_se(bs);
+			/*tc_offset_div2 = */gf_bs_read_se(bs);
 		}
 	}
 	if (/*pic_scaling_list_data_present_flag	= */gf_bs_read_int(bs, 1) ) {
@@ -3536,7 +3493,7 @@ s32 gf_media_hevc_read_pps(char *data, u32 size, HEVCState *hevc)
 		assert(0 && "not implemented");
 	}
 	/*lists_modification_present_flag	= */gf_bs_read_int(bs, 1);
-	/*log2_parallel_merge_level_minus2 = */bs_get_ue(bs);
+	/*log2_parallel_merge_level_minus2 = */gf_bs_read_ue(bs);
 	pps->num_extra_slice_header_bits = gf_bs_read_int(bs, 3);
 	pps->slice_segment_header_extension_present_flag = gf_bs_read_int(bs, 1);
 	if ( /*pps_extension_flag= */gf_bs_read_int(bs, 1) ) {
@@ -1070,6 +1070,7 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 				/* It means we have to reparse the file ... */
 				/* parse the MPD */
 				mpd_parser = gf_xml_dom_new();
+				gf_xml_dom_use_arena(mpd_parser, 1);
 				e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
 				if (e != GF_OK) {
 					gf_xml_dom_del(mpd_parser);
@@ -2785,12 +2786,14 @@ restart_period:
 
 				group->max_bitrate = 0;
 				group->min_bitrate = (u32)-1;
+				gf_trace_begin("dash", "download_segment");
 				/*use persistent connection for segment downloads*/
 				if (use_byterange) {
 					e = gf_dash_download_resource(dash->dash_io, &(group->segment_download), new_base_seg_url, start_range, end_range, 1, group);
 				} else {
 					e = gf_dash_download_resource(dash->dash_io, &(group->segment_download), new_base_seg_url, 0, 0, 1, group);
 				}
+				gf_trace_end("dash", "download_segment");
 
 				/*TODO decide what is the best, fetch from another representation or ignore ...*/
 				if (e != GF_OK) {
@@ -3212,6 +3215,7 @@ GF_Err gf_dash_open(GF_DashClient *dash, const char *manifest_url)
 
 	/* parse the MPD */
 	mpd_parser = gf_xml_dom_new();
+	gf_xml_dom_use_arena(mpd_parser, 1);
 	e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
 	if (e != GF_OK) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot connect service: MPD parsing problem %s\n", gf_xml_dom_get_error(mpd_parser) ));
@@ -33,6 +33,14 @@
 #endif
 #include "../../include/gpac/internal/isomedia_dev.h"
 
+/*zero-copy serving of indexed files*/
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_ANDROID)
+#include <sys/sendfile.h>
+#include <sys/select.h>
+#include <errno.h>
+#define DASH_INDEX_USE_SENDFILE
+#endif
+
 #ifdef GPAC_DISABLE_ISOM
 /*we should need a better way to work with sidx when no isom is defined*/
 #define GPAC_DISABLE_MPEG2TS
@@ -40,6 +48,15 @@
 
 
 typedef struct _dash_segment_input GF_DashSegInput;
+typedef struct _ts_segmenter GF_TSSegmenter;
+
+typedef struct
+{
+	/*media time in the input, in seconds*/
+	Double media_time;
+	/*gf_sys_clock_high_res() value when this media time was first available*/
+	u64 clock;
+} GF_DashSegArrival;
 
 struct _dash_component
 {
@@ -79,6 +96,19 @@ typedef struct
 	GF_Config *dash_ctx;
 
 	const char *tmpdir;
+
+	/*the input may grow: once all its samples are segmented, its position is kept in the context instead of restarting from its beginning*/
+	Bool follow_input_growth;
+
+	/*low-latency chunked segments: number of reference track samples per fragment, 0 if disabled*/
+	u32 chunk_frames;
+	gf_dasher_chunk_callback on_chunk;
+	void *on_chunk_udta;
+	/*segment being produced, for chunk callbacks*/
+	const char *chunk_segment_name;
+
+	/*start of the current period in the session, added to the segment start times stored in the context*/
+	Double period_start;
 } GF_DASHSegmenterOptions;
 
 struct _dash_segment_input
@@ -112,6 +142,28 @@ struct _dash_segment_input
 	Double duration;
 	struct _dash_component components[20];
 	u32 nb_components;
+
+	/*MPEG-2 TS only: earliest PTS of the input, origin of the segment boundaries agreed between the representations
+	of the adaptation set, and indexing state kept until the input is segmented*/
+	u64 first_PTS;
+	Bool has_boundary_origin;
+	u64 boundary_origin;
+	GF_TSSegmenter *ts_seg;
+
+	/*live segmenter session only: the ISO input is kept open between update cycles, and the file size and modification
+	time are checked at each cycle to detect media appended to the input*/
+	GF_ISOFile *isom_file;
+	u64 file_size, file_mtime;
+	Bool has_changed;
+	/*duration of the media available in a growing input, and wall-clock times at which this media was first seen, used
+	to measure the latency between input sample arrival and segment availability*/
+	Double available_duration;
+	GF_DashSegArrival *arrivals;
+	u32 nb_arrivals, nb_alloc_arrivals;
+	/*media duration already segmented*/
+	Double segmented_duration;
+	/*set by dasher_segment_file when the end of the input has been segmented*/
+	Bool input_done;
 };
 
 
@@ -238,7 +290,7 @@ GF_Err gf_dasher_store_segment_info(GF_DASHSegmenterOptions *dash_cfg, const cha
 	char szKey[512];
 	if (!dash_cfg->dash_ctx) return GF_OK;
 
-	sprintf(szKey, "%g", segStartTime);
+	sprintf(szKey, "%g", dash_cfg->period_start + segStartTime);
 	return gf_cfg_set_key(dash_cfg->dash_ctx, "SegmentsStartTimes", SegmentName, szKey);
 }
 
@@ -326,6 +378,7 @@ typedef struct
 	u64 last_sample_cts, next_sample_dts;
 	Bool all_sample_raps, splitable;
 	u32 split_sample_dts_shift;
+	u32 FragmentSampleCount;
 } GF_ISOMTrackFragmenter;
 
 static u64 isom_get_next_sap_time(GF_ISOFile *input, u32 track, u32 sample_count, u32 sample_num)
@@ -352,6 +405,12 @@ static u64 isom_get_next_sap_time(GF_ISOFile *input, u32 track, u32 sample_count
 	return time;
 }
 
+static void dasher_on_segment_chunk(void *udta, char *data, u32 size, u64 offset, Bool segment_end)
+{
+	GF_DASHSegmenterOptions *dash_cfg = (GF_DASHSegmenterOptions *)udta;
+	dash_cfg->on_chunk(dash_cfg->on_chunk_udta, dash_cfg->chunk_segment_name, data, size, offset, segment_end);
+}
+
 static GF_Err gf_media_isom_segment_file(GF_ISOFile *input, const char *output_file, Double max_duration_sec, GF_DASHSegmenterOptions *dash_cfg, GF_DashSegInput *dash_input, Bool first_in_set)
 {
 	u8 NbBits;
@@ -590,7 +649,7 @@ static GF_Err gf_media_isom_segment_file(GF_ISOFile *input, const char *output_f
 		avctype = gf_isom_get_avc_svc_type(input, i+1, 1);
 		if (avctype==GF_ISOM_AVCTYPE_AVC_ONLY) {
 			/*for AVC we concatenate SPS/PPS*/
-			if (dash_cfg->inband_param_set)
+			if (dash_cfg && dash_cfg->inband_param_set)
 				gf_isom_set_nalu_extract_mode(input, i+1, GF_ISOM_NALU_EXTRACT_INBAND_PS_FLAG);
 		}
 		else if (avctype > GF_ISOM_AVCTYPE_AVC_ONLY) {
@@ -774,6 +833,12 @@ static GF_Err gf_media_isom_segment_file(GF_ISOFile *input, const char *output_f
 	ref_track_id = tfref->TrackID;
 	if (tfref->all_sample_raps) split_seg_at_rap = 1;
 
+	/*chunked segments: fragment duration is given by the number of frames per chunk*/
+	if (dash_cfg && dash_cfg->chunk_frames && tfref->DefaultDuration) {
+		max_duration_sec = (Double) dash_cfg->chunk_frames * tfref->DefaultDuration / tfref->TimeScale;
+		MaxFragmentDuration = (u32) (max_duration_sec * 1000);
+	}
+
 
 	if (!dash_moov_setup) {
 		max_track_duration /= gf_isom_get_timescale(input);
@@ -788,12 +853,18 @@ static GF_Err gf_media_isom_segment_file(GF_ISOFile *input, const char *output_f
 	e = gf_isom_finalize_for_fragment(output, dash_cfg ? 1 : 0);
 	if (e) goto err_exit;
 
+	if (dash_cfg && dash_cfg->chunk_frames) {
+		dash_cfg->chunk_segment_name = gf_isom_get_filename(output);
+		e = gf_isom_set_segment_chunk_mode(output, 1, ref_track_id, (dash_cfg->subsegs_per_sidx>=0) ? 1 : 0, dash_cfg->on_chunk ? dasher_on_segment_chunk : NULL, dash_cfg);
+		if (e) goto err_exit;
+	}
+
 	start_range = 0;
 	file_size = gf_isom_get_file_size(bs_switch_segment ? bs_switch_segment : output);
 	end_range = file_size - 1;
 	init_seg_size = file_size;
 
-	if (dash_cfg->dash_ctx) {
+	if (dash_cfg && dash_cfg->dash_ctx) {
 		if (store_dash_params) {
 			char szVal[1024];
 			sprintf(szVal, LLU, init_seg_size);
@@ -834,7 +905,7 @@ restart_fragmentation_pass:
 	ref_track_next_cts = 0;
 
 	/*setup previous URL list*/
-	if (dash_cfg->dash_ctx) {
+	if (dash_cfg && dash_cfg->dash_ctx) {
 		const char *opt;
 		char sKey[100];
 		count = gf_cfg_get_key_count(dash_cfg->dash_ctx, RepURLsSecName);
@@ -896,6 +967,7 @@ restart_fragmentation_pass:
 				if (seg_rad_name) {
 					gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_SEGMENT, is_bs_switching, SegmentName, output_file, dash_input->representationID, seg_rad_name, !stricmp(seg_ext, "null") ? NULL : seg_ext, (u64) ( period_duration * timeline_timescale + segment_start_time), bandwidth, cur_seg);
 					e = gf_isom_start_segment(output, SegmentName);
+					if (dash_cfg->chunk_frames) dash_cfg->chunk_segment_name = SegmentName;
 
 					gf_dasher_store_segment_info(dash_cfg, SegmentName, period_duration + segment_start_time / 1000.0);
 
@@ -1082,6 +1154,7 @@ restart_fragmentation_pass:
 					tf->split_sample_dts_shift = 0;
 				}
 				tf->FragmentLength += defaultDuration;
+				tf->FragmentSampleCount++;
 
 				/*compute SAP type*/
 				if (sample) {
@@ -1147,8 +1220,12 @@ restart_fragmentation_pass:
 				if (tf->SampleNum==tf->SampleCount) {
 					stop_frag = 1;
 				} else if (tf==tfref) {
+					/*chunked segments: no more than chunk_frames samples per fragment*/
+					if (dash_cfg && dash_cfg->chunk_frames && (tf->FragmentSampleCount >= dash_cfg->chunk_frames)) {
+						stop_frag = 1;
+					}
 					/*fragmenting on "clock" track: no drift control*/
-					if (!(dash_cfg ? dash_cfg->fragments_start_with_rap : 0) || ( (next && next->IsRAP) || split_at_rap) ) {
+					else if (!(dash_cfg ? dash_cfg->fragments_start_with_rap : 0) || ( (next && next->IsRAP) || split_at_rap) ) {
 						if (tf->FragmentLength*1000 >= MaxFragmentDuration*tf->TimeScale) {
 							stop_frag = 1;
 						}
@@ -1164,10 +1241,13 @@ restart_fragmentation_pass:
 				if (stop_frag) {
 					gf_isom_sample_del(&sample);
 					sample = next = NULL;
-					if (maxFragDurationOverSegment<=tf->FragmentLength*1000/tf->TimeScale) {
+					/*chunked segments: other tracks may overlap the reference track by a few samples in each chunk, only use the reference track duration*/
+					if ((!dash_cfg || !dash_cfg->chunk_frames || !tfref || (tf==tfref))
+					        && (maxFragDurationOverSegment<=tf->FragmentLength*1000/tf->TimeScale)) {
 						maxFragDurationOverSegment = tf->FragmentLength*1000/tf->TimeScale;
 					}
 					tf->FragmentLength = 0;
+					tf->FragmentSampleCount = 0;
 					if (split_sample_duration)
 						tf->split_sample_dts_shift += defaultDuration;
 
@@ -1265,6 +1345,7 @@ restart_fragmentation_pass:
 			tf->last_sample_cts = 0;
 			tf->next_sample_dts = 0;
 			tf->FragmentLength = 0;
+			tf->FragmentSampleCount = 0;
 			tf->SampleNum = 0;
 			if (tf->is_ref_track) tfref = tf;
 		}
@@ -1454,24 +1535,26 @@ restart_fragmentation_pass:
 			tf = (GF_ISOMTrackFragmenter *)gf_list_get(fragmenters, i);
 
 			/*InitialTSOffset is used when joining different files - if we are still in the same file , do not update it*/
-			if (tf->done) {
+			if (tf->done && !dash_cfg->follow_input_growth) {
 				sprintf(sKey, "TKID_%d_NextDecodingTime", tf->TrackID);
 				sprintf(sOpt, LLU, tf->InitialTSOffset + tf->next_sample_dts);
 				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, sOpt);
 			}
 
 			if (dash_cfg->subduration) {
+				/*restart from the beginning of the input once done, unless we wait for more media to be appended to it*/
+				Bool restart = (tf->done && !dash_cfg->follow_input_growth) ? 1 : 0;
 				sprintf(sKey, "TKID_%d_NextSampleNum", tf->TrackID);
 				sprintf(sOpt, "%d", tf->SampleNum);
-				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, tf->done ? NULL : sOpt);
+				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, restart ? NULL : sOpt);
 
 				sprintf(sKey, "TKID_%d_LastSampleCTS", tf->TrackID);
 				sprintf(sOpt, LLU, tf->last_sample_cts);
-				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, tf->done ? NULL : sOpt);
+				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, restart ? NULL : sOpt);
 
 				sprintf(sKey, "TKID_%d_NextSampleDTS", tf->TrackID);
 				sprintf(sOpt, LLU, tf->next_sample_dts);
-				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, tf->done ? NULL : sOpt);
+				gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, sKey, restart ? NULL : sOpt);
 			}
 		}
 		sprintf(sOpt, "%d", cur_seg);
@@ -1485,6 +1568,8 @@ restart_fragmentation_pass:
 		sprintf(sOpt, "%f", period_duration);
 		gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, "CumulatedDuration", sOpt);
 
+		dash_input->input_done = (nb_tracks_done==gf_list_count(fragmenters)) ? 1 : 0;
+
 		if (store_dash_params) {
 			sprintf(sOpt, "%u", bandwidth);
 			gf_cfg_set_key(dash_cfg->dash_ctx, RepSecName, "Bandwidth", sOpt);
@@ -1518,8 +1603,9 @@ static GF_Err dasher_isom_get_input_components_info(GF_DashSegInput *input, GF_D
 	GF_ISOFile *in;
 	Double dur;
 
-	in = gf_isom_open(input->file_name, GF_ISOM_OPEN_READ, NULL);
+	in = input->isom_file ? input->isom_file : gf_isom_open(input->file_name, GF_ISOM_OPEN_READ, NULL);
 	input->duration = 0;
+	input->nb_components = 0;
 	for (i=0; i<gf_isom_get_track_count(in); i++) {
 		u32 mtype = gf_isom_get_media_type(in, i+1);
 
@@ -1556,6 +1642,7 @@ static GF_Err dasher_isom_get_input_components_info(GF_DashSegInput *input, GF_D
 
 		input->nb_components++;
 	}
+	if (in == input->isom_file) return GF_OK;
 	return gf_isom_close(in);
 }
 
@@ -1829,9 +1916,9 @@ static GF_Err dasher_isom_create_init_segment(GF_DashSegInput *dash_inputs, u32
 
 static GF_Err dasher_isom_segment_file(GF_DashSegInput *dash_input, const char *szOutName, GF_DASHSegmenterOptions *dash_cfg, Bool first_in_set)
 {
-	GF_ISOFile *in = gf_isom_open(dash_input->file_name, GF_ISOM_OPEN_READ, dash_cfg->tmpdir);
+	GF_ISOFile *in = dash_input->isom_file ? dash_input->isom_file : gf_isom_open(dash_input->file_name, GF_ISOM_OPEN_READ, dash_cfg->tmpdir);
 	GF_Err e = gf_media_isom_segment_file(in, szOutName, dash_cfg->fragment_duration, dash_cfg, dash_input, first_in_set);
-	gf_isom_close(in);
+	if (in != dash_input->isom_file) gf_isom_close(in);
 	return e;
 }
 #endif /*GPAC_DISABLE_ISOM_FRAGMENTS*/
@@ -1972,7 +2059,7 @@ static GF_Err dasher_generic_get_components_info(GF_DashSegInput *input, GF_DASH
 
 #ifndef GPAC_DISABLE_MPEG2TS
 
-typedef struct
+struct _ts_segmenter
 {
 	FILE *src;
 	GF_M2TS_Demuxer *ts;
@@ -2070,7 +2157,14 @@ typedef struct
 	Bool first_pcr_position_valid;
 	u32 prev_last_pcr_position;
 
-} GF_TSSegmenter;
+	/*segment boundaries shared with the other representations: segments are cut at fixed times from the origin*/
+	Bool has_boundary_origin;
+	u64 boundary_origin;
+	u32 nb_boundaries;
+
+	/*PCR offset for the next call in dash context mode, computed at the end of the indexing*/
+	u64 next_pcr_shift;
+};
 
 static void m2ts_sidx_add_entry(GF_SegmentIndexBox *sidx, Bool ref_type,
 								u32 size, u32 duration, Bool first_is_SAP, u32 sap_type, u32 RAP_delta_time)
@@ -2258,6 +2352,20 @@ static void m2ts_check_indexing(GF_TSSegmenter *index_info)
 {
 	u32 delta_time = (u32)(index_info->last_PTS - index_info->base_PTS);
 	u32 segment_duration = (u32)(index_info->segment_duration*90000);
+
+	if (index_info->has_boundary_origin) {
+		/*cut at the first PES past the next boundary of the shared schedule, so that representations stay aligned*/
+		u64 next_boundary = index_info->boundary_origin + (u64) (index_info->nb_boundaries+1) * segment_duration;
+		if (!segment_duration || (index_info->last_PTS < next_boundary)) return;
+		while (index_info->last_PTS >= next_boundary) {
+			index_info->nb_boundaries++;
+			next_boundary += segment_duration;
+		}
+		/*input starting after the origin, skip the boundaries before its first PES*/
+		if (index_info->last_PTS == index_info->base_PTS) return;
+		m2ts_sidx_flush_entry(index_info);
+		return;
+	}
 	/* we exceed the segment duration flush sidx entry*/
 	if (delta_time >= segment_duration) {
 		m2ts_sidx_flush_entry(index_info);
@@ -2515,6 +2623,7 @@ static GF_Err dasher_mp2t_get_components_info(GF_DashSegInput *dash_input, GF_DA
 	if (e) return e;
 
 	dash_input->duration = (ts_seg.last_PTS + ts_seg.last_frame_duration - ts_seg.first_PTS)/90000.0;
+	dash_input->first_PTS = ts_seg.first_PTS;
 	dasher_del_ts_demux(&ts_seg);
 
 	return GF_OK;
@@ -2522,6 +2631,89 @@ static GF_Err dasher_mp2t_get_components_info(GF_DashSegInput *dash_input, GF_DA
 
 #define NB_TSPCK_IO_BYTES 18800
 
+/*indexes the TS input - the resulting state is kept in the input until it is segmented. This may run in a worker thread*/
+/*szSectionName is the representation section in the DASH context, ignored if no context*/
+static GF_Err dasher_mp2t_index_file(GF_DashSegInput *dash_input, GF_DASHSegmenterOptions *dash_cfg, const char *szSectionName)
+{
+	GF_TSSegmenter *ts_seg;
+	GF_Err e;
+
+	if (dash_input->ts_seg) return GF_OK;
+	GF_SAFEALLOC(ts_seg, GF_TSSegmenter);
+	if (!ts_seg) return GF_OUT_OF_MEM;
+
+	e = dasher_get_ts_demux(ts_seg, dash_input->file_name, 0);
+	if (e) {
+		gf_free(ts_seg);
+		return e;
+	}
+
+	ts_seg->segment_duration = dash_cfg->segment_duration;
+	ts_seg->segment_at_rap = dash_cfg->segments_start_with_rap;
+
+	ts_seg->bandwidth = (u32) (ts_seg->file_size * 8 / dash_input->duration);
+
+	ts_seg->PCR_DTS_initial_diff = (u64) -1;
+	ts_seg->subduration = (u32) (dash_cfg->subduration * 90000);
+	ts_seg->has_boundary_origin = dash_input->has_boundary_origin;
+	ts_seg->boundary_origin = dash_input->boundary_origin;
+
+	if (dash_cfg->dash_ctx) {
+		const char *opt;
+
+		/*restart where we left last time*/
+		opt = gf_cfg_get_key(dash_cfg->dash_ctx, szSectionName, "ByteOffset");
+		if (opt) {
+			u64 offset;
+			sscanf(opt, LLU, &offset);
+
+			while (!feof(ts_seg->src) && !ts_seg->has_seen_pat) {
+				char data[NB_TSPCK_IO_BYTES];
+				u32 size = fread(data, 1, NB_TSPCK_IO_BYTES, ts_seg->src);
+				gf_m2ts_process_data(ts_seg->ts, data, size);
+
+				if (size<NB_TSPCK_IO_BYTES) break;
+			}
+			gf_m2ts_reset_parsers(ts_seg->ts);
+
+			gf_f64_seek(ts_seg->src, offset, SEEK_SET);
+			ts_seg->base_offset = offset;
+			ts_seg->ts->pck_number = (u32) (offset/188);
+		}
+
+		opt = gf_cfg_get_key(dash_cfg->dash_ctx, szSectionName, "InitialDTSOffset");
+		if (opt) sscanf(opt, LLU, &ts_seg->PCR_DTS_initial_diff);
+	}
+
+	/*index the file*/
+	while (!feof(ts_seg->src) && !ts_seg->suspend_indexing) {
+		char data[NB_TSPCK_IO_BYTES];
+		u32 size = fread(data, 1, NB_TSPCK_IO_BYTES, ts_seg->src);
+		gf_m2ts_process_data(ts_seg->ts, data, size);
+		if (size<NB_TSPCK_IO_BYTES) break;
+	}
+	if (feof(ts_seg->src)) ts_seg->suspend_indexing = 0;
+
+	ts_seg->next_pcr_shift = 0;
+	if (!ts_seg->suspend_indexing) {
+		ts_seg->next_pcr_shift = ts_seg->last_DTS + ts_seg->last_frame_duration - ts_seg->PCR_DTS_initial_diff;
+	}
+
+	/* flush SIDX entry for the last packets */
+	m2ts_sidx_flush_entry(ts_seg);
+	m2ts_sidx_finalize_size(ts_seg, ts_seg->file_size);
+	if (!ts_seg->sidx) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH]: No PES found on reference PID of %s, cannot index\n", dash_input->file_name));
+		dasher_del_ts_demux(ts_seg);
+		gf_free(ts_seg);
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH]: Indexing done (1 sidx, %d entries).\n", ts_seg->sidx->nb_refs));
+
+	dash_input->ts_seg = ts_seg;
+	return GF_OK;
+}
+
 static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *szOutName, GF_DASHSegmenterOptions *dash_cfg, Bool first_in_set)
 {
 	GF_TSSegmenter ts_seg;
@@ -2529,7 +2721,7 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 	u8 is_pes[GF_M2TS_MAX_STREAMS];
 	char szOpt[100];
 	char SegName[GF_MAX_PATH], IdxName[GF_MAX_PATH];
-	char szSectionName[100], szRepURLsSecName[100];
+	char szSectionName[200], szRepURLsSecName[200];
 	char szCodecs[100];
 	const char *opt;
 	u32 i, startNumberRewind;
@@ -2541,14 +2733,20 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 	/*compute name for indexed segments*/
 	const char *basename = gf_url_get_resource_name(szOutName);
 
-	/*perform indexation of the file, this info will be destroyed at the end of the segment file routine*/
-	e = dasher_get_ts_demux(&ts_seg, dash_input->file_name, 0);
-	if (e) return e;
-
-	ts_seg.segment_duration = dash_cfg->segment_duration;
-	ts_seg.segment_at_rap = dash_cfg->segments_start_with_rap;
+	szSectionName[0] = 0;
+	if (dash_cfg->dash_ctx) {
+		snprintf(szSectionName, sizeof(szSectionName), "Representation_%s", dash_input->representationID);
+		snprintf(szRepURLsSecName, sizeof(szRepURLsSecName), "URLs_%s", dash_input->representationID);
+	}
 
-	ts_seg.bandwidth = (u32) (ts_seg.file_size * 8 / dash_input->duration);
+	/*perform indexation of the file if not done yet, this info will be destroyed at the end of the segment file routine*/
+	e = dasher_mp2t_index_file(dash_input, dash_cfg, szSectionName);
+	if (e) return e;
+	ts_seg = *dash_input->ts_seg;
+	ts_seg.ts->user = &ts_seg;
+	gf_free(dash_input->ts_seg);
+	dash_input->ts_seg = NULL;
+	e = GF_OK;
 
 	/*create bitstreams*/
 
@@ -2584,56 +2782,7 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 
 	gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_REPINDEX, 1, IdxName, basename, dash_input->representationID, dash_cfg->seg_rad_name, "six", 0, 0, 0);
 
-	ts_seg.PCR_DTS_initial_diff = (u64) -1;
-	ts_seg.subduration = (u32) (dash_cfg->subduration * 90000);
-
-	szSectionName[0] = 0;
-	if (dash_cfg->dash_ctx) {
-		sprintf(szSectionName, "Representation_%s", dash_input->representationID);
-		sprintf(szRepURLsSecName, "URLs_%s", dash_input->representationID);
-
-		/*restart where we left last time*/
-		opt = gf_cfg_get_key(dash_cfg->dash_ctx, szSectionName, "ByteOffset");
-		if (opt) {
-			u64 offset;
-			sscanf(opt, LLU, &offset);
-
-			while (!feof(ts_seg.src) && !ts_seg.has_seen_pat) {
-				char data[NB_TSPCK_IO_BYTES];
-				u32 size = fread(data, 1, NB_TSPCK_IO_BYTES, ts_seg.src);
-				gf_m2ts_process_data(ts_seg.ts, data, size);
-
-				if (size<NB_TSPCK_IO_BYTES) break;
-			}
-			gf_m2ts_reset_parsers(ts_seg.ts);
-
-			gf_f64_seek(ts_seg.src, offset, SEEK_SET);
-			ts_seg.base_offset = offset;
-			ts_seg.ts->pck_number = (u32) (offset/188);
-		}
-
-		opt = gf_cfg_get_key(dash_cfg->dash_ctx, szSectionName, "InitialDTSOffset");
-		if (opt) sscanf(opt, LLU, &ts_seg.PCR_DTS_initial_diff);
-	}
-
-	/*index the file*/
-	while (!feof(ts_seg.src) && !ts_seg.suspend_indexing) {
-		char data[NB_TSPCK_IO_BYTES];
-		u32 size = fread(data, 1, NB_TSPCK_IO_BYTES, ts_seg.src);
-		gf_m2ts_process_data(ts_seg.ts, data, size);
-		if (size<NB_TSPCK_IO_BYTES) break;
-	}
-	if (feof(ts_seg.src)) ts_seg.suspend_indexing = 0;
-
-	next_pcr_shift = 0;
-	if (!ts_seg.suspend_indexing) {
-		next_pcr_shift = ts_seg.last_DTS + ts_seg.last_frame_duration - ts_seg.PCR_DTS_initial_diff;
-	}
-
-	/* flush SIDX entry for the last packets */
-	m2ts_sidx_flush_entry(&ts_seg);
-	m2ts_sidx_finalize_size(&ts_seg, ts_seg.file_size);
-	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH]: Indexing done (1 sidx, %d entries).\n", ts_seg.sidx->nb_refs));
+	next_pcr_shift = ts_seg.next_pcr_shift;
 
 	gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_REPINDEX, 1, IdxName, basename, dash_input->representationID, gf_url_get_resource_name(dash_cfg->seg_rad_name), "six", 0, 0, 0);
 
@@ -2900,6 +3049,8 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 
 		sprintf(szOpt, "%g", cumulated_duration);
 		gf_cfg_set_key(dash_cfg->dash_ctx, szSectionName, "CumulatedDuration", szOpt);
+
+		dash_input->input_done = ts_seg.suspend_indexing ? 0 : 1;
 	}
 
 	if (ts_seg.sidx && ts_seg.index_bs) {
@@ -2920,6 +3071,152 @@ exit:
 	return e;
 }
 
+static u32 dasher_nb_threads = 0;
+
+GF_EXPORT
+void gf_dasher_set_threads(u32 nb_threads)
+{
+	dasher_nb_threads = nb_threads;
+}
+
+typedef struct
+{
+	GF_DashSegInput **inputs;
+	u32 nb_inputs, next_input;
+	GF_DASHSegmenterOptions *opts;
+	GF_Mutex *mx;
+	GF_Err e;
+} GF_DashIndexJob;
+
+static u32 dasher_mp2t_index_worker(void *par)
+{
+	GF_DashIndexJob *job = (GF_DashIndexJob *)par;
+	while (1) {
+		GF_DashSegInput *dash_input;
+		char szSectionName[200];
+		GF_Err e;
+
+		gf_mx_p(job->mx);
+		if (job->e || (job->next_input == job->nb_inputs)) {
+			gf_mx_v(job->mx);
+			break;
+		}
+		dash_input = job->inputs[job->next_input];
+		job->next_input++;
+		gf_mx_v(job->mx);
+
+		snprintf(szSectionName, sizeof(szSectionName), "Representation_%s", dash_input->representationID);
+		e = dasher_mp2t_index_file(dash_input, job->opts, szSectionName);
+		if (e) {
+			gf_mx_p(job->mx);
+			if (!job->e) job->e = e;
+			gf_mx_v(job->mx);
+		}
+	}
+	return 0;
+}
+
+/*checks that the segment boundaries of all representations match the ones of the first representation, within one
+frame, on the time range they have in common*/
+static void dasher_mp2t_check_boundaries(GF_DashSegInput **inputs, u32 nb_inputs)
+{
+	u32 i, k, r;
+	u64 ref_start, ref_end, t_ref, t;
+	GF_TSSegmenter *ref = inputs[0]->ts_seg;
+
+	ref_start = ref->sidx->earliest_presentation_time;
+	ref_end = ref_start;
+	for (k=0; k<ref->sidx->nb_refs; k++) ref_end += ref->sidx->refs[k].subsegment_duration;
+
+	for (i=1; i<nb_inputs; i++) {
+		u32 tolerance;
+		GF_TSSegmenter *ts_seg = inputs[i]->ts_seg;
+
+		tolerance = MAX(ref->last_frame_duration, ts_seg->last_frame_duration);
+		t_ref = ref_start;
+		t = ts_seg->sidx->earliest_presentation_time;
+		r = 0;
+		/*the first segment of each representation may start anywhere*/
+		for (k=1; k<ts_seg->sidx->nb_refs; k++) {
+			t += ts_seg->sidx->refs[k-1].subsegment_duration;
+			if ((t <= ref_start) || (t >= ref_end)) continue;
+			while ((r < ref->sidx->nb_refs) && (t_ref + tolerance < t)) {
+				t_ref += ref->sidx->refs[r].subsegment_duration;
+				r++;
+			}
+			if ((t > t_ref + tolerance) || (t_ref > t + tolerance)) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH]: Segment %d of representation %s starts at %g sec, no segment of representation %s starts there - segments are not aligned\n", k+1, inputs[i]->representationID, (Double) (s64) t / 90000.0, inputs[0]->representationID));
+				break;
+			}
+		}
+	}
+}
+
+/*indexes all TS representations of the adaptation set before segmenting them. The representations agree on a common
+origin for their segment boundaries (the earliest first PTS), so that segments are cut at the same times in all of them.
+Indexing is run on dasher_nb_threads threads, the calling thread being one of them*/
+static GF_Err dasher_mp2t_index_adaptation_set(GF_DashSegInput *dash_inputs, u32 nb_dash_inputs, u32 adaptation_set, GF_DASHSegmenterOptions *opts)
+{
+	u32 i, nb_threads;
+	u64 origin = 0;
+	GF_DashIndexJob job;
+	GF_Thread **threads;
+
+	memset(&job, 0, sizeof(GF_DashIndexJob));
+	job.inputs = (GF_DashSegInput **) gf_malloc(sizeof(GF_DashSegInput *) * nb_dash_inputs);
+	if (!job.inputs) return GF_OUT_OF_MEM;
+	for (i=0; i<nb_dash_inputs; i++) {
+		if (dash_inputs[i].adaptation_set != adaptation_set) continue;
+		if (dash_inputs[i].dasher_segment_file != dasher_mp2t_segment_file) continue;
+		if (!job.nb_inputs || (dash_inputs[i].first_PTS < origin)) origin = dash_inputs[i].first_PTS;
+		job.inputs[job.nb_inputs] = &dash_inputs[i];
+		job.nb_inputs++;
+	}
+	if (job.nb_inputs < 2) {
+		gf_free(job.inputs);
+		return GF_OK;
+	}
+	for (i=0; i<job.nb_inputs; i++) {
+		job.inputs[i]->has_boundary_origin = 1;
+		job.inputs[i]->boundary_origin = origin;
+	}
+
+	nb_threads = dasher_nb_threads ? dasher_nb_threads : 1;
+	if (nb_threads > job.nb_inputs) nb_threads = job.nb_inputs;
+	job.opts = opts;
+	job.mx = gf_mx_new("DashIndex");
+
+	threads = (GF_Thread **) gf_malloc(sizeof(GF_Thread *) * nb_threads);
+	for (i=1; i<nb_threads; i++) {
+		threads[i] = gf_th_new("DashIndex");
+		gf_th_run(threads[i], dasher_mp2t_index_worker, &job);
+	}
+	dasher_mp2t_index_worker(&job);
+	for (i=1; i<nb_threads; i++) {
+		gf_th_del(threads[i]);
+	}
+	gf_free(threads);
+	gf_mx_del(job.mx);
+
+	if (!job.e) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH]: Indexed %d representations using %d threads\n", job.nb_inputs, nb_threads));
+		dasher_mp2t_check_boundaries(job.inputs, job.nb_inputs);
+	}
+	gf_free(job.inputs);
+	return job.e;
+}
+
+/*destroys indexing states of inputs not segmented because of an error*/
+static void dasher_mp2t_reset_index(GF_DashSegInput *dash_input)
+{
+	if (!dash_input->ts_seg) return;
+	if (dash_input->ts_seg->sidx) gf_isom_box_del((GF_Box *)dash_input->ts_seg->sidx);
+	if (dash_input->ts_seg->pcrb) gf_isom_box_del((GF_Box *)dash_input->ts_seg->pcrb);
+	dasher_del_ts_demux(dash_input->ts_seg);
+	gf_free(dash_input->ts_seg);
+	dash_input->ts_seg = NULL;
+}
+
 #endif //GPAC_DISABLE_MPEG2TS
 
 GF_Err gf_dash_segmenter_probe_input(GF_DashSegInput *dash_input)
@@ -3062,7 +3359,7 @@ static GF_Err write_period_header(FILE *mpd, const char *szID, Double period_sta
 		s = period_start - h*3600 - m*60;
 		fprintf(mpd, " start=\"PT%dH%dM%.2fS\"", h, m, s);
 	}
-	if (!dash_dynamic && period_duration) {
+	if (period_duration) {
 		h = (u32) (period_duration/3600);
 		m = (u32) (period_duration-h*60)/60;
 		s = period_duration - h*3600 - m*60;
@@ -3251,6 +3548,9 @@ u32 gf_dasher_next_update_time(GF_Config *dash_ctx, u32 mpd_update_time)
 		if (section && !strncmp(section, "Representation_", 15)) {
 			opt = gf_cfg_get_key(dash_ctx, section, "CumulatedDuration");
 			if (opt) dur = atof(opt);
+			/*representations of live periods other than the first one*/
+			opt = gf_cfg_get_key(dash_ctx, section, "PeriodStart");
+			if (opt) dur += atof(opt);
 			if (dur>max_dur) max_dur = dur;
 		}
 	}
@@ -3271,8 +3571,19 @@ u32 gf_dasher_next_update_time(GF_Config *dash_ctx, u32 mpd_update_time)
 	return 0;
 }
 
-/*peform all file cleanup*/
-static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double dash_duration)
+static GF_Err dasher_purge_segment(void *par)
+{
+	char *fileName = (char *)par;
+	GF_Err e = gf_delete_file(fileName);
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Could not remove file %s: %s\n", fileName, gf_error_to_string(e) ));
+	}
+	gf_free(fileName);
+	return GF_OK;
+}
+
+/*peform all file cleanup - if a purge pool is given, expired segments are deleted by the pool*/
+static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double dash_duration, Bool follow_input_growth, GF_TaskPool *purge_pool, GF_TaskGroup *purge_group)
 {
 	Double max_dur = 0;
 	Double ellapsed = 0;
@@ -3295,6 +3606,9 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 		if (section && !strncmp(section, "Representation_", 15)) {
 			opt = gf_cfg_get_key(dash_ctx, section, "CumulatedDuration");
 			if (opt) dur = atof(opt);
+			/*representations of live periods other than the first one*/
+			opt = gf_cfg_get_key(dash_ctx, section, "PeriodStart");
+			if (opt) dur += atof(opt);
 			if (dur>max_dur) max_dur = dur;
 		}
 	}
@@ -3303,6 +3617,10 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 
 	if (dash_dynamic==2) {
 		ellapsed = (u32)-1;
+	}
+	/*growing inputs: the live edge is the end of the segmented media, whatever the wall clock*/
+	else if (follow_input_growth) {
+		ellapsed = max_dur;
 	} else {
 		ellapsed = ntp_sec;
 		ellapsed -= prev_sec;
@@ -3334,10 +3652,14 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 			if (seg_time + dash_duration + time_shift_depth >= ellapsed )
 				break;
 
-			e = gf_delete_file(fileName);
-			if (e) {
-				GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Could not remove file %s: %s\n", fileName, gf_error_to_string(e) ));
-				break;
+			if (purge_pool) {
+				gf_task_pool_submit(purge_pool, purge_group, GF_TASK_PRIORITY_LOW, dasher_purge_segment, gf_strdup(fileName));
+			} else {
+				e = gf_delete_file(fileName);
+				if (e) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Could not remove file %s: %s\n", fileName, gf_error_to_string(e) ));
+					break;
+				}
 			}
 
 			/*check all reps*/
@@ -3365,117 +3687,567 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 }
 
 
-/*dash segmenter*/
-GF_EXPORT
-GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *inputs, u32 nb_dash_inputs, GF_DashProfile dash_profile,
-							   const char *mpd_title, const char *mpd_source, const char *mpd_copyright,
-							   const char *mpd_moreInfoURL, const char **mpd_base_urls, u32 nb_mpd_base_urls,
-							   Bool use_url_template, Bool single_segment, Bool single_file, GF_DashSwitchingMode bitstream_switching,
-							   Bool seg_at_rap, Double dash_duration, char *seg_name, char *seg_ext,
-							   Double frag_duration, s32 subsegs_per_sidx, Bool daisy_chain_sidx, Bool frag_at_rap, const char *tmpdir,
-							   GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec)
+struct __dash_live_segmenter
 {
-	u32 i, j, segment_mode;
-	char *sep, szSegName[GF_MAX_PATH], szSolvedSegName[GF_MAX_PATH], szTempMPD[GF_MAX_PATH];
-	u32 cur_adaptation_set;
-	u32 max_adaptation_set = 0;
-	u32 cur_period;
-	u32 max_period = 0;
-	u32 cur_group_id = 0;
-	u32 max_sap_type = 0;
-	Bool none_supported = 1;
-	Bool has_mpeg2 = 0;
-	Bool has_role = 0;
-	Double presentation_duration = 0;
-	GF_Err e = GF_OK;
-	FILE *mpd = NULL;
+	/*segmentation parameters - profile-dependent ones are adjusted when the inputs are set up*/
+	const char *mpdfile;
+	GF_DashSegmenterInput *inputs;
+	u32 nb_inputs;
+	GF_DashProfile dash_profile;
+	const char *mpd_title, *mpd_source, *mpd_copyright, *mpd_moreInfoURL;
+	const char **mpd_base_urls;
+	u32 nb_mpd_base_urls;
+	Bool use_url_template, single_segment, single_file;
+	GF_DashSwitchingMode bitstream_switching;
+	Bool seg_at_rap;
+	Double dash_duration;
+	char *seg_name, *seg_ext;
+	Double frag_duration;
+	s32 subsegs_per_sidx;
+	Bool daisy_chain_sidx, frag_at_rap;
+	const char *tmpdir;
+	GF_Config *dash_ctx;
+	u32 dash_dynamic, mpd_update_time, time_shift_depth;
+	Double subduration, min_buffer;
+	u32 ast_shift_sec;
+
+	/*low-latency chunked segments*/
+	u32 chunk_frames;
+	gf_dasher_chunk_callback on_chunk;
+	void *on_chunk_udta;
+
+	/*inputs are probed and classified in periods and adaptation sets on the first cycle only*/
 	GF_DashSegInput *dash_inputs;
-	GF_DASHSegmenterOptions dash_opts;
+	Bool inputs_setup;
+	u32 max_adaptation_set, max_period, max_sap_type, segment_mode;
+	Bool has_mpeg2;
+	char szSegName[GF_MAX_PATH];
+	u32 nb_cycles;
+
+	/*dynamic session with a context and several periods: periods are segmented one after the other, the active one being
+	the only one producing segments. The active period ID is kept in the context, as well as the start time and, once the
+	period is closed, the duration and the MPD description of each period (sections Period_ID and PeriodMPD_ID)*/
+	Bool live_periods;
+	u32 active_period;
+	/*position of the active period content in the MPD being written*/
+	u64 period_mpd_start, period_mpd_end;
+
+	/*daemon mode: inputs are kept open between cycles, expired segments are deleted by the purge thread and
+	the MPD is only republished when its content changes*/
+	Bool is_daemon, follow_growth;
+	GF_TaskPool *purge_pool;
+	GF_TaskGroup *purge_group;
+	char *mpd_data;
+	u32 mpd_size;
+
+	/*input arrival to segment availability latency, in microseconds*/
+	u32 nb_latencies;
+	u64 last_latency, max_latency, cumulated_latency;
+};
 
-	/*init dash context if needed*/
-	if (dash_ctx) {
+/*no new segment shall be produced: stop before the first segment (a null subduration would segment the whole input)*/
+#define DASHER_LIVE_NO_SEGMENT	0.001
 
-		e = gf_dasher_init_context(dash_ctx, &dash_dynamic, &time_shift_depth, NULL);
-		if (e) return e;
-		if (dash_ctx) {
-			Bool regenerate;
-			const char *opt = gf_cfg_get_key(dash_ctx, "DASH", "MaxSegmentDuration");
-			if (opt) {
-				Double seg_dur = atof(opt);
-/*
-				if (seg_dur != dash_duration) {
-					return GF_NOT_SUPPORTED;
-				}
-*/
-				dash_duration = seg_dur;
-			} else {
-				char sOpt[100];
-				sprintf(sOpt, "%f", dash_duration);
-				gf_cfg_set_key(dash_ctx, "DASH", "MaxSegmentDuration", sOpt);
-			}
+static Double dasher_live_get_cumulated_duration(GF_Config *dash_ctx, GF_DashSegInput *dash_input)
+{
+	char szSection[200];
+	const char *opt;
+	sprintf(szSection, "Representation_%s", dash_input->representationID);
+	opt = gf_cfg_get_key(dash_ctx, szSection, "CumulatedDuration");
+	return opt ? atof(opt) : 0;
+}
 
-			/*peform all file cleanup*/
-			regenerate = gf_dasher_cleanup(dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, dash_duration);
-			if (!regenerate) return GF_OK;
-		}
-	}
+static Double dasher_live_get_period_time(GF_Config *dash_ctx, const char *periodID, const char *key)
+{
+	char szSection[200];
+	const char *opt;
+	sprintf(szSection, "Period_%s", periodID);
+	opt = gf_cfg_get_key(dash_ctx, szSection, key);
+	return opt ? atof(opt) : 0;
+}
 
-	/*copy over input files to our internal structure*/
-	max_period = 0;
-	dash_inputs = gf_malloc(sizeof(GF_DashSegInput)*nb_dash_inputs);
-	memset(dash_inputs, 0, sizeof(GF_DashSegInput)*nb_dash_inputs);
-	for (i=0; i<nb_dash_inputs; i++) {
-		dash_inputs[i].file_name = inputs[i].file_name;
-		strcpy(dash_inputs[i].representationID, inputs[i].representationID);
-		strcpy(dash_inputs[i].periodID, inputs[i].periodID);
-		strcpy(dash_inputs[i].role, inputs[i].role);
-		dash_inputs[i].bandwidth = inputs[i].bandwidth;
+static void dasher_live_set_period_time(GF_Config *dash_ctx, const char *periodID, const char *key, Double time)
+{
+	char szSection[200], szVal[100];
+	sprintf(szSection, "Period_%s", periodID);
+	sprintf(szVal, "%f", time);
+	gf_cfg_set_key(dash_ctx, szSection, key, szVal);
+}
 
-		if (strlen(inputs[i].role) && strcmp(inputs[i].role, "main"))
-			has_role = 1;
+/*first input of the period following the active one, NULL if the active period is the last one*/
+static GF_DashSegInput *dasher_live_get_next_period_input(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i;
+	GF_DashSegInput *next = NULL;
+	for (i=0; i<dasher->nb_inputs; i++) {
+		GF_DashSegInput *dash_input = &dasher->dash_inputs[i];
+		if (!dash_input->adaptation_set || (dash_input->period <= dasher->active_period)) continue;
+		if (!next || (dash_input->period < next->period)) next = dash_input;
+	}
+	return next;
+}
 
-		if (!strlen(dash_inputs[i].periodID)) {
-			max_period = 1;
-			dash_inputs[i].period = 1;
-			if (dash_dynamic) {
-				strcpy(dash_inputs[i].periodID, "GENID_DEF");
+/*restores the active period from the context, the first period being active when the session starts*/
+static void dasher_live_load_active_period(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i;
+	GF_DashSegInput *first = NULL;
+	const char *opt = gf_cfg_get_key(dasher->dash_ctx, "DASH", "ActivePeriod");
+
+	dasher->active_period = 0;
+	if (opt) {
+		for (i=0; i<dasher->nb_inputs; i++) {
+			if (dasher->dash_inputs[i].adaptation_set && !strcmp(dasher->dash_inputs[i].periodID, opt)) {
+				dasher->active_period = dasher->dash_inputs[i].period;
+				return;
 			}
 		}
-		gf_dash_segmenter_probe_input(&dash_inputs[i]);
+		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Active period %s not found in inputs, restarting from first period\n", opt));
+	}
 
-		if (!strcmp(dash_inputs[i].szMime, "video/mp2t")) has_mpeg2 = 1;
- 	}
-	memset(&dash_opts, 0, sizeof(GF_DASHSegmenterOptions));
+	for (i=0; i<dasher->nb_inputs; i++) {
+		GF_DashSegInput *dash_input = &dasher->dash_inputs[i];
+		if (!dash_input->adaptation_set) continue;
+		if (!first || (dash_input->period < first->period)) first = dash_input;
+	}
+	if (!first) return;
+	dasher->active_period = first->period;
+	gf_cfg_set_key(dasher->dash_ctx, "DASH", "ActivePeriod", first->periodID);
+	dasher_live_set_period_time(dasher->dash_ctx, first->periodID, "Start", 0);
+}
 
-	/*set all default roles to main if needed*/
-	if (has_role) {
-		for (i=0; i<nb_dash_inputs; i++) {
-			if (!strlen(dash_inputs[i].role))
-				strcpy(dash_inputs[i].role, "main");
-		}
+/*end of the active period in the session, as segmented so far*/
+static Double dasher_live_get_live_edge(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i;
+	Double start = -1, dur = 0;
+	for (i=0; i<dasher->nb_inputs; i++) {
+		GF_DashSegInput *dash_input = &dasher->dash_inputs[i];
+		if (!dash_input->adaptation_set || (dash_input->period != dasher->active_period)) continue;
+		if (start<0) start = dasher_live_get_period_time(dasher->dash_ctx, dash_input->periodID, "Start");
+		dur = MAX(dur, dasher_live_get_cumulated_duration(dasher->dash_ctx, dash_input));
 	}
+	return (start<0) ? 0 : start + dur;
+}
 
-	for (i=0; i<nb_dash_inputs; i++) {
-		if (dash_inputs[i].period)
-			continue;
-		if (strlen(dash_inputs[i].periodID)) {
-			max_period++;
-			dash_inputs[i].period = max_period;
+/*the adaptation sets of a closed period no longer change, they are kept in the context and no longer segmented. Lines
+are stored with a leading '|' to preserve their indentation*/
+static GF_Err dasher_live_store_period_mpd(GF_DASHLiveSegmenter *dasher, const char *periodID, const char *szMPD)
+{
+	char szSection[200], szKey[20], *data, *line, *sep, *value;
+	u32 size, nb_lines = 0;
+	FILE *f = gf_f64_open(szMPD, "rb");
+	if (!f) return GF_IO_ERR;
+
+	size = (u32) (dasher->period_mpd_end - dasher->period_mpd_start);
+	data = gf_malloc(sizeof(char)*(size+1));
+	gf_f64_seek(f, dasher->period_mpd_start, SEEK_SET);
+	if (fread(data, 1, size, f) != size) {
+		fclose(f);
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+	data[size] = 0;
 
-			for (j=i+1; j<nb_dash_inputs; j++) {
-				if (!strcmp(dash_inputs[j].periodID, dash_inputs[i].periodID))
-					dash_inputs[j].period = dash_inputs[i].period;
-			}
-		}
+	sprintf(szSection, "PeriodMPD_%s", periodID);
+	line = data;
+	while (line[0]) {
+		sep = strchr(line, '\n');
+		if (sep) sep[0] = 0;
+		value = gf_malloc(sizeof(char)*(strlen(line)+2));
+		sprintf(value, "|%s", line);
+		sprintf(szKey, "Line%d", nb_lines+1);
+		gf_cfg_set_key(dasher->dash_ctx, szSection, szKey, value);
+		gf_free(value);
+		nb_lines++;
+		if (!sep) break;
+		line = sep+1;
 	}
-	if (dash_dynamic && max_period>1) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Multiple periods in live mode not supported\n"));
-		return GF_NOT_SUPPORTED;
+	gf_free(data);
+	return GF_OK;
+}
+
+static void dasher_live_write_period_mpd(FILE *mpd, GF_Config *dash_ctx, const char *periodID)
+{
+	u32 i;
+	char szSection[200];
+	sprintf(szSection, "PeriodMPD_%s", periodID);
+	for (i=0; i<gf_cfg_get_key_count(dash_ctx, szSection); i++) {
+		const char *line = gf_cfg_get_key(dash_ctx, szSection, gf_cfg_get_key_name(dash_ctx, szSection, i));
+		if (line && (line[0]=='|')) line++;
+		fprintf(mpd, "%s\n", line ? line : "");
 	}
+}
 
-	for (cur_period=0; cur_period<max_period; cur_period++) {
-		/*classify all input in possible adaptation sets*/
-		for (i=0; i<nb_dash_inputs; i++) {
+/*closes the active period once all its inputs are segmented, and starts the next one where it ends. The last period
+is never closed: its inputs are looped or followed as in single period sessions*/
+static GF_Err dasher_live_check_period_end(GF_DASHLiveSegmenter *dasher, const char *szMPD)
+{
+	u32 i;
+	GF_Err e;
+	Double start = -1, dur = 0;
+	GF_DashSegInput *cur = NULL;
+	GF_DashSegInput *next = dasher_live_get_next_period_input(dasher);
+	if (!next) return GF_OK;
+
+	for (i=0; i<dasher->nb_inputs; i++) {
+		GF_DashSegInput *dash_input = &dasher->dash_inputs[i];
+		if (!dash_input->adaptation_set || (dash_input->period != dasher->active_period)) continue;
+		if (!dash_input->input_done) return GF_OK;
+		if (!cur) {
+			cur = dash_input;
+			start = dasher_live_get_period_time(dasher->dash_ctx, cur->periodID, "Start");
+		}
+		dur = MAX(dur, dasher_live_get_cumulated_duration(dasher->dash_ctx, dash_input));
+	}
+	if (!cur) return GF_OK;
+
+	e = dasher_live_store_period_mpd(dasher, cur->periodID, szMPD);
+	if (e) return e;
+	dasher_live_set_period_time(dasher->dash_ctx, cur->periodID, "Duration", dur);
+	dasher_live_set_period_time(dasher->dash_ctx, next->periodID, "Start", start + dur);
+	gf_cfg_set_key(dasher->dash_ctx, "DASH", "ActivePeriod", next->periodID);
+	dasher->active_period = next->period;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Period %s closed after %.3f sec - starting period %s at %.3f sec\n", cur->periodID, dur, next->periodID, start + dur));
+	return GF_OK;
+}
+
+static Bool dasher_live_input_modified(GF_DashSegInput *dash_input, u64 *size, u64 *mtime)
+{
+	FILE *f = gf_f64_open(dash_input->file_name, "rb");
+	/*input temporarily unavailable, keep what we have*/
+	if (!f) return 0;
+	gf_f64_seek(f, 0, SEEK_END);
+	*size = gf_f64_tell(f);
+	fclose(f);
+	*mtime = gf_file_modification_time(dash_input->file_name);
+	if (dash_input->file_size && (*size == dash_input->file_size) && (*mtime == dash_input->file_mtime))
+		return 0;
+	return 1;
+}
+
+static void dasher_live_record_arrival(GF_DashSegInput *dash_input)
+{
+	u32 i, nb_samples;
+	Double available = -1;
+	GF_ISOFile *in = dash_input->isom_file;
+
+	for (i=0; i<gf_isom_get_track_count(in); i++) {
+		Double end;
+		if (gf_isom_get_media_type(in, i+1) == GF_ISOM_MEDIA_HINT)
+			continue;
+		nb_samples = gf_isom_get_sample_count(in, i+1);
+		if (!nb_samples) {
+			available = 0;
+			break;
+		}
+		/*the media is available up to the end of the last sample of the shortest track*/
+		end = (Double) (s64) (gf_isom_get_sample_dts(in, i+1, nb_samples) + gf_isom_get_sample_duration(in, i+1, nb_samples));
+		end /= gf_isom_get_media_timescale(in, i+1);
+		if ((available<0) || (end<available)) available = end;
+	}
+	if (available <= dash_input->available_duration) return;
+
+	dash_input->available_duration = available;
+	if (dash_input->nb_arrivals == dash_input->nb_alloc_arrivals) {
+		dash_input->nb_alloc_arrivals = dash_input->nb_alloc_arrivals ? 2*dash_input->nb_alloc_arrivals : 10;
+		dash_input->arrivals = gf_realloc(dash_input->arrivals, sizeof(GF_DashSegArrival) * dash_input->nb_alloc_arrivals);
+	}
+	dash_input->arrivals[dash_input->nb_arrivals].media_time = available;
+	dash_input->arrivals[dash_input->nb_arrivals].clock = gf_sys_clock_high_res();
+	dash_input->nb_arrivals++;
+}
+
+/*checks if the input changed since last cycle, and loads the new media of ISO inputs*/
+static void dasher_live_refresh_input(GF_DASHLiveSegmenter *dasher, GF_DashSegInput *dash_input)
+{
+	u64 size, mtime, missing;
+	GF_Err e;
+
+	dash_input->has_changed = 0;
+	if (!dasher_live_input_modified(dash_input, &size, &mtime)) return;
+
+	dash_input->has_changed = 1;
+	dash_input->file_size = size;
+	dash_input->file_mtime = mtime;
+
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	if (dash_input->dasher_segment_file != dasher_isom_segment_file) return;
+
+	/*fragmented input, only parse the fragments appended since last refresh. Parsing resumes at the last top-level box,
+	which fails if it was the moov (no fragment yet): the input is then reloaded*/
+	e = GF_EOS;
+	if (dash_input->isom_file && gf_isom_is_fragmented(dash_input->isom_file)) {
+		e = gf_isom_refresh_fragmented(dash_input->isom_file, &missing);
+		if (e == GF_ISOM_INCOMPLETE_FILE) e = GF_OK;
+	}
+	if (e) {
+		GF_ISOFile *file;
+		e = gf_isom_open_progressive(dash_input->file_name, 0, 0, &file, &missing);
+		if (e || !file) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Cannot reload input %s: %s - keeping previous state\n", dash_input->file_name, gf_error_to_string(e) ));
+			if (dash_input->isom_file) dash_input->has_changed = 0;
+			return;
+		}
+		if (dash_input->isom_file) gf_isom_close(dash_input->isom_file);
+		dash_input->isom_file = file;
+	}
+	if (dasher->follow_growth)
+		dasher_live_record_arrival(dash_input);
+#endif
+}
+
+/*computes how much of a growing input can be segmented: at least one segment of media is kept after the last
+segment produced, so that the segmenter never ends a segment at the current end of the input*/
+static Double dasher_live_get_subduration(GF_DASHLiveSegmenter *dasher, GF_DashSegInput *dash_input)
+{
+	u32 nb_segs = 0;
+	Double avail = dash_input->available_duration - dasher_live_get_cumulated_duration(dasher->dash_ctx, dash_input);
+
+	if (avail > 2*dasher->dash_duration)
+		nb_segs = (u32) (avail / dasher->dash_duration) - 1;
+
+	if (!nb_segs) return DASHER_LIVE_NO_SEGMENT;
+	if (dasher->subduration && (nb_segs * dasher->dash_duration > dasher->subduration))
+		return dasher->subduration;
+	return nb_segs * dasher->dash_duration;
+}
+
+static void dasher_live_update_latency(GF_DASHLiveSegmenter *dasher, GF_DashSegInput *dash_input, Double segmented_duration, u64 now)
+{
+	u32 i;
+	u64 latency;
+
+	/*first time the input had all the media of the last produced segment*/
+	for (i=0; i<dash_input->nb_arrivals; i++) {
+		if (dash_input->arrivals[i].media_time + 0.001 >= segmented_duration) break;
+	}
+	if (i == dash_input->nb_arrivals) return;
+
+	latency = now - dash_input->arrivals[i].clock;
+	dasher->last_latency = latency;
+	if (latency > dasher->max_latency) dasher->max_latency = latency;
+	dasher->cumulated_latency += latency;
+	dasher->nb_latencies++;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Representation %s: media up to %.3f sec available %d ms after input arrival\n", dash_input->representationID, segmented_duration, (u32) (latency/1000) ));
+
+	/*older arrivals are covered by the produced segments*/
+	if (i) {
+		memmove(dash_input->arrivals, &dash_input->arrivals[i], sizeof(GF_DashSegArrival) * (dash_input->nb_arrivals - i));
+		dash_input->nb_arrivals -= i;
+	}
+}
+
+/*only replaces the published MPD if its content changed since last cycle*/
+static GF_Err dasher_live_publish_mpd(GF_DASHLiveSegmenter *dasher, const char *szTempMPD)
+{
+	u32 size;
+	char *data;
+	FILE *f = gf_f64_open(szTempMPD, "rb");
+	if (!f) return GF_IO_ERR;
+	gf_f64_seek(f, 0, SEEK_END);
+	size = (u32) gf_f64_tell(f);
+	gf_f64_seek(f, 0, SEEK_SET);
+	data = gf_malloc(sizeof(char)*size);
+	if (fread(data, 1, size, f) != size) {
+		fclose(f);
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+
+	if ((size == dasher->mpd_size) && !memcmp(data, dasher->mpd_data, size)) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] MPD unchanged, not republished\n"));
+		gf_free(data);
+		return gf_delete_file(szTempMPD);
+	}
+	if (dasher->mpd_data) gf_free(dasher->mpd_data);
+	dasher->mpd_data = data;
+	dasher->mpd_size = size;
+	return gf_move_file(szTempMPD, dasher->mpdfile);
+}
+
+GF_EXPORT
+GF_DASHLiveSegmenter *gf_dasher_live_new(const char *mpdfile, GF_DashSegmenterInput *inputs, u32 nb_inputs, GF_DashProfile dash_profile,
+							   const char *mpd_title, const char *mpd_source, const char *mpd_copyright,
+							   const char *mpd_moreInfoURL, const char **mpd_base_urls, u32 nb_mpd_base_urls,
+							   Bool use_url_template, Bool single_segment, Bool single_file, GF_DashSwitchingMode bitstream_switching,
+							   Bool seg_at_rap, Double dash_duration, char *seg_name, char *seg_ext,
+							   Double frag_duration, s32 subsegs_per_sidx, Bool daisy_chain_sidx, Bool frag_at_rap, const char *tmpdir,
+							   GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec,
+							   Bool follow_input_growth)
+{
+	GF_DASHLiveSegmenter *dasher;
+	GF_SAFEALLOC(dasher, GF_DASHLiveSegmenter);
+	if (!dasher) return NULL;
+
+	dasher->mpdfile = mpdfile;
+	dasher->inputs = inputs;
+	dasher->nb_inputs = nb_inputs;
+	dasher->dash_profile = dash_profile;
+	dasher->mpd_title = mpd_title;
+	dasher->mpd_source = mpd_source;
+	dasher->mpd_copyright = mpd_copyright;
+	dasher->mpd_moreInfoURL = mpd_moreInfoURL;
+	dasher->mpd_base_urls = mpd_base_urls;
+	dasher->nb_mpd_base_urls = nb_mpd_base_urls;
+	dasher->use_url_template = use_url_template;
+	dasher->single_segment = single_segment;
+	dasher->single_file = single_file;
+	dasher->bitstream_switching = bitstream_switching;
+	dasher->seg_at_rap = seg_at_rap;
+	dasher->dash_duration = dash_duration;
+	dasher->seg_name = seg_name;
+	dasher->seg_ext = seg_ext;
+	dasher->frag_duration = frag_duration;
+	dasher->subsegs_per_sidx = subsegs_per_sidx;
+	dasher->daisy_chain_sidx = daisy_chain_sidx;
+	dasher->frag_at_rap = frag_at_rap;
+	dasher->tmpdir = tmpdir;
+	dasher->dash_ctx = dash_ctx;
+	dasher->dash_dynamic = dash_dynamic;
+	dasher->mpd_update_time = mpd_update_time;
+	dasher->time_shift_depth = time_shift_depth;
+	dasher->subduration = subduration;
+	dasher->min_buffer = min_buffer;
+	dasher->ast_shift_sec = ast_shift_sec;
+
+	dasher->is_daemon = 1;
+	/*growing inputs can only be followed if we have a context to store their position*/
+	dasher->follow_growth = dash_ctx ? follow_input_growth : 0;
+	return dasher;
+}
+
+GF_EXPORT
+void gf_dasher_live_del(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i;
+	if (!dasher) return;
+
+	/*wait for pending segment deletions*/
+	if (dasher->purge_group) gf_task_group_del(dasher->purge_group);
+	if (dasher->purge_pool) gf_task_pool_del(dasher->purge_pool);
+
+	if (dasher->dash_inputs) {
+		for (i=0; i<dasher->nb_inputs; i++) {
+#ifndef GPAC_DISABLE_MPEG2TS
+			dasher_mp2t_reset_index(&dasher->dash_inputs[i]);
+#endif
+			if (dasher->dash_inputs[i].isom_file) gf_isom_close(dasher->dash_inputs[i].isom_file);
+			if (dasher->dash_inputs[i].arrivals) gf_free(dasher->dash_inputs[i].arrivals);
+		}
+		gf_free(dasher->dash_inputs);
+	}
+	if (dasher->mpd_data) gf_free(dasher->mpd_data);
+	gf_free(dasher);
+}
+
+GF_EXPORT
+GF_Err gf_dasher_live_set_chunk_mode(GF_DASHLiveSegmenter *dasher, u32 chunk_frames, gf_dasher_chunk_callback on_chunk, void *udta)
+{
+	if (!dasher) return GF_BAD_PARAM;
+	dasher->chunk_frames = chunk_frames;
+	dasher->on_chunk = chunk_frames ? on_chunk : NULL;
+	dasher->on_chunk_udta = udta;
+	return GF_OK;
+}
+
+GF_EXPORT
+u32 gf_dasher_live_next_update_time(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i;
+	u64 size, mtime;
+	if (!dasher->dash_ctx) return 0;
+	if (!dasher->follow_growth)
+		return gf_dasher_next_update_time(dasher->dash_ctx, dasher->mpd_update_time);
+
+	/*growing inputs: update as soon as one of them is modified*/
+	for (i=0; i<dasher->nb_inputs; i++) {
+		if (!dasher->dash_inputs || !dasher->dash_inputs[i].adaptation_set) continue;
+		if (dasher_live_input_modified(&dasher->dash_inputs[i], &size, &mtime))
+			return 0;
+	}
+	return 100;
+}
+
+GF_EXPORT
+void gf_dasher_live_get_latency(GF_DASHLiveSegmenter *dasher, u32 *nb_measures, u32 *last_ms, u32 *avg_ms, u32 *max_ms)
+{
+	if (nb_measures) *nb_measures = dasher->nb_latencies;
+	if (last_ms) *last_ms = (u32) (dasher->last_latency / 1000);
+	if (avg_ms) *avg_ms = dasher->nb_latencies ? (u32) (dasher->cumulated_latency / dasher->nb_latencies / 1000) : 0;
+	if (max_ms) *max_ms = (u32) (dasher->max_latency / 1000);
+}
+
+/*copies, probes and classifies the inputs in periods and adaptation sets, and adjusts parameters to the profile*/
+static GF_Err dasher_setup_inputs(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i, j;
+	u32 cur_period;
+	u32 cur_group_id = 0;
+	Bool none_supported = 1;
+	Bool has_role = 0;
+	GF_Err e;
+	GF_DashSegInput *dash_inputs;
+	u32 nb_dash_inputs = dasher->nb_inputs;
+
+	/*copy over input files to our internal structure*/
+	dasher->max_period = 0;
+	dash_inputs = gf_malloc(sizeof(GF_DashSegInput)*nb_dash_inputs);
+	memset(dash_inputs, 0, sizeof(GF_DashSegInput)*nb_dash_inputs);
+	dasher->dash_inputs = dash_inputs;
+	for (i=0; i<nb_dash_inputs; i++) {
+		dash_inputs[i].file_name = dasher->inputs[i].file_name;
+		strcpy(dash_inputs[i].representationID, dasher->inputs[i].representationID);
+		strcpy(dash_inputs[i].periodID, dasher->inputs[i].periodID);
+		strcpy(dash_inputs[i].role, dasher->inputs[i].role);
+		dash_inputs[i].bandwidth = dasher->inputs[i].bandwidth;
+		dash_inputs[i].has_changed = 1;
+
+		if (strlen(dasher->inputs[i].role) && strcmp(dasher->inputs[i].role, "main"))
+			has_role = 1;
+
+		if (!strlen(dash_inputs[i].periodID)) {
+			dasher->max_period = 1;
+			dash_inputs[i].period = 1;
+			if (dasher->dash_dynamic) {
+				strcpy(dash_inputs[i].periodID, "GENID_DEF");
+			}
+		}
+		gf_dash_segmenter_probe_input(&dash_inputs[i]);
+
+		if (!strcmp(dash_inputs[i].szMime, "video/mp2t")) dasher->has_mpeg2 = 1;
+ 	}
+
+	/*set all default roles to main if needed*/
+	if (has_role) {
+		for (i=0; i<nb_dash_inputs; i++) {
+			if (!strlen(dash_inputs[i].role))
+				strcpy(dash_inputs[i].role, "main");
+		}
+	}
+
+	for (i=0; i<nb_dash_inputs; i++) {
+		if (dash_inputs[i].period)
+			continue;
+		if (strlen(dash_inputs[i].periodID)) {
+			dasher->max_period++;
+			dash_inputs[i].period = dasher->max_period;
+
+			for (j=i+1; j<nb_dash_inputs; j++) {
+				if (!strcmp(dash_inputs[j].periodID, dash_inputs[i].periodID))
+					dash_inputs[j].period = dash_inputs[i].period;
+			}
+		}
+	}
+	dasher->live_periods = (dasher->dash_dynamic && dasher->dash_ctx && (dasher->max_period>1)) ? 1 : 0;
+
+	for (cur_period=0; cur_period<dasher->max_period; cur_period++) {
+		/*classify all input in possible adaptation sets*/
+		for (i=0; i<nb_dash_inputs; i++) {
 			/*this file does not belong to our current period*/
 			if (dash_inputs[i].period != cur_period+1) continue;
 
@@ -3487,12 +4259,12 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 				continue;
 			}
 
-			max_adaptation_set ++;
-			dash_inputs[i].adaptation_set = max_adaptation_set;
+			dasher->max_adaptation_set ++;
+			dash_inputs[i].adaptation_set = dasher->max_adaptation_set;
 			dash_inputs[i].nb_rep_in_adaptation_set = 1;
 
-			e = dash_inputs[i].dasher_input_classify(dash_inputs, nb_dash_inputs, i, &cur_group_id, &max_sap_type);
-			if (e) goto exit;
+			e = dash_inputs[i].dasher_input_classify(dash_inputs, nb_dash_inputs, i, &cur_group_id, &dasher->max_sap_type);
+			if (e) return e;
 			none_supported = 0;
 		}
 		if (none_supported) {
@@ -3502,89 +4274,156 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 	}
 
 	/*check requested profiles can be generated, or adjust them*/
-	if (max_sap_type>=3) {
-		if (dash_profile) {
-			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH]: WARNING! Max SAP type %d detected\n\tswitching to FULL profile\n", max_sap_type));
+	if (dasher->max_sap_type>=3) {
+		if (dasher->dash_profile) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH]: WARNING! Max SAP type %d detected\n\tswitching to FULL profile\n", dasher->max_sap_type));
 		}
-		dash_profile = 0;
+		dasher->dash_profile = 0;
 	}
-	if ((dash_profile==GF_DASH_PROFILE_LIVE) && !seg_name) {
+	if ((dasher->dash_profile==GF_DASH_PROFILE_LIVE) && !dasher->seg_name) {
 		GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH]: WARNING! DASH Live profile requested but no -segment-name\n\tusing \"%%s_dash\" by default\n\n"));
-		seg_name = "%s_dash";
+		dasher->seg_name = "%s_dash";
 	}
 
 	/*if output id not in the current working dir, concatenate output path to segment name*/
-	szSegName[0] = 0;
-	if (seg_name) {
-		if (gf_url_get_resource_path(mpdfile, szSegName)) {
-			strcat(szSegName, seg_name);
-			seg_name = szSegName;
+	dasher->szSegName[0] = 0;
+	if (dasher->seg_name) {
+		if (gf_url_get_resource_path(dasher->mpdfile, dasher->szSegName)) {
+			strcat(dasher->szSegName, dasher->seg_name);
+			dasher->seg_name = dasher->szSegName;
 		}
 	}
 
 	/*adjust params based on profiles*/
-	switch (dash_profile) {
+	switch (dasher->dash_profile) {
 	case GF_DASH_PROFILE_LIVE:
-		seg_at_rap = 1;
-		use_url_template = 1;
-		single_segment = single_file = 0;
+		dasher->seg_at_rap = 1;
+		dasher->use_url_template = 1;
+		dasher->single_segment = dasher->single_file = 0;
 		break;
 	case GF_DASH_PROFILE_ONDEMAND:
-		seg_at_rap = 1;
-		single_segment = 1;
+		dasher->seg_at_rap = 1;
+		dasher->single_segment = 1;
 		/*BS switching is meaningless in onDemand profile*/
-		bitstream_switching = GF_DASH_BSMODE_NONE;
-		use_url_template = single_file = 0;
+		dasher->bitstream_switching = GF_DASH_BSMODE_NONE;
+		dasher->use_url_template = dasher->single_file = 0;
 		break;
 	case GF_DASH_PROFILE_MAIN:
-		seg_at_rap = 1;
-		single_segment = 0;
+		dasher->seg_at_rap = 1;
+		dasher->single_segment = 0;
 		break;
 	default:
 		break;
 	}
 
-	segment_mode = single_segment ? 1 : (single_file ? 2 : 0);
+	dasher->segment_mode = dasher->single_segment ? 1 : (dasher->single_file ? 2 : 0);
 
-	if (single_segment) {
-		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("DASH-ing file%s - single segment\nSubsegment duration %.3f - Fragment duration: %.3f secs\n", (nb_dash_inputs>1) ? "s" : "", dash_duration, frag_duration));
-		subsegs_per_sidx = 0;
+	if (dasher->single_segment) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("DASH-ing file%s - single segment\nSubsegment duration %.3f - Fragment duration: %.3f secs\n", (nb_dash_inputs>1) ? "s" : "", dasher->dash_duration, dasher->frag_duration));
+		dasher->subsegs_per_sidx = 0;
 	} else {
-		if (!seg_ext) seg_ext = "m4s";
+		if (!dasher->seg_ext) dasher->seg_ext = "m4s";
 
-		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("DASH-ing file%s: %.2fs segments %.2fs fragments ", (nb_dash_inputs>1) ? "s" : "", dash_duration, frag_duration));
-		if (subsegs_per_sidx<0) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("DASH-ing file%s: %.2fs segments %.2fs fragments ", (nb_dash_inputs>1) ? "s" : "", dasher->dash_duration, dasher->frag_duration));
+		if (dasher->subsegs_per_sidx<0) {
 			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("no sidx used"));
-		} else if (subsegs_per_sidx) {
-			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("%d subsegments per sidx", subsegs_per_sidx));
+		} else if (dasher->subsegs_per_sidx) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("%d subsegments per sidx", dasher->subsegs_per_sidx));
 		} else {
 			GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("single sidx per segment"));
 		}
 		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("\n"));
 	}
-	if (frag_at_rap) seg_at_rap = 1;
+	if (dasher->frag_at_rap) dasher->seg_at_rap = 1;
 
-	if (seg_at_rap) {
-		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("Spliting segments %sat GOP boundaries\n", frag_at_rap ? "and fragments " : ""));
+	if (dasher->seg_at_rap) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("Spliting segments %sat GOP boundaries\n", dasher->frag_at_rap ? "and fragments " : ""));
 	}
+	return GF_OK;
+}
 
-	dash_opts.mpd_name = mpdfile;
-	dash_opts.segments_start_with_rap = seg_at_rap;
-	dash_opts.segment_duration = dash_duration;
-	dash_opts.seg_ext = seg_ext;
-	dash_opts.daisy_chain_sidx = daisy_chain_sidx;
-	dash_opts.subsegs_per_sidx = subsegs_per_sidx;
-	dash_opts.use_url_template = use_url_template;
-	dash_opts.single_file_mode = segment_mode;
-	dash_opts.fragments_start_with_rap = frag_at_rap;
-	dash_opts.fragment_duration = frag_duration;
-	dash_opts.tmpdir = tmpdir;
-	dash_opts.dash_ctx = dash_ctx;
-	dash_opts.time_shift_depth = (s32) time_shift_depth;
-	dash_opts.subduration = subduration;
-	dash_opts.inband_param_set = ((bitstream_switching == GF_DASH_BSMODE_INBAND) || (bitstream_switching == GF_DASH_BSMODE_SINGLE) ) ? 1 : 0;
+GF_EXPORT
+GF_Err gf_dasher_live_process(GF_DASHLiveSegmenter *dasher)
+{
+	u32 i, j;
+	char *sep, szSolvedSegName[GF_MAX_PATH], szTempMPD[GF_MAX_PATH];
+	u32 cur_adaptation_set;
+	u32 cur_period;
+	Bool has_changes = 0;
+	Bool next_period_started = 0;
+	Double presentation_duration = 0;
+	Double period_start = 0;
+	Double live_edge = 0;
+	GF_Err e = GF_OK;
+	FILE *mpd = NULL;
+	GF_DashSegInput *dash_inputs;
+	u32 nb_dash_inputs = dasher->nb_inputs;
+	GF_DASHSegmenterOptions dash_opts;
+	GF_Config *dash_ctx = dasher->dash_ctx;
 
-	for (cur_period=0; cur_period<max_period; cur_period++) {
+	/*init dash context if needed*/
+	if (dash_ctx) {
+		Bool regenerate;
+		const char *opt;
+
+		e = gf_dasher_init_context(dash_ctx, &dasher->dash_dynamic, &dasher->time_shift_depth, NULL);
+		if (e) return e;
+
+		opt = gf_cfg_get_key(dash_ctx, "DASH", "MaxSegmentDuration");
+		if (opt) {
+			dasher->dash_duration = atof(opt);
+		} else {
+			char sOpt[100];
+			sprintf(sOpt, "%f", dasher->dash_duration);
+			gf_cfg_set_key(dash_ctx, "DASH", "MaxSegmentDuration", sOpt);
+		}
+
+		/*in daemon mode, expired segments are deleted by a background thread*/
+		if (dasher->is_daemon && !dasher->purge_pool) {
+			dasher->purge_pool = gf_task_pool_new("DASHPurge", 1);
+			dasher->purge_group = gf_task_group_new(dasher->purge_pool);
+		}
+
+		/*peform all file cleanup*/
+		regenerate = gf_dasher_cleanup(dash_ctx, dasher->dash_dynamic, dasher->mpd_update_time, dasher->time_shift_depth, dasher->dash_duration, dasher->follow_growth, dasher->purge_pool, dasher->purge_group);
+		if (!regenerate) return GF_OK;
+	}
+
+	if (!dasher->inputs_setup) {
+		e = dasher_setup_inputs(dasher);
+		if (e) return e;
+		dasher->inputs_setup = 1;
+	}
+	if (!dasher->max_adaptation_set) return GF_OK;
+	dash_inputs = dasher->dash_inputs;
+
+	if (dasher->live_periods) {
+		dasher_live_load_active_period(dasher);
+		live_edge = dasher_live_get_live_edge(dasher);
+	}
+
+	memset(&dash_opts, 0, sizeof(GF_DASHSegmenterOptions));
+	dash_opts.mpd_name = dasher->mpdfile;
+	dash_opts.segments_start_with_rap = dasher->seg_at_rap;
+	dash_opts.segment_duration = dasher->dash_duration;
+	dash_opts.seg_ext = dasher->seg_ext;
+	dash_opts.daisy_chain_sidx = dasher->daisy_chain_sidx;
+	dash_opts.subsegs_per_sidx = dasher->subsegs_per_sidx;
+	dash_opts.use_url_template = dasher->use_url_template;
+	dash_opts.single_file_mode = dasher->segment_mode;
+	dash_opts.fragments_start_with_rap = dasher->frag_at_rap;
+	dash_opts.fragment_duration = dasher->frag_duration;
+	dash_opts.tmpdir = dasher->tmpdir;
+	dash_opts.dash_ctx = dash_ctx;
+	dash_opts.time_shift_depth = (s32) dasher->time_shift_depth;
+	dash_opts.subduration = dasher->subduration;
+	dash_opts.inband_param_set = ((dasher->bitstream_switching == GF_DASH_BSMODE_INBAND) || (dasher->bitstream_switching == GF_DASH_BSMODE_SINGLE) ) ? 1 : 0;
+	dash_opts.follow_input_growth = dasher->follow_growth;
+	dash_opts.chunk_frames = dasher->chunk_frames;
+	dash_opts.on_chunk = dasher->on_chunk;
+	dash_opts.on_chunk_udta = dasher->on_chunk_udta;
+
+	for (cur_period=0; cur_period<dasher->max_period; cur_period++) {
 		u32 first_in_period = 0;
 		Double period_duration=0;
 		for (i=0; i<nb_dash_inputs; i++) {
@@ -3594,14 +4433,23 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 			/*this file does not belongs to any adaptation set*/
 			if (!dash_inputs[i].adaptation_set) continue;
 
+			/*closed live period, no longer segmented*/
+			if (dasher->live_periods && (dash_inputs[i].period < dasher->active_period)) continue;
+
 			if (!first_in_period) {
 				first_in_period = i+1;
 			}
 
-			if (dash_inputs[i].dasher_get_components_info) {
+			/*inputs are kept open between cycles, only reload what changed*/
+			if (dasher->is_daemon) {
+				dasher_live_refresh_input(dasher, &dash_inputs[i]);
+			}
+
+			if (dash_inputs[i].has_changed && dash_inputs[i].dasher_get_components_info) {
 				e = dash_inputs[i].dasher_get_components_info(&dash_inputs[i], &dash_opts);
 				if (e) goto exit;
 			}
+			if (dash_inputs[i].has_changed) has_changes = 1;
 			if (dash_inputs[i].duration > period_duration)
 				period_duration = dash_inputs[i].duration;
 		}
@@ -3610,9 +4458,19 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 
 		presentation_duration += period_duration;
 	}
+	/*nothing appended to the inputs, nothing to segment*/
+	if (dasher->follow_growth && dasher->nb_cycles && !has_changes)
+		return GF_OK;
+
+	/*growing inputs: once media is appended to the inputs of the next period, the active period no longer grows*/
+	if (dasher->live_periods && dasher->follow_growth) {
+		GF_DashSegInput *next = dasher_live_get_next_period_input(dasher);
+		if (next && (next->available_duration>0)) next_period_started = 1;
+	}
+	dasher->nb_cycles++;
 
-	strcpy(szTempMPD, mpdfile);
-	if (dash_dynamic) strcat(szTempMPD, ".tmp");
+	strcpy(szTempMPD, dasher->mpdfile);
+	if (dasher->dash_dynamic) strcat(szTempMPD, ".tmp");
 
 	mpd = gf_f64_open(szTempMPD, "wt");
 	if (!mpd) {
@@ -3622,10 +4480,10 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 
 	dash_opts.mpd = mpd;
 
-	e = write_mpd_header(mpd, mpdfile, dash_ctx, dash_profile, has_mpeg2, mpd_title, mpd_source, mpd_copyright, mpd_moreInfoURL, (const char **) mpd_base_urls, nb_mpd_base_urls, dash_dynamic, time_shift_depth, presentation_duration, mpd_update_time, min_buffer, ast_shift_sec);
+	e = write_mpd_header(mpd, dasher->mpdfile, dash_ctx, dasher->dash_profile, dasher->has_mpeg2, dasher->mpd_title, dasher->mpd_source, dasher->mpd_copyright, dasher->mpd_moreInfoURL, dasher->mpd_base_urls, dasher->nb_mpd_base_urls, dasher->dash_dynamic, dasher->time_shift_depth, presentation_duration, dasher->mpd_update_time, dasher->min_buffer, dasher->ast_shift_sec);
 	if (e) goto exit;
 
-	for (cur_period=0; cur_period<max_period; cur_period++) {
+	for (cur_period=0; cur_period<dasher->max_period; cur_period++) {
 		Double period_duration = 0;
 		const char *id=NULL;
 		/*for each identified adaptationSets, write MPD and perform segmentation of input files*/
@@ -3636,18 +4494,48 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 				break;
 			}
 		}
-		e = write_period_header(mpd, id, 0.0, period_duration, dash_dynamic);
+
+		if (dasher->live_periods) {
+			/*period not started yet*/
+			if (!id || (cur_period+1 > dasher->active_period)) continue;
+
+			period_start = dasher_live_get_period_time(dash_ctx, id, "Start");
+			if (cur_period+1 < dasher->active_period) {
+				period_duration = dasher_live_get_period_time(dash_ctx, id, "Duration");
+				/*all segments of the period are out of the time shift buffer*/
+				if (((s32) dasher->time_shift_depth >= 0) && (period_start + period_duration + dasher->time_shift_depth < live_edge)) {
+					char szSection[200];
+					sprintf(szSection, "PeriodMPD_%s", id);
+					gf_cfg_del_section(dash_ctx, szSection);
+					continue;
+				}
+				e = write_period_header(mpd, id, period_start, period_duration, dasher->dash_dynamic);
+				if (e) goto exit;
+				dasher_live_write_period_mpd(mpd, dash_ctx, id);
+				fprintf(mpd, " </Period>\n");
+				continue;
+			}
+			e = write_period_header(mpd, id, period_start, 0, dasher->dash_dynamic);
+			dasher->period_mpd_start = gf_f64_tell(mpd);
+		} else if (dasher->dash_dynamic) {
+			/*all periods are segmented at once, the last one is left open*/
+			e = write_period_header(mpd, id, period_start, (cur_period+1 < dasher->max_period) ? period_duration : 0, dasher->dash_dynamic);
+			period_start += period_duration;
+		} else {
+			e = write_period_header(mpd, id, 0.0, period_duration, dasher->dash_dynamic);
+		}
 		if (e) goto exit;
+		dash_opts.period_start = dasher->live_periods ? period_start : 0;
 
 		/*for each identified adaptationSets, write MPD and perform segmentation of input files*/
-		for (cur_adaptation_set=0; cur_adaptation_set < max_adaptation_set; cur_adaptation_set++) {
+		for (cur_adaptation_set=0; cur_adaptation_set < dasher->max_adaptation_set; cur_adaptation_set++) {
 			char szInit[GF_MAX_PATH], tmp[GF_MAX_PATH];
 			u32 first_rep_in_set=0;
 			u32 max_width = 0;
 			u32 max_height = 0;
 			u32 fps_num = 0;
 			u32 fps_denum = 0;
-			Bool use_bs_switching = bitstream_switching ? 1 : 0;
+			Bool use_bs_switching = dasher->bitstream_switching ? 1 : 0;
 			char szLang[4];
 			char szFPS[100];
 			Bool is_first_rep=0;
@@ -3660,18 +4548,18 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 			if (dash_inputs[first_rep_in_set].period != cur_period+1)
 				continue;
 
-			strcpy(tmp, mpdfile);
+			strcpy(tmp, dasher->mpdfile);
 			sep = strrchr(tmp, '.');
 			if (sep) sep[0] = 0;
 
-			if (max_adaptation_set==1) {
+			if (dasher->max_adaptation_set==1) {
 				strcpy(szInit, tmp);
 				strcat(szInit, "_init.mp4");
 			} else {
 				sprintf(szInit, "%s_set%d_init.mp4", tmp, cur_adaptation_set+1);
 			}
 			/*unless asked to do BS switching on single rep, don't do it ...*/
-			if ((bitstream_switching < GF_DASH_BSMODE_SINGLE) && dash_inputs[first_rep_in_set].nb_rep_in_adaptation_set==1)
+			if ((dasher->bitstream_switching < GF_DASH_BSMODE_SINGLE) && dash_inputs[first_rep_in_set].nb_rep_in_adaptation_set==1)
 				use_bs_switching = 0;
 
 			if (! use_bs_switching) {
@@ -3693,14 +4581,14 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 
 			if (!skip_init_segment_creation) {
 				Bool disable_bs_switching = 0;
-				e = dash_inputs[first_rep_in_set].dasher_create_init_segment(dash_inputs, nb_dash_inputs, cur_adaptation_set+1, szInit, tmpdir, dash_opts.inband_param_set, &disable_bs_switching);
+				e = dash_inputs[first_rep_in_set].dasher_create_init_segment(dash_inputs, nb_dash_inputs, cur_adaptation_set+1, szInit, dasher->tmpdir, dash_opts.inband_param_set, &disable_bs_switching);
 				if (e) goto exit;
 				if (disable_bs_switching)
 					use_bs_switching = 0;
 			}
 
 			dash_opts.bs_switch_segment_file = use_bs_switching ? szInit : NULL;
-			dash_opts.use_url_template = seg_name ? use_url_template : 0;
+			dash_opts.use_url_template = dasher->seg_name ? dasher->use_url_template : 0;
 
 			szFPS[0] = 0;
 			szLang[0] = 0;
@@ -3735,8 +4623,13 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 					sprintf(szFPS, "%d", fps_num);
 			}
 
-			e = write_adaptation_header(mpd, dash_profile, use_url_template, segment_mode, &dash_inputs[first_rep_in_set], use_bs_switching, max_width, max_height, szFPS, szLang, szInit);
+			e = write_adaptation_header(mpd, dasher->dash_profile, dasher->use_url_template, dasher->segment_mode, &dash_inputs[first_rep_in_set], use_bs_switching, max_width, max_height, szFPS, szLang, szInit);
+			if (e) goto exit;
+
+#ifndef GPAC_DISABLE_MPEG2TS
+			e = dasher_mp2t_index_adaptation_set(dash_inputs, nb_dash_inputs, cur_adaptation_set+1, &dash_opts);
 			if (e) goto exit;
+#endif
 
 			is_first_rep = 1;
 			for (i=0; i<nb_dash_inputs && !e; i++) {
@@ -3745,30 +4638,46 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 				if (dash_inputs[i].adaptation_set!=cur_adaptation_set+1)
 					continue;
 
-				segment_name = seg_name;
+				segment_name = dasher->seg_name;
 
 				strcpy(szOutName, gf_url_get_resource_name(dash_inputs[i].file_name));
 				sep = strrchr(szOutName, '.');
 				if (sep) sep[0] = 0;
 
 				dash_opts.variable_seg_rad_name = 0;
-				if (seg_name) {
-					if (strstr(seg_name, "%s")) {
-						sprintf(szSolvedSegName, seg_name, szOutName);
+				if (dasher->seg_name) {
+					if (strstr(dasher->seg_name, "%s")) {
+						sprintf(szSolvedSegName, dasher->seg_name, szOutName);
 						dash_opts.variable_seg_rad_name = 1;
 					} else {
-						strcpy(szSolvedSegName, seg_name);
+						strcpy(szSolvedSegName, dasher->seg_name);
 					}
 					segment_name = szSolvedSegName;
 				}
 				strcat(szOutName, "_dash");
 
-				if (gf_url_get_resource_path(mpdfile, tmp)) {
+				if (gf_url_get_resource_path(dasher->mpdfile, tmp)) {
 					strcat(tmp, szOutName);
 					strcpy(szOutName, tmp);
 				}
 				dash_opts.seg_rad_name = segment_name;
 
+				/*growing input: only segment the media already appended*/
+				dash_opts.subduration = dasher->subduration;
+				if (dasher->follow_growth && dash_inputs[i].isom_file) {
+					/*the input no longer grows, segment all its remaining media*/
+					if (next_period_started)
+						dash_opts.subduration = 0;
+					else
+						dash_opts.subduration = dasher_live_get_subduration(dasher, &dash_inputs[i]);
+				}
+				if (dasher->live_periods) {
+					char szRepSecName[200], szVal[100];
+					sprintf(szRepSecName, "Representation_%s", dash_inputs[i].representationID);
+					sprintf(szVal, "%f", period_start);
+					gf_cfg_set_key(dash_ctx, szRepSecName, "PeriodStart", szVal);
+				}
+
 				GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("DASHing file %s\n", dash_inputs[i].file_name));
 				e = dash_inputs[i].dasher_segment_file(&dash_inputs[i], szOutName, &dash_opts, is_first_rep);
 
@@ -3782,20 +4691,452 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 			fprintf(mpd, "  </AdaptationSet>\n");
 		}
 
+		if (dasher->live_periods) dasher->period_mpd_end = gf_f64_tell(mpd);
 		fprintf(mpd, " </Period>\n");
 	}
 	fprintf(mpd, "</MPD>");
 
 exit:
+#ifndef GPAC_DISABLE_MPEG2TS
+	for (i=0; i<nb_dash_inputs; i++) {
+		dasher_mp2t_reset_index(&dash_inputs[i]);
+	}
+#endif
 
 	if (mpd) {
 		fclose(mpd);
-		if (!e && dash_dynamic)
-			gf_move_file(szTempMPD, mpdfile);
+		if (!e && dasher->live_periods)
+			e = dasher_live_check_period_end(dasher, szTempMPD);
+		if (!e && dasher->dash_dynamic) {
+			if (dasher->is_daemon)
+				e = dasher_live_publish_mpd(dasher, szTempMPD);
+			else
+				gf_move_file(szTempMPD, dasher->mpdfile);
+		}
+	}
+
+	/*segments are now available, check how long after their media was appended to the inputs*/
+	if (!e && dasher->follow_growth) {
+		u64 now = gf_sys_clock_high_res();
+		for (i=0; i<nb_dash_inputs; i++) {
+			Double segmented_duration;
+			if (!dash_inputs[i].adaptation_set || !dash_inputs[i].isom_file) continue;
+			segmented_duration = dasher_live_get_cumulated_duration(dash_ctx, &dash_inputs[i]);
+			if (segmented_duration > dash_inputs[i].segmented_duration) {
+				dash_inputs[i].segmented_duration = segmented_duration;
+				dasher_live_update_latency(dasher, &dash_inputs[i], segmented_duration, now);
+			}
+		}
+	}
+	return e;
+}
+
+/*dash segmenter*/
+GF_EXPORT
+GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *inputs, u32 nb_dash_inputs, GF_DashProfile dash_profile,
+							   const char *mpd_title, const char *mpd_source, const char *mpd_copyright,
+							   const char *mpd_moreInfoURL, const char **mpd_base_urls, u32 nb_mpd_base_urls,
+							   Bool use_url_template, Bool single_segment, Bool single_file, GF_DashSwitchingMode bitstream_switching,
+							   Bool seg_at_rap, Double dash_duration, char *seg_name, char *seg_ext,
+							   Double frag_duration, s32 subsegs_per_sidx, Bool daisy_chain_sidx, Bool frag_at_rap, const char *tmpdir,
+							   GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec)
+{
+	GF_Err e;
+	GF_DASHLiveSegmenter *dasher = gf_dasher_live_new(mpdfile, inputs, nb_dash_inputs, dash_profile, mpd_title, mpd_source, mpd_copyright,
+							   mpd_moreInfoURL, mpd_base_urls, nb_mpd_base_urls, use_url_template, single_segment, single_file, bitstream_switching,
+							   seg_at_rap, dash_duration, seg_name, seg_ext, frag_duration, subsegs_per_sidx, daisy_chain_sidx, frag_at_rap, tmpdir,
+							   dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, subduration, min_buffer, ast_shift_sec, 0);
+	if (!dasher) return GF_OUT_OF_MEM;
+
+	/*single cycle: inputs are opened by each segmentation step and segments are purged in place*/
+	dasher->is_daemon = 0;
+	e = gf_dasher_live_process(dasher);
+	gf_dasher_live_del(dasher);
+	return e;
+}
+
+
+
+
+#ifndef GPAC_DISABLE_ISOM
+
+/*max depth of sidx hierarchies, daisy-chained sidx are followed at the same depth*/
+#define DASH_INDEX_MAX_DEPTH	32
+#define DASH_INDEX_COPY_SIZE	65536
+
+typedef struct
+{
+	GF_DASHIndexRange range;
+	u32 first_subsegment, nb_subsegments;
+} GF_DASHIndexSegment;
+
+struct __dash_segment_index
+{
+	FILE *file;
+	u64 file_size;
+	u32 timescale, reference_ID;
+	u64 init_end_range, index_start_range, index_end_range;
+
+	GF_DASHIndexSegment *segments;
+	u32 nb_segments, nb_alloc_segments;
+	GF_DASHIndexRange *subsegments;
+	u32 nb_subsegments, nb_alloc_subsegments;
+
+	/*used when zero-copy is not available*/
+	char *copy_buffer;
+};
+
+static GF_Err dasher_index_add_subsegment(GF_DASHSegmentIndex *index, GF_DASHIndexRange *range)
+{
+	if (index->nb_subsegments == index->nb_alloc_subsegments) {
+		index->nb_alloc_subsegments = index->nb_alloc_subsegments ? 2*index->nb_alloc_subsegments : 64;
+		index->subsegments = gf_realloc(index->subsegments, sizeof(GF_DASHIndexRange) * index->nb_alloc_subsegments);
+		if (!index->subsegments) return GF_OUT_OF_MEM;
+	}
+	index->subsegments[index->nb_subsegments] = *range;
+	index->nb_subsegments++;
+	return GF_OK;
+}
+
+/*loads the sidx at sidx_offset: at depth 0, each reference is a segment, otherwise each media reference is a subsegment of the current segment.
+A daisy-chained sidx (media references followed by a single sidx reference) is continued at the same depth*/
+static GF_Err dasher_index_load_sidx(GF_DASHSegmentIndex *index, GF_BitStream *bs, u64 sidx_offset, u32 depth)
+{
+	GF_SegmentIndexBox *sidx;
+	GF_DASHIndexRange range;
+	u64 offset, time;
+	u32 i, nb_refs;
+	Bool first_in_chain = 1;
+	GF_Err e = GF_OK;
+
+	if (depth >= DASH_INDEX_MAX_DEPTH) return GF_ISOM_INVALID_FILE;
+
+	do {
+		u64 next_sidx = 0;
+		if (sidx_offset + 8 > index->file_size) return GF_ISOM_INVALID_FILE;
+
+		sidx = NULL;
+		gf_bs_seek(bs, sidx_offset);
+		e = gf_isom_parse_box((GF_Box **) &sidx, bs);
+		if (e) return e;
+		if (sidx->type != GF_ISOM_BOX_TYPE_SIDX) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Index: expecting sidx at offset "LLU", found %s\n", sidx_offset, gf_4cc_to_str(sidx->type)));
+			gf_isom_box_del((GF_Box *) sidx);
+			return GF_ISOM_INVALID_FILE;
+		}
+		if (!depth && first_in_chain) {
+			index->timescale = sidx->timescale;
+			index->reference_ID = sidx->reference_ID;
+			index->index_start_range = sidx_offset;
+			index->index_end_range = sidx_offset + sidx->size - 1;
+		}
+		first_in_chain = 0;
+
+		/*a trailing sidx reference after media references is the next sidx of a daisy chain*/
+		nb_refs = sidx->nb_refs;
+		if ((nb_refs > 1) && sidx->refs[nb_refs-1].reference_type) {
+			for (i=0; i<nb_refs-1; i++) {
+				if (!sidx->refs[i].reference_type) break;
+			}
+			if (i < nb_refs-1) nb_refs--;
+		}
+
+		/*references are anchored at the end of the sidx*/
+		offset = sidx_offset + sidx->size + sidx->first_offset;
+		time = sidx->earliest_presentation_time;
+		for (i=0; i<nb_refs; i++) {
+			memset(&range, 0, sizeof(GF_DASHIndexRange));
+			range.start_range = offset;
+			range.end_range = offset + sidx->refs[i].reference_size - 1;
+			range.earliest_presentation_time = time;
+			range.duration = sidx->refs[i].subsegment_duration;
+			range.sap_type = sidx->refs[i].SAP_type;
+			range.starts_with_sap = sidx->refs[i].starts_with_SAP;
+			range.sap_delta_time = sidx->refs[i].SAP_delta_time;
+			/*empty references may be written at the end of the last sidx of a chain*/
+			if (!sidx->refs[i].reference_size && !sidx->refs[i].subsegment_duration) {
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Index: skipping empty reference %d of sidx at "LLU"\n", i+1, sidx_offset));
+				continue;
+			}
+			if (!sidx->refs[i].reference_size || (range.end_range >= index->file_size)) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Index: reference %d of sidx at "LLU" is outside the file\n", i+1, sidx_offset));
+				e = GF_ISOM_INVALID_FILE;
+				break;
+			}
+
+			if (!depth) {
+				GF_DASHIndexSegment *seg;
+				if (index->nb_segments == index->nb_alloc_segments) {
+					index->nb_alloc_segments = index->nb_alloc_segments ? 2*index->nb_alloc_segments : 16;
+					index->segments = gf_realloc(index->segments, sizeof(GF_DASHIndexSegment) * index->nb_alloc_segments);
+					if (!index->segments) {
+						e = GF_OUT_OF_MEM;
+						break;
+					}
+				}
+				seg = &index->segments[index->nb_segments];
+				index->nb_segments++;
+				seg->range = range;
+				seg->first_subsegment = index->nb_subsegments;
+			}
+
+			if (sidx->refs[i].reference_type) {
+				e = dasher_index_load_sidx(index, bs, offset, depth+1);
+			} else {
+				/*a media reference at the top level is its own (single) subsegment*/
+				e = dasher_index_add_subsegment(index, &range);
+			}
+			if (e) break;
+
+			if (!depth) {
+				GF_DASHIndexSegment *seg = &index->segments[index->nb_segments-1];
+				seg->nb_subsegments = index->nb_subsegments - seg->first_subsegment;
+			}
+			offset += sidx->refs[i].reference_size;
+			time += sidx->refs[i].subsegment_duration;
+		}
+		if (!e && (nb_refs < sidx->nb_refs)) {
+			/*the next sidx must follow the media of this one*/
+			if (offset + sidx->refs[nb_refs].reference_size > index->file_size) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Index: daisy-chained sidx of sidx at "LLU" is outside the file\n", sidx_offset));
+				e = GF_ISOM_INVALID_FILE;
+			} else {
+				next_sidx = offset;
+			}
+		}
+		gf_isom_box_del((GF_Box *) sidx);
+		if (e) return e;
+		/*a sidx cannot start at 0 after media*/
+		sidx_offset = next_sidx;
+	} while (sidx_offset);
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_DASHSegmentIndex *gf_dasher_index_new(const char *file_name, GF_Err *out_err)
+{
+	GF_DASHSegmentIndex *index;
+	GF_BitStream *bs;
+	GF_Err e = GF_OK;
+	Bool has_sidx = 0;
+
+	GF_SAFEALLOC(index, GF_DASHSegmentIndex);
+	if (!index) {
+		if (out_err) *out_err = GF_OUT_OF_MEM;
+		return NULL;
+	}
+	index->file = gf_f64_open(file_name, "rb");
+	if (!index->file) {
+		gf_free(index);
+		if (out_err) *out_err = GF_URL_ERROR;
+		return NULL;
+	}
+	bs = gf_bs_from_file(index->file, GF_BITSTREAM_READ);
+	index->file_size = gf_bs_get_size(bs);
+
+	/*only box headers are read until the first sidx*/
+	while (!has_sidx && (gf_bs_available(bs) >= 8)) {
+		u64 pos = gf_bs_get_position(bs);
+		u64 size = gf_bs_read_u32(bs);
+		u32 type = gf_bs_read_u32(bs);
+		if (size==1) size = gf_bs_read_u64(bs);
+		else if (!size) size = index->file_size - pos;
+		if ((size < 8) || (pos + size > index->file_size)) {
+			e = GF_ISOM_INVALID_FILE;
+			break;
+		}
+		switch (type) {
+		case GF_ISOM_BOX_TYPE_SIDX:
+			e = dasher_index_load_sidx(index, bs, pos, 0);
+			has_sidx = 1;
+			break;
+		case GF_ISOM_BOX_TYPE_MOOF:
+			/*fragments before any index, this is not an indexed file*/
+			e = GF_NOT_SUPPORTED;
+			break;
+		case GF_ISOM_BOX_TYPE_MOOV:
+			index->init_end_range = pos + size - 1;
+			/*fall through*/
+		default:
+			gf_bs_seek(bs, pos + size);
+			break;
+		}
+		if (e) break;
+	}
+	gf_bs_del(bs);
+
+	if (!e && !has_sidx) e = GF_NOT_SUPPORTED;
+	if (!e && !index->nb_segments) e = GF_ISOM_INVALID_FILE;
+	if (e) {
+		if (e==GF_NOT_SUPPORTED) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Index: file %s has no segment index\n", file_name));
+		}
+		gf_dasher_index_del(index);
+		if (out_err) *out_err = e;
+		return NULL;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Index: %d segments and %d subsegments in %s\n", index->nb_segments, index->nb_subsegments, file_name));
+	if (out_err) *out_err = GF_OK;
+	return index;
+}
+
+GF_EXPORT
+void gf_dasher_index_del(GF_DASHSegmentIndex *index)
+{
+	if (!index) return;
+	if (index->file) fclose(index->file);
+	if (index->segments) gf_free(index->segments);
+	if (index->subsegments) gf_free(index->subsegments);
+	if (index->copy_buffer) gf_free(index->copy_buffer);
+	gf_free(index);
+}
+
+GF_EXPORT
+void gf_dasher_index_get_info(GF_DASHSegmentIndex *index, u32 *timescale, u64 *file_size, u64 *init_end_range, u64 *index_start_range, u64 *index_end_range)
+{
+	if (timescale) *timescale = index->timescale;
+	if (file_size) *file_size = index->file_size;
+	if (init_end_range) *init_end_range = index->init_end_range;
+	if (index_start_range) *index_start_range = index->index_start_range;
+	if (index_end_range) *index_end_range = index->index_end_range;
+}
+
+GF_EXPORT
+u32 gf_dasher_index_get_segment_count(GF_DASHSegmentIndex *index)
+{
+	return index ? index->nb_segments : 0;
+}
+
+GF_EXPORT
+const GF_DASHIndexRange *gf_dasher_index_get_segment(GF_DASHSegmentIndex *index, u32 segment_idx)
+{
+	if (!index || (segment_idx >= index->nb_segments)) return NULL;
+	return &index->segments[segment_idx].range;
+}
+
+GF_EXPORT
+u32 gf_dasher_index_get_subsegment_count(GF_DASHSegmentIndex *index, u32 segment_idx)
+{
+	if (!index || (segment_idx >= index->nb_segments)) return 0;
+	return index->segments[segment_idx].nb_subsegments;
+}
+
+GF_EXPORT
+const GF_DASHIndexRange *gf_dasher_index_get_subsegment(GF_DASHSegmentIndex *index, u32 segment_idx, u32 subsegment_idx)
+{
+	if (!index || (segment_idx >= index->nb_segments)) return NULL;
+	if (subsegment_idx >= index->segments[segment_idx].nb_subsegments) return NULL;
+	return &index->subsegments[index->segments[segment_idx].first_subsegment + subsegment_idx];
+}
+
+/*binary search of the last range starting at or before time*/
+static u32 dasher_index_find_range(GF_DASHIndexRange *ranges, u32 count, u32 stride, u64 time)
+{
+	u32 low = 0, high = count;
+	while (high - low > 1) {
+		u32 mid = (low + high) / 2;
+		GF_DASHIndexRange *r = (GF_DASHIndexRange *) ((char *) ranges + mid*stride);
+		if (r->earliest_presentation_time <= time) low = mid;
+		else high = mid;
+	}
+	return low;
+}
+
+GF_EXPORT
+GF_Err gf_dasher_index_find(GF_DASHSegmentIndex *index, u64 time, u32 *segment_idx, u32 *subsegment_idx)
+{
+	u32 seg_idx, sub_idx;
+	GF_DASHIndexSegment *seg;
+	if (!index) return GF_BAD_PARAM;
+
+	seg_idx = dasher_index_find_range(&index->segments[0].range, index->nb_segments, sizeof(GF_DASHIndexSegment), time);
+	seg = &index->segments[seg_idx];
+	/*before the first or after the last segment*/
+	if ((time < seg->range.earliest_presentation_time) || (time >= seg->range.earliest_presentation_time + seg->range.duration))
+		return GF_EOS;
+	sub_idx = 0;
+	if (seg->nb_subsegments)
+		sub_idx = dasher_index_find_range(&index->subsegments[seg->first_subsegment], seg->nb_subsegments, sizeof(GF_DASHIndexRange), time);
+	if (segment_idx) *segment_idx = seg_idx;
+	if (subsegment_idx) *subsegment_idx = sub_idx;
+	return GF_OK;
+}
+
+#ifdef DASH_INDEX_USE_SENDFILE
+/*waits for the socket to be writable, at most one second*/
+static Bool dasher_index_wait_write(s32 fd)
+{
+	fd_set group;
+	struct timeval timeout;
+	FD_ZERO(&group);
+	FD_SET(fd, &group);
+	timeout.tv_sec = 1;
+	timeout.tv_usec = 0;
+	return (select(fd+1, NULL, &group, NULL, &timeout) > 0) ? 1 : 0;
+}
+#endif
+
+GF_EXPORT
+GF_Err gf_dasher_index_send_range(GF_DASHSegmentIndex *index, u64 start_range, u64 end_range, GF_Socket *sock, u64 *bytes_sent)
+{
+	u64 done = 0, size;
+	GF_Err e = GF_OK;
+
+	if (bytes_sent) *bytes_sent = 0;
+	if (!index || !sock || (start_range > end_range) || (end_range >= index->file_size)) return GF_BAD_PARAM;
+	size = end_range - start_range + 1;
+
+#ifdef DASH_INDEX_USE_SENDFILE
+	/*zero-copy: the kernel moves file pages to the socket*/
+	if ((sizeof(off_t) >= 8) || (end_range < 0x7FFFFFFF)) {
+		s32 sk = gf_sk_get_handle(sock);
+		s32 fd = fileno(index->file);
+		off_t offset = (off_t) start_range;
+		while (done < size) {
+			size_t to_send = (size - done > 0x40000000) ? 0x40000000 : (size_t) (size - done);
+			ssize_t res = sendfile(sk, fd, &offset, to_send);
+			if (res > 0) {
+				done += res;
+				continue;
+			}
+			if (!res) {
+				e = GF_IO_ERR;
+			} else if ((errno == EAGAIN) || (errno == EINTR)) {
+				if ((errno == EINTR) || dasher_index_wait_write(sk)) continue;
+				e = GF_IP_SOCK_WOULD_BLOCK;
+			} else if ((errno == EPIPE) || (errno == ECONNRESET)) {
+				e = GF_IP_CONNECTION_CLOSED;
+			} else {
+				e = GF_IP_NETWORK_FAILURE;
+			}
+			break;
+		}
+		if (bytes_sent) *bytes_sent = done;
+		return e;
+	}
+#endif
+
+	if (!index->copy_buffer) {
+		index->copy_buffer = gf_malloc(sizeof(char) * DASH_INDEX_COPY_SIZE);
+		if (!index->copy_buffer) return GF_OUT_OF_MEM;
+	}
+	gf_f64_seek(index->file, start_range, SEEK_SET);
+	while (done < size) {
+		u32 to_read = (size - done > DASH_INDEX_COPY_SIZE) ? DASH_INDEX_COPY_SIZE : (u32) (size - done);
+		u32 read = (u32) fread(index->copy_buffer, 1, to_read, index->file);
+		if (read != to_read) {
+			e = GF_IO_ERR;
+			break;
+		}
+		e = gf_sk_send_wait(sock, index->copy_buffer, read, 1);
+		if (e) break;
+		done += read;
 	}
+	if (bytes_sent) *bytes_sent = done;
 	return e;
 }
 
+#endif /*GPAC_DISABLE_ISOM*/
 
 
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
@@ -31,6 +31,7 @@
 #include "../../include/gpac/constants.h"
 #include "../../include/gpac/internal/isomedia_dev.h"
 #include "../../include/gpac/crypt.h"
+#include "../../include/gpac/thread.h"
 
 
 #if !defined(GPAC_DISABLE_MCRYPT)
@@ -286,99 +287,296 @@ static GFINLINE void resync_IV(GF_Crypt *mc, u64 BSO, char *salt)
 	}
 }
 
+/*replace AVC start codes (0x00000001) by nalu size*/
+static void isma_avc_start_codes_to_sizes(char *data, u32 size)
+{
+	u32 nalu_size;
+	u32 remain = size;
+	char *start, *end;
+	start = data;
+	end = start + 4;
+	while (remain>4) {
+		if (!end[0] && !end[1] && !end[2] && (end[3]==0x01)) {
+			nalu_size = end - start - 4;
+			start[0] = (nalu_size>>24)&0xFF;
+			start[1] = (nalu_size>>16)&0xFF;
+			start[2] = (nalu_size>>8)&0xFF;
+			start[3] = (nalu_size)&0xFF;
+			start = end;
+			end = start+4;
+			continue;
+		}
+		end++;
+		remain--;
+	}
+	nalu_size = end - start - 4;
+	start[0] = (nalu_size>>24)&0xFF;
+	start[1] = (nalu_size>>16)&0xFF;
+	start[2] = (nalu_size>>8)&0xFF;
+	start[3] = (nalu_size)&0xFF;
+}
+
+/*isma e&a stores AVC1 in AVC/H264 annex B bitstream fashion, with 0x00000001 start codes*/
+static void isma_avc_sizes_to_start_codes(char *data, u32 size)
+{
+	u32 done = 0;
+	u8 *d = (u8 *) data;
+	while (done < size) {
+		u32 nal_size = GF_4CC(d[0], d[1], d[2], d[3]);
+		d[0] = d[1] = d[2] = 0; d[3] = 1;
+		d += 4 + nal_size;
+		done += 4 + nal_size;
+	}
+}
+
+/*multithreaded sample processing: samples are read and written back in order by the calling thread, by windows of
+ISMACRYP_SAMPLES_PER_THREAD samples per thread. Since the counter of each sample is derived from its byte stream
+offset, the samples of a window are processed independently by the workers*/
+#define ISMACRYP_SAMPLES_PER_THREAD	16
+
+static u32 ismacryp_nb_threads = 0;
+
 GF_EXPORT
-GF_Err gf_ismacryp_decrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*progress)(void *cbk, u64 done, u64 total), void *cbk)
+void gf_ismacryp_set_threads(u32 nb_threads)
+{
+	ismacryp_nb_threads = nb_threads;
+}
+
+typedef struct
 {
-	GF_Err e;
-	Bool use_sel_enc;
-	u32 track, count, i, j, si, is_avc;
 	GF_ISOSample *samp;
+	/*for decryption*/
 	GF_ISMASample *ismasamp;
+	char *data;
+	u32 size;
+	u64 BSO;
+	Bool encrypted;
+} ISMACrypJob;
+
+typedef struct __isma_crypt_pool ISMACrypPool;
+
+typedef struct
+{
+	ISMACrypPool *pool;
+	u32 idx;
 	GF_Crypt *mc;
-	unsigned char IV[17];
-	u32 IV_size;
-	Bool prev_sample_encrypted;
-	GF_ESD *esd;
+	GF_Thread *th;
+	GF_Semaphore *start;
+} ISMACrypWorker;
 
-	track = gf_isom_get_track_by_id(mp4, tci->trackID);
-	e = gf_isom_get_ismacryp_info(mp4, track, 1, &is_avc, NULL, NULL, NULL, NULL, &use_sel_enc, &IV_size, NULL);
-	is_avc = (is_avc==GF_4CC('2','6','4','b')) ? 1 : 0;
+struct __isma_crypt_pool
+{
+	Bool decrypt, is_avc, run;
+	char *salt;
+	/*sequential mode*/
+	GF_Crypt *mc;
+	Bool prev_encrypted;
 
+	u32 nb_threads;
+	ISMACrypWorker *workers;
+	GF_Semaphore *done;
 
-	mc = gf_crypt_open("AES-128", "CTR");
-	if (!mc) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ISMA E&A] Cannot open AES-128 CTR cryptography\n", tci->trackID));
-		return GF_IO_ERR;
+	ISMACrypJob *jobs;
+	u32 nb_jobs, window;
+};
+
+static void isma_process_job(ISMACrypPool *pool, GF_Crypt *mc, ISMACrypJob *job, Bool force_resync)
+{
+	if (!pool->decrypt && pool->is_avc) isma_avc_sizes_to_start_codes(job->data, job->size);
+
+	if (job->encrypted) {
+		if (force_resync || !pool->prev_encrypted) resync_IV(mc, job->BSO, pool->salt);
+		if (pool->decrypt) gf_crypt_decrypt(mc, job->data, job->size);
+		else gf_crypt_encrypt(mc, job->data, job->size);
+	}
+	if (pool->decrypt && pool->is_avc) isma_avc_start_codes_to_sizes(job->data, job->size);
+}
+
+static u32 isma_worker_run(void *par)
+{
+	ISMACrypWorker *w = (ISMACrypWorker *) par;
+	ISMACrypPool *pool = w->pool;
+	while (1) {
+		u32 i;
+		gf_sema_wait(w->start);
+		if (!pool->run) break;
+		for (i=w->idx; i<pool->nb_jobs; i+=pool->nb_threads) {
+			isma_process_job(pool, w->mc, &pool->jobs[i], 1);
+		}
+		gf_sema_notify(pool->done, 1);
 	}
+	return 0;
+}
 
+static GF_Crypt *isma_open_crypt(GF_TrackCryptInfo *tci)
+{
+	GF_Err e;
+	char IV[16];
+	GF_Crypt *mc = gf_crypt_open("AES-128", "CTR");
+	if (!mc) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ISMA E&A] Cannot open AES-128 CTR cryptography\n"));
+		return NULL;
+	}
 	memset(IV, 0, sizeof(char)*16);
 	memcpy(IV, tci->salt, sizeof(char)*8);
 	e = gf_crypt_init(mc, tci->key, 16, IV);
 	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ISMA E&A] Cannot initialize AES-128 CTR (%s)\n", gf_error_to_string(e)) );
 		gf_crypt_close(mc);
-		GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ISMA E&A] cannot initialize AES-128 CTR (%s)\n", gf_error_to_string(e)));
-		return GF_IO_ERR;
+		return NULL;
 	}
+	return mc;
+}
 
-	GF_LOG(GF_LOG_INFO, GF_LOG_AUTHOR, ("[ISMA E&A] Decrypting track ID %d - KMS: %s%s\n", tci->trackID, tci->KMS_URI, use_sel_enc ? " - Selective Decryption" : ""));
+static void isma_pool_del(ISMACrypPool *pool)
+{
+	u32 i;
+	if (pool->workers) {
+		pool->run = 0;
+		for (i=0; i<pool->nb_threads; i++) {
+			ISMACrypWorker *w = &pool->workers[i];
+			if (w->th) {
+				gf_sema_notify(w->start, 1);
+				gf_th_stop(w->th);
+				gf_th_del(w->th);
+			}
+			if (w->start) gf_sema_del(w->start);
+			if (w->mc) gf_crypt_close(w->mc);
+		}
+		gf_free(pool->workers);
+	}
+	if (pool->done) gf_sema_del(pool->done);
+	if (pool->mc) gf_crypt_close(pool->mc);
+	if (pool->jobs) gf_free(pool->jobs);
+	gf_free(pool);
+}
 
+/*nb_threads: number of worker threads, 0 or 1 processes samples in the calling thread*/
+static ISMACrypPool *isma_pool_new(GF_TrackCryptInfo *tci, Bool decrypt, Bool is_avc, u32 nb_threads)
+{
+	u32 i;
+	ISMACrypPool *pool;
+	GF_SAFEALLOC(pool, ISMACrypPool);
+	pool->decrypt = decrypt;
+	pool->is_avc = is_avc;
+	pool->salt = (char *) tci->salt;
 	/*start as initialized*/
-	prev_sample_encrypted = 1;
-	/* decrypt each sample */
-	count = gf_isom_get_sample_count(mp4, track);
-	for (i = 0; i < count; i++) {
-		samp = gf_isom_get_sample(mp4, track, i+1, &si);
-		ismasamp = gf_isom_get_ismacryp_sample(mp4, track, samp, si);
+	pool->prev_encrypted = 1;
+	pool->run = 1;
+	pool->window = 1;
+
+	/*the crypto state is always created in this thread, since the AES tables are lazily initialized*/
+	pool->mc = isma_open_crypt(tci);
+	if (!pool->mc) {
+		isma_pool_del(pool);
+		return NULL;
+	}
+	if (nb_threads > 1) {
+		pool->nb_threads = nb_threads;
+		pool->window = pool->nb_threads * ISMACRYP_SAMPLES_PER_THREAD;
+		pool->done = gf_sema_new(pool->nb_threads, 0);
+		pool->workers = (ISMACrypWorker *) gf_malloc(sizeof(ISMACrypWorker) * pool->nb_threads);
+		memset(pool->workers, 0, sizeof(ISMACrypWorker) * pool->nb_threads);
+		for (i=0; i<pool->nb_threads; i++) {
+			ISMACrypWorker *w = &pool->workers[i];
+			w->pool = pool;
+			w->idx = i;
+			w->mc = isma_open_crypt(tci);
+			w->start = gf_sema_new(1, 0);
+			w->th = gf_th_new("ISMACrypWorker");
+			if (!w->mc || !w->start || !w->th || gf_th_run(w->th, isma_worker_run, w)) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_AUTHOR, ("[ISMA E&A] Cannot start worker threads - using single thread\n"));
+				if (w->th) gf_th_del(w->th);
+				w->th = NULL;
+				pool->nb_threads = i+1;
+				isma_pool_del(pool);
+				return isma_pool_new(tci, decrypt, is_avc, 0);
+			}
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_AUTHOR, ("[ISMA E&A] Using %d worker threads\n", pool->nb_threads));
+	}
+	pool->jobs = (ISMACrypJob *) gf_malloc(sizeof(ISMACrypJob) * pool->window);
+	memset(pool->jobs, 0, sizeof(ISMACrypJob) * pool->window);
+	return pool;
+}
 
-		gf_free(samp->data);
-		samp->data = ismasamp->data;
-		samp->dataLength = ismasamp->dataLength;
-		ismasamp->data = NULL;
-		ismasamp->dataLength = 0;
-
-		/* Decrypt payload */
-		if (ismasamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED) {
-			/*restore IV*/
-			if (!prev_sample_encrypted) resync_IV(mc, ismasamp->IV, tci->salt);
-			gf_crypt_decrypt(mc, samp->data, samp->dataLength);
+/*processes the current window of samples*/
+static void isma_pool_process(ISMACrypPool *pool)
+{
+	u32 i;
+	if (!pool->nb_threads || (pool->nb_jobs==1)) {
+		for (i=0; i<pool->nb_jobs; i++) {
+			isma_process_job(pool, pool->mc, &pool->jobs[i], 0);
+			pool->prev_encrypted = pool->jobs[i].encrypted;
 		}
-		prev_sample_encrypted = (ismasamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED);
-		gf_isom_ismacryp_delete_sample(ismasamp);
-
-		/*replace AVC start codes (0x00000001) by nalu size*/
-		if (is_avc) {
-			u32 nalu_size;
-			u32 remain = samp->dataLength;
-			char *start, *end;
-			start = samp->data;
-			end = start + 4;
-			while (remain>4) {
-				if (!end[0] && !end[1] && !end[2] && (end[3]==0x01)) {
-					nalu_size = end - start - 4;
-					start[0] = (nalu_size>>24)&0xFF;
-					start[1] = (nalu_size>>16)&0xFF;
-					start[2] = (nalu_size>>8)&0xFF;
-					start[3] = (nalu_size)&0xFF;
-					start = end;
-					end = start+4;
-					continue;
-				}
-				end++;
-				remain--;
-			}
-			nalu_size = end - start - 4;
-			start[0] = (nalu_size>>24)&0xFF;
-			start[1] = (nalu_size>>16)&0xFF;
-			start[2] = (nalu_size>>8)&0xFF;
-			start[3] = (nalu_size)&0xFF;
+		return;
+	}
+	for (i=0; i<pool->nb_threads; i++) {
+		gf_sema_notify(pool->workers[i].start, 1);
+	}
+	for (i=0; i<pool->nb_threads; i++) {
+		gf_sema_wait(pool->done);
+	}
+	/*sequential state no longer in sync*/
+	pool->prev_encrypted = 0;
+}
+
+GF_EXPORT
+GF_Err gf_ismacryp_decrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*progress)(void *cbk, u64 done, u64 total), void *cbk)
+{
+	GF_Err e;
+	Bool use_sel_enc;
+	u32 track, count, i, j, si, is_avc;
+	GF_ISOSample *samp;
+	GF_ISMASample *ismasamp;
+	ISMACrypPool *pool;
+	u32 IV_size;
+	GF_ESD *esd;
+
+	track = gf_isom_get_track_by_id(mp4, tci->trackID);
+	e = gf_isom_get_ismacryp_info(mp4, track, 1, &is_avc, NULL, NULL, NULL, NULL, &use_sel_enc, &IV_size, NULL);
+	is_avc = (is_avc==GF_4CC('2','6','4','b')) ? 1 : 0;
+
+
+	pool = isma_pool_new(tci, 1, is_avc, ismacryp_nb_threads);
+	if (!pool) return GF_IO_ERR;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_AUTHOR, ("[ISMA E&A] Decrypting track ID %d - KMS: %s%s\n", tci->trackID, tci->KMS_URI, use_sel_enc ? " - Selective Decryption" : ""));
+
+	/* decrypt each sample */
+	count = gf_isom_get_sample_count(mp4, track);
+	for (i = 0; i < count; i += pool->nb_jobs) {
+		pool->nb_jobs = MIN(pool->window, count - i);
+		for (j=0; j<pool->nb_jobs; j++) {
+			ISMACrypJob *job = &pool->jobs[j];
+			samp = gf_isom_get_sample(mp4, track, i+j+1, &si);
+			ismasamp = gf_isom_get_ismacryp_sample(mp4, track, samp, si);
+
+			gf_free(samp->data);
+			samp->data = ismasamp->data;
+			samp->dataLength = ismasamp->dataLength;
+			ismasamp->data = NULL;
+			ismasamp->dataLength = 0;
+
+			job->samp = samp;
+			job->data = samp->data;
+			job->size = samp->dataLength;
+			job->BSO = ismasamp->IV;
+			job->encrypted = (ismasamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED) ? 1 : 0;
+			gf_isom_ismacryp_delete_sample(ismasamp);
 		}
 
-		gf_isom_update_sample(mp4, track, i+1, samp, 1);
-		gf_isom_sample_del(&samp);
-		gf_set_progress("ISMA Decrypt", i+1, count);
+		isma_pool_process(pool);
+
+		for (j=0; j<pool->nb_jobs; j++) {
+			samp = pool->jobs[j].samp;
+			gf_isom_update_sample(mp4, track, i+j+1, samp, 1);
+			gf_isom_sample_del(&samp);
+			gf_set_progress("ISMA Decrypt", i+j+1, count);
+		}
 	}
 
-	gf_crypt_close(mc);
+	isma_pool_del(pool);
 	/*and remove protection info*/
 	e = gf_isom_remove_ismacryp_protection(mp4, track, 1);
 	if (e) {
@@ -553,11 +751,10 @@ GF_Err gf_ismacryp_decrypt_file(GF_ISOFile *mp4, const char *drm_file)
 GF_EXPORT
 GF_Err gf_ismacryp_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*progress)(void *cbk, u64 done, u64 total), void *cbk)
 {
-	char IV[16];
 	GF_ISOSample *samp;
 	GF_ISMASample *isamp;
-	GF_Crypt *mc;
-	u32 i, count, di, track, IV_size, rand, avc_size_length;
+	ISMACrypPool *pool;
+	u32 i, j, count, di, track, IV_size, rand, avc_size_length;
 	u64 BSO, range_end;
 	GF_ESD *esd;
 	GF_IPMPPtr *ipmpdp;
@@ -567,7 +764,7 @@ GF_Err gf_ismacryp_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (
 	GF_IPMPX_ISMACryp *ismac;
 #endif
 	GF_Err e;
-	Bool prev_sample_encryped, has_crypted_samp;
+	Bool has_crypted_samp;
 
 	avc_size_length = 0;
 	track = gf_isom_get_track_by_id(mp4, tci->trackID);
@@ -619,19 +816,8 @@ GF_Err gf_ismacryp_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (
 	GF_LOG(GF_LOG_INFO, GF_LOG_AUTHOR, ("[ISMA E&A] Encrypting track ID %d - KMS: %s%s\n", tci->trackID, tci->KMS_URI, tci->sel_enc_type ? " - Selective Encryption" : ""));
 
 	/*init crypto*/
-	memset(IV, 0, sizeof(char)*16);
-	memcpy(IV, tci->salt, sizeof(char)*8);
-	mc = gf_crypt_open("AES-128", "CTR");
-	if (!mc) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ISMA E&A] Cannot open AES-128 CTR\n"));
-		return GF_IO_ERR;
-	}
-	e = gf_crypt_init(mc, tci->key, 16, IV);
-	if (e) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[ISMA E&A] Cannot initialize AES-128 CTR (%s)\n", gf_error_to_string(e)) );
-		gf_crypt_close(mc);
-		return GF_IO_ERR;
-	}
+	pool = isma_pool_new(tci, 0, avc_size_length ? 1 : 0, ismacryp_nb_threads);
+	if (!pool) return GF_IO_ERR;
 	if (!stricmp(tci->KMS_URI, "self")) {
 		char Data[100], d64[100];
 		u32 s64;
@@ -661,11 +847,13 @@ GF_Err gf_ismacryp_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (
 			tci->TextualHeadersLen,
 			(tci->sel_enc_type!=0) ? 1 : 0, 0, IV_size);
 	}
-	if (e) return e;
+	if (e) {
+		isma_pool_del(pool);
+		return e;
+	}
 
 	has_crypted_samp = 0;
 	BSO = 0;
-	prev_sample_encryped = 1;
 	range_end = 0;
 	if (tci->sel_enc_type==GF_ISMACRYP_SELENC_PREVIEW) {
 		range_end = gf_isom_get_media_timescale(mp4, track) * tci->sel_enc_range;
@@ -674,91 +862,87 @@ GF_Err gf_ismacryp_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (
 	if (gf_isom_has_time_offset(mp4, track)) gf_isom_set_cts_packing(mp4, track, 1);
 
 	count = gf_isom_get_sample_count(mp4, track);
-	for (i = 0; i < count; i++) {
-		samp = gf_isom_get_sample(mp4, track, i+1, &di);
-
-		isamp = gf_isom_ismacryp_new_sample();
-		isamp->IV_length = IV_size;
-		isamp->KI_length = 0;
-
-		switch (tci->sel_enc_type) {
-		case GF_ISMACRYP_SELENC_RAP:
-			if (samp->IsRAP) isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-			break;
-		case GF_ISMACRYP_SELENC_NON_RAP:
-			if (!samp->IsRAP) isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-			break;
-		/*random*/
-		case GF_ISMACRYP_SELENC_RAND:
-			rand = gf_rand();
-			if (rand%2) isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-			break;
-		/*random every sel_freq samples*/
-		case GF_ISMACRYP_SELENC_RAND_RANGE:
-			if (!(i%tci->sel_enc_range)) has_crypted_samp = 0;
-			if (!has_crypted_samp) {
+	for (i = 0; i < count; i += pool->nb_jobs) {
+		pool->nb_jobs = MIN(pool->window, count - i);
+		for (j=0; j<pool->nb_jobs; j++) {
+			ISMACrypJob *job = &pool->jobs[j];
+			u32 flags = 0;
+			samp = gf_isom_get_sample(mp4, track, i+j+1, &di);
+
+			switch (tci->sel_enc_type) {
+			case GF_ISMACRYP_SELENC_RAP:
+				if (samp->IsRAP) flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				break;
+			case GF_ISMACRYP_SELENC_NON_RAP:
+				if (!samp->IsRAP) flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				break;
+			/*random*/
+			case GF_ISMACRYP_SELENC_RAND:
 				rand = gf_rand();
-				if (!(rand%tci->sel_enc_range)) isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-
-				if (!(isamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED) && !( (1+i)%tci->sel_enc_range)) {
-					isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				if (rand%2) flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				break;
+			/*random every sel_freq samples*/
+			case GF_ISMACRYP_SELENC_RAND_RANGE:
+				if (!((i+j)%tci->sel_enc_range)) has_crypted_samp = 0;
+				if (!has_crypted_samp) {
+					rand = gf_rand();
+					if (!(rand%tci->sel_enc_range)) flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+
+					if (!(flags & GF_ISOM_ISMA_IS_ENCRYPTED) && !( (1+i+j)%tci->sel_enc_range)) {
+						flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+					}
+					has_crypted_samp = (flags & GF_ISOM_ISMA_IS_ENCRYPTED);
 				}
-				has_crypted_samp = (isamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED);
-			}
-			break;
-		/*every sel_freq samples*/
-		case GF_ISMACRYP_SELENC_RANGE:
-			if (!(i%tci->sel_enc_type)) isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-			break;
-		case GF_ISMACRYP_SELENC_PREVIEW:
-			if (samp->DTS + samp->CTS_Offset >= range_end)
-				isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-			break;
-		case 0:
-			isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
-			break;
-		default:
-			break;
-		}
-		if (tci->sel_enc_type) isamp->flags |= GF_ISOM_ISMA_USE_SEL_ENC;
-
-		/*isma e&a stores AVC1 in AVC/H264 annex B bitstream fashion, with 0x00000001 start codes*/
-		if (avc_size_length) {
-			u32 done = 0;
-			u8 *d = samp->data;
-			while (done < samp->dataLength) {
-				u32 nal_size = GF_4CC(d[0], d[1], d[2], d[3]);
-				d[0] = d[1] = d[2] = 0; d[3] = 1;
-				d += 4 + nal_size;
-				done += 4 + nal_size;
+				break;
+			/*every sel_freq samples*/
+			case GF_ISMACRYP_SELENC_RANGE:
+				if (!((i+j)%tci->sel_enc_type)) flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				break;
+			case GF_ISMACRYP_SELENC_PREVIEW:
+				if (samp->DTS + samp->CTS_Offset >= range_end)
+					flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				break;
+			case 0:
+				flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+				break;
+			default:
+				break;
 			}
+			job->samp = samp;
+			job->data = samp->data;
+			job->size = samp->dataLength;
+			job->BSO = BSO;
+			job->encrypted = (flags & GF_ISOM_ISMA_IS_ENCRYPTED) ? 1 : 0;
+			BSO += samp->dataLength;
 		}
 
-		if (isamp->flags & GF_ISOM_ISMA_IS_ENCRYPTED) {
-			/*resync IV*/
-			if (!prev_sample_encryped) resync_IV(mc, BSO, tci->salt);
-			gf_crypt_encrypt(mc, samp->data, samp->dataLength);
-			prev_sample_encryped = 1;
-		} else {
-			prev_sample_encryped = 0;
+		isma_pool_process(pool);
+
+		for (j=0; j<pool->nb_jobs; j++) {
+			ISMACrypJob *job = &pool->jobs[j];
+			samp = job->samp;
+
+			isamp = gf_isom_ismacryp_new_sample();
+			isamp->IV_length = IV_size;
+			isamp->KI_length = 0;
+			if (job->encrypted) isamp->flags |= GF_ISOM_ISMA_IS_ENCRYPTED;
+			if (tci->sel_enc_type) isamp->flags |= GF_ISOM_ISMA_USE_SEL_ENC;
+
+			isamp->IV = job->BSO;
+			isamp->data = samp->data;
+			isamp->dataLength = samp->dataLength;
+			samp->data = NULL;
+			samp->dataLength = 0;
+
+			gf_isom_ismacryp_sample_to_sample(isamp, samp);
+			gf_isom_ismacryp_delete_sample(isamp);
+			gf_isom_update_sample(mp4, track, i+j+1, samp, 1);
+			gf_isom_sample_del(&samp);
+			gf_set_progress("ISMA Encrypt", i+j+1, count);
 		}
-
-
-		isamp->IV = BSO;
-		BSO += samp->dataLength;
-		isamp->data = samp->data;
-		isamp->dataLength = samp->dataLength;
-		samp->data = NULL;
-		samp->dataLength = 0;
-
-		gf_isom_ismacryp_sample_to_sample(isamp, samp);
-		gf_isom_ismacryp_delete_sample(isamp);
-		gf_isom_update_sample(mp4, track, i+1, samp, 1);
-		gf_isom_sample_del(&samp);
-		gf_set_progress("ISMA Encrypt", i+1, count);
 	}
 	gf_isom_set_cts_packing(mp4, track, 0);
-	gf_crypt_close(mc);
+	isma_pool_del(pool);
 
 
 	/*format as IPMP(X) - note that the ISMACryp spec is broken since it always uses IPMPPointers to a
@@ -87,13 +87,15 @@ GF_Err gf_media_change_par(GF_ISOFile *file, u32 track, s32 ar_num, s32 ar_den)
 }
 #endif /*GPAC_DISABLE_ISOM_WRITE*/
 
+#define FILE_HASH_BLOCK_SIZE	(256*1024)
+
 GF_EXPORT
 GF_Err gf_media_get_file_hash(const char *file, u8 hash[20])
 {
 #ifdef GPAC_DISABLE_CORE_TOOLS
 	return GF_NOT_SUPPORTED;
 #else
-	u8 block[1024];
+	u8 *block;
 	u32 read;
 	u64 size, tot;
 	FILE *in;
@@ -104,6 +106,8 @@ GF_Err gf_media_get_file_hash(const char *file, u8 hash[20])
 #endif
 
 	in = gf_f64_open(file, "rb");
+	if (!in) return GF_URL_ERROR;
+	block = (u8 *) gf_malloc(sizeof(u8) * FILE_HASH_BLOCK_SIZE);
 	gf_f64_seek(in, 0, SEEK_END);
 	size = gf_f64_tell(in);
 	gf_f64_seek(in, 0, SEEK_SET);
@@ -132,7 +136,7 @@ GF_Err gf_media_get_file_hash(const char *file, u8 hash[20])
 			} else {
 				u32 bsize = 0;
 				while (bsize<box_size) {
-					u32 to_read = (u32) ((box_size-bsize<1024) ? (box_size-bsize) : 1024);
+					u32 to_read = (u32) ((box_size-bsize<FILE_HASH_BLOCK_SIZE) ? (box_size-bsize) : FILE_HASH_BLOCK_SIZE);
 					gf_bs_read_data(bs, block, to_read);
 					gf_sha1_update(ctx, block, to_read);
 					bsize += to_read;
@@ -142,7 +146,8 @@ GF_Err gf_media_get_file_hash(const char *file, u8 hash[20])
 		} else
 #endif
 		{
-			read = fread(block, 1, 1024, in);
+			read = fread(block, 1, FILE_HASH_BLOCK_SIZE, in);
+			if (!read) break;
 			gf_sha1_update(ctx, block, read);
 			tot += read;
 		}
@@ -151,6 +156,7 @@ GF_Err gf_media_get_file_hash(const char *file, u8 hash[20])
 #ifndef GPAC_DISABLE_ISOM
 	if (bs) gf_bs_del(bs);
 #endif
+	gf_free(block);
 	fclose(in);
 	return GF_OK;
 #endif
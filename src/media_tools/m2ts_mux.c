@@ -172,7 +172,8 @@ void gf_m2ts_mux_table_update(GF_M2TS_Mux_Stream *stream, u8 table_id, u16 table
 			section->length = remain + overhead_size;
 		}
 
-		bs = gf_bs_new(NULL,0,GF_BITSTREAM_WRITE);
+		/*section size is known, allocate it once*/
+		bs = gf_bs_new(NULL, section->length, GF_BITSTREAM_WRITE);
 
 		/* first header (not included in section length */
 		gf_bs_write_int(bs,	table_id, 8);
@@ -343,7 +344,8 @@ void gf_m2ts_mux_table_update_mpeg4(GF_M2TS_Mux_Stream *stream, u8 table_id, u16
 		}
 		sl_size = section->length - overhead_size - slhdr_size;
 
-		bs = gf_bs_new(NULL,0,GF_BITSTREAM_WRITE);
+		/*section size is known, allocate it once*/
+		bs = gf_bs_new(NULL, section->length, GF_BITSTREAM_WRITE);
 
 		/* first header (not included in section length */
 		gf_bs_write_int(bs,	table_id, 8);
@@ -42,6 +42,9 @@
 
 #ifndef GPAC_DISABLE_MEDIA_IMPORT
 
+/*read cache for importers parsing their input through a file bitstream*/
+#define IMPORT_READ_CACHE_SIZE	65536
+
 
 GF_Err gf_import_message(GF_MediaImporter *import, GF_Err e, char *format, ...)
 {
@@ -513,6 +516,7 @@ GF_Err gf_import_aac_adts(GF_MediaImporter *import)
 	if (!in) return gf_import_message(import, GF_URL_ERROR, "Opening file %s failed", import->in_name);
 
 	bs = gf_bs_from_file(in, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_CACHE_SIZE);
 
 	sync_frame = ADTS_SyncFrame(bs, &hdr);
 	if (!sync_frame) {
@@ -759,6 +763,7 @@ static GF_Err gf_import_cmp(GF_MediaImporter *import, Bool mpeg12)
 	mdia = gf_f64_open(import->in_name, "rb");
 	if (!mdia) return gf_import_message(import, GF_URL_ERROR, "Opening %s failed", import->in_name);
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_CACHE_SIZE);
 
 	samp = NULL;
 	vparse = gf_m4v_parser_bs_new(bs, mpeg12);
@@ -2538,6 +2543,7 @@ GF_Err gf_import_nhml_dims(GF_MediaImporter *import, Bool dims_doc)
 	strcat(szInfo, ".info");
 
 	parser = gf_xml_dom_new();
+	gf_xml_dom_use_arena(parser, 1);
 	e = gf_xml_dom_parse(parser, import->in_name, nhml_on_progress, import);
 	if (e) {
 		fclose(nhml);
@@ -3578,6 +3584,7 @@ GF_Err gf_import_h263(GF_MediaImporter *import)
 
 	e = GF_OK;
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_CACHE_SIZE);
 	if (!H263_IsStartCode(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find H263 Picture Start Code");
 		goto exit;
@@ -3799,6 +3806,7 @@ restart_import:
 	sei_recovery_frame_count = -1;
 
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_CACHE_SIZE);
 	if (!gf_media_nalu_is_start_code(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find H264 start code");
 		goto exit;
@@ -4676,6 +4684,7 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 	spss = ppss = vpss = NULL;
 
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_CACHE_SIZE);
 	if (!gf_media_nalu_is_start_code(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find H264 start code");
 		goto exit;
@@ -5935,6 +5944,7 @@ GF_Err gf_import_saf(GF_MediaImporter *import)
 	track = 0;
 
 	bs = gf_bs_from_file(saf, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_CACHE_SIZE);
 	tot = gf_bs_get_size(bs);
 
 	while (gf_bs_available(bs)) {
@@ -6095,7 +6105,7 @@ GF_Err gf_import_saf(GF_MediaImporter *import)
 #endif
 }
 
-typedef struct
+typedef struct __ts_import
 {
 	GF_MediaImporter *import;
 	u32 track;
@@ -6113,6 +6123,14 @@ typedef struct
 	u32 nb_video, nb_video_configured;
 	u32 nb_audio, nb_audio_configured;
 
+	/*single-pass multi-track import: one sub-importer per selected PID, demuxer events are dispatched to them*/
+	struct __ts_import *sub_imports;
+	u32 nb_sub_imports;
+	/*set for sub-importers: samples of all tracks are interleaved in the destination file, so the AU being
+	reassembled is kept in memory until complete rather than appended in place*/
+	Bool buffer_au, has_pending;
+	GF_ISOSample pending;
+	u32 pending_alloc;
 } GF_TSImport;
 
 #ifndef GPAC_DISABLE_MPEG2TS
@@ -6274,17 +6292,11 @@ static void m2ts_create_track(GF_TSImport *tsimp, u32 mtype, u32 stype, u32 oti,
 	}
 }
 
-/*rewrite last AVC sample currently stored in Annex-B format to ISO format (rewrite start code)*/
-void m2ts_rewrite_avc_sample(GF_MediaImporter *import, GF_TSImport *tsimp)
+static void m2ts_rewrite_avc_nalus(GF_ISOSample *samp)
 {
-	GF_Err e;
 	u32 sc_pos, start;
 	GF_BitStream *bs;
-	GF_ISOSample *samp;
-	u32 count = gf_isom_get_sample_count(import->dest, tsimp->track);
-	if (!count || !tsimp->avccfg) return;
 
-	samp = gf_isom_get_sample(import->dest, tsimp->track, count, NULL);
 	sc_pos = 1;
 	start = 0;
 	bs = gf_bs_new(samp->data, samp->dataLength, GF_BITSTREAM_WRITE);
@@ -6301,6 +6313,24 @@ void m2ts_rewrite_avc_sample(GF_MediaImporter *import, GF_TSImport *tsimp)
 	gf_bs_write_u32(bs, samp->dataLength-start-4);
 
 	gf_bs_del(bs);
+}
+
+/*rewrite last AVC sample currently stored in Annex-B format to ISO format (rewrite start code)*/
+void m2ts_rewrite_avc_sample(GF_MediaImporter *import, GF_TSImport *tsimp)
+{
+	GF_Err e;
+	GF_ISOSample *samp;
+	u32 count;
+
+	if (tsimp->buffer_au) {
+		if (tsimp->has_pending && tsimp->avccfg) m2ts_rewrite_avc_nalus(&tsimp->pending);
+		return;
+	}
+	count = gf_isom_get_sample_count(import->dest, tsimp->track);
+	if (!count || !tsimp->avccfg) return;
+
+	samp = gf_isom_get_sample(import->dest, tsimp->track, count, NULL);
+	m2ts_rewrite_avc_nalus(samp);
 
 	e = gf_isom_update_sample(import->dest, tsimp->track, count, samp, 1);
 	if (e) {
@@ -6309,6 +6339,55 @@ void m2ts_rewrite_avc_sample(GF_MediaImporter *import, GF_TSImport *tsimp)
 	gf_isom_sample_del(&samp);
 }
 
+static GF_Err m2ts_flush_sample(GF_TSImport *tsimp)
+{
+	if (!tsimp->has_pending) return GF_OK;
+	tsimp->has_pending = 0;
+	return gf_isom_add_sample(tsimp->import->dest, tsimp->track, 1, &tsimp->pending);
+}
+
+static GF_Err m2ts_append_sample_data(GF_TSImport *tsimp, char *data, u32 data_len)
+{
+	if (!tsimp->buffer_au) return gf_isom_append_sample_data(tsimp->import->dest, tsimp->track, data, data_len);
+
+	if (!tsimp->has_pending) return GF_BAD_PARAM;
+	if (tsimp->pending.dataLength + data_len > tsimp->pending_alloc) {
+		tsimp->pending_alloc = 2*(tsimp->pending.dataLength + data_len);
+		tsimp->pending.data = (char*)gf_realloc(tsimp->pending.data, sizeof(char)*tsimp->pending_alloc);
+		if (!tsimp->pending.data) return GF_OUT_OF_MEM;
+	}
+	memcpy(tsimp->pending.data + tsimp->pending.dataLength, data, sizeof(char)*data_len);
+	tsimp->pending.dataLength += data_len;
+	return GF_OK;
+}
+
+static GF_Err m2ts_add_sample(GF_TSImport *tsimp, GF_ISOSample *samp)
+{
+	GF_Err e;
+	if (!tsimp->buffer_au) return gf_isom_add_sample(tsimp->import->dest, tsimp->track, 1, samp);
+
+	e = m2ts_flush_sample(tsimp);
+	tsimp->pending.DTS = samp->DTS;
+	tsimp->pending.CTS_Offset = samp->CTS_Offset;
+	tsimp->pending.IsRAP = samp->IsRAP;
+	tsimp->pending.dataLength = 0;
+	tsimp->has_pending = 1;
+	if (!e) e = m2ts_append_sample_data(tsimp, samp->data, samp->dataLength);
+	return e;
+}
+
+static GF_Err m2ts_set_sample_rap(GF_TSImport *tsimp)
+{
+	if (!tsimp->buffer_au) return gf_isom_set_sample_rap(tsimp->import->dest, tsimp->track);
+	if (tsimp->has_pending) tsimp->pending.IsRAP = 1;
+	return GF_OK;
+}
+
+static u32 m2ts_get_sample_count(GF_TSImport *tsimp)
+{
+	return gf_isom_get_sample_count(tsimp->import->dest, tsimp->track) + (tsimp->has_pending ? 1 : 0);
+}
+
 static void hevc_cfg_add_nalu(GF_HEVCConfig *hevccfg, u8 nal_type, char *data, u32 data_len)
 {
 	u32 i, count;
@@ -6337,14 +6416,13 @@ static void hevc_cfg_add_nalu(GF_HEVCConfig *hevccfg, u8 nal_type, char *data, u
 	}
 }
 
-void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+static void m2ts_import_event(GF_M2TS_Demuxer *ts, GF_TSImport *tsimp, u32 evt_type, void *par)
 {
 	GF_Err e;
 	GF_ISOSample *samp;
 	Bool is_au_start;
 	u32 i, count, idx;
 	GF_M2TS_Program *prog;
-	GF_TSImport *tsimp = (GF_TSImport *) ts->user;
 	GF_MediaImporter *import= (GF_MediaImporter *)tsimp->import;
 	GF_M2TS_ES *es = NULL;
 	GF_M2TS_PES *pes = NULL;
@@ -6850,9 +6928,9 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 			}
 
 			if (!is_au_start) {
-				e = gf_isom_append_sample_data(import->dest, tsimp->track, (char*)pck->data, pck->data_len);
+				e = m2ts_append_sample_data(tsimp, (char*)pck->data, pck->data_len);
 				if (e) {
-					if (!gf_isom_get_sample_count(import->dest, tsimp->track)) {
+					if (!m2ts_get_sample_count(tsimp)) {
 						GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] missed begining of sample data\n"));
 						e = GF_OK;
 					} else {
@@ -6864,7 +6942,7 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 				if (pck->flags & GF_M2TS_PES_PCK_B_FRAME) tsimp->nb_b++;
 
 				if (pck->flags & GF_M2TS_PES_PCK_RAP) {
-					e = gf_isom_set_sample_rap(import->dest, tsimp->track);
+					e = m2ts_set_sample_rap(tsimp);
 				}
 				return;
 			}
@@ -6912,11 +6990,11 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 				samp->dataLength = pck->data_len;
 
 				if (samp->DTS && (samp->DTS==tsimp->last_dts)) {
-					e = gf_isom_append_sample_data(import->dest, tsimp->track, (char*)pck->data, pck->data_len);
+					e = m2ts_append_sample_data(tsimp, (char*)pck->data, pck->data_len);
 				} else {
 
 					if (tsimp->avccfg) m2ts_rewrite_avc_sample(import, tsimp);
-					e = gf_isom_add_sample(import->dest, tsimp->track, 1, samp);
+					e = m2ts_add_sample(tsimp, samp);
 				}
 				if (e) {
 					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] PID %d: Error adding sample: %s\n", pck->stream->pid, gf_error_to_string(e)));
@@ -7022,7 +7100,7 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 				gf_sl_depacketize(import->esd->slConfig, &hdr, sl_pck->data, sl_pck->data_len, &hdr_len);
 
 				if (!hdr.accessUnitStartFlag) {
-					e = gf_isom_append_sample_data(import->dest, tsimp->track, sl_pck->data + hdr_len, sl_pck->data_len - hdr_len);
+					e = m2ts_append_sample_data(tsimp, sl_pck->data + hdr_len, sl_pck->data_len - hdr_len);
 					if (e) {
 						GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] Error appending sample data\n"));
 					}
@@ -7054,13 +7132,13 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 						samp->IsRAP = import->esd->slConfig->useRandomAccessPointFlag ? hdr.randomAccessPointFlag: 1;
 
 						/*fix for some DMB streams where TSs are not coded*/
-						if ((tsimp->last_dts == samp->DTS) && gf_isom_get_sample_count(import->dest, tsimp->track))
+						if ((tsimp->last_dts == samp->DTS) && m2ts_get_sample_count(tsimp))
 							samp->DTS += gf_isom_get_media_timescale(import->dest, tsimp->track);
 
 						samp->data = sl_pck->data + hdr_len;
 						samp->dataLength = sl_pck->data_len - hdr_len;
 
-						e = gf_isom_add_sample(import->dest, tsimp->track, 1, samp);
+						e = m2ts_add_sample(tsimp, samp);
 						/*if CTS was not specified, samples will simply be skipped*/
 						if (e) {
 							GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS Import] PID %d Error adding sample\n", sl_pck->stream->pid));
@@ -7086,15 +7164,117 @@ void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
 		break;
 	}
 }
+/*finalizes the track of an importer once the whole TS has been demuxed*/
+static GF_Err m2ts_import_finalize(GF_M2TS_Demuxer *ts, GF_TSImport *tsimp)
+{
+	GF_Err e;
+	GF_MediaImporter *import = tsimp->import;
+	GF_M2TS_ES *es = (GF_M2TS_ES *)ts->ess[import->trackID];
+	if (!es) return gf_import_message(import, GF_BAD_PARAM, "Unknown PID %d", import->trackID);
+
+	if (tsimp->avccfg) {
+		u32 w = ((GF_M2TS_PES*)es)->vid_w;
+		u32 h = ((GF_M2TS_PES*)es)->vid_h;
+		gf_isom_avc_config_update(import->dest, tsimp->track, 1, tsimp->avccfg);
+		gf_isom_set_visual_info(import->dest, tsimp->track, 1, w, h);
+		gf_isom_set_track_layout_info(import->dest, tsimp->track, w<<16, h<<16, 0, 0, 0);
+
+		m2ts_rewrite_avc_sample(import, tsimp);
+
+		gf_odf_avc_cfg_del(tsimp->avccfg);
+		tsimp->avccfg = NULL;
+	}
+	e = m2ts_flush_sample(tsimp);
+	if (e) return e;
+
+	if (tsimp->track) {
+		MP4T_RecomputeBitRate(import->dest, tsimp->track);
+		/* creation of the edit lists */
+		if ((es->first_dts != es->program->first_dts) && gf_isom_get_sample_count(import->dest, tsimp->track) ){
+			u32 media_ts, moov_ts, offset;
+			u64 dur;
+			media_ts = gf_isom_get_media_timescale(import->dest, tsimp->track);
+			moov_ts = gf_isom_get_timescale(import->dest);
+			assert(es->program->first_dts <= es->first_dts);
+			offset = (u32)(es->first_dts - es->program->first_dts) * moov_ts / media_ts;
+			dur = gf_isom_get_media_duration(import->dest, tsimp->track) * moov_ts / media_ts;
+			gf_isom_set_edit_segment(import->dest, tsimp->track, 0, offset, 0, GF_ISOM_EDIT_EMPTY);
+			gf_isom_set_edit_segment(import->dest, tsimp->track, offset, dur, 0, GF_ISOM_EDIT_NORMAL);
+			gf_import_message(import, GF_OK, "Timeline offset: %d ms", offset);
+		}
+
+		if (tsimp->nb_p) {
+			gf_import_message(import, GF_OK, "Import results: %d VOPs (%d Is - %d Ps - %d Bs)", gf_isom_get_sample_count(import->dest, tsimp->track), tsimp->nb_i, tsimp->nb_p, tsimp->nb_b);
+		}
+
+		if (es->program->pmt_iod)
+			gf_isom_set_brand_info(import->dest, GF_ISOM_BRAND_MP42, 1);
+	}
+	return GF_OK;
+}
+
+static GF_TSImport *m2ts_get_sub_import(GF_TSImport *tsimp, u32 pid)
+{
+	u32 i;
+	for (i=0; i<tsimp->nb_sub_imports; i++) {
+		if (tsimp->sub_imports[i].import->trackID == pid) return &tsimp->sub_imports[i];
+	}
+	return NULL;
+}
+
+void on_m2ts_import_data(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	u32 i;
+	GF_TSImport *sub;
+	GF_TSImport *tsimp = (GF_TSImport *) ts->user;
+
+	if (!tsimp->nb_sub_imports) {
+		m2ts_import_event(ts, tsimp, evt_type, par);
+		return;
+	}
+
+	switch (evt_type) {
+	case GF_M2TS_EVT_PMT_FOUND:
+		for (i=0; i<tsimp->nb_sub_imports; i++) {
+			m2ts_import_event(ts, &tsimp->sub_imports[i], evt_type, par);
+		}
+		/*each importer switches all streams of its program to raw framing but its own PID: restore the framing of all imported PIDs*/
+		for (i=0; i<tsimp->nb_sub_imports; i++) {
+			GF_M2TS_ES *es = ts->ess[tsimp->sub_imports[i].import->trackID];
+			if (es && (es->program == (GF_M2TS_Program *)par) && !(es->flags & GF_M2TS_ES_IS_SECTION))
+				gf_m2ts_set_pes_framing((GF_M2TS_PES *)es, GF_M2TS_PES_FRAMING_DEFAULT);
+		}
+		break;
+	case GF_M2TS_EVT_AAC_CFG:
+		sub = m2ts_get_sub_import(tsimp, ((GF_M2TS_PES_PCK *)par)->stream->pid);
+		if (sub) m2ts_import_event(ts, sub, evt_type, par);
+		break;
+	case GF_M2TS_EVT_PES_PCK:
+		/*packets from PIDs not imported are only used to locate the program first DTS, any importer can handle them*/
+		sub = m2ts_get_sub_import(tsimp, ((GF_M2TS_PES_PCK *)par)->stream->pid);
+		m2ts_import_event(ts, sub ? sub : &tsimp->sub_imports[0], evt_type, par);
+		break;
+	case GF_M2TS_EVT_SL_PCK:
+		sub = m2ts_get_sub_import(tsimp, ((GF_M2TS_SL_PCK *)par)->stream->pid);
+		m2ts_import_event(ts, sub ? sub : &tsimp->sub_imports[0], evt_type, par);
+		break;
+	default:
+		sub = &tsimp->sub_imports[0];
+		m2ts_import_event(ts, sub, evt_type, par);
+		if (sub->import->flags & GF_IMPORT_DO_ABORT) tsimp->import->flags |= GF_IMPORT_DO_ABORT;
+		break;
+	}
+}
+
 /* Warning: we start importing only after finding the PMT */
 GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 {
 	GF_M2TS_Demuxer *ts;
-	GF_M2TS_ES *es;
 	char data[188];
 	GF_TSImport tsimp;
 	u64 fsize, done;
 	u32 size;
+	GF_Err e;
 	Bool do_import = 1;
 	FILE *mts;
 	char progress[1000];
@@ -7137,7 +7317,7 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 	import->flags &= ~GF_IMPORT_DO_ABORT;
 
 	if (import->last_error) {
-		GF_Err e = import->last_error;
+		e = import->last_error;
 		import->last_error = GF_OK;
 		if (tsimp.avccfg) gf_odf_avc_cfg_del(tsimp.avccfg);
   		gf_m2ts_demux_del(ts);
@@ -7151,56 +7331,113 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 		gf_m2ts_print_info(ts);
 	}
 
-	if (!(import->flags & GF_IMPORT_PROBE_ONLY)) {
-		es = (GF_M2TS_ES *)ts->ess[import->trackID];
-  		if (!es) {
-  			gf_m2ts_demux_del(ts);
-  			fclose(mts);
-  			return gf_import_message(import, GF_BAD_PARAM, "Unknown PID %d", import->trackID);
-  		}
+	e = GF_OK;
+	if (!(import->flags & GF_IMPORT_PROBE_ONLY)) e = m2ts_import_finalize(ts, &tsimp);
 
-		if (tsimp.avccfg) {
-			u32 w = ((GF_M2TS_PES*)es)->vid_w;
-			u32 h = ((GF_M2TS_PES*)es)->vid_h;
-			gf_isom_avc_config_update(import->dest, tsimp.track, 1, tsimp.avccfg);
-			gf_isom_set_visual_info(import->dest, tsimp.track, 1, w, h);
-			gf_isom_set_track_layout_info(import->dest, tsimp.track, w<<16, h<<16, 0, 0, 0);
+	gf_m2ts_demux_del(ts);
+	fclose(mts);
+	return e;
+}
 
+/*single-pass import of several PIDs: the TS is read and demuxed once and each packet is handed to the importer of its PID*/
+static GF_Err gf_import_mpeg_ts_multi(GF_MediaImporter *import, u32 nb_tracks, u32 *track_nums, u32 *final_trackIDs)
+{
+	GF_M2TS_Demuxer *ts;
+	char data[188];
+	GF_TSImport tsimp;
+	GF_MediaImporter *imports;
+	u64 fsize, done;
+	u32 i, size;
+	GF_Err e;
+	FILE *mts;
+	char progress[1000];
 
-			m2ts_rewrite_avc_sample(import, &tsimp);
+	for (i=0; i<nb_tracks; i++) {
+		if (track_nums[i] >= GF_M2TS_MAX_STREAMS)
+			return gf_import_message(import, GF_BAD_PARAM, "Invalid PID %d", track_nums[i]);
+	}
 
-			gf_odf_avc_cfg_del(tsimp.avccfg);
-		}
+	mts = gf_f64_open(import->in_name, "rb");
+	if (!mts) return gf_import_message(import, GF_URL_ERROR, "Opening file %s failed", import->in_name);
 
+	gf_f64_seek(mts, 0, SEEK_END);
+	fsize = gf_f64_tell(mts);
+	gf_f64_seek(mts, 0, SEEK_SET);
+	done = 0;
 
-		if (tsimp.track) {
-			MP4T_RecomputeBitRate(import->dest, tsimp.track);
-			/* creation of the edit lists */
-			if ((es->first_dts != es->program->first_dts) && gf_isom_get_sample_count(import->dest, tsimp.track) ){
-				u32 media_ts, moov_ts, offset;
-				u64 dur;
-				media_ts = gf_isom_get_media_timescale(import->dest, tsimp.track);
-				moov_ts = gf_isom_get_timescale(import->dest);
-				assert(es->program->first_dts <= es->first_dts);
-				offset = (u32)(es->first_dts - es->program->first_dts) * moov_ts / media_ts;
-				dur = gf_isom_get_media_duration(import->dest, tsimp.track) * moov_ts / media_ts;
-				gf_isom_set_edit_segment(import->dest, tsimp.track, 0, offset, 0, GF_ISOM_EDIT_EMPTY);
-				gf_isom_set_edit_segment(import->dest, tsimp.track, offset, dur, 0, GF_ISOM_EDIT_NORMAL);
-				gf_import_message(import, GF_OK, "Timeline offset: %d ms", offset);
-			}
+	memset(&tsimp, 0, sizeof(GF_TSImport));
+	tsimp.import = import;
+	tsimp.sub_imports = (GF_TSImport *) gf_malloc(sizeof(GF_TSImport) * nb_tracks);
+	imports = (GF_MediaImporter *) gf_malloc(sizeof(GF_MediaImporter) * nb_tracks);
+	if (!tsimp.sub_imports || !imports) {
+		if (tsimp.sub_imports) gf_free(tsimp.sub_imports);
+		if (imports) gf_free(imports);
+		fclose(mts);
+		return GF_OUT_OF_MEM;
+	}
+	memset(tsimp.sub_imports, 0, sizeof(GF_TSImport) * nb_tracks);
+	tsimp.nb_sub_imports = nb_tracks;
+	for (i=0; i<nb_tracks; i++) {
+		memcpy(&imports[i], import, sizeof(GF_MediaImporter));
+		imports[i].trackID = track_nums[i];
+		imports[i].final_trackID = 0;
+		imports[i].esd = NULL;
+		imports[i].last_error = GF_OK;
+		tsimp.sub_imports[i].import = &imports[i];
+		tsimp.sub_imports[i].avc.sps_active_idx = -1;
+		tsimp.sub_imports[i].buffer_au = 1;
+	}
 
-			if (tsimp.nb_p) {
-				gf_import_message(import, GF_OK, "Import results: %d VOPs (%d Is - %d Ps - %d Bs)", gf_isom_get_sample_count(import->dest, tsimp.track), tsimp.nb_i, tsimp.nb_p, tsimp.nb_b);
-			}
+	ts = gf_m2ts_demux_new();
+	ts->on_event = on_m2ts_import_data;
+	ts->user = &tsimp;
+
+	ts->dvb_h_demux = (import->flags & GF_IMPORT_MPE_DEMUX) ? 1 : 0;
+
+	sprintf(progress, "Importing MPEG-2 TS (%d PIDs)", nb_tracks);
+	gf_import_message(import, GF_OK, progress);
+
+	while (!feof(mts)) {
+		size = fread(data, sizeof(char), 188, mts);
+		if (size<188)
+			break;
+
+		gf_m2ts_process_data(ts, data, size);
+		if (import->flags & GF_IMPORT_DO_ABORT) break;
+		done += size;
+		gf_set_progress(progress, (u32) (done/1024), (u32) (fsize/1024));
+	}
+	import->flags &= ~GF_IMPORT_DO_ABORT;
 
-			if (es->program->pmt_iod)
-				gf_isom_set_brand_info(import->dest, GF_ISOM_BRAND_MP42, 1);
+	e = GF_OK;
+	for (i=0; i<nb_tracks; i++) {
+		if (imports[i].last_error) {
+			e = imports[i].last_error;
+			break;
+		}
+	}
+	if (!e) {
+		gf_set_progress(progress, (u32) (fsize/1024), (u32) (fsize/1024));
+		if (! (import->flags & GF_IMPORT_MPE_DEMUX)) {
+			gf_m2ts_print_info(ts);
+		}
+		for (i=0; i<nb_tracks; i++) {
+			e = m2ts_import_finalize(ts, &tsimp.sub_imports[i]);
+			if (e) break;
+			if (final_trackIDs) final_trackIDs[i] = imports[i].final_trackID;
+			if (imports[i].final_trackID) import->final_trackID = imports[i].final_trackID;
 		}
 	}
 
+	for (i=0; i<nb_tracks; i++) {
+		if (tsimp.sub_imports[i].avccfg) gf_odf_avc_cfg_del(tsimp.sub_imports[i].avccfg);
+		if (tsimp.sub_imports[i].pending.data) gf_free(tsimp.sub_imports[i].pending.data);
+	}
+	gf_free(tsimp.sub_imports);
+	gf_free(imports);
 	gf_m2ts_demux_del(ts);
 	fclose(mts);
-	return GF_OK;
+	return e;
 }
 
 #endif /*GPAC_DISABLE_MPEG2TS*/
@@ -7844,6 +8081,20 @@ GF_Err gf_media_import_chapters(GF_ISOFile *file, char *chap_file, Double import
 	return gf_media_import(&import);
 }
 
+#ifndef GPAC_DISABLE_MPEG2TS
+static Bool import_is_mpeg_ts(char *ext, char *fmt)
+{
+	if (!strnicmp(ext, ".ts", 3) || !strnicmp(ext, ".m2t", 4)
+		|| !stricmp(fmt, "MPEGTS") || !stricmp(fmt, "MPEG-TS")
+		|| !stricmp(fmt, "MPGTS") || !stricmp(fmt, "MPG-TS")
+		|| !stricmp(fmt, "MPEG2TS")  || !stricmp(fmt, "MPEG2-TS")
+		|| !stricmp(fmt, "MPG2TS")  || !stricmp(fmt, "MPG2-TS")
+		)
+		return 1;
+	return 0;
+}
+#endif
+
 GF_EXPORT
 GF_Err gf_media_import(GF_MediaImporter *importer)
 {
@@ -7910,12 +8161,7 @@ GF_Err gf_media_import(GF_MediaImporter *importer)
 
 #ifndef GPAC_DISABLE_MPEG2TS
 	/*MPEG-2 TS*/
-	if (!strnicmp(ext, ".ts", 3) || !strnicmp(ext, ".m2t", 4)
-		|| !stricmp(fmt, "MPEGTS") || !stricmp(fmt, "MPEG-TS")
-		|| !stricmp(fmt, "MPGTS") || !stricmp(fmt, "MPG-TS")
-		|| !stricmp(fmt, "MPEG2TS")  || !stricmp(fmt, "MPEG2-TS")
-		|| !stricmp(fmt, "MPG2TS")  || !stricmp(fmt, "MPG2-TS")
-		) {
+	if (import_is_mpeg_ts(ext, fmt)) {
 		return gf_import_mpeg_ts(importer);
 	}
 #endif
@@ -8017,6 +8263,33 @@ GF_Err gf_media_import(GF_MediaImporter *importer)
 	return gf_import_message(importer, e, "Unknown input file type");
 }
 
+GF_EXPORT
+GF_Err gf_media_import_tracks(GF_MediaImporter *importer, u32 nb_tracks, u32 *track_nums, u32 *final_trackIDs)
+{
+	u32 i;
+	GF_Err e;
+	if (!importer || !importer->dest || !nb_tracks || !track_nums || (importer->flags & GF_IMPORT_PROBE_ONLY)) return GF_BAD_PARAM;
+
+#ifndef GPAC_DISABLE_MPEG2TS
+	if ((nb_tracks>1) && !importer->orig && !importer->esd && importer->in_name) {
+		char *ext = importer->force_ext ? importer->force_ext : strrchr(importer->in_name, '.');
+		if (import_is_mpeg_ts(ext ? ext : "", importer->streamFormat ? importer->streamFormat : "")
+			&& !gf_isom_probe_file(importer->in_name)
+		)
+			return gf_import_mpeg_ts_multi(importer, nb_tracks, track_nums, final_trackIDs);
+	}
+#endif
+
+	for (i=0; i<nb_tracks; i++) {
+		importer->trackID = track_nums[i];
+		importer->final_trackID = 0;
+		e = gf_media_import(importer);
+		if (e) return e;
+		if (final_trackIDs) final_trackIDs[i] = importer->final_trackID;
+	}
+	return GF_OK;
+}
+
 
 GF_EXPORT
 GF_Err gf_media_change_pl(GF_ISOFile *file, u32 track, u32 profile, u32 compat, u32 level)
@@ -98,7 +98,7 @@ static u32 gf_m2ts_reframe_reset(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, Bool sam
 		gf_free(pes->data);
 		pes->data = NULL;
 	}
-	pes->data_len = 0;
+	pes->data_len = pes->data_alloc = 0;
 	if (pes->prev_data) {
 		gf_free(pes->prev_data);
 		pes->prev_data = NULL;
@@ -454,7 +454,7 @@ static u32 gf_m2ts_reframe_aac_adts(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, Bool
 	pck.PTS = PTS;
 	pck.flags = 0;
 
-	if (pes->frame_state && (data[pes->frame_state]==0xFF) && ((data[pes->frame_state+1] & 0xF0) == 0xF0)) {
+	if (pes->frame_state && (pes->frame_state+1 < data_len) && (data[pes->frame_state]==0xFF) && ((data[pes->frame_state+1] & 0xF0) == 0xF0)) {
 		assert(pes->frame_state<=data_len);
 		/*dispatch frame*/
 		pck.stream = pes;
@@ -524,7 +524,7 @@ static u32 gf_m2ts_reframe_aac_adts(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, Bool
 		gf_bs_del(bs);
 
 		/*make sure we are sync if we have more data following*/
-		if (sc_pos + hdr.frame_size < data_len) {
+		if (sc_pos + hdr.frame_size + 1 < data_len) {
 			if ((hdr.frame_size < hdr_size) || (data[sc_pos + hdr.frame_size]!=0xFF) || ((data[sc_pos+hdr.frame_size+1] & 0xF0) != 0xF0)) {
 				sc_pos++;
 				continue;
@@ -1985,24 +1985,35 @@ void gf_m2ts_pes_header(GF_M2TS_PES *pes, unsigned char *data, u32 data_size, GF
 	}
 }
 
-static void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
+/*makes sure the PES re-assembly buffer can hold size bytes - the buffer is kept from one PES packet to the next*/
+static void gf_m2ts_pes_realloc(GF_M2TS_PES *pes, u32 size)
+{
+	if (size <= pes->data_alloc) return;
+	if (size < 2*pes->data_alloc) size = 2*pes->data_alloc;
+	pes->data = (unsigned char*)gf_realloc(pes->data, sizeof(char)*size);
+	pes->data_alloc = size;
+}
+
+/*parses and dispatches a complete PES packet - data is either the PES re-assembly buffer or, for PES packets
+carried in a single TS packet, the TS packet payload itself*/
+static void gf_m2ts_flush_pes_data(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, unsigned char *data, u32 data_len)
 {
 	GF_M2TS_PESHeader pesh;
 
 	/*we need at least a full, valid start code !!*/
-	if ((pes->data_len >= 4) && !pes->data[0] && !pes->data[1] && (pes->data[2]==0x1)) {
+	if ((data_len >= 4) && !data[0] && !data[1] && (data[2]==0x1)) {
 		u32 len;
-        u32 stream_id = pes->data[3] | 0x100;
+        u32 stream_id = data[3] | 0x100;
         if ((stream_id >= 0x1c0 && stream_id <= 0x1df) ||
               (stream_id >= 0x1e0 && stream_id <= 0x1ef) ||
               (stream_id == 0x1bd) ||
 			  /*SL-packetized*/
-			  ((u8) pes->data[3]==0xfa)
+			  ((u8) data[3]==0xfa)
 		) {
 			Bool same_pts = 0;
 
 			/*OK read header*/
-			gf_m2ts_pes_header(pes, pes->data+3, pes->data_len-3, &pesh);
+			gf_m2ts_pes_header(pes, data+3, data_len-3, &pesh);
 
 			/*send PES timing*/
 			if (ts->notify_pes_timing) {
@@ -2051,56 +2062,65 @@ static void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
 			/*3-byte start-code + 6 bytes header + hdr extensions*/
 			len = 9 + pesh.hdr_data_len;
 
-			if ((u8) pes->data[3]==0xfa) {
+			if ((u8) data[3]==0xfa) {
 				GF_M2TS_SL_PCK sl_pck;
 
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] SL Packet in PES for %d - ES ID %d\n", pes->pid, pes->mpeg4_es_id));
 
-				if (pes->data_len > len) {
-					sl_pck.data = pes->data + len;
-					sl_pck.data_len = pes->data_len - len;
+				if (data_len > len) {
+					sl_pck.data = data + len;
+					sl_pck.data_len = data_len - len;
 					sl_pck.stream = (GF_M2TS_ES *)pes;
 					if (ts->on_event) ts->on_event(ts, GF_M2TS_EVT_SL_PCK, &sl_pck);
 				} else {
-					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] Bad SL Packet size: (%d indicated < %d header)\n", pes->pid, pes->data_len, len));
+					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] Bad SL Packet size: (%d indicated < %d header)\n", pes->pid, data_len, len));
 				}
 			} else if (pes->reframe) {
 				u32 remain;
 				u32 offset = len;
 
-				if (pesh.pck_len && (pesh.pck_len-3-pesh.hdr_data_len != pes->data_len-len)) {
-					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PES payload size %d but received %d bytes\n", (u32) ( pesh.pck_len-3-pesh.hdr_data_len), pes->data_len-len));
+				if (pesh.pck_len && (pesh.pck_len-3-pesh.hdr_data_len != data_len-len)) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PES payload size %d but received %d bytes\n", (u32) ( pesh.pck_len-3-pesh.hdr_data_len), data_len-len));
 				}
 
 				if (pes->prev_data_len) {
 					assert(pes->prev_data_len < len);
 					offset = len - pes->prev_data_len;
-					memcpy(pes->data + offset, pes->prev_data, pes->prev_data_len);
+					memcpy(data + offset, pes->prev_data, pes->prev_data_len);
 				}
-				remain = pes->reframe(ts, pes, same_pts, pes->data+offset, pes->data_len-offset);
+				remain = pes->reframe(ts, pes, same_pts, data+offset, data_len-offset);
 
 				if (pes->prev_data) gf_free(pes->prev_data);
 				pes->prev_data = NULL;
 				pes->prev_data_len = 0;
 				if (remain) {
 					pes->prev_data = gf_malloc(sizeof(char)*remain);
-					memcpy(pes->prev_data, pes->data + pes->data_len - remain, remain);
+					memcpy(pes->prev_data, data + data_len - remain, remain);
 					pes->prev_data_len = remain;
 				}
 			}
 		} else {
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PES %d: unknown stream ID %08X\n", pes->pid, stream_id));
 		}
-	} else if (pes->data) {
+	} else if (data_len) {
 		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PES %d: Bad PES Header, discarding packet (maybe stream is encrypted ?)\n", pes->pid));
 	}
-	if (pes->data) gf_free(pes->data);
-	pes->data = NULL;
-	pes->data_len = 0;
 	pes->pes_len = 0;
 	pes->rap = 0;
 }
 
+static void gf_m2ts_flush_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes)
+{
+	gf_m2ts_flush_pes_data(ts, pes, pes->data, pes->data_len);
+	pes->data_len = 0;
+	/*PES skipped from now on, release the re-assembly buffer*/
+	if (!pes->reframe && pes->data) {
+		gf_free(pes->data);
+		pes->data = NULL;
+		pes->data_alloc = 0;
+	}
+}
+
 static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_Header *hdr, unsigned char *data, u32 data_size, GF_M2TS_AdaptationField *paf)
 {
 	u8 expect_cc;
@@ -2124,14 +2144,12 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 		}
 		if (disc) {
 			if (hdr->payload_start) {
-				if (pes->data) {
+				if (pes->data_len) {
 					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] PES %d: Packet discontinuity (%d expected - got %d) - may have lost end of previous PES\n", pes->pid, expect_cc, hdr->continuity_counter));
 				}
 			} else {
-				if (pes->data) {
+				if (pes->data_len) {
 					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[MPEG-2 TS] PES %d: Packet discontinuity (%d expected - got %d) - trashing PES packet\n", pes->pid, expect_cc, hdr->continuity_counter));
-					gf_free(pes->data);
-					pes->data = NULL;
 				}
 				pes->data_len = 0;
 				pes->pes_len = 0;
@@ -2153,8 +2171,7 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 	} else if (pes->pes_len && (pes->data_len + data_size == pes->pes_len + 6)) {
 		/* 6 = startcode+stream_id+length*/
 		/*reassemble pes*/
-		if (pes->data) pes->data = (char*)gf_realloc(pes->data, pes->data_len+data_size);
-		else pes->data = (char*)gf_malloc(data_size);
+		gf_m2ts_pes_realloc(pes, pes->data_len+data_size);
 		memcpy(pes->data+pes->data_len, data, data_size);
 		pes->data_len += data_size;
 		/*force discard*/
@@ -2163,7 +2180,7 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 	}
 
 	/*PES first fragment: flush previous packet*/
-	if (flush_pes && pes->data) {
+	if (flush_pes && pes->data_len) {
 		gf_m2ts_flush_pes(ts, pes);
 		if (!data_size) return;
 	}
@@ -2172,17 +2189,27 @@ static void gf_m2ts_process_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_H
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d: Waiting for PES header, trashing data\n", hdr->pid));
 		return;
 	}
-	/*reassemble*/
-	if (pes->data){
-		pes->data = (char*)gf_realloc(pes->data, pes->data_len+data_size);
-		//fprintf(stderr, "[MPEG-2 TS] REALLOC \n");
-	}else{
-		pes->data = (char*)gf_malloc(data_size);
+	if (paf && paf->random_access_indicator) pes->rap = 1;
+
+	/*the whole PES packet is in this TS packet: dispatch it from the TS payload without copying it. The NALU reframers
+	patch short start codes in place and bytes left over from the previous PES are inserted before the payload,
+	use the re-assembly buffer in these cases*/
+	if (hdr->payload_start && (data_size>=6) && !pes->prev_data_len && (((data[4]<<8) | data[5]) + 6 == data_size)
+		&& (pes->reframe != gf_m2ts_reframe_avc_h264) && (pes->reframe != gf_m2ts_reframe_hevc)
+	) {
+		pes->pes_len = (data[4]<<8) | data[5];
+		gf_m2ts_flush_pes_data(ts, pes, data, data_size);
+		return;
+	}
+
+	/*reassemble - the PES packet length, when known, is used to allocate the buffer once*/
+	if (hdr->payload_start && (data_size>=6) && ((data[4]<<8) | data[5]) ) {
+		gf_m2ts_pes_realloc(pes, ((data[4]<<8) | data[5]) + 6);
 	}
+	gf_m2ts_pes_realloc(pes, pes->data_len+data_size);
 	memcpy(pes->data+pes->data_len, data, data_size);
 	pes->data_len += data_size;
 
-	if (paf && paf->random_access_indicator) pes->rap = 1;
 	if (hdr->payload_start && !pes->pes_len && (pes->data_len>=6)) {
 		pes->pes_len = (pes->data[4]<<8) | pes->data[5];
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS] PID %d: Got PES packet len %d\n", pes->pid, pes->pes_len));
@@ -2224,6 +2251,437 @@ static void gf_m2ts_get_adaptation_field(GF_M2TS_Demuxer *ts, GF_M2TS_Adaptation
 #endif
 }
 
+#define GF_M2TS_INDEX_VERSION	2
+#define GF_M2TS_PTS_MASK	0x1FFFFFFFFULL
+
+GF_EXPORT
+GF_M2TS_Index *gf_m2ts_index_new()
+{
+	GF_M2TS_Index *idx;
+	GF_SAFEALLOC(idx, GF_M2TS_Index);
+	if (!idx) return NULL;
+	idx->tracks = gf_list_new();
+	return idx;
+}
+
+GF_EXPORT
+void gf_m2ts_index_del(GF_M2TS_Index *idx)
+{
+	if (!idx) return;
+	while (gf_list_count(idx->tracks)) {
+		GF_M2TS_IndexTrack *trk = (GF_M2TS_IndexTrack *)gf_list_last(idx->tracks);
+		gf_list_rem_last(idx->tracks);
+		if (trk->entries) gf_free(trk->entries);
+		gf_free(trk);
+	}
+	gf_list_del(idx->tracks);
+	gf_free(idx);
+}
+
+static GF_M2TS_IndexTrack *gf_m2ts_index_get_track(GF_M2TS_Index *idx, u32 pid, u32 stream_type, Bool is_pcr)
+{
+	GF_M2TS_IndexTrack *trk;
+	u16 *map = is_pcr ? idx->pcr_map : idx->pes_map;
+	if (map[pid]) return (GF_M2TS_IndexTrack *)gf_list_get(idx->tracks, map[pid]-1);
+
+	GF_SAFEALLOC(trk, GF_M2TS_IndexTrack);
+	if (!trk) return NULL;
+	trk->pid = pid;
+	trk->stream_type = stream_type;
+	trk->is_pcr = is_pcr;
+	gf_list_add(idx->tracks, trk);
+	map[pid] = gf_list_count(idx->tracks);
+	return trk;
+}
+
+static void gf_m2ts_index_add_entry(GF_M2TS_IndexTrack *trk, u64 dts, u32 cts_offset, u64 byte_pos, u32 flags)
+{
+	GF_M2TS_IndexEntry *ent;
+
+	/*unwrap 33 bits timestamps against the previous entry*/
+	if (trk->nb_entries) {
+		u64 last = trk->entries[trk->nb_entries-1].dts;
+		dts |= last & ~GF_M2TS_PTS_MASK;
+		if (dts + 0x100000000ULL < last) dts += GF_M2TS_PTS_MASK + 1;
+		else if ((dts > last + 0x100000000ULL) && (dts > GF_M2TS_PTS_MASK)) dts -= GF_M2TS_PTS_MASK + 1;
+	}
+	if (trk->nb_entries == trk->nb_alloc) {
+		trk->nb_alloc = trk->nb_alloc ? 2*trk->nb_alloc : 64;
+		trk->entries = (GF_M2TS_IndexEntry*)gf_realloc(trk->entries, sizeof(GF_M2TS_IndexEntry)*trk->nb_alloc);
+	}
+	ent = &trk->entries[trk->nb_entries];
+	trk->nb_entries++;
+	ent->dts = dts;
+	ent->byte_pos = byte_pos;
+	ent->cts_offset = (cts_offset>0xFFFF) ? 0xFFFF : cts_offset;
+	ent->flags = flags;
+}
+
+/*checks whether the start of a PES payload is a random access point - only the first TS packet of the PES is inspected*/
+static Bool gf_m2ts_index_is_rap(u32 stream_type, unsigned char *data, u32 size)
+{
+	u32 i, nal_type;
+	switch (stream_type) {
+	case GF_M2TS_VIDEO_MPEG1:
+	case GF_M2TS_VIDEO_MPEG2:
+	case GF_M2TS_VIDEO_MPEG4:
+	case GF_M2TS_VIDEO_H264:
+	case GF_M2TS_VIDEO_HEVC:
+		break;
+	case GF_M2TS_VIDEO_VC1:
+		return 0;
+	/*audio and other streams: every PES can be decoded independently*/
+	default:
+		return 1;
+	}
+
+	for (i=0; i+5<size; i++) {
+		if (data[i] || data[i+1] || (data[i+2]!=1)) continue;
+		switch (stream_type) {
+		case GF_M2TS_VIDEO_H264:
+			nal_type = data[i+3] & 0x1F;
+			if ((nal_type==GF_AVC_NALU_IDR_SLICE) || (nal_type==GF_AVC_NALU_SEQ_PARAM)) return 1;
+			if (nal_type==GF_AVC_NALU_NON_IDR_SLICE) return 0;
+			break;
+		case GF_M2TS_VIDEO_HEVC:
+			nal_type = (data[i+3] & 0x7E) >> 1;
+			/*IRAP pictures, VPS and SPS*/
+			if ((nal_type>=16) && (nal_type<=23)) return 1;
+			if ((nal_type==32) || (nal_type==33)) return 1;
+			if (nal_type<16) return 0;
+			break;
+		case GF_M2TS_VIDEO_MPEG1:
+		case GF_M2TS_VIDEO_MPEG2:
+			/*sequence header or GOP*/
+			if ((data[i+3]==0xB3) || (data[i+3]==0xB8)) return 1;
+			/*picture start code*/
+			if (data[i+3]==0x00) return (((data[i+5]>>3) & 0x7) == 1) ? 1 : 0;
+			break;
+		case GF_M2TS_VIDEO_MPEG4:
+			/*VOS, GOV or VOL*/
+			if ((data[i+3]==0xB0) || (data[i+3]==0xB3) || ((data[i+3]>=0x20) && (data[i+3]<=0x2F))) return 1;
+			/*VOP*/
+			if (data[i+3]==0xB6) return ((data[i+4]>>6) == 0) ? 1 : 0;
+			break;
+		}
+		i += 2;
+	}
+	return 0;
+}
+
+static void gf_m2ts_index_pes(GF_M2TS_Demuxer *ts, GF_M2TS_PES *pes, GF_M2TS_AdaptationField *paf, unsigned char *data, u32 size)
+{
+	GF_M2TS_IndexTrack *trk;
+	u64 pts, dts;
+	u32 flags, hdr_len;
+
+	if ((size < 14) || data[0] || data[1] || (data[2]!=1)) return;
+	/*no PTS, cannot be used for seeking*/
+	if (! (data[7] & 0x80)) return;
+	hdr_len = 9 + data[8];
+	if (hdr_len > size) return;
+	pts = dts = gf_m2ts_get_pts(data+9);
+	if ((data[7] & 0x40) && (size >= 19)) dts = gf_m2ts_get_pts(data+14);
+
+	flags = GF_M2TS_INDEX_PES;
+	if ((paf && paf->random_access_indicator) || gf_m2ts_index_is_rap(pes->stream_type, data+hdr_len, size-hdr_len))
+		flags |= GF_M2TS_INDEX_RAP;
+
+	trk = gf_m2ts_index_get_track(ts->index, pes->pid, pes->stream_type, 0);
+	if (trk) gf_m2ts_index_add_entry(trk, dts, (u32) ((pts + GF_M2TS_PTS_MASK + 1 - dts) & GF_M2TS_PTS_MASK), ts->pck_pos, flags);
+}
+
+static void gf_m2ts_index_pcr(GF_M2TS_Demuxer *ts, u32 pid, u64 pcr_base)
+{
+	GF_M2TS_IndexTrack *trk = gf_m2ts_index_get_track(ts->index, pid, 0, 1);
+	if (trk) gf_m2ts_index_add_entry(trk, pcr_base, 0, ts->pck_pos, GF_M2TS_INDEX_PCR);
+}
+
+static Bool gf_m2ts_index_is_video(u32 stream_type)
+{
+	switch (stream_type) {
+	case GF_M2TS_VIDEO_MPEG1:
+	case GF_M2TS_VIDEO_MPEG2:
+	case GF_M2TS_VIDEO_MPEG4:
+	case GF_M2TS_VIDEO_H264:
+	case GF_M2TS_VIDEO_HEVC:
+	case GF_M2TS_VIDEO_VC1:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static GF_M2TS_IndexTrack *gf_m2ts_index_ref_track(GF_M2TS_Index *idx, u32 pid)
+{
+	u32 i, count;
+	GF_M2TS_IndexTrack *first = NULL;
+
+	if (pid) {
+		if ((pid >= GF_M2TS_MAX_STREAMS) || !idx->pes_map[pid]) return NULL;
+		return (GF_M2TS_IndexTrack *)gf_list_get(idx->tracks, idx->pes_map[pid]-1);
+	}
+	count = gf_list_count(idx->tracks);
+	for (i=0; i<count; i++) {
+		GF_M2TS_IndexTrack *trk = (GF_M2TS_IndexTrack *)gf_list_get(idx->tracks, i);
+		if (trk->is_pcr || !trk->nb_entries) continue;
+		if (gf_m2ts_index_is_video(trk->stream_type)) return trk;
+		if (!first) first = trk;
+	}
+	return first;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_index_get_start(GF_M2TS_Index *idx, u32 pid, u64 *start_pts)
+{
+	GF_M2TS_IndexTrack *trk;
+	if (!idx || !start_pts) return GF_BAD_PARAM;
+	trk = gf_m2ts_index_ref_track(idx, pid);
+	if (!trk || !trk->nb_entries) return GF_NOT_SUPPORTED;
+	*start_pts = trk->entries[0].dts + trk->entries[0].cts_offset;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_index_find(GF_M2TS_Index *idx, u32 pid, u64 pts, u64 *byte_pos, u64 *rap_pts)
+{
+	GF_M2TS_IndexTrack *trk;
+	GF_M2TS_IndexEntry *ent;
+	u32 lo, hi, i;
+
+	if (!idx) return GF_BAD_PARAM;
+	trk = gf_m2ts_index_ref_track(idx, pid);
+	if (!trk || !trk->nb_entries) return GF_NOT_SUPPORTED;
+
+	/*number of entries with DTS lower than or equal to pts*/
+	lo = 0;
+	hi = trk->nb_entries;
+	while (lo < hi) {
+		u32 mid = (lo+hi) / 2;
+		if (trk->entries[mid].dts <= pts) lo = mid+1;
+		else hi = mid;
+	}
+	/*walk back to the last RAP presented at or before pts*/
+	ent = NULL;
+	for (i=lo; i>0; i--) {
+		GF_M2TS_IndexEntry *e = &trk->entries[i-1];
+		if ((e->flags & GF_M2TS_INDEX_RAP) && (e->dts + e->cts_offset <= pts)) {
+			ent = e;
+			break;
+		}
+	}
+	/*before the first RAP, use the first one*/
+	if (!ent) {
+		for (i=0; i<trk->nb_entries; i++) {
+			if (trk->entries[i].flags & GF_M2TS_INDEX_RAP) {
+				ent = &trk->entries[i];
+				break;
+			}
+		}
+		if (!ent) ent = &trk->entries[0];
+	}
+	if (byte_pos) *byte_pos = ent->byte_pos;
+	if (rap_pts) *rap_pts = ent->dts + ent->cts_offset;
+	if (!idx->complete && (lo == trk->nb_entries)) return GF_EOS;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_index_save(GF_M2TS_Index *idx, const char *sidecar)
+{
+	u32 i, j, count;
+	GF_BitStream *bs;
+	FILE *f;
+
+	if (!idx || !sidecar) return GF_BAD_PARAM;
+	f = gf_f64_open(sidecar, "wb");
+	if (!f) return GF_IO_ERR;
+	bs = gf_bs_from_file(f, GF_BITSTREAM_WRITE);
+	if (!bs) {
+		fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+
+	count = gf_list_count(idx->tracks);
+	gf_bs_write_u32(bs, GF_4CC('G','T','S','I'));
+	gf_bs_write_u8(bs, GF_M2TS_INDEX_VERSION);
+	gf_bs_write_u64(bs, idx->file_size);
+	gf_bs_write_u64(bs, idx->indexed_size);
+	gf_bs_write_u8(bs, idx->complete ? 1 : 0);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		u64 prev_dts = 0;
+		u64 prev_pos = 0;
+		GF_M2TS_IndexTrack *trk = (GF_M2TS_IndexTrack *)gf_list_get(idx->tracks, i);
+		gf_bs_write_u16(bs, trk->pid);
+		gf_bs_write_u16(bs, trk->stream_type);
+		gf_bs_write_u8(bs, trk->is_pcr ? 1 : 0);
+		gf_bs_write_u32(bs, trk->nb_entries);
+		/*entries are coded as byte offset and DTS deltas*/
+		for (j=0; j<trk->nb_entries; j++) {
+			GF_M2TS_IndexEntry *ent = &trk->entries[j];
+			s64 diff = (s64) (ent->dts - prev_dts);
+			u64 pos_diff = ent->byte_pos - prev_pos;
+			if (pos_diff < 0x40000000ULL) {
+				gf_bs_write_int(bs, 0, 1);
+				gf_bs_write_ue(bs, (u32) pos_diff);
+			} else {
+				gf_bs_write_int(bs, 1, 1);
+				gf_bs_write_long_int(bs, ent->byte_pos, 64);
+			}
+			if (j && (diff > -0x40000000LL) && (diff < 0x40000000LL)) {
+				gf_bs_write_int(bs, 0, 1);
+				gf_bs_write_se(bs, (s32) diff);
+			} else {
+				gf_bs_write_int(bs, 1, 1);
+				gf_bs_write_long_int(bs, ent->dts, 64);
+			}
+			gf_bs_write_ue(bs, ent->cts_offset);
+			gf_bs_write_int(bs, ent->flags, 3);
+			prev_dts = ent->dts;
+			prev_pos = ent->byte_pos;
+		}
+		gf_bs_align(bs);
+	}
+	gf_bs_del(bs);
+	fclose(f);
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_index_load(const char *sidecar, u64 file_size, GF_M2TS_Index **out_idx)
+{
+	u32 i, j, count;
+	GF_M2TS_Index *idx;
+	GF_BitStream *bs;
+	GF_Err e;
+	FILE *f;
+
+	if (!sidecar || !out_idx) return GF_BAD_PARAM;
+	*out_idx = NULL;
+	f = gf_f64_open(sidecar, "rb");
+	if (!f) return GF_URL_ERROR;
+	bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+	if (!bs) {
+		fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+	idx = NULL;
+	e = GF_OK;
+	if ((gf_bs_available(bs) < 26) || (gf_bs_read_u32(bs) != GF_4CC('G','T','S','I'))) {
+		e = GF_NON_COMPLIANT_BITSTREAM;
+		goto exit;
+	}
+	if (gf_bs_read_u8(bs) != GF_M2TS_INDEX_VERSION) {
+		e = GF_NOT_SUPPORTED;
+		goto exit;
+	}
+	if (gf_bs_read_u64(bs) != file_size) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS] Index file %s does not match the TS file size - ignoring\n", sidecar));
+		e = GF_BAD_PARAM;
+		goto exit;
+	}
+	idx = gf_m2ts_index_new();
+	idx->file_size = file_size;
+	idx->indexed_size = gf_bs_read_u64(bs);
+	idx->complete = gf_bs_read_u8(bs);
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		u64 dts = 0, pos = 0;
+		u32 pid, stream_type, is_pcr, nb_entries;
+		GF_M2TS_IndexTrack *trk;
+
+		if (gf_bs_available(bs) < 9) {
+			e = GF_NON_COMPLIANT_BITSTREAM;
+			goto exit;
+		}
+		pid = gf_bs_read_u16(bs);
+		stream_type = gf_bs_read_u16(bs);
+		is_pcr = gf_bs_read_u8(bs);
+		nb_entries = gf_bs_read_u32(bs);
+		/*each entry takes at least 8 bits*/
+		if ((pid >= GF_M2TS_MAX_STREAMS) || (is_pcr ? idx->pcr_map[pid] : idx->pes_map[pid]) || (nb_entries > gf_bs_available(bs))) {
+			e = GF_NON_COMPLIANT_BITSTREAM;
+			goto exit;
+		}
+		trk = gf_m2ts_index_get_track(idx, pid, stream_type, is_pcr ? 1 : 0);
+		if (!trk) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		trk->nb_alloc = nb_entries;
+		if (nb_entries) trk->entries = (GF_M2TS_IndexEntry*)gf_malloc(sizeof(GF_M2TS_IndexEntry)*nb_entries);
+		for (j=0; j<nb_entries; j++) {
+			GF_M2TS_IndexEntry *ent = &trk->entries[j];
+			if (gf_bs_read_int(bs, 1)) pos = gf_bs_read_long_int(bs, 64);
+			else pos += gf_bs_read_ue(bs);
+			if (gf_bs_read_int(bs, 1)) dts = gf_bs_read_long_int(bs, 64);
+			else dts += (s64) gf_bs_read_se(bs);
+			ent->byte_pos = pos;
+			ent->dts = dts;
+			ent->cts_offset = gf_bs_read_ue(bs);
+			ent->flags = gf_bs_read_int(bs, 3);
+		}
+		trk->nb_entries = nb_entries;
+		gf_bs_align(bs);
+	}
+
+exit:
+	gf_bs_del(bs);
+	fclose(f);
+	if (e) {
+		if (idx) gf_m2ts_index_del(idx);
+		return e;
+	}
+	*out_idx = idx;
+	return GF_OK;
+}
+
+static void gf_m2ts_index_on_event(GF_M2TS_Demuxer *ts, u32 evt_type, void *par)
+{
+	/*PES framing is left to GF_M2TS_PES_FRAMING_SKIP, only the first packet of each PES is inspected*/
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_index_build(const char *fileName, GF_M2TS_Index **out_idx)
+{
+	char data[188*64];
+	GF_M2TS_Demuxer *ts;
+	GF_M2TS_Index *idx;
+	u32 size;
+	FILE *f;
+
+	if (!fileName || !out_idx) return GF_BAD_PARAM;
+	*out_idx = NULL;
+	f = gf_f64_open(fileName, "rb");
+	if (!f) return GF_URL_ERROR;
+
+	idx = gf_m2ts_index_new();
+	ts = gf_m2ts_demux_new();
+	if (!idx || !ts) {
+		if (idx) gf_m2ts_index_del(idx);
+		if (ts) gf_m2ts_demux_del(ts);
+		fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+	gf_f64_seek(f, 0, SEEK_END);
+	idx->file_size = gf_f64_tell(f);
+	gf_f64_seek(f, 0, SEEK_SET);
+
+	ts->on_event = gf_m2ts_index_on_event;
+	ts->index = idx;
+	while ((size = (u32) fread(data, 1, sizeof(data), f)) > 0) {
+		gf_m2ts_process_data(ts, data, size);
+	}
+	idx->complete = 1;
+	ts->index = NULL;
+	gf_m2ts_demux_del(ts);
+	fclose(f);
+
+	*out_idx = idx;
+	return GF_OK;
+}
+
 static void gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 {
 	GF_M2TS_ES *es;
@@ -2234,6 +2692,13 @@ static void gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 
 	ts->pck_number++;
 
+	/*extend the index only while the file is processed contiguously from its start*/
+	ts->index_record = 0;
+	if (ts->index && !ts->index->complete && (ts->pck_pos == ts->index->indexed_size)) {
+		ts->index->indexed_size += 188;
+		ts->index_record = 1;
+	}
+
 	/* read TS packet header*/
 	hdr.sync = data[0];
 	hdr.error = (data[1] & 0x80) ? 1 : 0;
@@ -2329,6 +2794,7 @@ static void gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 		} else {
 			GF_M2TS_PES *pes = (GF_M2TS_PES *)es;
 			/* regular stream using PES packets */
+			if (ts->index_record && hdr.payload_start && payload_size) gf_m2ts_index_pes(ts, pes, paf, data, payload_size);
 			if (pes->reframe && payload_size) gf_m2ts_process_pes(ts, pes, &hdr, data, payload_size, paf);
 		}
 	}
@@ -2340,6 +2806,7 @@ static void gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 		es->program->last_pcr_value_pck_number = ts->pck_number;
 		es->program->last_pcr_value = paf->PCR_base * 300 + paf->PCR_ext;
 		if (!es->program->last_pcr_value) es->program->last_pcr_value =  1;
+		if (ts->index_record) gf_m2ts_index_pcr(ts, hdr.pid, paf->PCR_base);
 		pck.PTS = es->program->last_pcr_value;
 		pck.stream = (GF_M2TS_PES *)es;
 		if (paf->discontinuity_indicator) pck.flags = GF_M2TS_PES_PCK_DISCONTINUITY;
@@ -2348,10 +2815,10 @@ static void gf_m2ts_process_packet(GF_M2TS_Demuxer *ts, unsigned char *data)
 	return;
 }
 
-GF_EXPORT
-GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
+static GF_Err gf_m2ts_process_data_internal(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
 {
 	u32 pos;
+	u64 buffer_pos;
 	Bool is_align = 1;
 	if (ts->buffer) {
 		if (ts->alloc_size < ts->buffer_size+data_size) {
@@ -2366,6 +2833,10 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
 		ts->buffer_size = data_size;
 	}
 
+	/*offset in the source of the first buffered byte*/
+	buffer_pos = ts->data_pos + data_size - ts->buffer_size;
+	ts->data_pos += data_size;
+
 	/*sync input data*/
 	pos = gf_m2ts_sync(ts, is_align);
 	if (pos==ts->buffer_size) {
@@ -2376,6 +2847,10 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
 		}
 		return GF_OK;
 	}
+	/*bytes skipped at sync are part of the indexed range*/
+	if (pos && ts->index && !ts->index->complete && (buffer_pos == ts->index->indexed_size)) {
+		ts->index->indexed_size += pos;
+	}
 	for (;;) {
 		/*wait for a complete packet*/
 		if (ts->buffer_size - pos < 188) {
@@ -2396,12 +2871,23 @@ GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
 			return GF_OK;
 		}
 		/*process*/
+		ts->pck_pos = buffer_pos + pos;
 		gf_m2ts_process_packet(ts, ts->buffer+pos);
 		pos += 188;
 	}
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_m2ts_process_data(GF_M2TS_Demuxer *ts, char *data, u32 data_size)
+{
+	GF_Err e;
+	gf_trace_begin("mpegts", "process_data");
+	e = gf_m2ts_process_data_internal(ts, data, data_size);
+	gf_trace_end("mpegts", "process_data");
+	return e;
+}
+
 GF_ESD *gf_m2ts_get_esd(GF_M2TS_ES *es)
 {
 	GF_ESD *esd;
@@ -2465,7 +2951,7 @@ void gf_m2ts_reset_parsers(GF_M2TS_Demuxer *ts)
 			pes->frame_state = 0;
 			if (pes->data) gf_free(pes->data);
 			pes->data = NULL;
-			pes->data_len = 0;
+			pes->data_len = pes->data_alloc = 0;
 			if (pes->prev_data) gf_free(pes->prev_data);
 			pes->prev_data = NULL;
 			pes->prev_data_len = 0;
@@ -2494,6 +2980,26 @@ void gf_m2ts_reset_parsers(GF_M2TS_Demuxer *ts)
 
 }
 
+GF_EXPORT
+GF_Err gf_m2ts_demux_seek(GF_M2TS_Demuxer *ts, u64 pts, u64 *byte_pos)
+{
+	GF_Err e;
+	u64 pos;
+	if (!ts->index) return GF_BAD_PARAM;
+	e = gf_m2ts_index_find(ts->index, 0, pts, &pos, NULL);
+	if (e && (e!=GF_EOS)) return e;
+
+	gf_m2ts_reset_parsers(ts);
+	ts->pck_number = (u32) (pos / 188);
+	ts->data_pos = pos;
+	/*drop any pending partial packet*/
+	if (ts->buffer) gf_free(ts->buffer);
+	ts->buffer = NULL;
+	ts->buffer_size = ts->alloc_size = 0;
+	if (byte_pos) *byte_pos = pos;
+	return e;
+}
+
 static void gf_m2ts_process_section_discard(GF_M2TS_Demuxer *ts, GF_M2TS_SECTION_ES *es, GF_List *sections, u8 table_id, u16 ex_table_id, u8 version_number, u8 last_section_number, u32 status)
 {
 }
@@ -2632,6 +3138,7 @@ void gf_m2ts_demux_del(GF_M2TS_Demuxer *ts)
 		if (ts->ess[i]) gf_m2ts_es_del(ts->ess[i]);
 	}
 	if (ts->buffer) gf_free(ts->buffer);
+	if (ts->index) gf_m2ts_index_del(ts->index);
 	while (gf_list_count(ts->programs)) {
 		GF_M2TS_Program *p = (GF_M2TS_Program *)gf_list_last(ts->programs);
 		gf_list_rem_last(ts->programs);
@@ -2754,6 +3261,7 @@ static u32 TSDemux_DemuxRun(void *_p)
 		 }
 	 } else if (ts->file || ts->ts_data_chunk) {
 		u32 pos = 0;
+		u64 index_pos = 0;
 		GF_BitStream *ts_bs = NULL;
 
 		if (ts->segment_switch) {
@@ -2770,6 +3278,16 @@ static u32 TSDemux_DemuxRun(void *_p)
 				pos = 0;
 			}
 		}
+		/*locate the random access point preceding the requested time through the index*/
+		if (ts->start_range && ts->index && ts->file && !ts->query_next) {
+			u64 start_pts, seek_pos;
+			if ((gf_m2ts_index_get_start(ts->index, 0, &start_pts)==GF_OK)
+				&& (gf_m2ts_demux_seek(ts, start_pts + 90 * (u64) ts->start_range, &seek_pos) != GF_BAD_PARAM)
+			) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[M2TSDemux] Seeking to %d ms from index at byte offset "LLU"\n", ts->start_range, seek_pos));
+				index_pos = seek_pos;
+			}
+		}
 
 restart_stream:
 
@@ -2778,7 +3296,8 @@ restart_stream:
 		else
 			ts_bs = gf_bs_new(ts->ts_data_chunk, ts->ts_data_chunk_size, GF_BITSTREAM_READ);
 
-		gf_bs_seek(ts_bs, ts->start_byterange);
+		gf_bs_seek(ts_bs, ts->start_byterange + index_pos);
+		index_pos = 0;
 
 		while (ts->run_state && gf_bs_available(ts_bs)) {
 			/*m2ts chunks by chunks*/
@@ -2793,6 +3312,7 @@ restart_stream:
 				GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TS In] %u bytes read from file instead of 188.\n", size));
 			}
 			/*process chunk*/
+			ts->data_pos = gf_bs_get_position(ts_bs) - size;
 			gf_m2ts_process_data(ts, data, size);
 
 			ts->nb_pck++;
@@ -3156,6 +3676,19 @@ static GF_Err TSDemux_SetupFile(GF_M2TS_Demuxer *ts, char *url)
 		gf_f64_seek(ts->file, 0, SEEK_END);
 		ts->file_size = gf_f64_tell(ts->file);
 
+		/*use the index sidecar if any, otherwise build the index while demuxing*/
+		if (ts->index) gf_m2ts_index_del(ts->index);
+		ts->index = NULL;
+		if (!ts->query_next && (strlen(url) + 7 < GF_MAX_PATH)) {
+			char szIndex[GF_MAX_PATH];
+			sprintf(szIndex, "%s.tsidx", url);
+			if (gf_m2ts_index_load(szIndex, ts->file_size, &ts->index) != GF_OK) {
+				ts->index = gf_m2ts_index_new();
+				if (ts->index) ts->index->file_size = ts->file_size;
+			} else {
+				GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[TSDemux] Using index file %s\n", szIndex));
+			}
+		}
 	}
 
 	/* reinitialization for seek */
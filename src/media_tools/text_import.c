@@ -1208,6 +1208,7 @@ static GF_Err gf_text_import_ttxt(GF_MediaImporter *import)
 	if (import->flags==GF_IMPORT_PROBE_ONLY) return GF_OK;
 
 	parser = gf_xml_dom_new();
+	gf_xml_dom_use_arena(parser, 1);
 	e = gf_xml_dom_parse(parser, import->in_name, ttxt_import_progress, import);
 	if (e) {
 		gf_import_message(import, e, "Error parsing TTXT file: Line %d - %s", gf_xml_dom_get_line(parser), gf_xml_dom_get_error(parser));
@@ -1599,6 +1600,7 @@ static GF_Err gf_text_import_texml(GF_MediaImporter *import)
 	if (import->flags==GF_IMPORT_PROBE_ONLY) return GF_OK;
 
 	parser = gf_xml_dom_new();
+	gf_xml_dom_use_arena(parser, 1);
 	e = gf_xml_dom_parse(parser, import->in_name, texml_import_progress, import);
 	if (e) {
 		gf_import_message(import, e, "Error parsing TeXML file: Line %d - %s", gf_xml_dom_get_line(parser), gf_xml_dom_get_error(parser));
@@ -67,6 +67,8 @@ struct __tag_scene_engine
 	Bool embed_resources;
     Bool dump_rap;
     Bool first_dims_sent;
+	/*set when the engine gets node modification notifications*/
+	Bool rap_cache;
 };
 
 #ifndef GPAC_DISABLE_BIFS_ENC
@@ -80,8 +82,10 @@ static GF_Err gf_sm_setup_bifsenc(GF_SceneEngine *seng, GF_StreamContext *sc, GF
 
 	if (!esd->decoderConfig || (esd->decoderConfig->streamType != GF_STREAM_SCENE)) return GF_BAD_PARAM;
 
-	if (!seng->bifsenc)
+	if (!seng->bifsenc) {
 		seng->bifsenc = gf_bifs_encoder_new(seng->ctx->scene_graph);
+		if (seng->rap_cache) gf_bifs_encoder_enable_rap_cache(seng->bifsenc, 1);
+	}
 
 	delete_bcfg = 0;
 	/*inputctx is not properly setup, do it*/
@@ -593,6 +597,19 @@ GF_Err gf_seng_dump_rap_on(GF_SceneEngine *seng, Bool dump_rap)
     return 0;
 }
 
+GF_EXPORT
+GF_Err gf_seng_enable_rap_cache(GF_SceneEngine *seng, Bool enable)
+{
+	if (!seng) return GF_BAD_PARAM;
+	/*we cannot track modifications of a scene graph we don't own*/
+	if (!seng->owns_context) return enable ? GF_NOT_SUPPORTED : GF_OK;
+	seng->rap_cache = enable;
+#ifndef GPAC_DISABLE_BIFS_ENC
+	if (seng->bifsenc) gf_bifs_encoder_enable_rap_cache(seng->bifsenc, enable);
+#endif
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_seng_save_context(GF_SceneEngine *seng, char *ctxFileName)
 {
@@ -820,6 +837,8 @@ void gf_seng_terminate(GF_SceneEngine *seng)
 {
 #ifndef GPAC_DISABLE_BIFS_ENC
 	if (seng->bifsenc) gf_bifs_encoder_del(seng->bifsenc);
+	/*nodes destroyed with the graph must not notify the encoder*/
+	seng->bifsenc = NULL;
 #endif
 
 #ifndef GPAC_DISABLE_LASER
@@ -901,7 +920,16 @@ static void gf_seng_on_node_modified(void *_seng, u32 type, GF_Node *node, void
 		break;
 #endif
 	case GF_SG_CALLBACK_MODIFIED:
+	case GF_SG_CALLBACK_MODIFIED_INTERNAL:
 		gf_node_dirty_parents(node);
+#ifndef GPAC_DISABLE_BIFS_ENC
+		if (((GF_SceneEngine *)_seng)->bifsenc) gf_bifs_encoder_invalidate_rap_cache(((GF_SceneEngine *)_seng)->bifsenc, node);
+#endif
+		break;
+	case GF_SG_CALLBACK_NODE_DESTROY:
+#ifndef GPAC_DISABLE_BIFS_ENC
+		if (((GF_SceneEngine *)_seng)->bifsenc) gf_bifs_encoder_invalidate_rap_cache(((GF_SceneEngine *)_seng)->bifsenc, node);
+#endif
 		break;
 	}
 }
@@ -926,6 +954,7 @@ GF_SceneEngine *gf_seng_init(void *calling_object, char * inputContext, u32 load
     seng->dump_path = dump_path;
 	seng->ctx = gf_sm_new(seng->sg);
 	seng->owns_context = 1;
+	seng->rap_cache = 1;
 	memset(&(seng->loader), 0, sizeof(GF_SceneLoader));
 	seng->loader.ctx = seng->ctx;
     seng->loader.type = load_type;
@@ -998,8 +1027,11 @@ GF_SceneEngine *gf_seng_init_from_string(void *calling_object, char * inputConte
     seng->dump_path = dump_path;
     /*Step 1: create context and load input*/
 	seng->sg = gf_sg_new();
+	gf_sg_set_node_callback(seng->sg, gf_seng_on_node_modified);
+	gf_sg_set_private(seng->sg, seng);
 	seng->ctx = gf_sm_new(seng->sg);
 	seng->owns_context = 1;
+	seng->rap_cache = 1;
 	memset(& seng->loader, 0, sizeof(GF_SceneLoader));
 	seng->loader.ctx = seng->ctx;
     seng->loader.type = load_type;
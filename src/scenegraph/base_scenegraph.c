@@ -1510,6 +1510,9 @@ void gf_node_free(GF_Node *node)
 
 	if (node->sgprivate->UserCallback) node->sgprivate->UserCallback(node, NULL, 1);
 
+	if (node->sgprivate->scenegraph && node->sgprivate->scenegraph->NodeCallback)
+		node->sgprivate->scenegraph->NodeCallback(node->sgprivate->scenegraph->userpriv, GF_SG_CALLBACK_NODE_DESTROY, node, NULL);
+
 	if (node->sgprivate->interact) {
 		if (node->sgprivate->interact->routes) {
 			gf_list_del(node->sgprivate->interact->routes);
@@ -1744,7 +1747,10 @@ void gf_node_changed_internal(GF_Node *node, GF_FieldInfo *field, Bool notify_sc
 
 	/*internal nodes*/
 #ifndef GPAC_DISABLE_VRML
-	if (gf_sg_vrml_node_changed(node, field)) return;
+	if (gf_sg_vrml_node_changed(node, field)) {
+		if (sg->NodeCallback) sg->NodeCallback(sg->userpriv, GF_SG_CALLBACK_MODIFIED_INTERNAL, node, field);
+		return;
+	}
 #endif
 
 #ifndef GPAC_DISABLE_SVG
@@ -326,7 +326,7 @@ GF_Err gf_sg_command_apply(GF_SceneGraph *graph, GF_Command *com, Double time_of
 				/*we must remove the node before in case the new node uses the same ID (not forbidden) and this
 				command removes the last instance of the node with the same ID*/
 				gf_node_replace_child(com->node, (GF_ChildNodeItem**) field.far_ptr, inf->pos, inf->new_node);
-				if (inf->new_node) gf_node_register(inf->new_node, NULL);
+				if (inf->new_node) gf_node_register(inf->new_node, com->node);
 			}
 			/*erase the field item*/
 			else {
@@ -554,7 +554,7 @@ GF_Err gf_sg_command_apply(GF_SceneGraph *graph, GF_Command *com, Double time_of
 			if (field.fieldType == GF_SG_VRML_MFNODE) {
 				GF_Node *nn = *(GF_Node**)value.far_ptr;
 				gf_node_replace_child(target, (GF_ChildNodeItem**) field.far_ptr, pos, nn);
-				if (nn) gf_node_register(nn, NULL);
+				if (nn) gf_node_register(nn, target);
 			}
 			/*erase the field item*/
 			else {
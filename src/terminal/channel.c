@@ -57,6 +57,101 @@ static void ch_buffer_on(GF_Channel *ch)
 	}
 }
 
+/*AU payloads are allocated by size classes of 256<<k bytes and recycled in the channel once dropped, so that
+steady-state reception does not go through the allocator for every AU. Payloads larger than the biggest class
+are not pooled*/
+static char *gf_es_pool_alloc(GF_Channel *ch, u32 size, u32 *alloc_size)
+{
+	char *data = NULL;
+	u32 k = 0;
+	while ((k<GF_ES_POOL_CLASSES) && (((u32) 256<<k) < size)) k++;
+
+	gf_mx_p(ch->mx);
+	if (k<GF_ES_POOL_CLASSES) {
+		size = 256<<k;
+		if (ch->au_pool_count[k]) {
+			ch->au_pool_count[k]--;
+			data = ch->au_pool[k][ch->au_pool_count[k]];
+		}
+	}
+	if (data) ch->pool_hits++;
+	else ch->pool_misses++;
+	gf_mx_v(ch->mx);
+
+	if (!data) data = (char*)gf_malloc(sizeof(char) * size);
+	*alloc_size = size;
+	return data;
+}
+
+static void gf_es_pool_free(GF_Channel *ch, char *data, u32 alloc_size)
+{
+	u32 k = 0;
+	if (!data) return;
+	while ((k<GF_ES_POOL_CLASSES) && (((u32) 256<<k) < alloc_size)) k++;
+
+	gf_mx_p(ch->mx);
+	if ((k<GF_ES_POOL_CLASSES) && (((u32) 256<<k) == alloc_size) && (ch->au_pool_count[k]<GF_ES_POOL_DEPTH)) {
+		ch->au_pool[k][ch->au_pool_count[k]] = data;
+		ch->au_pool_count[k]++;
+		data = NULL;
+	}
+	gf_mx_v(ch->mx);
+	if (data) gf_free(data);
+}
+
+static GF_DBUnit *gf_es_unit_new(GF_Channel *ch)
+{
+	GF_DBUnit *au;
+	gf_mx_p(ch->mx);
+	au = ch->db_pool;
+	if (au) {
+		ch->db_pool = au->next;
+		ch->db_pool_count--;
+	}
+	gf_mx_v(ch->mx);
+	if (!au) return gf_db_unit_new();
+	memset(au, 0, sizeof(GF_DBUnit));
+	return au;
+}
+
+/*releases a list of AUs to the channel pool*/
+static void gf_es_unit_del(GF_Channel *ch, GF_DBUnit *au)
+{
+	while (au) {
+		GF_DBUnit *next = au->next;
+		if (au->allocSize) gf_es_pool_free(ch, au->data, au->allocSize);
+		else if (au->data) gf_free(au->data);
+		au->data = NULL;
+
+		gf_mx_p(ch->mx);
+		if (ch->db_pool_count < GF_ES_POOL_CLASSES*GF_ES_POOL_DEPTH) {
+			au->next = ch->db_pool;
+			ch->db_pool = au;
+			ch->db_pool_count++;
+			au = NULL;
+		}
+		gf_mx_v(ch->mx);
+		if (au) gf_free(au);
+		au = next;
+	}
+}
+
+static void gf_es_pool_reset(GF_Channel *ch)
+{
+	u32 i, k;
+	while (ch->db_pool) {
+		GF_DBUnit *au = ch->db_pool;
+		ch->db_pool = au->next;
+		gf_free(au);
+	}
+	ch->db_pool_count = 0;
+	for (k=0; k<GF_ES_POOL_CLASSES; k++) {
+		for (i=0; i<ch->au_pool_count[k]; i++) gf_free(ch->au_pool[k][i]);
+		ch->au_pool_count[k] = 0;
+	}
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_SYNC, ("[SyncLayer] ES%d: AU pool %d hits %d misses\n", ch->esd ? ch->esd->ESID : 0, ch->pool_hits, ch->pool_misses));
+}
+
 /*reset channel*/
 static void Channel_Reset(GF_Channel *ch, Bool for_start)
 {
@@ -80,11 +175,11 @@ static void Channel_Reset(GF_Channel *ch, Bool for_start)
 
 	ch_buffer_off(ch);
 
-	if (ch->buffer) gf_free(ch->buffer);
+	gf_es_pool_free(ch, ch->buffer, ch->allocSize);
 	ch->buffer = NULL;
 	ch->len = ch->allocSize = 0;
 
-	gf_db_unit_del(ch->AU_buffer_first);
+	gf_es_unit_del(ch, ch->AU_buffer_first);
 	ch->AU_buffer_first = ch->AU_buffer_last = NULL;
 	ch->AU_Count = 0;
 	ch->BufferTime = 0;
@@ -180,6 +275,7 @@ void gf_es_del(GF_Channel *ch)
 		ch->AU_buffer_pull->data = NULL;
 		gf_db_unit_del(ch->AU_buffer_pull);
 	}
+	gf_es_pool_reset(ch);
 	if (ch->ipmp_tool)
 		gf_modules_close_interface((GF_BaseInterface *) ch->ipmp_tool);
 
@@ -265,8 +361,9 @@ void Channel_WaitRAP(GF_Channel *ch)
 	/*if using RAP signal and codec not resilient, wait for rap. If RAP isn't signaled DON'T wait for it :)*/
 	if (!ch->codec_resilient)
 		ch->stream_state = 2;
-	if (ch->buffer) gf_free(ch->buffer);
+	gf_es_pool_free(ch, ch->buffer, ch->allocSize);
 	ch->buffer = NULL;
+	ch->len = ch->allocSize = 0;
 	ch->AULength = 0;
 	ch->au_sn = 0;
 }
@@ -275,11 +372,11 @@ void gf_es_reset_buffers(GF_Channel *ch)
 {
 	gf_mx_p(ch->mx);
 
-	if (ch->buffer) gf_free(ch->buffer);
+	gf_es_pool_free(ch, ch->buffer, ch->allocSize);
 	ch->buffer = NULL;
 	ch->len = ch->allocSize = 0;
 
-	gf_db_unit_del(ch->AU_buffer_first);
+	gf_es_unit_del(ch, ch->AU_buffer_first);
 	ch->AU_buffer_first = ch->AU_buffer_last = NULL;
 	ch->AU_Count = 0;
 
@@ -402,17 +499,18 @@ static void Channel_DispatchAU(GF_Channel *ch, u32 duration)
 
 	if (!ch->buffer || !ch->len) {
 		if (ch->buffer) {
-			gf_free(ch->buffer);
+			gf_es_pool_free(ch, ch->buffer, ch->allocSize);
 			ch->buffer = NULL;
+			ch->allocSize = 0;
 		}
 		return;
 	}
 
-	au = gf_db_unit_new();
+	au = gf_es_unit_new(ch);
 	if (!au) {
-		gf_free(ch->buffer);
+		gf_es_pool_free(ch, ch->buffer, ch->allocSize);
 		ch->buffer = NULL;
-		ch->len = 0;
+		ch->len = ch->allocSize = 0;
 		return;
 	}
 
@@ -430,6 +528,7 @@ static void Channel_DispatchAU(GF_Channel *ch, u32 duration)
 	}
 	au->data = ch->buffer;
 	au->dataLength = ch->len;
+	au->allocSize = ch->allocSize;
 	au->PaddingBits = ch->padingBits;
 
 	ch->IsRap = 0;
@@ -437,9 +536,8 @@ static void Channel_DispatchAU(GF_Channel *ch, u32 duration)
 	au->next = NULL;
 	ch->buffer = NULL;
 
-	if (ch->len + ch->media_padding_bytes != ch->allocSize) {
-		au->data = (char*)gf_realloc(au->data, sizeof(char) * (au->dataLength + ch->media_padding_bytes));
-	}
+	/*the reassembly buffer always has room for the padding bytes, it is no longer trimmed so that it can go back to the pool*/
+	assert(au->allocSize >= au->dataLength + ch->media_padding_bytes);
 	if (ch->media_padding_bytes) memset(au->data + au->dataLength, 0, sizeof(char)*ch->media_padding_bytes);
 
 	ch->len = ch->allocSize = 0;
@@ -509,8 +607,7 @@ static void Channel_DispatchAU(GF_Channel *ch, u32 duration)
 				}
 				assert(au_prev);
 				if (au_prev->next->DTS==au->DTS) {
-					gf_free(au->data);
-					gf_free(au);
+					gf_es_unit_del(ch, au);
 				} else {
 					au->next = au_prev->next;
 					au_prev->next = au;
@@ -593,10 +690,10 @@ void Channel_ReceiveSkipSL(GF_ClientService *serv, GF_Channel *ch, const char *S
 	if (!StreamLength) return;
 
 	gf_es_lock(ch, 1);
-	au = gf_db_unit_new();
+	au = gf_es_unit_new(ch);
 	au->flags = GF_DB_AU_RAP;
 	au->DTS = gf_clock_time(ch->clock);
-	au->data = (char*)gf_malloc(sizeof(char) * (ch->media_padding_bytes + StreamLength));
+	au->data = gf_es_pool_alloc(ch, ch->media_padding_bytes + StreamLength, &au->allocSize);
 	memcpy(au->data, StreamBuf, sizeof(char) * StreamLength);
 	if (ch->media_padding_bytes) memset(au->data + StreamLength, 0, sizeof(char)*ch->media_padding_bytes);
 	au->dataLength = StreamLength;
@@ -917,7 +1014,7 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 				if (!ch->IsClockInit && !ch->skip_time_check_for_pending) gf_es_check_timing(ch);
 				Channel_DispatchAU(ch, 0);
 			} else {
-				gf_free(ch->buffer);
+				gf_es_pool_free(ch, ch->buffer, ch->allocSize);
 				ch->buffer = NULL;
 				ch->AULength = 0;
 				ch->len = ch->allocSize = 0;
@@ -1132,14 +1229,11 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 		assert(!ch->buffer);
 		/*ignore length fields*/
 		size = payload_size + ch->media_padding_bytes;
-		ch->buffer = (char*)gf_malloc(sizeof(char) * size);
+		ch->buffer = gf_es_pool_alloc(ch, size, &ch->allocSize);
 		if (!ch->buffer) {
 			assert(0);
 			return;
 		}
-
-		ch->allocSize = size;
-		memset(ch->buffer, 0, sizeof(char) * size);
 		ch->len = 0;
 	}
 	if (!ch->esd->slConfig->usePaddingFlag) hdr.paddingFlag = 0;
@@ -1181,12 +1275,16 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 	} else {
 		/*check if enough space*/
 		size = ch->allocSize;
-		if (size && (payload_size + ch->len <= size)) {
+		if (size && (payload_size + ch->len + ch->media_padding_bytes <= size)) {
 			memcpy(ch->buffer+ch->len, payload, payload_size);
 			ch->len += payload_size;
 		} else {
+			char *buffer;
 			size = payload_size + ch->len + ch->media_padding_bytes;
-			ch->buffer = (char*)gf_realloc(ch->buffer, sizeof(char) * size);
+			buffer = gf_es_pool_alloc(ch, size, &size);
+			if (ch->len) memcpy(buffer, ch->buffer, ch->len);
+			gf_es_pool_free(ch, ch->buffer, ch->allocSize);
+			ch->buffer = buffer;
 			memcpy(ch->buffer+ch->len, payload, payload_size);
 			ch->allocSize = size;
 			ch->len += payload_size;
@@ -1348,7 +1446,7 @@ void gf_es_drop_au(GF_Channel *ch)
 	au = ch->AU_buffer_first;
 	ch->AU_buffer_first = au->next;
 	au->next = NULL;
-	gf_db_unit_del(au);
+	gf_es_unit_del(ch, au);
 	ch->AU_Count -= 1;
 
 	if (!ch->AU_Count && ch->AU_buffer_first) {
@@ -165,9 +165,8 @@ GF_Err gf_codec_add_channel(GF_Codec *codec, GF_Channel *ch)
 
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CODEC, ("[ODM] Creating composition buffer for codec %s - %d units %d bytes each\n", codec->decio->module_name, max, CUsize));
 
-			codec->CB = gf_cm_new(CUsize, max, (codec->flags & GF_ESM_CODEC_IS_RAW_MEDIA) ? 1 : 0);
+			codec->CB = gf_cm_new(codec->odm, CUsize, max, (codec->flags & GF_ESM_CODEC_IS_RAW_MEDIA) ? 1 : 0);
 			codec->CB->Min = min;
-			codec->CB->odm = codec->odm;
 		}
 
 		if (codec->CB) {
@@ -227,9 +226,8 @@ GF_Err gf_codec_add_channel(GF_Codec *codec, GF_Channel *ch)
 		/*create a semaphore in non-notified stage*/
 		codec->odm->raw_frame_sema = gf_sema_new(1, 0);
 
-		codec->CB = gf_cm_new(CUsize, 1, 1);
+		codec->CB = gf_cm_new(codec->odm, CUsize, 1, 1);
 		codec->CB->Min = 0;
-		codec->CB->odm = codec->odm;
 		ch->is_raw_channel = 1;
 		if (gf_es_owns_clock(ch))
 			ch->is_raw_channel = 2;
@@ -1030,6 +1028,14 @@ GF_Err gf_codec_process(GF_Codec *codec, u32 TimeAvailable)
 	codec->Muted = 0;
 #endif
 
+	if (gf_trace_enabled()) {
+		GF_Err e;
+		const char *name = (codec->type==GF_STREAM_VISUAL) ? "decode_video" : (codec->type==GF_STREAM_AUDIO) ? "decode_audio" : "decode_systems";
+		gf_trace_begin("codec", name);
+		e = codec->process(codec, TimeAvailable);
+		gf_trace_end("codec", name);
+		return e;
+	}
 	return codec->process(codec, TimeAvailable);
 }
 
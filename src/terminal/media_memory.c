@@ -85,22 +85,138 @@ static GFINLINE void my_large_gf_free(void *ptr) {
 #endif
 
 
-static void gf_cm_unit_del(GF_CMUnit *cb, Bool no_data_allocation)
+typedef struct
 {
-	if (!cb)
-	  return;
-	if (cb->next) gf_cm_unit_del(cb->next, no_data_allocation);
-	cb->next = NULL;
-	if (cb->data) {
-		if (!no_data_allocation) {
-			my_large_gf_free(cb->data);
+	u32 size;
+	char *data;
+} GF_PoolFrame;
+
+struct _cm_frame_pool
+{
+	GF_Mutex *mx;
+	/*unused buffers*/
+	GF_List *frames;
+	u32 size, max_size;
+	u32 nb_hits, nb_misses;
+};
+
+/*frames are pooled by page-aligned size, frames of the same dimensions and format always match*/
+#define GF_CM_POOL_SIZE(_size)	(((_size) + 4095) & ~4095)
+
+GF_FramePool *gf_cm_pool_new(u32 max_size)
+{
+	GF_FramePool *pool;
+	GF_SAFEALLOC(pool, GF_FramePool);
+	if (!pool) return NULL;
+	pool->mx = gf_mx_new("FramePool");
+	pool->frames = gf_list_new();
+	pool->max_size = max_size;
+	return pool;
+}
+
+void gf_cm_pool_del(GF_FramePool *pool)
+{
+	if (!pool) return;
+	while (gf_list_count(pool->frames)) {
+		GF_PoolFrame *fr = gf_list_last(pool->frames);
+		gf_list_rem_last(pool->frames);
+		my_large_gf_free(fr->data);
+		gf_free(fr);
+	}
+	gf_list_del(pool->frames);
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[Terminal] Frame pool: %d hits %d misses\n", pool->nb_hits, pool->nb_misses));
+	gf_mx_del(pool->mx);
+	gf_free(pool);
+}
+
+void gf_cm_pool_get_stats(GF_FramePool *pool, u32 *nb_hits, u32 *nb_misses)
+{
+	*nb_hits = pool ? pool->nb_hits : 0;
+	*nb_misses = pool ? pool->nb_misses : 0;
+}
+
+static char *gf_cm_pool_alloc(GF_FramePool *pool, u32 size)
+{
+	u32 i, count;
+	char *data = NULL;
+	if (!size) return NULL;
+	if (!pool) return (char*)my_large_alloc(size);
+
+	size = GF_CM_POOL_SIZE(size);
+	gf_mx_p(pool->mx);
+	count = gf_list_count(pool->frames);
+	for (i=0; i<count; i++) {
+		GF_PoolFrame *fr = gf_list_get(pool->frames, i);
+		if (fr->size != size) continue;
+		gf_list_rem(pool->frames, i);
+		pool->size -= size;
+		data = fr->data;
+		gf_free(fr);
+		break;
+	}
+	if (data) pool->nb_hits++;
+	else pool->nb_misses++;
+	gf_mx_v(pool->mx);
+
+	if (!data) data = (char*)my_large_alloc(size);
+	return data;
+}
+
+static void gf_cm_pool_free(GF_FramePool *pool, char *data, u32 size)
+{
+	GF_PoolFrame *fr;
+	if (!data) return;
+	if (!pool) {
+		my_large_gf_free(data);
+		return;
+	}
+	size = GF_CM_POOL_SIZE(size);
+	gf_mx_p(pool->mx);
+	/*pool is full, drop the oldest buffers*/
+	while (gf_list_count(pool->frames) && (pool->size + size > pool->max_size)) {
+		fr = gf_list_get(pool->frames, 0);
+		gf_list_rem(pool->frames, 0);
+		pool->size -= fr->size;
+		my_large_gf_free(fr->data);
+		gf_free(fr);
+	}
+	if (size > pool->max_size) {
+		gf_mx_v(pool->mx);
+		my_large_gf_free(data);
+		return;
+	}
+	GF_SAFEALLOC(fr, GF_PoolFrame);
+	if (!fr) {
+		gf_mx_v(pool->mx);
+		my_large_gf_free(data);
+		return;
+	}
+	fr->data = data;
+	fr->size = size;
+	gf_list_add(pool->frames, fr);
+	pool->size += size;
+	gf_mx_v(pool->mx);
+}
+
+static GF_FramePool *gf_cm_get_pool(GF_CompositionMemory *cb)
+{
+	return (cb->odm && cb->odm->term) ? cb->odm->term->frame_pool : NULL;
+}
+
+static void gf_cm_unit_del(GF_CompositionMemory *cb, GF_CMUnit *cu)
+{
+	while (cu) {
+		GF_CMUnit *next = cu->next;
+		if (cu->data && !cb->no_allocation) {
+			gf_cm_pool_free(gf_cm_get_pool(cb), cu->data, cb->UnitSize);
 		}
-		cb->data = NULL;
+		cu->data = NULL;
+		gf_free(cu);
+		cu = next;
 	}
-	gf_free(cb);
 }
 
-GF_CompositionMemory *gf_cm_new(u32 UnitSize, u32 capacity, Bool no_allocation)
+GF_CompositionMemory *gf_cm_new(struct _od_manager *odm, u32 UnitSize, u32 capacity, Bool no_allocation)
 {
 	GF_CompositionMemory *tmp;
 	GF_CMUnit *cu, *prev;
@@ -112,6 +228,7 @@ GF_CompositionMemory *gf_cm_new(u32 UnitSize, u32 capacity, Bool no_allocation)
 	tmp->Capacity = capacity;
 	tmp->UnitSize = UnitSize;
 	tmp->no_allocation = no_allocation;
+	tmp->odm = odm;
 
 	prev = NULL;
 	i = 1;
@@ -127,7 +244,7 @@ GF_CompositionMemory *gf_cm_new(u32 UnitSize, u32 capacity, Bool no_allocation)
 		if (no_allocation) {
 			cu->data = NULL;
 		} else {
-			cu->data = UnitSize ? (char*)my_large_alloc(sizeof(char)*UnitSize) : NULL;
+			cu->data = gf_cm_pool_alloc(gf_cm_get_pool(tmp), UnitSize);
 			if (cu->data) memset(cu->data, 0, sizeof(char)*UnitSize);
 		}
 		prev = cu;
@@ -156,7 +273,7 @@ void gf_cm_del(GF_CompositionMemory *cb)
 	if (cb->input){
 	  /*break the loop and destroy*/
 	  cb->input->prev->next = NULL;
-	  gf_cm_unit_del(cb->input, cb->no_allocation);
+	  gf_cm_unit_del(cb, cb->input);
 	  cb->input = NULL;
 	}
 	gf_odm_lock(cb->odm, 0);
@@ -410,10 +527,9 @@ void gf_cm_resize(GF_CompositionMemory *cb, u32 newCapacity)
 	gf_odm_lock(cb->odm, 1);
 	cu = cb->input;
 
-	cb->UnitSize = newCapacity;
 	if (!cb->no_allocation) {
-		my_large_gf_free(cu->data);
-		cu->data = (char*) my_large_alloc(newCapacity);
+		gf_cm_pool_free(gf_cm_get_pool(cb), cu->data, cb->UnitSize);
+		cu->data = gf_cm_pool_alloc(gf_cm_get_pool(cb), newCapacity);
 		cu->dataLength = 0;
 	} else {
 		cu->data = NULL;
@@ -425,14 +541,15 @@ void gf_cm_resize(GF_CompositionMemory *cb, u32 newCapacity)
 	cu = cu->next;
 	while (cu != cb->input) {
 		if (!cb->no_allocation) {
-			my_large_gf_free(cu->data);
-			cu->data = (char*) my_large_alloc(newCapacity);
+			gf_cm_pool_free(gf_cm_get_pool(cb), cu->data, cb->UnitSize);
+			cu->data = gf_cm_pool_alloc(gf_cm_get_pool(cb), newCapacity);
 		} else {
 			cu->data = NULL;
 		}
 		cu->dataLength = 0;
 		cu = cu->next;
 	}
+	cb->UnitSize = newCapacity;
 
 	cb->UnitCount = 0;
 	cb->output = cb->input;
@@ -452,7 +569,7 @@ void gf_cm_reinit(GF_CompositionMemory *cb, u32 UnitSize, u32 Capacity)
 	if (cb->input){
 	  /*break the loop and destroy*/
 	  cb->input->prev->next = NULL;
-	  gf_cm_unit_del(cb->input, cb->no_allocation);
+	  gf_cm_unit_del(cb, cb->input);
 	  cb->input = NULL;
 	}
 
@@ -474,7 +591,7 @@ void gf_cm_reinit(GF_CompositionMemory *cb, u32 UnitSize, u32 Capacity)
 		if (cb->no_allocation) {
 			cu->data = NULL;
 		} else {
-			cu->data = (char*)my_large_alloc(UnitSize);
+			cu->data = gf_cm_pool_alloc(gf_cm_get_pool(cb), UnitSize);
 		}
 		prev = cu;
 		Capacity --;
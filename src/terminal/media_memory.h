@@ -60,6 +60,8 @@ typedef struct _decoding_buffer
 
 	u32 dataLength;
 	char *data;
+	/*size of the data buffer when allocated from the channel pool, 0 otherwise*/
+	u32 allocSize;
 } GF_DBUnit;
 
 GF_DBUnit *gf_db_unit_new();
@@ -128,8 +130,19 @@ struct _composition_memory
 	u32 LastRenderedTS;
 };
 
-/*a composition buffer only has fixed-size unit*/
-GF_CompositionMemory *gf_cm_new(u32 UnitSize, u32 capacity, Bool no_allocation);
+/*pool of composition unit buffers shared by all the composition memories of a terminal. Buffers are recycled
+by size classes (page-aligned sizes), so that resizing or recreating a composition memory for the same frame size
+does not go through the allocator*/
+typedef struct _cm_frame_pool GF_FramePool;
+
+/*creates a frame pool keeping at most max_size bytes of unused buffers*/
+GF_FramePool *gf_cm_pool_new(u32 max_size);
+void gf_cm_pool_del(GF_FramePool *pool);
+/*gets number of buffer allocations served by the pool and number of allocations that missed it*/
+void gf_cm_pool_get_stats(GF_FramePool *pool, u32 *nb_hits, u32 *nb_misses);
+
+/*a composition buffer only has fixed-size unit - units are allocated from the frame pool of the terminal of the odm*/
+GF_CompositionMemory *gf_cm_new(struct _od_manager *odm, u32 UnitSize, u32 capacity, Bool no_allocation);
 void gf_cm_del(GF_CompositionMemory *cb);
 /*re-inits complete cb*/
 void gf_cm_reinit(GF_CompositionMemory *cb, u32 UnitSize, u32 Capacity);
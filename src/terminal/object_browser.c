@@ -172,6 +172,7 @@ GF_Err gf_term_get_object_info(GF_Terminal *term, GF_ObjectManager *odm, GF_Medi
 
 	info->buffer = -2;
 	info->db_unit_count = 0;
+	info->db_pool_hits = info->db_pool_misses = 0;
 
 	/*Warning: is_open==2 means object setup, don't check then*/
 	if (odm->state==GF_ODM_STATE_IN_SETUP) {
@@ -196,6 +197,8 @@ GF_Err gf_term_get_object_info(GF_Terminal *term, GF_ObjectManager *odm, GF_Medi
 			i=0;
 			while ((ch = (GF_Channel*)gf_list_enum(odm->channels, &i))) {
 				info->db_unit_count += ch->AU_Count;
+				info->db_pool_hits += ch->pool_hits;
+				info->db_pool_misses += ch->pool_misses;
 				if (!ch->is_pulling) {
 					if (ch->MaxBuffer) info->buffer = 0;
 					buf += ch->BufferTime;
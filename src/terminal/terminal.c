@@ -576,6 +576,15 @@ GF_Terminal *gf_term_new(GF_User *user)
 	gf_sc_set_fps(tmp->compositor, 30.0);
 	tmp->frame_duration = (u32) (1000/30);
 
+	/*max size in MB of the unused composition buffers kept around*/
+	cf = gf_cfg_get_key(user->config, "Systems", "FramePoolSize");
+	if (!cf) {
+		gf_cfg_set_key(user->config, "Systems", "FramePoolSize", "64");
+		cf = "64";
+	}
+	i = atoi(cf);
+	if (i) tmp->frame_pool = gf_cm_pool_new(i*1024*1024);
+
 	tmp->downloader = gf_dm_new(user->config);
 	gf_dm_set_auth_callback(tmp->downloader, gf_term_get_user_pass, tmp);
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[Terminal] downloader loaded\n"));
@@ -734,6 +743,9 @@ GF_Err gf_term_del(GF_Terminal * term)
 	when destroying these stacks*/
 	gf_sc_del(term->compositor);
 
+	/*all composition memories are now destroyed*/
+	gf_cm_pool_del(term->frame_pool);
+
 	gf_list_del(term->net_services);
 	gf_list_del(term->net_services_to_remove);
 	gf_list_del(term->connection_tasks);
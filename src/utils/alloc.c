@@ -142,8 +142,165 @@ This is only needed when building libgpac and modules when libgpac is not instal
 # include "../../include/gpac/configuration.h"
 #endif
 
-/*GPAC memory tracking*/
-#ifndef GPAC_MEMORY_TRACKING
+/*GPAC memory accounting*/
+#if defined(GPAC_MEMORY_ACCOUNTING) && !defined(GPAC_MEMORY_TRACKING)
+
+#include "../../include/gpac/thread.h"
+
+/*header placed before each block, keeps blocks 16 bytes aligned. As with memory tracking, blocks passed to gf_free
+or gf_realloc must come from gf_malloc/gf_calloc/gf_realloc/gf_strdup, and blocks from these functions cannot be
+released with the system free()*/
+typedef union
+{
+	struct {
+		u32 tag;
+		u32 size;
+	} h;
+	u64 align[2];
+} GF_MemAccHeader;
+
+static struct
+{
+	const char *name;
+	volatile u32 bytes_live, bytes_peak, nb_blocks, nb_allocs;
+	/*for allocation rate*/
+	u32 last_nb_allocs, last_time;
+} mem_tags[GF_MEM_TAG_MAX] = {
+	{"other"}, {"core"}, {"isomedia"}, {"mpegts"}, {"dash"}, {"media"}, {"scene"}, {"compositor"}, {"terminal"}, {"network"}, {"modules"}
+};
+
+/*resolves the subsystem of a translation unit from its file name, only once per file*/
+static u32 gf_mem_acc_get_tag(u32 *file_tag, const char *filename)
+{
+	u32 tag = *file_tag;
+	if (tag) return tag-1;
+
+	tag = GF_MEM_TAG_OTHER;
+	if (!filename) ;
+	else if (strstr(filename, "mpegts") || strstr(filename, "m2ts")) tag = GF_MEM_TAG_MPEGTS;
+	else if (strstr(filename, "dash") || strstr(filename, "mpd")) tag = GF_MEM_TAG_DASH;
+	else if (strstr(filename, "modules")) tag = GF_MEM_TAG_MODULES;
+	else if (strstr(filename, "isomedia")) tag = GF_MEM_TAG_ISOM;
+	else if (strstr(filename, "media_tools")) tag = GF_MEM_TAG_MEDIA;
+	else if (strstr(filename, "scenegraph") || strstr(filename, "scene_manager") || strstr(filename, "bifs") || strstr(filename, "laser") || strstr(filename, "odf")) tag = GF_MEM_TAG_SCENE;
+	else if (strstr(filename, "compositor")) tag = GF_MEM_TAG_COMPOSITOR;
+	else if (strstr(filename, "terminal")) tag = GF_MEM_TAG_TERMINAL;
+	else if (strstr(filename, "ietf")) tag = GF_MEM_TAG_NETWORK;
+	else if (strstr(filename, "utils")) tag = GF_MEM_TAG_CORE;
+	*file_tag = tag+1;
+	return tag;
+}
+
+static void gf_mem_acc_grow(u32 tag, u32 size)
+{
+	u32 live, peak;
+	live = gf_atomic_add(&mem_tags[tag].bytes_live, size);
+	peak = mem_tags[tag].bytes_peak;
+	while (live > peak) {
+		if (gf_atomic_cas(&mem_tags[tag].bytes_peak, peak, live)) break;
+		peak = mem_tags[tag].bytes_peak;
+	}
+}
+
+static void *gf_mem_acc_register(GF_MemAccHeader *hdr, u32 tag, u32 size)
+{
+	hdr->h.tag = tag;
+	hdr->h.size = size;
+	gf_atomic_inc(&mem_tags[tag].nb_allocs);
+	gf_atomic_inc(&mem_tags[tag].nb_blocks);
+	gf_mem_acc_grow(tag, size);
+	return hdr+1;
+}
+
+GF_EXPORT
+void *gf_mem_acc_malloc(size_t size, u32 *file_tag, const char *filename)
+{
+	GF_MemAccHeader *hdr = (GF_MemAccHeader *) MALLOC(size + sizeof(GF_MemAccHeader));
+	if (!hdr) return NULL;
+	return gf_mem_acc_register(hdr, gf_mem_acc_get_tag(file_tag, filename), (u32) size);
+}
+
+GF_EXPORT
+void *gf_mem_acc_calloc(size_t num, size_t size_of, u32 *file_tag, const char *filename)
+{
+	GF_MemAccHeader *hdr = (GF_MemAccHeader *) CALLOC(1, num*size_of + sizeof(GF_MemAccHeader));
+	if (!hdr) return NULL;
+	return gf_mem_acc_register(hdr, gf_mem_acc_get_tag(file_tag, filename), (u32) (num*size_of));
+}
+
+GF_EXPORT
+void gf_mem_acc_free(void *ptr)
+{
+	GF_MemAccHeader *hdr;
+	if (!ptr) return;
+	hdr = ((GF_MemAccHeader *) ptr) - 1;
+	gf_atomic_dec(&mem_tags[hdr->h.tag].nb_blocks);
+	gf_atomic_add(&mem_tags[hdr->h.tag].bytes_live, (u32) -(s32)hdr->h.size);
+	FREE(hdr);
+}
+
+GF_EXPORT
+void *gf_mem_acc_realloc(void *ptr, size_t size, u32 *file_tag, const char *filename)
+{
+	GF_MemAccHeader *hdr;
+	u32 tag, prev_size;
+	if (!ptr) return gf_mem_acc_malloc(size, file_tag, filename);
+	if (!size) {
+		gf_mem_acc_free(ptr);
+		return NULL;
+	}
+	hdr = ((GF_MemAccHeader *) ptr) - 1;
+	tag = hdr->h.tag;
+	prev_size = hdr->h.size;
+	hdr = (GF_MemAccHeader *) REALLOC(hdr, size + sizeof(GF_MemAccHeader));
+	if (!hdr) return NULL;
+	hdr->h.size = (u32) size;
+	if (size > prev_size) gf_mem_acc_grow(tag, (u32) size - prev_size);
+	else gf_atomic_add(&mem_tags[tag].bytes_live, (u32) size - prev_size);
+	return hdr+1;
+}
+
+GF_EXPORT
+char *gf_mem_acc_strdup(const char *str, u32 *file_tag, const char *filename)
+{
+	char *ptr;
+	u32 len;
+	if (!str) return NULL;
+	len = (u32) strlen(str) + 1;
+	ptr = (char *) gf_mem_acc_malloc(len, file_tag, filename);
+	if (ptr) memcpy(ptr, str, len);
+	return ptr;
+}
+
+u64 gf_mem_acc_get_live_memory()
+{
+	u32 i;
+	u64 res = 0;
+	for (i=0; i<GF_MEM_TAG_MAX; i++) res += mem_tags[i].bytes_live;
+	return res;
+}
+
+GF_EXPORT
+Bool gf_sys_get_memory_tag_info(u32 tag, GF_MemoryTagInfo *info)
+{
+	u32 now, nb_allocs;
+	if (tag >= GF_MEM_TAG_MAX) return 0;
+	now = gf_sys_clock();
+	nb_allocs = mem_tags[tag].nb_allocs;
+	info->name = mem_tags[tag].name;
+	info->bytes_live = mem_tags[tag].bytes_live;
+	info->bytes_peak = mem_tags[tag].bytes_peak;
+	info->nb_blocks = mem_tags[tag].nb_blocks;
+	info->nb_allocs = nb_allocs;
+	info->allocs_per_sec = 0;
+	if (mem_tags[tag].last_time && (now > mem_tags[tag].last_time))
+		info->allocs_per_sec = (u32) ( ((u64) (nb_allocs - mem_tags[tag].last_nb_allocs)) * 1000 / (now - mem_tags[tag].last_time) );
+	mem_tags[tag].last_nb_allocs = nb_allocs;
+	mem_tags[tag].last_time = now;
+	return 1;
+}
+
+#elif !defined(GPAC_MEMORY_TRACKING)
 
 CDECL
 void *gf_malloc(size_t size)
@@ -706,6 +863,30 @@ void gf_memory_print()
 
 #endif /*GPAC_MEMORY_TRACKING*/
 
+#if !defined(GPAC_MEMORY_ACCOUNTING) || defined(GPAC_MEMORY_TRACKING)
+GF_EXPORT
+Bool gf_sys_get_memory_tag_info(u32 tag, GF_MemoryTagInfo *info)
+{
+	return 0;
+}
+#endif
+
+GF_EXPORT
+void gf_sys_dump_memory_tags(FILE *out)
+{
+	u32 i;
+	GF_MemoryTagInfo info;
+	if (!gf_sys_get_memory_tag_info(0, &info)) {
+		fprintf(out, "Memory accounting not available\n");
+		return;
+	}
+	fprintf(out, "Subsystem\tLive(kB)\tPeak(kB)\tBlocks\tAllocs\tAllocs/s\n");
+	for (i=0; i<GF_MEM_TAG_MAX; i++) {
+		if (i) gf_sys_get_memory_tag_info(i, &info);
+		fprintf(out, "%-10s\t%8d\t%8d\t%6d\t%8d\t%6d\n", info.name, info.bytes_live/1024, info.bytes_peak/1024, info.nb_blocks, info.nb_allocs, info.allocs_per_sec);
+	}
+}
+
 
 /*gf_asprintf(): as_printf portable implementation*/
 #if defined(WIN32) || defined(_WIN32_WCE) || (defined (__SVR4) && defined (__sun))
@@ -25,6 +25,17 @@
 
 #include "../../include/gpac/bitstream.h"
 
+#if !defined(WIN32) && !defined(_WIN32_WCE)
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#define GPAC_HAS_WRITEV
+/*transfers of chained blocks to a file below this size are copied through the regular write path*/
+#define BS_WRITEV_MIN_SIZE		65536
+/*max number of blocks written in a single writev call*/
+#define BS_WRITEV_MAX_IOV		64
+#endif
+
 /*the default size for new streams allocation...*/
 #define BS_MEM_BLOCK_ALLOC_SIZE		250
 
@@ -34,7 +45,9 @@ enum
 	GF_BITSTREAM_FILE_READ = GF_BITSTREAM_WRITE + 1,
 	GF_BITSTREAM_FILE_WRITE,
 	/*private mode if we own the buffer*/
-	GF_BITSTREAM_WRITE_DYN
+	GF_BITSTREAM_WRITE_DYN,
+	/*private mode for chained blocks*/
+	GF_BITSTREAM_WRITE_CHAINED
 };
 
 struct __tag_bitstream
@@ -61,8 +74,28 @@ struct __tag_bitstream
 
 	char *buffer_io;
 	u32 buffer_io_size, buffer_written;
+
+	/*read cache for file-based read streams: the file is positioned at the end of the cached window*/
+	char *cache_read;
+	u32 cache_read_size, cache_read_pos, cache_read_alloc;
+	Bool cache_read_eof;
+
+	/*chained write mode: blocks (all full except the last one), their allocated sizes, current block and its offset in the stream*/
+	GF_BitStreamBlock *blocks;
+	u32 *blocks_alloc;
+	u32 nb_blocks, nb_alloc_blocks, block_size, cur_block;
+	u64 cur_block_start;
 };
 
+/*returns the new allocation size of a dynamic buffer of size cur_size which must hold at least needed bytes*/
+static u64 bs_dyn_grow_size(u64 cur_size, u64 needed)
+{
+	u64 new_size = cur_size ? 2*cur_size : BS_MEM_BLOCK_ALLOC_SIZE;
+	if (new_size < needed) new_size = needed;
+	if (new_size > 0xFFFFFFFF) new_size = 0xFFFFFFFF;
+	return new_size;
+}
+
 
 GF_EXPORT
 GF_BitStream *gf_bs_new(const char *buffer, u64 BufferSize, u32 mode)
@@ -116,6 +149,216 @@ GF_BitStream *gf_bs_new(const char *buffer, u64 BufferSize, u32 mode)
 	return tmp;
 }
 
+/*appends a new block able to hold at least min_size bytes*/
+static Bool bs_chain_add_block(GF_BitStream *bs, u32 min_size)
+{
+	u32 size = (min_size > bs->block_size) ? min_size : bs->block_size;
+	char *data;
+	if (bs->nb_blocks == bs->nb_alloc_blocks) {
+		u32 nb_alloc = bs->nb_alloc_blocks ? 2*bs->nb_alloc_blocks : 8;
+		GF_BitStreamBlock *blocks = (GF_BitStreamBlock *) gf_realloc(bs->blocks, sizeof(GF_BitStreamBlock) * nb_alloc);
+		u32 *blocks_alloc;
+		if (!blocks) return 0;
+		bs->blocks = blocks;
+		blocks_alloc = (u32 *) gf_realloc(bs->blocks_alloc, sizeof(u32) * nb_alloc);
+		if (!blocks_alloc) return 0;
+		bs->blocks_alloc = blocks_alloc;
+		bs->nb_alloc_blocks = nb_alloc;
+	}
+	data = (char *) gf_malloc(sizeof(char) * size);
+	if (!data) return 0;
+	bs->blocks[bs->nb_blocks].data = data;
+	bs->blocks[bs->nb_blocks].size = 0;
+	bs->blocks_alloc[bs->nb_blocks] = size;
+	bs->nb_blocks++;
+	return 1;
+}
+
+/*writes nb bytes from data (or nb times val if data is NULL) at the current position of a chained bitstream*/
+static u32 bs_chain_write(GF_BitStream *bs, const char *data, u8 val, u32 nb)
+{
+	u32 done = 0;
+	while (nb) {
+		GF_BitStreamBlock *blk;
+		u32 offset, avail;
+		if (!bs->nb_blocks && !bs_chain_add_block(bs, nb)) break;
+		blk = &bs->blocks[bs->cur_block];
+		offset = (u32) (bs->position - bs->cur_block_start);
+		avail = bs->blocks_alloc[bs->cur_block] - offset;
+		if (!avail) {
+			/*current block is full, move to the next one or create it*/
+			if ((bs->cur_block + 1 == bs->nb_blocks) && !bs_chain_add_block(bs, nb)) break;
+			bs->cur_block_start += bs->blocks[bs->cur_block].size;
+			bs->cur_block++;
+			continue;
+		}
+		if (avail > nb) avail = nb;
+		if (data) {
+			memcpy(blk->data + offset, data + done, avail);
+		} else {
+			memset(blk->data + offset, val, avail);
+		}
+		if (offset + avail > blk->size) {
+			bs->size += offset + avail - blk->size;
+			blk->size = offset + avail;
+		}
+		bs->position += avail;
+		done += avail;
+		nb -= avail;
+	}
+	return done;
+}
+
+/*moves a chained bitstream to the given offset (at most the stream size)*/
+static void bs_chain_seek(GF_BitStream *bs, u64 offset)
+{
+	u32 i;
+	u64 start = 0;
+	bs->cur_block = 0;
+	bs->cur_block_start = 0;
+	for (i=0; i<bs->nb_blocks; i++) {
+		bs->cur_block = i;
+		bs->cur_block_start = start;
+		if (offset < start + bs->blocks[i].size) break;
+		start += bs->blocks[i].size;
+	}
+	bs->position = offset;
+}
+
+/*aligns a chained bitstream and drops data after the current position, as done for dynamic bitstreams*/
+static void bs_chain_flush(GF_BitStream *bs)
+{
+	gf_bs_align(bs);
+	if (bs->position < bs->size) gf_bs_truncate(bs);
+}
+
+static void bs_chain_reset(GF_BitStream *bs)
+{
+	u32 i;
+	for (i=0; i<bs->nb_blocks; i++) gf_free(bs->blocks[i].data);
+	bs->nb_blocks = 0;
+	bs->cur_block = 0;
+	bs->cur_block_start = 0;
+	bs->size = bs->position = 0;
+}
+
+GF_EXPORT
+GF_BitStream *gf_bs_new_chained(u32 block_size)
+{
+	GF_BitStream *tmp;
+	GF_SAFEALLOC(tmp, GF_BitStream);
+	if (!tmp) return NULL;
+	tmp->bsmode = GF_BITSTREAM_WRITE_CHAINED;
+	tmp->block_size = block_size ? block_size : BS_MEM_BLOCK_ALLOC_SIZE;
+	return tmp;
+}
+
+GF_EXPORT
+u32 gf_bs_get_blocks(GF_BitStream *bs, const GF_BitStreamBlock **blocks)
+{
+	if (bs->bsmode != GF_BITSTREAM_WRITE_CHAINED) {
+		*blocks = NULL;
+		return 0;
+	}
+	bs_chain_flush(bs);
+	*blocks = bs->blocks;
+	return bs->nb_blocks;
+}
+
+static void bs_flush_cache(GF_BitStream *bs);
+
+#ifdef GPAC_HAS_WRITEV
+/*writes chained blocks to a file bitstream with scatter/gather I/O, bypassing the stdio and output buffers.
+returns GF_NOT_SUPPORTED if the blocks are better written through gf_bs_write_data*/
+static GF_Err bs_write_blocks_file(GF_BitStream *dst, const GF_BitStreamBlock *blocks, u32 nb_blocks)
+{
+	struct iovec iov[BS_WRITEV_MAX_IOV];
+	u32 i, nb_iov, iov_start;
+	u64 total = 0;
+	int fd;
+
+	if ((dst->bsmode != GF_BITSTREAM_FILE_WRITE) || !dst->stream || dst->nbBits) return GF_NOT_SUPPORTED;
+	for (i=0; i<nb_blocks; i++) total += blocks[i].size;
+	if (total < BS_WRITEV_MIN_SIZE) return GF_NOT_SUPPORTED;
+	/*fits in the output buffer, a copy is cheaper than a system call*/
+	if (dst->buffer_io && (dst->buffer_written + total <= dst->buffer_io_size)) return GF_NOT_SUPPORTED;
+
+	/*the file descriptor must be at the bitstream position*/
+	bs_flush_cache(dst);
+	if (fflush(dst->stream)) return GF_IO_ERR;
+	fd = fileno(dst->stream);
+	if (fd < 0) return GF_NOT_SUPPORTED;
+
+	i = 0;
+	while (i<nb_blocks) {
+		nb_iov = 0;
+		while ((i<nb_blocks) && (nb_iov<BS_WRITEV_MAX_IOV)) {
+			if (blocks[i].size) {
+				iov[nb_iov].iov_base = blocks[i].data;
+				iov[nb_iov].iov_len = blocks[i].size;
+				nb_iov++;
+			}
+			i++;
+		}
+		iov_start = 0;
+		while (iov_start<nb_iov) {
+			ssize_t res = writev(fd, iov + iov_start, nb_iov - iov_start);
+			if (res < 0) {
+				if (errno == EINTR) continue;
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CORE, ("[BS] Failed to write %d data blocks to file: %s\n", nb_iov - iov_start, strerror(errno)));
+				return GF_IO_ERR;
+			}
+			dst->position += res;
+			if (dst->position > dst->size) dst->size = dst->position;
+			/*skip written blocks and resume partial ones*/
+			while ((iov_start<nb_iov) && ((size_t) res >= iov[iov_start].iov_len)) {
+				res -= iov[iov_start].iov_len;
+				iov_start++;
+			}
+			if (res) {
+				iov[iov_start].iov_base = (char *) iov[iov_start].iov_base + res;
+				iov[iov_start].iov_len -= res;
+			}
+		}
+	}
+	/*resync the stdio stream with the file descriptor*/
+	gf_f64_seek(dst->stream, dst->position, SEEK_SET);
+	return GF_OK;
+}
+#endif
+
+GF_EXPORT
+GF_Err gf_bs_transfer(GF_BitStream *dst, GF_BitStream *src)
+{
+	const GF_BitStreamBlock *blocks;
+	u32 i, nb_blocks;
+	switch (src->bsmode) {
+	case GF_BITSTREAM_WRITE:
+	case GF_BITSTREAM_WRITE_DYN:
+		gf_bs_align(src);
+		if (src->position > 0xFFFFFFFF) return GF_IO_ERR;
+		if (src->position && (gf_bs_write_data(dst, src->original, (u32) src->position) != src->position))
+			return GF_IO_ERR;
+		return GF_OK;
+	case GF_BITSTREAM_WRITE_CHAINED:
+		nb_blocks = gf_bs_get_blocks(src, &blocks);
+#ifdef GPAC_HAS_WRITEV
+		{
+			GF_Err e = bs_write_blocks_file(dst, blocks, nb_blocks);
+			if (e != GF_NOT_SUPPORTED) return e;
+		}
+#endif
+		for (i=0; i<nb_blocks; i++) {
+			if (!blocks[i].size) continue;
+			if (gf_bs_write_data(dst, blocks[i].data, blocks[i].size) != blocks[i].size)
+				return GF_IO_ERR;
+		}
+		return GF_OK;
+	default:
+		return GF_BAD_PARAM;
+	}
+}
+
 GF_EXPORT
 GF_BitStream *gf_bs_from_file(FILE *f, u32 mode)
 {
@@ -175,14 +418,90 @@ u32 gf_bs_get_output_buffering(GF_BitStream *bs)
 	return bs ? bs->buffer_io_size : 0;
 }
 
+GF_EXPORT
+void gf_bs_flush(GF_BitStream *bs)
+{
+	if (!bs || !bs->stream) return;
+	if (bs->bsmode != GF_BITSTREAM_FILE_WRITE) return;
+	if (bs->buffer_io)
+		bs_flush_cache(bs);
+	fflush(bs->stream);
+}
+
+/*drops the read cache and puts the file back at the logical position*/
+static void bs_drop_read_cache(GF_BitStream *bs)
+{
+	if (bs->cache_read_pos != bs->cache_read_alloc)
+		gf_f64_seek(bs->stream, bs->position, SEEK_SET);
+	bs->cache_read_pos = bs->cache_read_alloc = 0;
+}
+
+/*refills the read cache, returns the number of bytes available*/
+static u32 bs_refill_read_cache(GF_BitStream *bs)
+{
+	if (bs->cache_read_eof) return 0;
+	/*file may have grown since we hit its end*/
+	if (feof(bs->stream)) clearerr(bs->stream);
+	bs->cache_read_pos = 0;
+	bs->cache_read_alloc = (u32) fread(bs->cache_read, 1, bs->cache_read_size, bs->stream);
+	return bs->cache_read_alloc;
+}
+
+/*moves a file-based read stream to the given offset, reusing the cached window if possible*/
+static void bs_seek_read_cache(GF_BitStream *bs, u64 offset)
+{
+	u64 start = bs->position - bs->cache_read_pos;
+	if ((offset >= start) && (offset <= start + bs->cache_read_alloc)) {
+		bs->cache_read_pos = (u32) (offset - start);
+	} else {
+		gf_f64_seek(bs->stream, offset, SEEK_SET);
+		bs->cache_read_pos = bs->cache_read_alloc = 0;
+	}
+	bs->cache_read_eof = 0;
+	bs->position = offset;
+}
+
+GF_EXPORT
+GF_Err gf_bs_set_input_buffering(GF_BitStream *bs, u32 size)
+{
+	if (!bs->stream) return GF_OK;
+	if (bs->bsmode != GF_BITSTREAM_FILE_READ) {
+		return GF_OK;
+	}
+	bs_drop_read_cache(bs);
+	if (!size) {
+		if (bs->cache_read) gf_free(bs->cache_read);
+		bs->cache_read = NULL;
+		bs->cache_read_size = 0;
+		return GF_OK;
+	}
+	bs->cache_read = gf_realloc(bs->cache_read, size);
+	if (!bs->cache_read) {
+		bs->cache_read_size = 0;
+		return GF_OUT_OF_MEM;
+	}
+	bs->cache_read_size = size;
+	return GF_OK;
+}
+
 GF_EXPORT
 void gf_bs_del(GF_BitStream *bs)
 {
 	if (!bs) return;
 	/*if we are in dynamic mode (alloc done by the bitstream), free the buffer if still present*/
 	if ((bs->bsmode == GF_BITSTREAM_WRITE_DYN) && bs->original) gf_free(bs->original);
+	if (bs->bsmode == GF_BITSTREAM_WRITE_CHAINED) {
+		bs_chain_reset(bs);
+		if (bs->blocks) gf_free(bs->blocks);
+		if (bs->blocks_alloc) gf_free(bs->blocks_alloc);
+	}
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
+	/*the file handle is still owned by the caller, leave it where we logically are*/
+	if (bs->cache_read) {
+		bs_drop_read_cache(bs);
+		gf_free(bs->cache_read);
+	}
 	gf_free(bs);
 }
 
@@ -210,6 +529,20 @@ static u8 BS_ReadByte(GF_BitStream *bs)
 		}
 		return (u32) bs->original[bs->position++];
 	}
+	if (bs->cache_read) {
+		if ((bs->cache_read_pos == bs->cache_read_alloc) && !bs_refill_read_cache(bs)) {
+			/*same behaviour as fgetc() below: first read past the end returns EOF*/
+			if (!bs->cache_read_eof) {
+				bs->cache_read_eof = 1;
+				bs->position++;
+				return (u8) EOF;
+			}
+			if (bs->EndOfStream) bs->EndOfStream(bs->par);
+			return 0;
+		}
+		bs->position++;
+		return (u8) bs->cache_read[bs->cache_read_pos++];
+	}
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
 
@@ -222,50 +555,52 @@ static u8 BS_ReadByte(GF_BitStream *bs)
 	return 0;
 }
 
-#define NO_OPTS
-
-#ifndef NO_OPTS
-static u32 bit_mask[] = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
-static u32 bits_mask[] = {0x0, 0x1, 0x3, 0x7, 0xF, 0x1F, 0x3F, 0x7F};
-#endif
+/*in read mode, current holds the last byte fetched and nbBits the number of its bits already consumed
+(8 meaning a new byte must be fetched). In write mode, current accumulates the nbBits pending bits.
+Bits are extracted by byte chunks rather than one at a time*/
+static const u32 bits_mask[] = {0x0, 0x1, 0x3, 0x7, 0xF, 0x1F, 0x3F, 0x7F, 0xFF};
 
 GF_EXPORT
 u8 gf_bs_read_bit(GF_BitStream *bs)
 {
 	if (bs->nbBits == 8) {
 		bs->current = BS_ReadByte(bs);
-	 	bs->nbBits = 0;
-	}
-#ifdef NO_OPTS
-	{
-		s32 ret;
-		bs->current <<= 1;
-		bs->nbBits++;
-		ret = (bs->current & 0x100) >> 8;
-		return (u8) ret;
-	}
-#else
-	return (u8) (bs->current & bit_mask[bs->nbBits++]) ? 1 : 0;
-#endif
-
+		bs->nbBits = 0;
+	}
+	return (u8) ((bs->current >> (7 - bs->nbBits++)) & 1);
 }
 
 GF_EXPORT
 u32 gf_bs_read_int(GF_BitStream *bs, u32 nBits)
 {
-	u32 ret;
+	u32 ret, left;
 
-#ifndef NO_OPTS
+	/*only the last 32 bits are returned*/
+	if (nBits > 32) {
+		gf_bs_read_long_int(bs, nBits - 32);
+		nBits = 32;
+	}
+	/*enough bits in the current byte*/
 	if (nBits + bs->nbBits <= 8) {
 		bs->nbBits += nBits;
-        ret = (bs->current >> (8 - bs->nbBits) ) & bits_mask[nBits];
-		return ret;
+		return (bs->current >> (8 - bs->nbBits)) & bits_mask[nBits];
 	}
-#endif
-	ret = 0;
-	while (nBits-- > 0) {
-		ret <<= 1;
-		ret |= gf_bs_read_bit(bs);
+	/*flush remaining bits of the current byte*/
+	left = 8 - bs->nbBits;
+	ret = bs->current & bits_mask[left];
+	nBits -= left;
+	bs->nbBits = 8;
+	/*whole bytes*/
+	while (nBits >= 8) {
+		bs->current = BS_ReadByte(bs);
+		ret = (ret << 8) | bs->current;
+		nBits -= 8;
+	}
+	/*and first bits of the last byte*/
+	if (nBits) {
+		bs->current = BS_ReadByte(bs);
+		bs->nbBits = nBits;
+		ret = (ret << nBits) | (bs->current >> (8 - nBits));
 	}
 	return ret;
 }
@@ -323,15 +658,27 @@ u64 gf_bs_read_u64(GF_BitStream *bs)
 GF_EXPORT
 u64 gf_bs_read_long_int(GF_BitStream *bs, u32 nBits)
 {
-	u64 ret = 0;
+	u64 ret;
+	u32 left;
 	if (nBits>64) {
 		gf_bs_read_long_int(bs, nBits-64);
-		ret = gf_bs_read_long_int(bs, 64);
-	} else {
-		while (nBits-- > 0) {
-			ret <<= 1;
-			ret |= gf_bs_read_bit(bs);
-		}
+		return gf_bs_read_long_int(bs, 64);
+	}
+	if (nBits <= 32) return gf_bs_read_int(bs, nBits);
+
+	left = 8 - bs->nbBits;
+	ret = bs->current & bits_mask[left];
+	nBits -= left;
+	bs->nbBits = 8;
+	while (nBits >= 8) {
+		bs->current = BS_ReadByte(bs);
+		ret = (ret << 8) | bs->current;
+		nBits -= 8;
+	}
+	if (nBits) {
+		bs->current = BS_ReadByte(bs);
+		bs->nbBits = nBits;
+		ret = (ret << nBits) | (bs->current >> (8 - nBits));
 	}
 	return ret;
 }
@@ -341,16 +688,10 @@ GF_EXPORT
 Float gf_bs_read_float(GF_BitStream *bs)
 {
 	char buf [4] = "\0\0\0";
-#ifdef NO_OPTS
-	s32 i;
-	for (i = 0; i < 32; i++)
-		buf[3-i/8] |= gf_bs_read_bit(bs) << (7 - i%8);
-#else
 	buf[3] = gf_bs_read_int(bs, 8);
 	buf[2] = gf_bs_read_int(bs, 8);
 	buf[1] = gf_bs_read_int(bs, 8);
 	buf[0] = gf_bs_read_int(bs, 8);
-#endif
 	return (* (Float *) buf);
 }
 
@@ -359,11 +700,37 @@ Double gf_bs_read_double(GF_BitStream *bs)
 {
 	char buf [8] = "\0\0\0\0\0\0\0";
 	s32 i;
-	for (i = 0; i < 64; i++)
-		buf[7-i/8] |= gf_bs_read_bit(bs) << (7 - i%8);
+	for (i = 0; i < 8; i++)
+		buf[7-i] = gf_bs_read_int(bs, 8);
 	return (* (Double *) buf);
 }
 
+static u32 bs_read_data_cached(GF_BitStream *bs, char *data, u32 nbBytes)
+{
+	u32 done = 0;
+	while (done < nbBytes) {
+		u32 nb = bs->cache_read_alloc - bs->cache_read_pos;
+		if (!nb) {
+			/*large reads go straight to the file*/
+			if (nbBytes - done >= bs->cache_read_size / 2) {
+				nb = (u32) fread(data + done, 1, nbBytes - done, bs->stream);
+				bs->cache_read_pos = bs->cache_read_alloc = 0;
+				bs->position += nb;
+				done += nb;
+				break;
+			}
+			if (!bs_refill_read_cache(bs)) break;
+			continue;
+		}
+		if (nb > nbBytes - done) nb = nbBytes - done;
+		memcpy(data + done, bs->cache_read + bs->cache_read_pos, nb);
+		bs->cache_read_pos += nb;
+		bs->position += nb;
+		done += nb;
+	}
+	return done;
+}
+
 GF_EXPORT
 u32 gf_bs_read_data(GF_BitStream *bs, char *data, u32 nbBytes)
 {
@@ -379,6 +746,8 @@ u32 gf_bs_read_data(GF_BitStream *bs, char *data, u32 nbBytes)
 			return nbBytes;
 		case GF_BITSTREAM_FILE_READ:
 		case GF_BITSTREAM_FILE_WRITE:
+			if (bs->cache_read)
+				return bs_read_data_cached(bs, data, nbBytes);
 			if (bs->buffer_io)
 				bs_flush_cache(bs);
 			nbBytes = fread(data, 1, nbBytes, bs->stream);
@@ -400,8 +769,13 @@ u32 gf_bs_read_data(GF_BitStream *bs, char *data, u32 nbBytes)
 
 static void BS_WriteByte(GF_BitStream *bs, u8 val)
 {
+	u64 new_size;
 	/*we don't allow write on READ buffers*/
 	if ( (bs->bsmode == GF_BITSTREAM_READ) || (bs->bsmode == GF_BITSTREAM_FILE_READ) ) return;
+	if (bs->bsmode == GF_BITSTREAM_WRITE_CHAINED) {
+		bs_chain_write(bs, NULL, val, 1);
+		return;
+	}
 	if (!bs->original && !bs->stream) return;
 
 	/*we are in MEM mode*/
@@ -410,10 +784,11 @@ static void BS_WriteByte(GF_BitStream *bs, u8 val)
 			/*no more space...*/
 			if (bs->bsmode != GF_BITSTREAM_WRITE_DYN) return;
 			/*gf_realloc if enough space...*/
-			if (bs->size > 0xFFFFFFFF) return;
-			bs->original = (char*)gf_realloc(bs->original, (u32) (bs->size + BS_MEM_BLOCK_ALLOC_SIZE));
+			if (bs->size >= 0xFFFFFFFF) return;
+			new_size = bs_dyn_grow_size(bs->size, bs->size + 1);
+			bs->original = (char*)gf_realloc(bs->original, (u32) new_size);
 			if (!bs->original) return;
-			bs->size += BS_MEM_BLOCK_ALLOC_SIZE;
+			bs->size = new_size;
 		}
 		bs->original[bs->position] = val;
 		bs->position++;
@@ -434,40 +809,69 @@ static void BS_WriteByte(GF_BitStream *bs, u8 val)
 	bs->position += 1;
 }
 
-static void BS_WriteBit(GF_BitStream *bs, u32 bit)
+GF_EXPORT
+void gf_bs_write_int(GF_BitStream *bs, s32 _value, s32 nBits)
 {
-	bs->current <<= 1;
-	bs->current |= bit;
-	if (++ bs->nbBits == 8) {
-		bs->nbBits = 0;
-		BS_WriteByte(bs, (u8) bs->current);
-		bs->current = 0;
+	u32 value, left;
+	if (nBits <= 0) return;
+	if (nBits > 32) {
+		gf_bs_write_int(bs, 0, nBits - 32);
+		nBits = 32;
 	}
-}
+	value = (u32) _value;
+	if (nBits < 32) value &= (1 << nBits) - 1;
 
-GF_EXPORT
-void gf_bs_write_int(GF_BitStream *bs, s32 value, s32 nBits)
-{
-	value <<= sizeof (s32) * 8 - nBits;
-	while (--nBits >= 0) {
-		BS_WriteBit (bs, value < 0);
-		value <<= 1;
+	/*not enough bits to complete the current byte*/
+	if (bs->nbBits + nBits < 8) {
+		bs->current = (bs->current << nBits) | value;
+		bs->nbBits += nBits;
+		return;
 	}
+	/*complete the current byte*/
+	if (bs->nbBits) {
+		left = 8 - bs->nbBits;
+		nBits -= left;
+		BS_WriteByte(bs, (u8) ((bs->current << left) | (value >> nBits)));
+		bs->nbBits = 0;
+	}
+	/*whole bytes*/
+	while (nBits >= 8) {
+		nBits -= 8;
+		BS_WriteByte(bs, (u8) (value >> nBits));
+	}
+	/*keep remaining bits*/
+	bs->current = value & bits_mask[nBits];
+	bs->nbBits = nBits;
 }
 
 GF_EXPORT
-void gf_bs_write_long_int(GF_BitStream *bs, s64 value, s32 nBits)
+void gf_bs_write_long_int(GF_BitStream *bs, s64 _value, s32 nBits)
 {
+	u64 value;
+	u32 left;
 	if (nBits>64) {
 		gf_bs_write_int(bs, 0, nBits-64);
-		gf_bs_write_long_int(bs, value, 64);
-	} else {
-		value <<= sizeof (s64) * 8 - nBits;
-		while (--nBits >= 0) {
-			BS_WriteBit (bs, value < 0);
-			value <<= 1;
-		}
+		nBits = 64;
+	}
+	if (nBits <= 32) {
+		gf_bs_write_int(bs, (s32) _value, nBits);
+		return;
 	}
+	value = (u64) _value;
+	if (nBits < 64) value &= (((u64) 1) << nBits) - 1;
+
+	if (bs->nbBits) {
+		left = 8 - bs->nbBits;
+		nBits -= left;
+		BS_WriteByte(bs, (u8) ((bs->current << left) | (u32) (value >> nBits)));
+		bs->nbBits = 0;
+	}
+	while (nBits >= 8) {
+		nBits -= 8;
+		BS_WriteByte(bs, (u8) (value >> nBits));
+	}
+	bs->current = (u32) value & bits_mask[nBits];
+	bs->nbBits = nBits;
 }
 
 GF_EXPORT
@@ -534,16 +938,20 @@ u32 gf_bs_write_byte(GF_BitStream *bs, u8 byte, u32 repeat_count)
 	case GF_BITSTREAM_WRITE_DYN:
 		/*need to gf_realloc ...*/
 		if (bs->position+repeat_count> bs->size) {
-			if (bs->size + repeat_count > 0xFFFFFFFF)
+			u64 new_size;
+			if (bs->position + repeat_count > 0xFFFFFFFF)
 				return 0;
-			bs->original = (char*)gf_realloc(bs->original, sizeof(u32)*((u32) bs->size + repeat_count));
+			new_size = bs_dyn_grow_size(bs->size, bs->position + repeat_count);
+			bs->original = (char*)gf_realloc(bs->original, (u32) new_size);
 			if (!bs->original)
 				return 0;
-			bs->size += repeat_count;
+			bs->size = new_size;
 		}
 		memset(bs->original + bs->position, byte, repeat_count);
 		bs->position += repeat_count;
 		return repeat_count;
+	case GF_BITSTREAM_WRITE_CHAINED:
+		return bs_chain_write(bs, NULL, byte, repeat_count);
 	case GF_BITSTREAM_FILE_READ:
 	case GF_BITSTREAM_FILE_WRITE:
 
@@ -568,9 +976,8 @@ void gf_bs_write_float(GF_BitStream *bs, Float value)
 	} float_value;
 	float_value.f = value;
 
-	for (i = 0; i < 32; i++)
-		BS_WriteBit(bs, (float_value.sz [3 - i / 8] & 1 << (7 - i % 8)) != 0);
-
+	for (i = 0; i < 4; i++)
+		gf_bs_write_int(bs, float_value.sz [3 - i], 8);
 }
 
 GF_EXPORT
@@ -582,9 +989,8 @@ void gf_bs_write_double (GF_BitStream *bs, Double value)
 		char sz [8];
 	} double_value;
 	double_value.d = value;
-	for (i = 0; i < 64; i++) {
-		BS_WriteBit(bs, (double_value.sz [7 - i / 8] & 1 << (7 - i % 8)) != 0);
-	}
+	for (i = 0; i < 8; i++)
+		gf_bs_write_int(bs, double_value.sz [7 - i], 8);
 }
 
 
@@ -606,16 +1012,20 @@ u32 gf_bs_write_data(GF_BitStream *bs, const char *data, u32 nbBytes)
 		case GF_BITSTREAM_WRITE_DYN:
 			/*need to gf_realloc ...*/
 			if (bs->position+nbBytes > bs->size) {
-				if (bs->size + nbBytes > 0xFFFFFFFF)
+				u64 new_size;
+				if (bs->position + nbBytes > 0xFFFFFFFF)
 					return 0;
-				bs->original = (char*)gf_realloc(bs->original, sizeof(u32)*((u32) bs->size + nbBytes));
+				new_size = bs_dyn_grow_size(bs->size, bs->position + nbBytes);
+				bs->original = (char*)gf_realloc(bs->original, (u32) new_size);
 				if (!bs->original)
 					return 0;
-				bs->size += nbBytes;
+				bs->size = new_size;
 			}
 			memcpy(bs->original + bs->position, data, nbBytes);
 			bs->position += nbBytes;
 			return nbBytes;
+		case GF_BITSTREAM_WRITE_CHAINED:
+			return bs_chain_write(bs, data, 0, nbBytes);
 		case GF_BITSTREAM_FILE_READ:
 		case GF_BITSTREAM_FILE_WRITE:
 			if (bs->buffer_io) {
@@ -675,6 +1085,7 @@ u64 gf_bs_available(GF_BitStream *bs)
 	/*in WRITE mode only, this should not be called, but return something big in case ...*/
 	if ( (bs->bsmode == GF_BITSTREAM_WRITE)
 		|| (bs->bsmode == GF_BITSTREAM_WRITE_DYN)
+		|| (bs->bsmode == GF_BITSTREAM_WRITE_CHAINED)
 		)
 		return (u64) -1;
 
@@ -722,6 +1133,34 @@ static s32 BS_CutBuffer(GF_BitStream *bs)
 GF_EXPORT
 void gf_bs_get_content(GF_BitStream *bs, char **output, u32 *outSize)
 {
+	if (bs->bsmode == GF_BITSTREAM_WRITE_CHAINED) {
+		u32 i;
+		bs_chain_flush(bs);
+		*output = NULL;
+		*outSize = (u32) bs->size;
+		if (bs->nb_blocks == 1) {
+			/*single block, hand it over*/
+			*output = (char*)gf_realloc(bs->blocks[0].data, bs->blocks[0].size ? bs->blocks[0].size : 1);
+			if (!*output) gf_free(bs->blocks[0].data);
+			bs->nb_blocks = 0;
+		} else if (bs->size) {
+			*output = (char*)gf_malloc(sizeof(char) * (u32) bs->size);
+			if (*output) {
+				u32 offset = 0;
+				for (i=0; i<bs->nb_blocks; i++) {
+					memcpy(*output + offset, bs->blocks[i].data, bs->blocks[i].size);
+					offset += bs->blocks[i].size;
+				}
+			}
+		}
+		if (!bs->size && *output) {
+			gf_free(*output);
+			*output = NULL;
+		}
+		if (!*output) *outSize = 0;
+		bs_chain_reset(bs);
+		return;
+	}
 	/*only in WRITE MEM mode*/
 	if (bs->bsmode != GF_BITSTREAM_WRITE_DYN) return;
 	if (!bs->position && !bs->nbBits) {
@@ -755,6 +1194,10 @@ void gf_bs_skip_bytes(GF_BitStream *bs, u64 nbBytes)
 
 	/*special case for file skipping...*/
 	if ((bs->bsmode == GF_BITSTREAM_FILE_WRITE) || (bs->bsmode == GF_BITSTREAM_FILE_READ)) {
+		if (bs->cache_read) {
+			bs_seek_read_cache(bs, bs->position + nbBytes);
+			return;
+		}
 		if (bs->buffer_io)
 			bs_flush_cache(bs);
 		gf_f64_seek(bs->stream, nbBytes, SEEK_CUR);
@@ -795,6 +1238,17 @@ void gf_bs_rewind_bits(GF_BitStream *bs, u64 nbBits)
 static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset)
 {
 	u32 i;
+	if (bs->bsmode == GF_BITSTREAM_WRITE_CHAINED) {
+		/*extend with 0s if needed*/
+		if (offset > bs->size) {
+			bs_chain_seek(bs, bs->size);
+			bs_chain_write(bs, NULL, 0, (u32) (offset - bs->size));
+		}
+		bs_chain_seek(bs, offset);
+		bs->current = 0;
+		bs->nbBits = 0;
+		return GF_OK;
+	}
 	/*if mem, do it */
 	if ((bs->bsmode == GF_BITSTREAM_READ) || (bs->bsmode == GF_BITSTREAM_WRITE) || (bs->bsmode == GF_BITSTREAM_WRITE_DYN)) {
 		if (offset > 0xFFFFFFFF) return GF_IO_ERR;
@@ -817,7 +1271,10 @@ static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset)
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
 
-	gf_f64_seek(bs->stream, offset, SEEK_SET);
+	if (bs->cache_read)
+		bs_seek_read_cache(bs, offset);
+	else
+		gf_f64_seek(bs->stream, offset, SEEK_SET);
 
 	bs->position = offset;
 	bs->current = 0;
@@ -871,6 +1328,8 @@ u64 gf_bs_get_refreshed_size(GF_BitStream *bs)
 	switch (bs->bsmode) {
 	case GF_BITSTREAM_READ:
 	case GF_BITSTREAM_WRITE:
+	case GF_BITSTREAM_WRITE_DYN:
+	case GF_BITSTREAM_WRITE_CHAINED:
 		return bs->size;
 
 	default:
@@ -880,6 +1339,8 @@ u64 gf_bs_get_refreshed_size(GF_BitStream *bs)
 		gf_f64_seek(bs->stream, 0, SEEK_END);
 		bs->size = gf_f64_tell(bs->stream);
 		gf_f64_seek(bs->stream, offset, SEEK_SET);
+		/*seeking resets the end of file state*/
+		bs->cache_read_eof = 0;
 		return bs->size;
 	}
 }
@@ -975,9 +1436,72 @@ u32 gf_bs_read_vluimsbf5(GF_BitStream *bs)
 	return gf_bs_read_int(bs, 4*nb_words);
 }
 
+GF_EXPORT
+u32 gf_bs_read_ue(GF_BitStream *bs)
+{
+	u32 nb_zeros = 0, left, val;
+
+	/*count leading zeros by bytes*/
+	while (1) {
+		left = 8 - bs->nbBits;
+		if (!left) {
+			if (!gf_bs_available(bs)) return 0;
+			bs->current = BS_ReadByte(bs);
+			bs->nbBits = 0;
+			left = 8;
+		}
+		val = bs->current & bits_mask[left];
+		if (val) break;
+		nb_zeros += left;
+		bs->nbBits = 8;
+		/*corrupted stream*/
+		if (nb_zeros > 32) return 0;
+	}
+	/*then locate the leading one in the current byte and skip it*/
+	while (! (val & (1 << (left-1)))) {
+		left--;
+		nb_zeros++;
+	}
+	bs->nbBits = 8 - left + 1;
+	if (nb_zeros > 32) return 0;
+	return (u32) ( (((u64) 1) << nb_zeros) - 1 + gf_bs_read_long_int(bs, nb_zeros) );
+}
+
+GF_EXPORT
+s32 gf_bs_read_se(GF_BitStream *bs)
+{
+	u32 v = gf_bs_read_ue(bs);
+	if ((v & 0x1) == 0) return (s32) (0 - (v>>1));
+	return (v + 1) >> 1;
+}
+
+GF_EXPORT
+void gf_bs_write_ue(GF_BitStream *bs, u32 value)
+{
+	u64 v = (u64) value + 1;
+	u32 nb_bits = 0;
+	while (v >> (nb_bits+1)) nb_bits++;
+	/*nb_bits zeros, the leading one and nb_bits info bits*/
+	gf_bs_write_long_int(bs, v, 2*nb_bits + 1);
+}
+
+GF_EXPORT
+void gf_bs_write_se(GF_BitStream *bs, s32 value)
+{
+	if (value > 0) gf_bs_write_ue(bs, 2 * (u32) value - 1);
+	else gf_bs_write_ue(bs, 2 * (u32) (-(s64) value));
+}
+
 GF_EXPORT
 void gf_bs_truncate(GF_BitStream *bs)
 {
+	if (bs->bsmode == GF_BITSTREAM_WRITE_CHAINED) {
+		u32 i;
+		if (!bs->nb_blocks) return;
+		bs->blocks[bs->cur_block].size = (u32) (bs->position - bs->cur_block_start);
+		for (i=bs->cur_block+1; i<bs->nb_blocks; i++) gf_free(bs->blocks[i].data);
+		bs->nb_blocks = bs->cur_block+1;
+	}
 	bs->size = bs->position;
 	if (bs->stream) return;
 }
@@ -28,25 +28,209 @@
 
 #define MAX_INI_LINE			2046
 
+/*initial number of buckets of section and key hash indexes - grown by 2 when load factor goes above 2*/
+#define INI_HASH_MIN_BUCKETS	16
+/*journal is compacted (full rewrite) once it holds more than twice the number of live keys, plus this margin*/
+#define INI_JOURNAL_MARGIN		1024
+
+/*common header of hashed entries (sections and keys)*/
+#define INI_HASHED_ENTRY	\
+	char *name;	\
+	u32 hash;	\
+	struct __ini_entry *hnext;	\
+
+typedef struct __ini_entry
+{
+	INI_HASHED_ENTRY
+} IniEntry;
+
+typedef struct
+{
+	IniEntry **buckets;
+	u32 nb_buckets, count;
+} IniHash;
+
 typedef struct
 {
-	char *name;
+	INI_HASHED_ENTRY
 	char *value;
+	/*set if the key is pending in the journal*/
+	Bool in_journal;
 } IniKey;
 
 typedef struct
 {
-	char *section_name;
+	INI_HASHED_ENTRY
 	GF_List *keys;
+	IniHash key_index;
 } IniSection;
 
+typedef struct
+{
+	char *sec_name;
+	char *key_name;
+} IniJournalEntry;
+
 struct __tag_config
 {
 	char *fileName;
 	GF_List *sections;
+	IniHash sec_index;
 	Bool hasChanged;
+
+	/*journaled save mode*/
+	Bool journaled;
+	/*set when the file on disk matches the in-memory config, except for pending journal entries*/
+	Bool file_synced;
+	/*set when the pending changes cannot be expressed as journal entries*/
+	Bool needs_rewrite;
+	GF_List *journal;
+	u32 nb_journal_lines, nb_live_keys;
 };
 
+static u32 ini_hash_name(const char *name)
+{
+	/*FNV-1a*/
+	u32 h = 2166136261U;
+	while (*name) {
+		h ^= (u8) *name;
+		h *= 16777619U;
+		name++;
+	}
+	return h;
+}
+
+static IniEntry *ini_hash_find(IniHash *hash, const char *name, u32 h)
+{
+	IniEntry *ent;
+	if (!hash->nb_buckets) return NULL;
+	ent = hash->buckets[h % hash->nb_buckets];
+	while (ent) {
+		if ((ent->hash == h) && !strcmp(ent->name, name)) return ent;
+		ent = ent->hnext;
+	}
+	return NULL;
+}
+
+static void ini_hash_add(IniHash *hash, IniEntry *ent)
+{
+	u32 idx;
+	if (hash->count >= 2*hash->nb_buckets) {
+		u32 i, nb_buckets = hash->nb_buckets ? 2*hash->nb_buckets : INI_HASH_MIN_BUCKETS;
+		IniEntry **buckets = (IniEntry **) gf_malloc(sizeof(IniEntry *) * nb_buckets);
+		memset(buckets, 0, sizeof(IniEntry *) * nb_buckets);
+		for (i=0; i<hash->nb_buckets; i++) {
+			IniEntry *cur = hash->buckets[i];
+			while (cur) {
+				IniEntry *next = cur->hnext;
+				idx = cur->hash % nb_buckets;
+				cur->hnext = buckets[idx];
+				buckets[idx] = cur;
+				cur = next;
+			}
+		}
+		if (hash->buckets) gf_free(hash->buckets);
+		hash->buckets = buckets;
+		hash->nb_buckets = nb_buckets;
+	}
+	idx = ent->hash % hash->nb_buckets;
+	ent->hnext = hash->buckets[idx];
+	hash->buckets[idx] = ent;
+	hash->count++;
+}
+
+static void ini_hash_remove(IniHash *hash, IniEntry *ent)
+{
+	IniEntry **prev;
+	if (!hash->nb_buckets) return;
+	prev = &hash->buckets[ent->hash % hash->nb_buckets];
+	while (*prev) {
+		if (*prev == ent) {
+			*prev = ent->hnext;
+			ent->hnext = NULL;
+			hash->count--;
+			return;
+		}
+		prev = &(*prev)->hnext;
+	}
+}
+
+static void ini_hash_reset(IniHash *hash)
+{
+	if (hash->buckets) gf_free(hash->buckets);
+	memset(hash, 0, sizeof(IniHash));
+}
+
+static IniSection *ini_find_section(GF_Config *iniFile, const char *secName)
+{
+	return (IniSection *) ini_hash_find(&iniFile->sec_index, secName, ini_hash_name(secName));
+}
+
+static IniKey *ini_find_key(IniSection *sec, const char *keyName)
+{
+	return (IniKey *) ini_hash_find(&sec->key_index, keyName, ini_hash_name(keyName));
+}
+
+static IniSection *ini_new_section(GF_Config *iniFile, const char *secName)
+{
+	IniSection *sec;
+	GF_SAFEALLOC(sec, IniSection);
+	sec->name = gf_strdup(secName);
+	sec->hash = ini_hash_name(sec->name);
+	sec->keys = gf_list_new();
+	gf_list_add(iniFile->sections, sec);
+	ini_hash_add(&iniFile->sec_index, (IniEntry *) sec);
+	return sec;
+}
+
+static IniKey *ini_new_key(GF_Config *iniFile, IniSection *sec, const char *keyName, const char *keyValue)
+{
+	IniKey *key;
+	GF_SAFEALLOC(key, IniKey);
+	key->name = gf_strdup(keyName);
+	key->hash = ini_hash_name(key->name);
+	key->value = gf_strdup(keyValue);
+	gf_list_add(sec->keys, key);
+	ini_hash_add(&sec->key_index, (IniEntry *) key);
+	iniFile->nb_live_keys++;
+	return key;
+}
+
+static void ini_del_key(GF_Config *iniFile, IniSection *sec, IniKey *key)
+{
+	ini_hash_remove(&sec->key_index, (IniEntry *) key);
+	gf_list_del_item(sec->keys, key);
+	if (key->name) gf_free(key->name);
+	if (key->value) gf_free(key->value);
+	gf_free(key);
+	iniFile->nb_live_keys--;
+}
+
+static void ini_journal_reset(GF_Config *iniFile)
+{
+	while (gf_list_count(iniFile->journal)) {
+		IniJournalEntry *ent = (IniJournalEntry *) gf_list_last(iniFile->journal);
+		gf_list_rem_last(iniFile->journal);
+		gf_free(ent->sec_name);
+		gf_free(ent->key_name);
+		gf_free(ent);
+	}
+}
+
+/*records a key change (key set to NULL when removed) for the next journaled save*/
+static void ini_journal_key(GF_Config *iniFile, IniSection *sec, IniKey *key, const char *keyName)
+{
+	IniJournalEntry *ent;
+	if (!iniFile->journaled || iniFile->needs_rewrite) return;
+	if (key) {
+		if (key->in_journal) return;
+		key->in_journal = 1;
+	}
+	GF_SAFEALLOC(ent, IniJournalEntry);
+	ent->sec_name = gf_strdup(sec->name);
+	ent->key_name = gf_strdup(keyName);
+	gf_list_add(iniFile->journal, ent);
+}
 
 static void DelSection(IniSection *ptr)
 {
@@ -62,7 +246,8 @@ static void DelSection(IniSection *ptr)
 		}
 		gf_list_del(ptr->keys);
 	}
-	if (ptr->section_name) gf_free(ptr->section_name);
+	ini_hash_reset(&ptr->key_index);
+	if (ptr->name) gf_free(ptr->name);
 	gf_free(ptr);
 }
 
@@ -81,6 +266,11 @@ static void gf_cfg_clear(GF_Config * iniFile){
 	  }
 	  gf_list_del(iniFile->sections);
 	}
+	ini_hash_reset(&iniFile->sec_index);
+	if (iniFile->journal) {
+		ini_journal_reset(iniFile);
+		gf_list_del(iniFile->journal);
+	}
 	if (iniFile->fileName)
 	  gf_free(iniFile->fileName);
 	memset((void *)iniFile, 0, sizeof(GF_Config));
@@ -98,8 +288,11 @@ GF_Err gf_cfg_parse_config_file(GF_Config * tmp, const char * filePath, const ch
 	char *line;
 	u32 line_alloc = MAX_INI_LINE;
 	char fileName[GF_MAX_PATH];
+	Bool journaled = tmp->journaled;
 
 	gf_cfg_clear(tmp);
+	tmp->journaled = journaled;
+	if (journaled) tmp->journal = gf_list_new();
 
 	if (filePath && ((filePath[strlen(filePath)-1] == '/') || (filePath[strlen(filePath)-1] == '\\')) ) {
 		strcpy(fileName, filePath);
@@ -143,47 +336,54 @@ GF_Err gf_cfg_parse_config_file(GF_Config * tmp, const char * filePath, const ch
 		if (line[0] == '#') continue;
 
 
-		/* new section */
+		/* new section - sections appearing several times (journaled files) are merged */
 		if (line[0] == '[') {
-			p = (IniSection *) gf_malloc(sizeof(IniSection));
-			p->keys = gf_list_new();
-			p->section_name = gf_strdup(line + 1);
-			p->section_name[strlen(line) - 2] = 0;
-			while (p->section_name[strlen(p->section_name) - 1] == ']' || p->section_name[strlen(p->section_name) - 1] == ' ') p->section_name[strlen(p->section_name) - 1] = 0;
-			gf_list_add(tmp->sections, p);
+			char *secName = gf_strdup(line + 1);
+			secName[strlen(line) - 2] = 0;
+			while (secName[strlen(secName) - 1] == ']' || secName[strlen(secName) - 1] == ' ') secName[strlen(secName) - 1] = 0;
+			p = ini_find_section(tmp, secName);
+			if (!p) p = ini_new_section(tmp, secName);
+			gf_free(secName);
+		}
+		/* journaled key removal */
+		else if (line[0] == '!') {
+			if (p) {
+				k = ini_find_key(p, line+1);
+				if (k) ini_del_key(tmp, p, k);
+			}
+			tmp->nb_journal_lines++;
 		}
 		else if (strlen(line) && (strchr(line, '=') != NULL) ) {
+			char *name, *value;
 			if (!p) {
-				gf_list_del(tmp->sections);
-				gf_free(tmp->fileName);
-				gf_free(tmp);
 				fclose(file);
 				gf_free(line);
 				return GF_IO_ERR;
 			}
 
-			k = (IniKey *) gf_malloc(sizeof(IniKey));
-			memset((void *)k, 0, sizeof(IniKey));
 			ret = strchr(line, '=');
-			if (ret) {
-				ret[0] = 0;
-				k->name = gf_strdup(line);
-				while (k->name[strlen(k->name) - 1] == ' ') k->name[strlen(k->name) - 1] = 0;
-				ret[0] = '=';
-				ret += 1;
-				while (ret[0] == ' ') ret++;
-				if ( ret[0] != 0) {
-					k->value = gf_strdup(ret);
-					while (k->value[strlen(k->value) - 1] == ' ') k->value[strlen(k->value) - 1] = 0;
-				} else {
-					k->value = gf_strdup("");
-				}
+			ret[0] = 0;
+			name = line;
+			while (strlen(name) && (name[strlen(name) - 1] == ' ')) name[strlen(name) - 1] = 0;
+			ret += 1;
+			while (ret[0] == ' ') ret++;
+			value = ret;
+			while (strlen(value) && (value[strlen(value) - 1] == ' ')) value[strlen(value) - 1] = 0;
+
+			/* keys appearing several times (journaled files) keep the last value */
+			k = ini_find_key(p, name);
+			if (k) {
+				gf_free(k->value);
+				k->value = gf_strdup(value);
+				tmp->nb_journal_lines++;
+			} else {
+				ini_new_key(tmp, p, name, value);
 			}
-			gf_list_add(p->keys, k);
 		}
 	}
 	gf_free(line);
 	fclose(file);
+	tmp->file_synced = 1;
 	return GF_OK;
 }
 
@@ -222,6 +422,37 @@ char * gf_cfg_get_filename(GF_Config *iniFile)
     return iniFile->fileName ? gf_strdup(iniFile->fileName) : NULL;
 }
 
+static GF_Err ini_save_journal(GF_Config *iniFile)
+{
+	u32 i;
+	const char *cur_sec = NULL;
+	IniJournalEntry *ent;
+	FILE *file = gf_f64_open(iniFile->fileName, "at");
+	if (!file) return GF_IO_ERR;
+
+	i=0;
+	while ( (ent = (IniJournalEntry *) gf_list_enum(iniFile->journal, &i)) ) {
+		IniKey *key = NULL;
+		IniSection *sec = ini_find_section(iniFile, ent->sec_name);
+		if (sec) key = ini_find_key(sec, ent->key_name);
+
+		if (!cur_sec || strcmp(cur_sec, ent->sec_name)) {
+			fprintf(file, "[%s]\n", ent->sec_name);
+			cur_sec = ent->sec_name;
+		}
+		if (key) {
+			fprintf(file, "%s=%s\n", key->name, key->value);
+			key->in_journal = 0;
+		} else {
+			fprintf(file, "!%s\n", ent->key_name);
+		}
+		iniFile->nb_journal_lines++;
+	}
+	fclose(file);
+	ini_journal_reset(iniFile);
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_cfg_save(GF_Config *iniFile)
 {
@@ -233,26 +464,55 @@ GF_Err gf_cfg_save(GF_Config *iniFile)
 	if (!iniFile->hasChanged) return GF_OK;
 	if (!iniFile->fileName) return GF_OK;
 
+	if (iniFile->journaled && iniFile->file_synced && !iniFile->needs_rewrite
+		&& (iniFile->nb_journal_lines + gf_list_count(iniFile->journal) <= 2*iniFile->nb_live_keys + INI_JOURNAL_MARGIN)
+	) {
+		GF_Err e = ini_save_journal(iniFile);
+		if (!e) iniFile->hasChanged = 0;
+		return e;
+	}
+
 	file = gf_f64_open(iniFile->fileName, "wt");
 	if (!file) return GF_IO_ERR;
 
 	i=0;
 	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
 		/*Temporary sections are not saved*/
-		if (!strnicmp(sec->section_name, "Temp", 4)) continue;
+		if (!strnicmp(sec->name, "Temp", 4)) continue;
 
-		fprintf(file, "[%s]\n", sec->section_name);
+		fprintf(file, "[%s]\n", sec->name);
 		j=0;
 		while ( (key = (IniKey *) gf_list_enum(sec->keys, &j)) ) {
 			fprintf(file, "%s=%s\n", key->name, key->value);
+			key->in_journal = 0;
 		}
 		/* end of section */
 		fprintf(file, "\n");
 	}
 	fclose(file);
+
+	if (iniFile->journal) ini_journal_reset(iniFile);
+	iniFile->nb_journal_lines = 0;
+	iniFile->needs_rewrite = 0;
+	iniFile->file_synced = 1;
+	iniFile->hasChanged = 0;
 	return GF_OK;
 }
 
+GF_EXPORT
+void gf_cfg_set_journaled(GF_Config *iniFile, Bool journaled)
+{
+	if (!iniFile) return;
+	iniFile->journaled = journaled;
+	if (journaled) {
+		if (!iniFile->journal) iniFile->journal = gf_list_new();
+		/*changes made before switching to journaled mode are not tracked*/
+		if (iniFile->hasChanged) iniFile->needs_rewrite = 1;
+	} else if (iniFile->journal) {
+		ini_journal_reset(iniFile);
+	}
+}
+
 GF_EXPORT
 void gf_cfg_del(GF_Config *iniFile)
 {
@@ -274,22 +534,11 @@ void gf_cfg_remove(GF_Config *iniFile)
 GF_EXPORT
 const char *gf_cfg_get_key(GF_Config *iniFile, const char *secName, const char *keyName)
 {
-	u32 i;
-	IniSection *sec;
 	IniKey *key;
-
-	i=0;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!strcmp(secName, sec->section_name)) goto get_key;
-	}
-	return NULL;
-
-get_key:
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i)) ) {
-		if (!strcmp(key->name, keyName)) return key->value;
-	}
-	return NULL;
+	IniSection *sec = ini_find_section(iniFile, secName);
+	if (!sec) return NULL;
+	key = ini_find_key(sec, keyName);
+	return key ? key->value : NULL;
 }
 
 GF_EXPORT
@@ -301,7 +550,7 @@ const char *gf_cfg_get_ikey(GF_Config *iniFile, const char *secName, const char
 
         i=0;
         while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-                if (!stricmp(secName, sec->section_name)) goto get_key;
+                if (!stricmp(secName, sec->name)) goto get_key;
         }
         return NULL;
 
@@ -317,8 +566,8 @@ get_key:
 GF_EXPORT
 GF_Err gf_cfg_set_key(GF_Config *iniFile, const char *secName, const char *keyName, const char *keyValue)
 {
-	u32 i;
 	Bool has_changed = 1;
+	Bool new_key = 0;
 	IniSection *sec;
 	IniKey *key;
 
@@ -326,45 +575,42 @@ GF_Err gf_cfg_set_key(GF_Config *iniFile, const char *secName, const char *keyNa
 
 	if (!strnicmp(secName, "temp", 4)) has_changed = 0;
 
-	i=0;
-	while ((sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!strcmp(secName, sec->section_name)) goto get_key;
+	sec = ini_find_section(iniFile, secName);
+	if (!sec) {
+		/* need a new section */
+		sec = ini_new_section(iniFile, secName);
+		if (has_changed) iniFile->hasChanged = 1;
 	}
-	/* need a new key */
-	sec = (IniSection *) gf_malloc(sizeof(IniSection));
-	sec->section_name = gf_strdup(secName);
-	sec->keys = gf_list_new();
-	if (has_changed) iniFile->hasChanged = 1;
-	gf_list_add(iniFile->sections, sec);
 
-get_key:
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i) ) ) {
-		if (!strcmp(key->name, keyName)) goto set_value;
+	key = ini_find_key(sec, keyName);
+	if (!key) {
+		if (!keyValue) return GF_OK;
+		/* need a new key */
+		key = ini_new_key(iniFile, sec, keyName, "");
+		if (has_changed) iniFile->hasChanged = 1;
+		new_key = 1;
 	}
-	if (!keyValue) return GF_OK;
-	/* need a new key */
-	key = (IniKey *) gf_malloc(sizeof(IniKey));
-	key->name = gf_strdup(keyName);
-	key->value = gf_strdup("");
-	if (has_changed) iniFile->hasChanged = 1;
-	gf_list_add(sec->keys, key);
 
-set_value:
 	if (!keyValue) {
-		gf_list_del_item(sec->keys, key);
-		if (key->name) gf_free(key->name);
-		if (key->value) gf_free(key->value);
-		gf_free(key);
-		if (has_changed) iniFile->hasChanged = 1;
+		ini_del_key(iniFile, sec, key);
+		if (has_changed) {
+			iniFile->hasChanged = 1;
+			ini_journal_key(iniFile, sec, NULL, keyName);
+		}
 		return GF_OK;
 	}
 	/* same value, don't update */
-	if (!strcmp(key->value, keyValue)) return GF_OK;
+	if (!strcmp(key->value, keyValue)) {
+		if (new_key && has_changed) ini_journal_key(iniFile, sec, key, keyName);
+		return GF_OK;
+	}
 
 	if (key->value) gf_free(key->value);
 	key->value = gf_strdup(keyValue);
-	if (has_changed) iniFile->hasChanged = 1;
+	if (has_changed) {
+		iniFile->hasChanged = 1;
+		ini_journal_key(iniFile, sec, key, keyName);
+	}
 	return GF_OK;
 }
 
@@ -379,76 +625,60 @@ const char *gf_cfg_get_section_name(GF_Config *iniFile, u32 secIndex)
 {
 	IniSection *is = (IniSection *) gf_list_get(iniFile->sections, secIndex);
 	if (!is) return NULL;
-	return is->section_name;
+	return is->name;
 }
 
 GF_EXPORT
 u32 gf_cfg_get_key_count(GF_Config *iniFile, const char *secName)
 {
-	u32 i = 0;
-	IniSection *sec;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!strcmp(secName, sec->section_name)) return gf_list_count(sec->keys);
-	}
-	return 0;
+	IniSection *sec = ini_find_section(iniFile, secName);
+	return sec ? gf_list_count(sec->keys) : 0;
 }
 
 GF_EXPORT
 const char *gf_cfg_get_key_name(GF_Config *iniFile, const char *secName, u32 keyIndex)
 {
-	u32 i = 0;
-	IniSection *sec;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i) ) ) {
-		if (!strcmp(secName, sec->section_name)) {
-			IniKey *key = (IniKey *) gf_list_get(sec->keys, keyIndex);
-			return key ? key->name : NULL;
-		}
-	}
-	return NULL;
+	IniKey *key;
+	IniSection *sec = ini_find_section(iniFile, secName);
+	if (!sec) return NULL;
+	key = (IniKey *) gf_list_get(sec->keys, keyIndex);
+	return key ? key->name : NULL;
 }
 
 GF_EXPORT
 void gf_cfg_del_section(GF_Config *iniFile, const char *secName)
 {
-	u32 i;
 	IniSection *p;
 	if (!iniFile) return;
 
-	i = 0;
-	while ((p = gf_list_enum(iniFile->sections, &i))) {
-		if (!strcmp(secName, p->section_name)) {
-			DelSection(p);
-			gf_list_rem(iniFile->sections, i-1);
-			return;
-		}
-	}
+	p = ini_find_section(iniFile, secName);
+	if (!p) return;
+	ini_hash_remove(&iniFile->sec_index, (IniEntry *) p);
+	gf_list_del_item(iniFile->sections, p);
+	iniFile->nb_live_keys -= gf_list_count(p->keys);
+	DelSection(p);
+	/*section removal is not journaled*/
+	iniFile->needs_rewrite = 1;
 }
 
 GF_EXPORT
 GF_Err gf_cfg_insert_key(GF_Config *iniFile, const char *secName, const char *keyName, const char *keyValue, u32 index)
 {
-	u32 i;
 	IniSection *sec;
 	IniKey *key;
 
 	if (!iniFile || !secName || !keyName|| !keyValue) return GF_BAD_PARAM;
 
-	i=0;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i) ) ) {
-		if (!strcmp(secName, sec->section_name)) break;
-	}
+	sec = ini_find_section(iniFile, secName);
 	if (!sec) return GF_BAD_PARAM;
+	if (ini_find_key(sec, keyName)) return GF_BAD_PARAM;
 
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i) ) ) {
-		if (!strcmp(key->name, keyName)) return GF_BAD_PARAM;
-	}
-
-	key = (IniKey *) gf_malloc(sizeof(IniKey));
-	key->name = gf_strdup(keyName);
-	key->value = gf_strdup(keyValue);
+	key = ini_new_key(iniFile, sec, keyName, keyValue);
+	gf_list_del_item(sec->keys, key);
 	gf_list_insert(sec->keys, key, index);
 	iniFile->hasChanged = 1;
+	/*key order is not journaled*/
+	iniFile->needs_rewrite = 1;
 	return GF_OK;
 }
 
@@ -486,5 +716,6 @@ GF_Err gf_cfg_set_filename(GF_Config *iniFile, const char * fileName)
 	if (!fileName) return GF_OK;
 	if (iniFile->fileName) gf_free(iniFile->fileName);
 	iniFile->fileName = gf_strdup(fileName);
+	iniFile->file_synced = 0;
 	return iniFile->fileName ? GF_OK : GF_OUT_OF_MEM;
 }
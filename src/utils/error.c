@@ -24,6 +24,7 @@
  */
 
 #include "../../include/gpac/tools.h"
+#include "../../include/gpac/thread.h"
 
 
 static char szTYPE[5];
@@ -335,15 +336,219 @@ static void *user_log_cbk = NULL;
 static gf_log_cbk log_cbk = default_log_callback;
 static Bool log_exit_on_error = 0;
 
+#if !defined(WIN32) && !defined(_WIN32_WCE)
+#define _vsnprintf vsnprintf
+#endif
+
+/*asynchronous logging: messages are formatted by the calling thread in a bounded multi-producer single-consumer ring
+and passed to the log callback by a dedicated thread*/
+
+/*must be a power of 2*/
+#define GF_LOG_ASYNC_SLOTS	4096
+#define GF_LOG_ASYNC_MSG_SIZE	512
+
+typedef struct
+{
+	/*equals the write position of the slot when free, write position + 1 when the record is ready*/
+	volatile u32 seq;
+	u32 level, tool;
+	u32 time, thread_id;
+	char msg[GF_LOG_ASYNC_MSG_SIZE];
+} GF_LogRecord;
+
+static GF_LogRecord *log_ring = NULL;
+static volatile u32 log_ring_head = 0;
+static u32 log_ring_tail = 0;
+static volatile u32 log_nb_dropped = 0;
+/*async mode state, only changed through compare-and-swap*/
+enum
+{
+	GF_LOG_ASYNC_OFF = 0,
+	GF_LOG_ASYNC_ON,
+	/*ring is being set up or torn down*/
+	GF_LOG_ASYNC_BUSY
+};
+static volatile u32 log_async = GF_LOG_ASYNC_OFF;
+/*number of threads currently writing to the ring*/
+static volatile u32 log_nb_pushers = 0;
+/*set by the first thread exiting on a strict error*/
+static volatile u32 log_exiting = 0;
+static volatile Bool log_th_run = 0;
+static GF_Thread *log_th = NULL;
+/*signaled once per published record and on teardown*/
+static GF_Semaphore *log_sema = NULL;
+static u32 log_th_id = 0;
+/*time and thread of the record being dispatched by the log thread*/
+static u32 log_rec_time = 0;
+static u32 log_rec_thread_id = 0;
+
+static void gf_log_async_push(u32 level, u32 tool, const char *fmt, va_list vl)
+{
+	GF_LogRecord *rec;
+	u32 pos = gf_atomic_get(&log_ring_head);
+	while (1) {
+		s32 diff;
+		rec = &log_ring[pos & (GF_LOG_ASYNC_SLOTS-1)];
+		diff = (s32) (gf_atomic_get(&rec->seq) - pos);
+		if (!diff) {
+			/*slot is free, try to claim it*/
+			if (gf_atomic_cas(&log_ring_head, pos, pos+1)) break;
+		} else if (diff < 0) {
+			/*ring is full*/
+			gf_atomic_inc(&log_nb_dropped);
+			return;
+		}
+		pos = gf_atomic_get(&log_ring_head);
+	}
+	rec->level = level;
+	rec->tool = tool;
+	rec->time = gf_sys_clock();
+	rec->thread_id = gf_th_id();
+	_vsnprintf(rec->msg, GF_LOG_ASYNC_MSG_SIZE, fmt, vl);
+	rec->msg[GF_LOG_ASYNC_MSG_SIZE-1] = 0;
+	/*publish and wake up the log thread*/
+	gf_atomic_inc(&rec->seq);
+	gf_sema_notify(log_sema, 1);
+}
+
+static void gf_log_async_dispatch(u32 level, u32 tool, const char *fmt, ...)
+{
+	va_list vl;
+	va_start(vl, fmt);
+	log_cbk(user_log_cbk, level, tool, fmt, vl);
+	va_end(vl);
+}
+
+static u32 gf_log_async_proc(void *par)
+{
+	u32 nb_dropped, nb_reported = 0;
+	log_th_id = gf_th_id();
+	while (1) {
+		GF_LogRecord *rec = &log_ring[log_ring_tail & (GF_LOG_ASYNC_SLOTS-1)];
+		if (gf_atomic_get(&rec->seq) != log_ring_tail + 1) {
+			/*nothing pending, exit once asked to - a claimed slot may not be published yet*/
+			if (!log_th_run && (log_ring_tail == gf_atomic_get(&log_ring_head))) break;
+			gf_sema_wait(log_sema);
+			continue;
+		}
+		nb_dropped = gf_atomic_get(&log_nb_dropped);
+		if (nb_dropped != nb_reported) {
+			log_rec_time = rec->time;
+			log_rec_thread_id = log_th_id;
+			gf_log_async_dispatch(GF_LOG_WARNING, GF_LOG_CORE, "[core] %d log messages dropped\n", nb_dropped - nb_reported);
+			nb_reported = nb_dropped;
+		}
+		log_rec_time = rec->time;
+		log_rec_thread_id = rec->thread_id;
+		gf_log_async_dispatch(rec->level, rec->tool, "%s", rec->msg);
+		/*release the slot for the next round*/
+		gf_atomic_add(&rec->seq, GF_LOG_ASYNC_SLOTS-1);
+		log_ring_tail++;
+		/*consume the signal of this record if not done yet, so that the count stays bounded by the ring size*/
+		gf_sema_wait_for(log_sema, 0);
+	}
+	return 0;
+}
+
+GF_EXPORT
+GF_Err gf_log_set_async(Bool enable)
+{
+	u32 i;
+	if (enable) {
+		if (!gf_atomic_cas(&log_async, GF_LOG_ASYNC_OFF, GF_LOG_ASYNC_BUSY)) return GF_OK;
+		log_ring = (GF_LogRecord *) gf_malloc(sizeof(GF_LogRecord)*GF_LOG_ASYNC_SLOTS);
+		if (!log_ring) {
+			gf_atomic_cas(&log_async, GF_LOG_ASYNC_BUSY, GF_LOG_ASYNC_OFF);
+			return GF_OUT_OF_MEM;
+		}
+		/*one signal per ring slot plus the teardown one*/
+		log_sema = gf_sema_new(GF_LOG_ASYNC_SLOTS+1, 0);
+		if (!log_sema) {
+			gf_free(log_ring);
+			log_ring = NULL;
+			gf_atomic_cas(&log_async, GF_LOG_ASYNC_BUSY, GF_LOG_ASYNC_OFF);
+			return GF_IO_ERR;
+		}
+		for (i=0; i<GF_LOG_ASYNC_SLOTS; i++) log_ring[i].seq = i;
+		log_ring_head = log_ring_tail = 0;
+		log_nb_dropped = 0;
+		log_th_run = 1;
+		log_th = gf_th_new("Logger");
+		if (gf_th_run(log_th, gf_log_async_proc, NULL) != GF_OK) {
+			gf_th_del(log_th);
+			log_th = NULL;
+			gf_sema_del(log_sema);
+			log_sema = NULL;
+			gf_free(log_ring);
+			log_ring = NULL;
+			gf_atomic_cas(&log_async, GF_LOG_ASYNC_BUSY, GF_LOG_ASYNC_OFF);
+			return GF_IO_ERR;
+		}
+		gf_atomic_cas(&log_async, GF_LOG_ASYNC_BUSY, GF_LOG_ASYNC_ON);
+	} else {
+		/*only one thread tears down the ring*/
+		if (!gf_atomic_cas(&log_async, GF_LOG_ASYNC_ON, GF_LOG_ASYNC_BUSY)) return GF_OK;
+		/*new messages go to the callback directly, wait for the threads already writing to the ring*/
+		while (gf_atomic_get(&log_nb_pushers)) gf_sleep(0);
+		/*the log thread flushes pending records before exiting*/
+		log_th_run = 0;
+		gf_sema_notify(log_sema, 1);
+		gf_th_del(log_th);
+		log_th = NULL;
+		gf_sema_del(log_sema);
+		log_sema = NULL;
+		gf_free(log_ring);
+		log_ring = NULL;
+		gf_atomic_cas(&log_async, GF_LOG_ASYNC_BUSY, GF_LOG_ASYNC_OFF);
+	}
+	return GF_OK;
+}
+
+GF_EXPORT
+u32 gf_log_get_async_dropped()
+{
+	return log_nb_dropped;
+}
+
+GF_EXPORT
+void gf_log_get_record_info(u32 *time_ms, u32 *thread_id)
+{
+	if (log_async && (gf_th_id() == log_th_id)) {
+		if (time_ms) *time_ms = log_rec_time;
+		if (thread_id) *thread_id = log_rec_thread_id;
+	} else {
+		if (time_ms) *time_ms = gf_sys_clock();
+		if (thread_id) *thread_id = gf_th_id();
+	}
+}
+
 GF_EXPORT
 void gf_log(const char *fmt, ...)
 {
 	va_list vl;
+	Bool pushed = 0;
 	va_start(vl, fmt);
-	log_cbk(user_log_cbk, call_lev, call_tool, fmt, vl);
+	if (log_async == GF_LOG_ASYNC_ON) {
+		gf_atomic_inc(&log_nb_pushers);
+		/*check again, the ring is not released while we are registered*/
+		if (gf_atomic_get(&log_async) == GF_LOG_ASYNC_ON) {
+			gf_log_async_push(call_lev, call_tool, fmt, vl);
+			pushed = 1;
+		}
+		gf_atomic_dec(&log_nb_pushers);
+	}
+	if (!pushed) {
+		log_cbk(user_log_cbk, call_lev, call_tool, fmt, vl);
+	}
 	va_end(vl);
-	if (log_exit_on_error && call_lev==GF_LOG_ERROR)
+	if (log_exit_on_error && call_lev==GF_LOG_ERROR) {
+		/*flush pending messages once, other threads logging errors meanwhile wait for the exit*/
+		if (!gf_atomic_cas(&log_exiting, 0, 1)) {
+			while (1) gf_sleep(1000);
+		}
+		gf_log_set_async(0);
 		exit(1);
+	}
 }
 
 GF_EXPORT
@@ -388,6 +593,22 @@ void gf_log(const char *fmt, ...)
 {
 }
 GF_EXPORT
+GF_Err gf_log_set_async(Bool enable)
+{
+	return GF_NOT_SUPPORTED;
+}
+GF_EXPORT
+u32 gf_log_get_async_dropped()
+{
+	return 0;
+}
+GF_EXPORT
+void gf_log_get_record_info(u32 *time_ms, u32 *thread_id)
+{
+	if (time_ms) *time_ms = gf_sys_clock();
+	if (thread_id) *thread_id = gf_th_id();
+}
+GF_EXPORT
 void gf_log_lt(u32 ll, u32 lt)
 {
 }
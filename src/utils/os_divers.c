@@ -24,6 +24,7 @@
  */
 
 #include "../../include/gpac/tools.h"
+#include "../../include/gpac/thread.h"
 
 #if defined(_WIN32_WCE)
 
@@ -67,6 +68,7 @@
 #define SLEEP_ABS_SELECT		1
 
 static u32 sys_start_time = 0;
+static u64 sys_start_time_hr = 0;
 #endif
 
 
@@ -84,6 +86,22 @@ u32 gf_sys_clock()
 	gettimeofday(&now, NULL);
 	return ( (now.tv_sec)*1000 + (now.tv_usec) / 1000) - sys_start_time;
 }
+
+GF_EXPORT
+u64 gf_sys_clock_high_res()
+{
+#if defined(CLOCK_MONOTONIC)
+	/*not affected by system time changes*/
+	struct timespec now;
+	if (!clock_gettime(CLOCK_MONOTONIC, &now))
+		return ((u64) now.tv_sec)*1000000 + now.tv_nsec/1000 - sys_start_time_hr;
+#endif
+	{
+		struct timeval now_tv;
+		gettimeofday(&now_tv, NULL);
+		return ((u64) now_tv.tv_sec)*1000000 + now_tv.tv_usec - sys_start_time_hr;
+	}
+}
 #endif
 
 
@@ -1087,6 +1105,17 @@ static u32 OS_GetSysClockNORMAL()
 #endif
 }
 
+GF_EXPORT
+u64 gf_sys_clock_high_res()
+{
+	LARGE_INTEGER now;
+	if (!frequency.QuadPart) return ((u64) OS_GetSysClockNORMAL()) * 1000;
+	QueryPerformanceCounter(&now);
+	now.QuadPart -= init_counter.QuadPart;
+	/*split to avoid overflowing the counter*/
+	return (u64) ((now.QuadPart / frequency.QuadPart) * 1000000 + ((now.QuadPart % frequency.QuadPart) * 1000000) / frequency.QuadPart);
+}
+
 #endif /* WIN32 */
 
 #if defined(__sh__)
@@ -1217,6 +1246,7 @@ void gf_sys_init(Bool enable_memory_tracker)
 		memset(&the_rti, 0, sizeof(GF_SystemRTInfo));
 		the_rti.pid = getpid();
 		sys_start_time = gf_sys_clock();
+		sys_start_time_hr = gf_sys_clock_high_res();
 #endif
 		GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[core] process id %d\n", the_rti.pid));
 
@@ -1235,6 +1265,8 @@ void gf_sys_init(Bool enable_memory_tracker)
 	}
 }
 
+static void gf_trace_reset();
+
 GF_EXPORT
 void gf_sys_close()
 {
@@ -1254,6 +1286,11 @@ void gf_sys_close()
 		psapi_hinst = NULL;
 #endif
 
+		/*flush pending log messages*/
+		gf_log_set_async(0);
+
+		gf_trace_reset();
+
 #ifdef GPAC_MEMORY_TRACKING
 		gf_memory_print();
 #endif
@@ -1263,6 +1300,8 @@ void gf_sys_close()
 #ifdef GPAC_MEMORY_TRACKING
 extern size_t gpac_allocated_memory;
 extern size_t gpac_nb_alloc_blocs;
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+u64 gf_mem_acc_get_live_memory();
 #endif
 
 /*CPU and Memory Usage*/
@@ -1301,6 +1340,8 @@ Bool gf_sys_get_rti_os(u32 refresh_time_ms, GF_SystemRTInfo *rti, u32 flags)
 		rti->physical_memory_avail = ms.dwAvailPhys;
 #ifdef GPAC_MEMORY_TRACKING
 		rti->gpac_memory = (u64) gpac_allocated_memory;
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+		rti->gpac_memory = gf_mem_acc_get_live_memory();
 #endif
 		return 1;
 	}
@@ -1496,6 +1537,8 @@ Bool gf_sys_get_rti_os(u32 refresh_time_ms, GF_SystemRTInfo *rti, u32 flags)
 	the_rti.physical_memory = ms.dwTotalPhys;
 #ifdef GPAC_MEMORY_TRACKING
 	the_rti.gpac_memory = (u64) gpac_allocated_memory;
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+	the_rti.gpac_memory = gf_mem_acc_get_live_memory();
 #endif
 	the_rti.physical_memory_avail = ms.dwAvailPhys;
 
@@ -1646,6 +1689,8 @@ Bool gf_sys_get_rti_os(u32 refresh_time_ms, GF_SystemRTInfo *rti, u32 flags)
 
 #ifdef GPAC_MEMORY_TRACKING
 	the_rti.gpac_memory = gpac_allocated_memory;
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+	the_rti.gpac_memory = gf_mem_acc_get_live_memory();
 #endif
 
 	last_process_k_u_time = process_u_k_time;
@@ -1806,6 +1851,8 @@ Bool gf_sys_get_rti_os(u32 refresh_time_ms, GF_SystemRTInfo *rti, u32 flags)
   the_rti.process_memory = mem_at_startup - the_rti.physical_memory_avail;
 #ifdef GPAC_MEMORY_TRACKING
   the_rti.gpac_memory = gpac_allocated_memory;
+#elif defined(GPAC_MEMORY_ACCOUNTING)
+  the_rti.gpac_memory = gf_mem_acc_get_live_memory();
 #endif
 
   last_process_k_u_time = process_u_k_time;
@@ -1825,6 +1872,7 @@ Bool gf_sys_get_rti(u32 refresh_time_ms, GF_SystemRTInfo *rti, u32 flags)
 	if (res) {
 		if (!rti->process_memory) rti->process_memory = memory_at_gpac_startup - rti->physical_memory_avail;
 		if (!rti->gpac_memory) rti->gpac_memory = memory_at_gpac_startup - rti->physical_memory_avail;
+		gf_mx_get_global_stats(&rti->lock_contentions, &rti->lock_wait_time);
 	}
 	return res;
 }
@@ -2052,6 +2100,210 @@ GF_Err gf_global_resource_unlock(GF_GlobalLock * lock){
 	return GF_OK;
 }
 
+
+/*number of events kept per thread, must be a power of 2*/
+#define GF_TRACE_RING_SIZE	(1<<15)
+#define GF_TRACE_MAX_THREADS	64
+
+typedef struct
+{
+	u64 ts;
+	const char *cat, *name;
+	/*'B' or 'E'*/
+	u32 phase;
+} GF_TraceEvent;
+
+typedef struct
+{
+	u32 thread_id;
+	/*total number of events written - only modified by the owning thread, incremented atomically once the event is written*/
+	volatile u32 nb_events;
+	/*set by the owning thread while it writes an event*/
+	volatile u32 writing;
+	GF_TraceEvent events[GF_TRACE_RING_SIZE];
+} GF_TraceRing;
+
+static Bool trace_on = 0;
+static GF_Mutex *trace_mx = NULL;
+static GF_TraceRing *trace_rings[GF_TRACE_MAX_THREADS];
+static u32 nb_trace_rings = 0;
+/*incremented each time the rings are destroyed, invalidating the per-thread ring pointers*/
+static u32 trace_generation = 1;
+
+#if defined(__GNUC__)
+#define GF_TRACE_TLS	__thread
+#elif defined(WIN32) && !defined(_WIN32_WCE)
+#define GF_TRACE_TLS	__declspec(thread)
+#endif
+
+#ifdef GF_TRACE_TLS
+static GF_TRACE_TLS GF_TraceRing *trace_thread_ring = NULL;
+static GF_TRACE_TLS u32 trace_thread_generation = 0;
+#endif
+
+static GF_TraceRing *gf_trace_get_ring()
+{
+	GF_TraceRing *ring = NULL;
+	u32 i, th_id;
+#ifdef GF_TRACE_TLS
+	if (trace_thread_ring && (trace_thread_generation == trace_generation)) return trace_thread_ring;
+#endif
+	th_id = gf_th_id();
+#ifndef GF_TRACE_TLS
+	/*no thread-local storage, look up the ring of this thread*/
+	for (i=0; i<nb_trace_rings; i++) {
+		if (trace_rings[i]->thread_id == th_id) return trace_rings[i];
+	}
+#endif
+	/*first event for this thread, register a new ring*/
+	gf_mx_p(trace_mx);
+	for (i=0; i<nb_trace_rings; i++) {
+		if (trace_rings[i]->thread_id == th_id) {
+			ring = trace_rings[i];
+			break;
+		}
+	}
+	if (!ring && (nb_trace_rings < GF_TRACE_MAX_THREADS)) {
+		GF_SAFEALLOC(ring, GF_TraceRing);
+		if (ring) {
+			ring->thread_id = th_id;
+			trace_rings[nb_trace_rings] = ring;
+			nb_trace_rings++;
+		}
+	}
+	gf_mx_v(trace_mx);
+#ifdef GF_TRACE_TLS
+	trace_thread_ring = ring;
+	trace_thread_generation = trace_generation;
+#endif
+	return ring;
+}
+
+/*waits for the events being written when recording was stopped*/
+static void gf_trace_wait_writers()
+{
+	u32 i;
+	for (i=0; i<nb_trace_rings; i++) {
+		while (gf_atomic_get(&trace_rings[i]->writing)) gf_sleep(0);
+	}
+}
+
+/*rings are released, so no other thread shall be recording events anymore*/
+static void gf_trace_reset()
+{
+	u32 i;
+	trace_on = 0;
+	if (!trace_mx) return;
+	gf_mx_p(trace_mx);
+	gf_trace_wait_writers();
+	for (i=0; i<nb_trace_rings; i++) {
+		gf_free(trace_rings[i]);
+		trace_rings[i] = NULL;
+	}
+	nb_trace_rings = 0;
+	trace_generation++;
+	gf_mx_v(trace_mx);
+	gf_mx_del(trace_mx);
+	trace_mx = NULL;
+}
+
+static void gf_trace_event(const char *cat, const char *name, u32 phase)
+{
+	GF_TraceEvent *evt;
+	GF_TraceRing *ring = gf_trace_get_ring();
+	if (!ring) return;
+	/*check the recorder state once flagged as writing, so that stopping it waits for this event*/
+	gf_atomic_inc(&ring->writing);
+	if (trace_on) {
+		evt = &ring->events[ring->nb_events & (GF_TRACE_RING_SIZE-1)];
+		evt->ts = gf_sys_clock_high_res();
+		evt->cat = cat;
+		evt->name = name;
+		evt->phase = phase;
+		gf_atomic_inc(&ring->nb_events);
+	}
+	gf_atomic_dec(&ring->writing);
+}
+
+GF_EXPORT
+void gf_trace_enable(Bool enable)
+{
+	if (enable && !trace_mx) trace_mx = gf_mx_new("TraceRecorder");
+	trace_on = enable;
+	if (!enable && trace_mx) {
+		gf_mx_p(trace_mx);
+		gf_trace_wait_writers();
+		gf_mx_v(trace_mx);
+	}
+}
+
+GF_EXPORT
+Bool gf_trace_enabled()
+{
+	return trace_on;
+}
+
+GF_EXPORT
+void gf_trace_begin(const char *cat, const char *name)
+{
+	if (trace_on) gf_trace_event(cat, name, 'B');
+}
+
+GF_EXPORT
+void gf_trace_end(const char *cat, const char *name)
+{
+	if (trace_on) gf_trace_event(cat, name, 'E');
+}
+
+GF_EXPORT
+GF_Err gf_trace_dump(const char *filename)
+{
+	u32 i, j, nb_rings, first;
+	GF_TraceEvent *events;
+	FILE *out;
+
+	/*events of a ring are copied before being written, the ring may be written meanwhile*/
+	events = (GF_TraceEvent *) gf_malloc(sizeof(GF_TraceEvent) * GF_TRACE_RING_SIZE);
+	if (!events) return GF_OUT_OF_MEM;
+	out = gf_f64_open(filename, "wt");
+	if (!out) {
+		gf_free(events);
+		return GF_IO_ERR;
+	}
+
+	fprintf(out, "{\"traceEvents\":[\n");
+	first = 1;
+	if (trace_mx) gf_mx_p(trace_mx);
+	nb_rings = nb_trace_rings;
+	if (trace_mx) gf_mx_v(trace_mx);
+	for (i=0; i<nb_rings; i++) {
+		GF_TraceRing *ring = trace_rings[i];
+		u32 nb_events, nb_written, in_progress, start;
+		/*snapshot the write index, events below it are complete*/
+		nb_events = gf_atomic_get(&ring->nb_events);
+		start = (nb_events > GF_TRACE_RING_SIZE) ? nb_events - GF_TRACE_RING_SIZE : 0;
+		for (j=start; j<nb_events; j++) {
+			events[j & (GF_TRACE_RING_SIZE-1)] = ring->events[j & (GF_TRACE_RING_SIZE-1)];
+		}
+		/*drop the events overwritten during the copy, including the one being written if any*/
+		in_progress = gf_atomic_get(&ring->writing) ? 1 : 0;
+		nb_written = gf_atomic_get(&ring->nb_events);
+		if (nb_written + in_progress > start + GF_TRACE_RING_SIZE) start = nb_written + in_progress - GF_TRACE_RING_SIZE;
+		for (j=start; j<nb_events; j++) {
+			GF_TraceEvent *evt = &events[j & (GF_TRACE_RING_SIZE-1)];
+			fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":"LLU",\"pid\":%d,\"tid\":%u}", first ? "" : ",\n", evt->name, evt->cat, (char) evt->phase, evt->ts, the_rti.pid, ring->thread_id);
+			first = 0;
+		}
+		if (start) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_CORE, ("[core] Trace ring of thread %u overflowed, %d events lost\n", ring->thread_id, start));
+		}
+	}
+	fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(out);
+	gf_free(events);
+	return GF_OK;
+}
+
 #ifdef GPAC_ANDROID
 
 fm_callback_func fm_cbk = NULL;
@@ -481,6 +481,7 @@ s32 gf_sk_get_handle(GF_Socket *sock)
 
 
 //connects a socket to a remote peer on a given port
+GF_EXPORT
 GF_Err gf_sk_connect(GF_Socket *sock, const char *PeerName, u16 PortNumber, const char *local_ip)
 {
 	s32 ret;
@@ -1170,6 +1171,7 @@ GF_Err gf_sk_receive(GF_Socket *sock, char *buffer, u32 length, u32 startFrom, u
 }
 
 
+GF_EXPORT
 GF_Err gf_sk_listen(GF_Socket *sock, u32 MaxConnection)
 {
 	s32 i;
@@ -1181,6 +1183,7 @@ GF_Err gf_sk_listen(GF_Socket *sock, u32 MaxConnection)
 	return GF_OK;
 }
 
+GF_EXPORT
 GF_Err gf_sk_accept(GF_Socket *sock, GF_Socket **newConnection)
 {
 	u32 client_address_size;
@@ -1249,6 +1252,7 @@ GF_Err gf_sk_accept(GF_Socket *sock, GF_Socket **newConnection)
 	return GF_OK;
 }
 
+GF_EXPORT
 GF_Err gf_sk_get_local_info(GF_Socket *sock, u16 *Port, u32 *Familly)
 {
 #ifdef GPAC_HAS_IPV6
@@ -1412,6 +1416,7 @@ GF_Err gf_sk_send_to(GF_Socket *sock, const char *buffer, u32 length, char *remo
 
 
 
+GF_EXPORT
 GF_Err gf_sk_receive_wait(GF_Socket *sock, char *buffer, u32 length, u32 startFrom, u32 *BytesRead, u32 Second )
 {
 	s32 res;
@@ -1462,6 +1467,7 @@ GF_Err gf_sk_receive_wait(GF_Socket *sock, char *buffer, u32 length, u32 startFr
 
 
 //send length bytes of a buffer
+GF_EXPORT
 GF_Err gf_sk_send_wait(GF_Socket *sock, const char *buffer, u32 length, u32 Second )
 {
 	u32 count;
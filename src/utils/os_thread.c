@@ -43,6 +43,16 @@ typedef HANDLE TH_HANDLE;
 #include <errno.h>
 typedef pthread_t TH_HANDLE ;
 
+/*on linux, mutexes are implemented on top of futexes: locking and unlocking without contention is a single atomic
+operation, the kernel is only called when threads have to wait*/
+#if (defined(GPAC_CONFIG_LINUX) || defined(__linux__)) && defined(__GNUC__) && !defined(GPAC_ANDROID)
+#define GPAC_USE_FUTEX
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
 #endif
 
 
@@ -388,19 +398,110 @@ u32 gf_th_id()
 }
 
 
+/*********************************************************************
+						Lightweight Mutex Object
+**********************************************************************/
+/*lock states: 0 is free, 1 is locked, 2 is locked with (possibly) waiting threads*/
+#define LMX_FREE		0
+#define LMX_LOCKED		1
+#define LMX_CONTENDED	2
+
+/*total number of contended locks and time spent waiting for them, for all mutexes*/
+static volatile u32 nb_lock_contentions = 0;
+static volatile u32 lock_wait_time_ms = 0;
+
+static GFINLINE u32 lmx_swap(volatile u32 *state, u32 val)
+{
+	u32 prev;
+	do {
+		prev = *state;
+	} while (!gf_atomic_cas(state, prev, val));
+	return prev;
+}
+
+static GFINLINE void lmx_wait(volatile u32 *state, u32 val)
+{
+#if defined(GPAC_USE_FUTEX)
+	syscall(SYS_futex, state, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+#elif defined(WIN32) || defined(_WIN32_WCE)
+	Sleep(0);
+#else
+	sched_yield();
+#endif
+}
+
+static GFINLINE void lmx_wake(volatile u32 *state)
+{
+#if defined(GPAC_USE_FUTEX)
+	syscall(SYS_futex, state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+}
+
+static void lmx_lock_slow(GF_LightMutex *lmx)
+{
+	/*flag the lock as contended so that the holder wakes us up, and sleep until we get it*/
+	while (lmx_swap(&lmx->state, LMX_CONTENDED) != LMX_FREE) {
+		lmx_wait(&lmx->state, LMX_CONTENDED);
+	}
+}
+
+GF_EXPORT
+void gf_lmx_init(GF_LightMutex *lmx)
+{
+	lmx->state = LMX_FREE;
+	lmx->nb_contentions = 0;
+}
+
+GF_EXPORT
+void gf_lmx_lock(GF_LightMutex *lmx)
+{
+	if (gf_atomic_cas(&lmx->state, LMX_FREE, LMX_LOCKED)) return;
+	lmx_lock_slow(lmx);
+	lmx->nb_contentions++;
+	gf_atomic_inc(&nb_lock_contentions);
+}
+
+GF_EXPORT
+Bool gf_lmx_try_lock(GF_LightMutex *lmx)
+{
+	return gf_atomic_cas(&lmx->state, LMX_FREE, LMX_LOCKED) ? 1 : 0;
+}
+
+GF_EXPORT
+void gf_lmx_unlock(GF_LightMutex *lmx)
+{
+	if (gf_atomic_dec(&lmx->state) == LMX_FREE) return;
+	/*someone may be waiting*/
+	lmx_swap(&lmx->state, LMX_FREE);
+	lmx_wake(&lmx->state);
+}
+
+GF_EXPORT
+void gf_mx_get_global_stats(u32 *nb_contentions, u32 *wait_time_ms)
+{
+	if (nb_contentions) *nb_contentions = gf_atomic_get(&nb_lock_contentions);
+	if (wait_time_ms) *wait_time_ms = gf_atomic_get(&lock_wait_time_ms);
+}
+
+
 /*********************************************************************
 						OS-Specific Mutex Object
 **********************************************************************/
 struct __tag_mutex
 {
-#ifdef WIN32
+#if defined(WIN32)
 	HANDLE hMutex;
+#elif defined(GPAC_USE_FUTEX)
+	GF_LightMutex lmx;
 #else
 	pthread_mutex_t hMutex;
 #endif
 	/* We filter recursive calls (1 thread calling Lock several times in a row only locks
 	ONCE the mutex. Holder is the current ThreadID of the mutex holder*/
 	u32 Holder, HolderCount;
+	/*contention stats, only modified by the holder*/
+	u32 nb_locks, nb_contentions;
+	u64 wait_time;
 #ifndef GPAC_DISABLE_LOG
 	char *log_name;
 #endif
@@ -410,24 +511,30 @@ struct __tag_mutex
 GF_EXPORT
 GF_Mutex *gf_mx_new(const char *name)
 {
-#ifndef WIN32
+#if !defined(WIN32) && !defined(GPAC_USE_FUTEX)
 	pthread_mutexattr_t attr;
 #endif
 	GF_Mutex *tmp = gf_malloc(sizeof(GF_Mutex));
 	if (!tmp) return NULL;
 	memset(tmp, 0, sizeof(GF_Mutex));
 
-#ifdef WIN32
+#if defined(WIN32)
 	tmp->hMutex = CreateMutex(NULL, FALSE, NULL);
 	if (!tmp->hMutex) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex] Couldn't create mutex %s\n", name ? name : ""));
+		gf_free(tmp);
+		return NULL;
+	}
+#elif defined(GPAC_USE_FUTEX)
+	gf_lmx_init(&tmp->lmx);
 #else
 	pthread_mutexattr_init(&attr);
 	if ( pthread_mutex_init(&tmp->hMutex, &attr) != 0 ) {
-#endif
-		GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex] Couldn't create mutex %s\n", strlen(name) ? name : ""));
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex] Couldn't create mutex %s\n", name ? name : ""));
 		gf_free(tmp);
 		return NULL;
 	}
+#endif
 
 #ifndef GPAC_DISABLE_LOG
 	if (name) {
@@ -446,11 +553,14 @@ GF_Mutex *gf_mx_new(const char *name)
 GF_EXPORT
 void gf_mx_del(GF_Mutex *mx)
 {
-#ifdef WIN32
+#if defined(WIN32)
 	if (!CloseHandle(mx->hMutex)) {
 		DWORD err = GetLastError();
 		GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex %s] CloseHandle when deleting mutex failed with error code %d\n", mx->log_name, err));
 	}
+#elif defined(GPAC_USE_FUTEX)
+	if (mx->lmx.state != LMX_FREE)
+		GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex %s] Destroying mutex while locked\n", mx->log_name));
 #else
 	int err = pthread_mutex_destroy(&mx->hMutex);
 	if (err)
@@ -458,6 +568,9 @@ void gf_mx_del(GF_Mutex *mx)
 
 #endif
 #ifndef GPAC_DISABLE_LOG
+	if (mx->nb_contentions) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_MUTEX, ("[Mutex %s] %d locks - %d contended (%.02f %%) - "LLU" us spent waiting\n", mx->log_name, mx->nb_locks, mx->nb_contentions, 100.0 * mx->nb_contentions / mx->nb_locks, mx->wait_time));
+	}
 	gf_free(mx->log_name);
 	mx->log_name = NULL;
 #endif
@@ -482,7 +595,7 @@ void gf_mx_v(GF_Mutex *mx)
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_MUTEX, ("[Mutex %s] At %d Released by thread %s\n", mx->log_name, gf_sys_clock(), log_th_name(mx->Holder) ));
 #endif
 		mx->Holder = 0;
-#ifdef WIN32
+#if defined(WIN32)
 		{
 			BOOL ret = ReleaseMutex(mx->hMutex);
 			if (!ret) {
@@ -490,6 +603,8 @@ void gf_mx_v(GF_Mutex *mx)
 				GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex] Couldn't release mutex (thread %s, error %d)\n", log_th_name(mx->Holder), err));
 			}
 		}
+#elif defined(GPAC_USE_FUTEX)
+		gf_lmx_unlock(&mx->lmx);
 #else
 		if (pthread_mutex_unlock(&mx->hMutex))
 			GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex] Couldn't release mutex (thread %s)\n", log_th_name(mx->Holder)));
@@ -497,12 +612,25 @@ void gf_mx_v(GF_Mutex *mx)
 	}
 }
 
+/*non-blocking attempt to grab the mutex*/
+static GFINLINE Bool mx_try_grab(GF_Mutex *mx)
+{
+#if defined(WIN32)
+	return (WaitForSingleObject(mx->hMutex, 0) == WAIT_OBJECT_0) ? 1 : 0;
+#elif defined(GPAC_USE_FUTEX)
+	return gf_lmx_try_lock(&mx->lmx);
+#else
+	return pthread_mutex_trylock(&mx->hMutex) ? 0 : 1;
+#endif
+}
+
 GF_EXPORT
 u32 gf_mx_p(GF_Mutex *mx)
 {
-#ifndef WIN32
+#if !defined(WIN32) && !defined(GPAC_USE_FUTEX)
 	int retCode;
 #endif
+	u64 wait_start;
 	u32 caller;
 	assert(mx);
 	if (!mx) return 0;
@@ -512,12 +640,19 @@ u32 gf_mx_p(GF_Mutex *mx)
 		return 1;
 	}
 
+	/*uncontended fast path*/
+	if (mx_try_grab(mx)) {
+		mx->nb_locks++;
+		goto locked;
+	}
+
 #ifndef GPAC_DISABLE_LOG
 	if (mx->Holder)
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_MUTEX, ("[Mutex %s] At %d Thread %s waiting a release from thread %s\n", mx->log_name, gf_sys_clock(), log_th_name(caller), log_th_name(mx->Holder) ));
 #endif
 
-#ifdef WIN32
+	wait_start = gf_sys_clock_high_res();
+#if defined(WIN32)
 	switch (WaitForSingleObject(mx->hMutex, INFINITE)) {
 	case WAIT_ABANDONED:
 	case WAIT_TIMEOUT:
@@ -525,6 +660,8 @@ u32 gf_mx_p(GF_Mutex *mx)
 	default:
 		break;
 	}
+#elif defined(GPAC_USE_FUTEX)
+	lmx_lock_slow(&mx->lmx);
 #else
 	retCode = pthread_mutex_lock(&mx->hMutex);
 	if (retCode != 0 ) {
@@ -538,6 +675,18 @@ u32 gf_mx_p(GF_Mutex *mx)
 		return 0;
 	}
 #endif /* NOT WIN32 */
+
+	/*we own the mutex, update contention stats*/
+	{
+		u64 prev_ms = mx->wait_time / 1000;
+		mx->wait_time += gf_sys_clock_high_res() - wait_start;
+		mx->nb_locks++;
+		mx->nb_contentions++;
+		gf_atomic_inc(&nb_lock_contentions);
+		if (mx->wait_time / 1000 != prev_ms) gf_atomic_add(&lock_wait_time_ms, (u32) (mx->wait_time / 1000 - prev_ms));
+	}
+
+locked:
 	mx->HolderCount = 1;
 	mx->Holder = caller;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_MUTEX, ("[Mutex %s] At %d Grabbed by thread %s\n", mx->log_name, gf_sys_clock(), log_th_name(mx->Holder) ));
@@ -556,6 +705,14 @@ s32 gf_mx_get_num_locks(GF_Mutex *mx)
 	return -1;
 }
 
+GF_EXPORT
+void gf_mx_get_stats(GF_Mutex *mx, u32 *nb_locks, u32 *nb_contentions, u64 *wait_time_us)
+{
+	if (nb_locks) *nb_locks = mx ? mx->nb_locks : 0;
+	if (nb_contentions) *nb_contentions = mx ? mx->nb_contentions : 0;
+	if (wait_time_us) *wait_time_us = mx ? mx->wait_time : 0;
+}
+
 GF_EXPORT
 Bool gf_mx_try_lock(GF_Mutex *mx)
 {
@@ -567,7 +724,7 @@ Bool gf_mx_try_lock(GF_Mutex *mx)
 		return 1;
 	}
 
-#ifdef WIN32
+#if defined(WIN32)
 	/*is the object signaled?*/
 	switch (WaitForSingleObject(mx->hMutex, 0)) {
 	case WAIT_OBJECT_0:
@@ -584,11 +741,12 @@ Bool gf_mx_try_lock(GF_Mutex *mx)
 		return 0;
 	}
 #else
-	if (pthread_mutex_trylock(&mx->hMutex) != 0 ) {
+	if (!mx_try_grab(mx)) {
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_MUTEX, ("[Mutex %s] At %d Couldn't release it for thread %s (grabbed by thread %s)\n", mx->log_name, gf_sys_clock(), log_th_name(caller), log_th_name(mx->Holder) ));
 		return 0;
 	}
 #endif
+	mx->nb_locks++;
 	mx->Holder = caller;
 	mx->HolderCount = 1;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_MUTEX, ("[Mutex %s] At %d Grabbed by thread %s\n", mx->log_name, gf_sys_clock(), log_th_name(mx->Holder) ));
@@ -733,6 +891,24 @@ Bool gf_sema_wait_for(GF_Semaphore *sm, u32 TimeOut)
 		if (!sem_trywait(hSem)) return 1;
 		return 0;
 	}
+#if defined(GPAC_USE_FUTEX)
+	/*no polling, let the kernel wake us up*/
+	{
+		struct timespec ts;
+		if (!clock_gettime(CLOCK_REALTIME, &ts)) {
+			ts.tv_sec += TimeOut / 1000;
+			ts.tv_nsec += (TimeOut % 1000) * 1000000;
+			if (ts.tv_nsec >= 1000000000) {
+				ts.tv_sec += 1;
+				ts.tv_nsec -= 1000000000;
+			}
+			while (sem_timedwait(hSem, &ts)) {
+				if (errno != EINTR) return 0;
+			}
+			return 1;
+		}
+	}
+#endif
 	TimeOut += gf_sys_clock();
 	do {
 		if (!sem_trywait(hSem)) return 1;
@@ -742,3 +918,430 @@ Bool gf_sema_wait_for(GF_Semaphore *sm, u32 TimeOut)
 #endif
 }
 
+
+#if !defined(__GNUC__)
+
+#if defined(WIN32) || defined(_WIN32_WCE)
+
+GF_EXPORT
+u32 gf_atomic_add(volatile u32 *ptr, u32 val)
+{
+	return (u32) InterlockedExchangeAdd((volatile LONG *) ptr, (LONG) val) + val;
+}
+
+GF_EXPORT
+Bool gf_atomic_cas(volatile u32 *ptr, u32 old_val, u32 new_val)
+{
+	return (InterlockedCompareExchange((volatile LONG *) ptr, (LONG) new_val, (LONG) old_val) == (LONG) old_val) ? 1 : 0;
+}
+
+#else
+
+/*no atomic primitives known for this compiler, use a global lock*/
+static pthread_mutex_t atomic_mx = PTHREAD_MUTEX_INITIALIZER;
+
+GF_EXPORT
+u32 gf_atomic_add(volatile u32 *ptr, u32 val)
+{
+	u32 res;
+	pthread_mutex_lock(&atomic_mx);
+	res = *ptr += val;
+	pthread_mutex_unlock(&atomic_mx);
+	return res;
+}
+
+GF_EXPORT
+Bool gf_atomic_cas(volatile u32 *ptr, u32 old_val, u32 new_val)
+{
+	Bool res = 0;
+	pthread_mutex_lock(&atomic_mx);
+	if (*ptr == old_val) {
+		*ptr = new_val;
+		res = 1;
+	}
+	pthread_mutex_unlock(&atomic_mx);
+	return res;
+}
+
+#endif
+
+#endif
+
+
+/*********************************************************************
+						Task Pool
+**********************************************************************/
+#include "../../include/gpac/list.h"
+
+#if !defined(WIN32) && !defined(_WIN32_WCE)
+#include <unistd.h>
+#endif
+
+#define GF_TASK_PRIORITY_COUNT	3
+
+typedef struct
+{
+	gf_task_run run;
+	void *par;
+	GF_TaskGroup *group;
+} GF_Task;
+
+typedef struct
+{
+	GF_TaskPool *pool;
+	GF_Thread *th;
+	u32 th_id;
+	/*one LIFO/FIFO queue per priority: the owner pops the last task, thieves take the first one*/
+	GF_List *queues[GF_TASK_PRIORITY_COUNT];
+	GF_LightMutex mx;
+	u32 nb_run, nb_steal;
+} GF_TaskWorker;
+
+struct __tag_task_pool
+{
+	char *name;
+	GF_TaskWorker *workers;
+	u32 nb_workers;
+	/*one notification per queued task*/
+	GF_Semaphore *tasks;
+	volatile u32 run;
+	volatile u32 next_queue;
+	/*recycled task objects*/
+	GF_List *task_reservoir;
+	GF_LightMutex reservoir_mx;
+};
+
+struct __tag_task_group
+{
+	GF_TaskPool *pool;
+	GF_LightMutex mx;
+	u32 pending;
+	GF_Err error;
+	GF_Semaphore *done;
+};
+
+static u32 gf_sys_get_cpu_count()
+{
+#if defined(WIN32) || defined(_WIN32_WCE)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	long nb_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+	return (nb_cpu>0) ? (u32) nb_cpu : 1;
+#else
+	return 1;
+#endif
+}
+
+static void *task_list_pop_last(GF_List *list)
+{
+	void *item = gf_list_last(list);
+	if (item) gf_list_rem_last(list);
+	return item;
+}
+
+static void *task_list_pop_first(GF_List *list)
+{
+	void *item = gf_list_get(list, 0);
+	if (item) gf_list_rem(list, 0);
+	return item;
+}
+
+static s32 task_pool_get_worker(GF_TaskPool *pool)
+{
+	u32 i, id = gf_th_id();
+	for (i=0; i<pool->nb_workers; i++) {
+		if (pool->workers[i].th_id == id) return i;
+	}
+	return -1;
+}
+
+/*picks the highest priority task, from the worker own queue first then from the other workers' queues*/
+static GF_Task *task_pool_pick(GF_TaskPool *pool, s32 self)
+{
+	u32 prio, i, first;
+	GF_Task *task;
+
+	first = (self>=0) ? (u32) self : gf_atomic_get(&pool->next_queue) % pool->nb_workers;
+	for (prio=0; prio<GF_TASK_PRIORITY_COUNT; prio++) {
+		for (i=0; i<pool->nb_workers; i++) {
+			GF_TaskWorker *w = &pool->workers[(first + i) % pool->nb_workers];
+			if (!gf_list_count(w->queues[prio])) continue;
+
+			task = NULL;
+			gf_lmx_lock(&w->mx);
+			if (gf_list_count(w->queues[prio])) {
+				if (self>=0 && (w == &pool->workers[self])) {
+					task = (GF_Task *)task_list_pop_last(w->queues[prio]);
+				} else {
+					task = (GF_Task *)task_list_pop_first(w->queues[prio]);
+				}
+			}
+			gf_lmx_unlock(&w->mx);
+			if (!task) continue;
+
+			if (self>=0) {
+				pool->workers[self].nb_run++;
+				if (w != &pool->workers[self]) pool->workers[self].nb_steal++;
+			}
+			return task;
+		}
+	}
+	return NULL;
+}
+
+static void task_pool_exec(GF_TaskPool *pool, GF_Task *task)
+{
+	GF_Err e = task->run(task->par);
+	GF_TaskGroup *group = task->group;
+
+	gf_lmx_lock(&pool->reservoir_mx);
+	gf_list_add(pool->task_reservoir, task);
+	gf_lmx_unlock(&pool->reservoir_mx);
+
+	if (!group) return;
+	gf_lmx_lock(&group->mx);
+	if (e && !group->error) group->error = e;
+	group->pending--;
+	if (!group->pending) gf_sema_notify(group->done, 1);
+	gf_lmx_unlock(&group->mx);
+}
+
+static u32 task_pool_worker_run(void *par)
+{
+	GF_TaskWorker *w = (GF_TaskWorker *)par;
+	GF_TaskPool *pool = w->pool;
+	s32 self = (s32) (w - pool->workers);
+
+	w->th_id = gf_th_id();
+	while (1) {
+		GF_Task *task;
+		gf_sema_wait(pool->tasks);
+		if (!pool->run) break;
+		while ((task = task_pool_pick(pool, self)) != NULL) {
+			task_pool_exec(pool, task);
+		}
+	}
+	return 0;
+}
+
+GF_EXPORT
+GF_TaskPool *gf_task_pool_new(const char *name, u32 nb_threads)
+{
+	u32 i, j;
+	char szName[100];
+	GF_TaskPool *pool;
+
+	GF_SAFEALLOC(pool, GF_TaskPool);
+	if (!pool) return NULL;
+	if (!nb_threads) nb_threads = gf_sys_get_cpu_count();
+	if (!name) name = "TaskPool";
+
+	pool->name = gf_strdup(name);
+	pool->nb_workers = nb_threads;
+	pool->workers = (GF_TaskWorker *)gf_malloc(sizeof(GF_TaskWorker) * nb_threads);
+	memset(pool->workers, 0, sizeof(GF_TaskWorker) * nb_threads);
+	pool->tasks = gf_sema_new(0xFFFFFF, 0);
+	pool->task_reservoir = gf_list_new();
+	gf_lmx_init(&pool->reservoir_mx);
+	pool->run = 1;
+
+	for (i=0; i<nb_threads; i++) {
+		GF_TaskWorker *w = &pool->workers[i];
+		w->pool = pool;
+		for (j=0; j<GF_TASK_PRIORITY_COUNT; j++) w->queues[j] = gf_list_new();
+		sprintf(szName, "%s%d", name, i+1);
+		gf_lmx_init(&w->mx);
+		w->th = gf_th_new(szName);
+	}
+	for (i=0; i<nb_threads; i++) {
+		gf_th_run(pool->workers[i].th, task_pool_worker_run, &pool->workers[i]);
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[TaskPool %s] Started %d worker threads\n", name, nb_threads));
+	return pool;
+}
+
+GF_EXPORT
+void gf_task_pool_del(GF_TaskPool *pool)
+{
+	u32 i, j;
+	if (!pool) return;
+
+	pool->run = 0;
+	gf_sema_notify(pool->tasks, pool->nb_workers);
+	for (i=0; i<pool->nb_workers; i++) {
+		GF_TaskWorker *w = &pool->workers[i];
+		gf_th_stop(w->th);
+		gf_th_del(w->th);
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CORE, ("[TaskPool %s] Worker %d ran %d tasks (%d stolen)\n", pool->name, i+1, w->nb_run, w->nb_steal));
+		for (j=0; j<GF_TASK_PRIORITY_COUNT; j++) {
+			while (gf_list_count(w->queues[j])) {
+				GF_Task *task = (GF_Task *)task_list_pop_last(w->queues[j]);
+				GF_LOG(GF_LOG_WARNING, GF_LOG_CORE, ("[TaskPool %s] Discarding pending task\n", pool->name));
+				gf_free(task);
+			}
+			gf_list_del(w->queues[j]);
+		}
+	}
+	while (gf_list_count(pool->task_reservoir)) {
+		GF_Task *task = (GF_Task *)task_list_pop_last(pool->task_reservoir);
+		gf_free(task);
+	}
+	gf_list_del(pool->task_reservoir);
+	gf_sema_del(pool->tasks);
+	gf_free(pool->workers);
+	gf_free(pool->name);
+	gf_free(pool);
+}
+
+GF_EXPORT
+u32 gf_task_pool_get_thread_count(GF_TaskPool *pool)
+{
+	return pool ? pool->nb_workers : 0;
+}
+
+GF_EXPORT
+GF_Err gf_task_pool_submit(GF_TaskPool *pool, GF_TaskGroup *group, u32 priority, gf_task_run run, void *par)
+{
+	s32 self;
+	GF_Task *task;
+	GF_TaskWorker *w;
+	if (!pool || !run || (group && (group->pool != pool))) return GF_BAD_PARAM;
+	if (priority >= GF_TASK_PRIORITY_COUNT) priority = GF_TASK_PRIORITY_LOW;
+
+	gf_lmx_lock(&pool->reservoir_mx);
+	task = (GF_Task *)task_list_pop_last(pool->task_reservoir);
+	gf_lmx_unlock(&pool->reservoir_mx);
+	if (!task) {
+		task = (GF_Task *)gf_malloc(sizeof(GF_Task));
+		if (!task) return GF_OUT_OF_MEM;
+	}
+	task->run = run;
+	task->par = par;
+	task->group = group;
+
+	if (group) {
+		gf_lmx_lock(&group->mx);
+		group->pending++;
+		gf_lmx_unlock(&group->mx);
+	}
+
+	/*tasks created by a worker stay local, others are spread over the workers*/
+	self = task_pool_get_worker(pool);
+	if (self>=0) w = &pool->workers[self];
+	else w = &pool->workers[gf_atomic_inc(&pool->next_queue) % pool->nb_workers];
+
+	gf_lmx_lock(&w->mx);
+	gf_list_add(w->queues[priority], task);
+	gf_lmx_unlock(&w->mx);
+	gf_sema_notify(pool->tasks, 1);
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_TaskGroup *gf_task_group_new(GF_TaskPool *pool)
+{
+	GF_TaskGroup *group;
+	if (!pool) return NULL;
+	GF_SAFEALLOC(group, GF_TaskGroup);
+	if (!group) return NULL;
+	group->pool = pool;
+	gf_lmx_init(&group->mx);
+	group->done = gf_sema_new(0xFFFFFF, 0);
+	return group;
+}
+
+GF_EXPORT
+GF_Err gf_task_group_wait(GF_TaskGroup *group)
+{
+	GF_Err e;
+	s32 self;
+	if (!group) return GF_BAD_PARAM;
+
+	self = task_pool_get_worker(group->pool);
+	while (1) {
+		u32 pending;
+		GF_Task *task;
+		gf_lmx_lock(&group->mx);
+		pending = group->pending;
+		gf_lmx_unlock(&group->mx);
+		if (!pending) break;
+
+		/*help the workers rather than sleeping*/
+		task = task_pool_pick(group->pool, self);
+		if (task) {
+			task_pool_exec(group->pool, task);
+			continue;
+		}
+		/*remaining tasks are running, wait for the last one to signal us - the semaphore may hold notifications
+		from previous waits, in which case we simply check again*/
+		gf_sema_wait(group->done);
+	}
+	/*the mutex also makes sure the task signaling completion is done with the group*/
+	gf_lmx_lock(&group->mx);
+	e = group->error;
+	group->error = GF_OK;
+	gf_lmx_unlock(&group->mx);
+	return e;
+}
+
+GF_EXPORT
+void gf_task_group_del(GF_TaskGroup *group)
+{
+	if (!group) return;
+	gf_task_group_wait(group);
+	gf_sema_del(group->done);
+	gf_free(group);
+}
+
+typedef struct
+{
+	gf_task_range_run run;
+	void *par;
+	u32 start, end;
+} GF_TaskRange;
+
+static GF_Err task_pool_run_range(void *par)
+{
+	GF_TaskRange *range = (GF_TaskRange *)par;
+	return range->run(range->par, range->start, range->end);
+}
+
+GF_EXPORT
+GF_Err gf_task_pool_parallel_for(GF_TaskPool *pool, u32 start, u32 end, u32 grain, gf_task_range_run run, void *par)
+{
+	GF_Err e;
+	u32 i, nb_ranges;
+	GF_TaskRange *ranges;
+	GF_TaskGroup *group;
+	if (!pool || !run || (end < start)) return GF_BAD_PARAM;
+	if (start == end) return GF_OK;
+
+	if (!grain) grain = (end - start + 4*pool->nb_workers - 1) / (4*pool->nb_workers);
+	if (!grain) grain = 1;
+	nb_ranges = (end - start + grain - 1) / grain;
+	/*nothing to split*/
+	if (nb_ranges==1) return run(par, start, end);
+
+	ranges = (GF_TaskRange *)gf_malloc(sizeof(GF_TaskRange) * nb_ranges);
+	if (!ranges) return GF_OUT_OF_MEM;
+	group = gf_task_group_new(pool);
+	e = GF_OK;
+	for (i=0; i<nb_ranges; i++) {
+		ranges[i].run = run;
+		ranges[i].par = par;
+		ranges[i].start = start + i*grain;
+		ranges[i].end = MIN(end, ranges[i].start + grain);
+		/*the first range is run by the caller once everything is queued*/
+		if (!i) continue;
+		e = gf_task_pool_submit(pool, group, GF_TASK_PRIORITY_NORMAL, task_pool_run_range, &ranges[i]);
+		if (e) break;
+	}
+	if (!e) e = run(par, ranges[0].start, ranges[0].end);
+	if (e) gf_task_group_wait(group);
+	else e = gf_task_group_wait(group);
+	gf_task_group_del(group);
+	gf_free(ranges);
+	return e;
+}
@@ -3,6 +3,7 @@
 #endif
 
 #include "../../include/gpac/tools.h"
+#include "../../include/gpac/thread.h"
 
 #ifndef PUT_UINT32_BE
 #define PUT_UINT32_BE(n,b,i)                            \
@@ -14,7 +15,6 @@
 }
 #endif
 
-#if 0
 /*
  *  FIPS-180-1 compliant SHA-1 implementation
  *
@@ -48,6 +48,11 @@ struct __sha1_context
     u8 buffer[64];
 };
 
+/*block compression function, selected at runtime*/
+typedef void (*sha1_process_blocks_fn)(u32 state[5], const u8 *data, u32 nb_blocks);
+static sha1_process_blocks_fn sha1_process_blocks = NULL;
+static void sha1_select_impl();
+
 /*
  * 32-bit integer manipulation macros (big endian)
  */
@@ -76,10 +81,12 @@ GF_SHA1Context *gf_sha1_starts()
     ctx->state[2] = 0x98BADCFE;
     ctx->state[3] = 0x10325476;
     ctx->state[4] = 0xC3D2E1F0;
+
+	if (!sha1_process_blocks) sha1_select_impl();
 	return ctx;
 }
 
-static void sha1_process(GF_SHA1Context *ctx, u8 data[64] )
+static void sha1_process(u32 state[5], const u8 data[64] )
 {
     u32 temp, W[16], A, B, C, D, E;
 
@@ -114,11 +121,11 @@ static void sha1_process(GF_SHA1Context *ctx, u8 data[64] )
     e += S(a,5) + F(b,c,d) + K + x; b = S(b,30);        \
 }
 
-    A = ctx->state[0];
-    B = ctx->state[1];
-    C = ctx->state[2];
-    D = ctx->state[3];
-    E = ctx->state[4];
+    A = state[0];
+    B = state[1];
+    C = state[2];
+    D = state[3];
+    E = state[4];
 
 #define F(x,y,z) (z ^ (x & (y ^ z)))
 #define K 0x5A827999
@@ -228,11 +235,94 @@ static void sha1_process(GF_SHA1Context *ctx, u8 data[64] )
 #undef K
 #undef F
 
-    ctx->state[0] += A;
-    ctx->state[1] += B;
-    ctx->state[2] += C;
-    ctx->state[3] += D;
-    ctx->state[4] += E;
+    state[0] += A;
+    state[1] += B;
+    state[2] += C;
+    state[3] += D;
+    state[4] += E;
+}
+
+static void sha1_process_blocks_c(u32 state[5], const u8 *data, u32 nb_blocks)
+{
+    while (nb_blocks--) {
+        sha1_process(state, data);
+        data += 64;
+    }
+}
+
+/*
+ * SHA-1 compression using the x86 SHA extensions, selected at runtime
+ */
+#if !defined(GPAC_DISABLE_SHA_NI) && (defined(__x86_64__) || defined(__i386__)) \
+	&& ( (defined(__GNUC__) && !defined(__clang__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))) \
+		|| (defined(__clang__) && (__clang_major__ >= 4)) )
+
+#define GPAC_HAS_SHA_NI
+
+#include <immintrin.h>
+#include <cpuid.h>
+
+/*rounds 4*k to 4*k+3 - the message schedule is kept in the 4 last 128-bit words*/
+#define SHA1_NI_ROUNDS(k)	\
+	if (k<4) {	\
+		M[k] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (data + 16*k)), MASK);	\
+	} else {	\
+		M[k%4] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(M[k%4], M[(k+1)%4]), M[(k+2)%4]), M[(k+3)%4]);	\
+	}	\
+	if (!k) E = _mm_add_epi32(E0, M[0]);	\
+	else E = _mm_sha1nexte_epu32(ABCD_PREV, M[k%4]);	\
+	ABCD_PREV = ABCD;	\
+	ABCD = _mm_sha1rnds4_epu32(ABCD, E, k/5);	\
+
+__attribute__((target("sha,sse4.1")))
+static void sha1_process_blocks_ni(u32 state[5], const u8 *data, u32 nb_blocks)
+{
+	__m128i ABCD, ABCD_SAVE, ABCD_PREV, E0, E, M[4];
+	const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+	ABCD = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state), 0x1B);
+	E0 = _mm_set_epi32((s32) state[4], 0, 0, 0);
+
+	while (nb_blocks--) {
+		ABCD_SAVE = ABCD;
+
+		SHA1_NI_ROUNDS(0) SHA1_NI_ROUNDS(1) SHA1_NI_ROUNDS(2) SHA1_NI_ROUNDS(3)
+		SHA1_NI_ROUNDS(4) SHA1_NI_ROUNDS(5) SHA1_NI_ROUNDS(6) SHA1_NI_ROUNDS(7)
+		SHA1_NI_ROUNDS(8) SHA1_NI_ROUNDS(9) SHA1_NI_ROUNDS(10) SHA1_NI_ROUNDS(11)
+		SHA1_NI_ROUNDS(12) SHA1_NI_ROUNDS(13) SHA1_NI_ROUNDS(14) SHA1_NI_ROUNDS(15)
+		SHA1_NI_ROUNDS(16) SHA1_NI_ROUNDS(17) SHA1_NI_ROUNDS(18) SHA1_NI_ROUNDS(19)
+
+		E0 = _mm_sha1nexte_epu32(ABCD_PREV, E0);
+		ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+		data += 64;
+	}
+
+	_mm_storeu_si128((__m128i *) state, _mm_shuffle_epi32(ABCD, 0x1B));
+	state[4] = (u32) _mm_extract_epi32(E0, 3);
+}
+
+static Bool sha1_has_sha_ni()
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0, NULL) < 7) return 0;
+	__cpuid(1, eax, ebx, ecx, edx);
+	/*SSSE3 and SSE4.1*/
+	if (!(ecx & (1<<9)) || !(ecx & (1<<19))) return 0;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & (1<<29)) ? 1 : 0;
+}
+#endif
+
+static void sha1_select_impl()
+{
+	sha1_process_blocks_fn fn = sha1_process_blocks_c;
+#ifdef GPAC_HAS_SHA_NI
+	if (sha1_has_sha_ni()) {
+		fn = sha1_process_blocks_ni;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CORE, ("[SHA1] Using x86 SHA extensions\n"));
+	}
+#endif
+	sha1_process_blocks = fn;
 }
 
 /*
@@ -259,17 +349,17 @@ void gf_sha1_update(GF_SHA1Context *ctx, u8 *input, u32 ilen )
     {
         memcpy( (void *) (ctx->buffer + left),
                 (void *) input, fill );
-        sha1_process( ctx, ctx->buffer );
+        sha1_process_blocks( ctx->state, ctx->buffer, 1 );
         input += fill;
         ilen  -= fill;
         left = 0;
     }
 
-    while( ilen >= 64 )
+    if( ilen >= 64 )
     {
-        sha1_process( ctx, input );
-        input += 64;
-        ilen  -= 64;
+        sha1_process_blocks( ctx->state, input, ilen / 64 );
+        input += ilen & ~0x3F;
+        ilen  &= 0x3F;
     }
 
     if( ilen > 0 )
@@ -317,381 +407,19 @@ void gf_sha1_finish(GF_SHA1Context *ctx, u8 output[20] )
 
 	gf_free(ctx);
 }
-#else
-
-/*
- *  sha1.c
- *
- *  Copyright (C) 1998, 2009
- *  Paul E. Jones <paulej@packetizer.com>
- *  All Rights Reserved
- *
- *  Freeware Public License (FPL)
- *
- *  This software is licensed as "freeware."  Permission to distribute
- *  this software in source and binary forms, including incorporation
- *  into other products, is hereby granted without a fee.  THIS SOFTWARE
- *  IS PROVIDED 'AS IS' AND WITHOUT ANY EXPRESSED OR IMPLIED WARRANTIES,
- *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY
- *  AND FITNESS FOR A PARTICULAR PURPOSE.  THE AUTHOR SHALL NOT BE HELD
- *  LIABLE FOR ANY DAMAGES RESULTING FROM THE USE OF THIS SOFTWARE, EITHER
- *  DIRECTLY OR INDIRECTLY, INCLUDING, BUT NOT LIMITED TO, LOSS OF DATA
- *  OR DATA BEING RENDERED INACCURATE.
- *
- *****************************************************************************
- *  $Id: sha1.c 12 2009-06-22 19:34:25Z paulej $
- *****************************************************************************
- *
- *  Description:
- *      This file implements the Secure Hashing Standard as defined
- *      in FIPS PUB 180-1 published April 17, 1995.
- *
- *      The Secure Hashing Standard, which uses the Secure Hashing
- *      Algorithm (SHA), produces a 160-bit message digest for a
- *      given data stream.  In theory, it is highly improbable that
- *      two messages will produce the same message digest.  Therefore,
- *      this algorithm can serve as a means of providing a "fingerprint"
- *      for a message.
- *
- *  Portability Issues:
- *      SHA-1 is defined in terms of 32-bit "words".  This code was
- *      written with the expectation that the processor has at least
- *      a 32-bit machine word size.  If the machine word size is larger,
- *      the code should still function properly.  One caveat to that
- *      is that the input functions taking characters and character
- *      arrays assume that only 8 bits of information are stored in each
- *      character.
- *
- *  Caveats:
- *      SHA-1 is designed to work with messages less than 2^64 bits
- *      long. Although SHA-1 allows a message digest to be generated for
- *      messages of any number of bits less than 2^64, this
- *      implementation only works with messages with a length that is a
- *      multiple of the size of an 8-bit character.
- *
- */
-
-/*
- *  This structure will hold context information for the hashing
- *  operation
- */
-struct __sha1_context
-{
-    unsigned Message_Digest[5]; /* Message Digest (output)          */
-
-    unsigned Length_Low;        /* Message length in bits           */
-    unsigned Length_High;       /* Message length in bits           */
-
-    unsigned char Message_Block[64]; /* 512-bit message blocks      */
-    int Message_Block_Index;    /* Index into message block array   */
-
-    int Computed;               /* Is the digest computed?          */
-    int Corrupted;              /* Is the message digest corruped?  */
-};
-
-/*
- *  Define the circular shift macro
- */
-#define SHA1CircularShift(bits,word) \
-                ((((word) << (bits)) & 0xFFFFFFFF) | \
-                ((word) >> (32-(bits))))
-
-
-/*
- *  SHA1ProcessMessageBlock
- *
- *  Description:
- *      This function will process the next 512 bits of the message
- *      stored in the Message_Block array.
- *
- *  Parameters:
- *      None.
- *
- *  Returns:
- *      Nothing.
- *
- *  Comments:
- *      Many of the variable names in the SHAContext, especially the
- *      single character names, were used because those were the names
- *      used in the publication.
- *
- *
- */
-void SHA1ProcessMessageBlock(GF_SHA1Context *context)
-{
-    const unsigned K[] =            /* Constants defined in SHA-1   */
-    {
-        0x5A827999,
-        0x6ED9EBA1,
-        0x8F1BBCDC,
-        0xCA62C1D6
-    };
-    int         t;                  /* Loop counter                 */
-    unsigned    temp;               /* Temporary word value         */
-    unsigned    W[80];              /* Word sequence                */
-    unsigned    A, B, C, D, E;      /* Word buffers                 */
-
-    /*
-     *  Initialize the first 16 words in the array W
-     */
-    for(t = 0; t < 16; t++)
-    {
-        W[t] = ((unsigned) context->Message_Block[t * 4]) << 24;
-        W[t] |= ((unsigned) context->Message_Block[t * 4 + 1]) << 16;
-        W[t] |= ((unsigned) context->Message_Block[t * 4 + 2]) << 8;
-        W[t] |= ((unsigned) context->Message_Block[t * 4 + 3]);
-    }
-
-    for(t = 16; t < 80; t++)
-    {
-       W[t] = SHA1CircularShift(1,W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16]);
-    }
-
-    A = context->Message_Digest[0];
-    B = context->Message_Digest[1];
-    C = context->Message_Digest[2];
-    D = context->Message_Digest[3];
-    E = context->Message_Digest[4];
-
-    for(t = 0; t < 20; t++)
-    {
-        temp =  SHA1CircularShift(5,A) +
-                ((B & C) | ((~B) & D)) + E + W[t] + K[0];
-        temp &= 0xFFFFFFFF;
-        E = D;
-        D = C;
-        C = SHA1CircularShift(30,B);
-        B = A;
-        A = temp;
-    }
-
-    for(t = 20; t < 40; t++)
-    {
-        temp = SHA1CircularShift(5,A) + (B ^ C ^ D) + E + W[t] + K[1];
-        temp &= 0xFFFFFFFF;
-        E = D;
-        D = C;
-        C = SHA1CircularShift(30,B);
-        B = A;
-        A = temp;
-    }
-
-    for(t = 40; t < 60; t++)
-    {
-        temp = SHA1CircularShift(5,A) +
-               ((B & C) | (B & D) | (C & D)) + E + W[t] + K[2];
-        temp &= 0xFFFFFFFF;
-        E = D;
-        D = C;
-        C = SHA1CircularShift(30,B);
-        B = A;
-        A = temp;
-    }
-
-    for(t = 60; t < 80; t++)
-    {
-        temp = SHA1CircularShift(5,A) + (B ^ C ^ D) + E + W[t] + K[3];
-        temp &= 0xFFFFFFFF;
-        E = D;
-        D = C;
-        C = SHA1CircularShift(30,B);
-        B = A;
-        A = temp;
-    }
-
-    context->Message_Digest[0] =
-                        (context->Message_Digest[0] + A) & 0xFFFFFFFF;
-    context->Message_Digest[1] =
-                        (context->Message_Digest[1] + B) & 0xFFFFFFFF;
-    context->Message_Digest[2] =
-                        (context->Message_Digest[2] + C) & 0xFFFFFFFF;
-    context->Message_Digest[3] =
-                        (context->Message_Digest[3] + D) & 0xFFFFFFFF;
-    context->Message_Digest[4] =
-                        (context->Message_Digest[4] + E) & 0xFFFFFFFF;
-
-    context->Message_Block_Index = 0;
-}
-
-/*
- *  SHA1PadMessage
- *
- *  Description:
- *      According to the standard, the message must be padded to an even
- *      512 bits.  The first padding bit must be a '1'.  The last 64
- *      bits represent the length of the original message.  All bits in
- *      between should be 0.  This function will pad the message
- *      according to those rules by filling the Message_Block array
- *      accordingly.  It will also call SHA1ProcessMessageBlock()
- *      appropriately.  When it returns, it can be assumed that the
- *      message digest has been computed.
- *
- *  Parameters:
- *      context: [in/out]
- *          The context to pad
- *
- *  Returns:
- *      Nothing.
- *
- *  Comments:
- *
- */
-static void SHA1PadMessage(GF_SHA1Context *context)
-{
-    /*
-     *  Check to see if the current message block is too small to hold
-     *  the initial padding bits and length.  If so, we will pad the
-     *  block, process it, and then continue padding into a second
-     *  block.
-     */
-    if (context->Message_Block_Index > 55)
-    {
-        context->Message_Block[context->Message_Block_Index++] = 0x80;
-        while(context->Message_Block_Index < 64)
-        {
-            context->Message_Block[context->Message_Block_Index++] = 0;
-        }
-
-        SHA1ProcessMessageBlock(context);
-
-        while(context->Message_Block_Index < 56)
-        {
-            context->Message_Block[context->Message_Block_Index++] = 0;
-        }
-    }
-    else
-    {
-        context->Message_Block[context->Message_Block_Index++] = 0x80;
-        while(context->Message_Block_Index < 56)
-        {
-            context->Message_Block[context->Message_Block_Index++] = 0;
-        }
-    }
-
-    /*
-     *  Store the message length as the last 8 octets
-     */
-    context->Message_Block[56] = (context->Length_High >> 24) & 0xFF;
-    context->Message_Block[57] = (context->Length_High >> 16) & 0xFF;
-    context->Message_Block[58] = (context->Length_High >> 8) & 0xFF;
-    context->Message_Block[59] = (context->Length_High) & 0xFF;
-    context->Message_Block[60] = (context->Length_Low >> 24) & 0xFF;
-    context->Message_Block[61] = (context->Length_Low >> 16) & 0xFF;
-    context->Message_Block[62] = (context->Length_Low >> 8) & 0xFF;
-    context->Message_Block[63] = (context->Length_Low) & 0xFF;
-
-    SHA1ProcessMessageBlock(context);
-}
-/*
- *  SHA1Reset
- *
- *  Description:
- *      This function will initialize the SHA1Context in preparation
- *      for computing a new message digest.
- *
- *  Parameters:
- *      context: [in/out]
- *          The context to reset.
- *
- *  Returns:
- *      Nothing.
- *
- *  Comments:
- *
- */
-GF_SHA1Context *gf_sha1_starts()
-{
-	GF_SHA1Context *context;
-	GF_SAFEALLOC(context, GF_SHA1Context);
-    context->Length_Low             = 0;
-    context->Length_High            = 0;
-    context->Message_Block_Index    = 0;
-
-    context->Message_Digest[0]      = 0x67452301;
-    context->Message_Digest[1]      = 0xEFCDAB89;
-    context->Message_Digest[2]      = 0x98BADCFE;
-    context->Message_Digest[3]      = 0x10325476;
-    context->Message_Digest[4]      = 0xC3D2E1F0;
-
-    context->Computed   = 0;
-    context->Corrupted  = 0;
-	return context;
-}
-
-void gf_sha1_update(GF_SHA1Context *context, u8 *message_array, u32 length )
-{
-    if (!length)
-    {
-        return;
-    }
-
-    if (context->Computed || context->Corrupted)
-    {
-        context->Corrupted = 1;
-        return;
-    }
-
-    while(length-- && !context->Corrupted)
-    {
-        context->Message_Block[context->Message_Block_Index++] =
-                                                (*message_array & 0xFF);
-
-        context->Length_Low += 8;
-        /* Force it to 32 bits */
-        context->Length_Low &= 0xFFFFFFFF;
-        if (context->Length_Low == 0)
-        {
-            context->Length_High++;
-            /* Force it to 32 bits */
-            context->Length_High &= 0xFFFFFFFF;
-            if (context->Length_High == 0)
-            {
-                /* Message is too long */
-                context->Corrupted = 1;
-            }
-        }
-
-        if (context->Message_Block_Index == 64)
-        {
-            SHA1ProcessMessageBlock(context);
-        }
-
-        message_array++;
-    }
-}
-void gf_sha1_finish(GF_SHA1Context *context, u8 output[20] )
-{
-    if (context->Corrupted)
-    {
-        return;
-    }
-
-    if (!context->Computed)
-    {
-        SHA1PadMessage(context);
-        context->Computed = 1;
-    }
-    PUT_UINT32_BE( context->Message_Digest[0], output,  0 );
-    PUT_UINT32_BE( context->Message_Digest[1], output,  4 );
-    PUT_UINT32_BE( context->Message_Digest[2], output,  8 );
-    PUT_UINT32_BE( context->Message_Digest[3], output, 12 );
-    PUT_UINT32_BE( context->Message_Digest[4], output, 16 );
-
-	gf_free(context);
-}
-
-#endif
 
 /*
  * Output = SHA-1( file contents )
  */
+#define SHA1_FILE_BUFFER_SIZE	(256*1024)
+
 GF_EXPORT
 s32 gf_sha1_file( const char *path, u8 output[20] )
 {
     FILE *f;
     size_t n;
     GF_SHA1Context *ctx;
-    u8 buf[1024];
+    u8 *buf;
 
 	if (!strncmp(path, "gmem://", 7)) {
 		u32 size;
@@ -706,17 +434,139 @@ s32 gf_sha1_file( const char *path, u8 output[20] )
     if( ( f = gf_f64_open( path, "rb" ) ) == NULL )
         return( 1 );
 
+    buf = (u8 *) gf_malloc(SHA1_FILE_BUFFER_SIZE);
+    if (!buf) {
+        fclose( f );
+        return( 1 );
+    }
     ctx  = gf_sha1_starts();
 
-    while( ( n = fread( buf, 1, sizeof( buf ), f ) ) > 0 )
+    while( ( n = fread( buf, 1, SHA1_FILE_BUFFER_SIZE, f ) ) > 0 )
         gf_sha1_update(ctx, buf, (s32) n );
 
     gf_sha1_finish(ctx, output );
 
+    gf_free(buf);
     fclose( f );
     return( 0 );
 }
 
+typedef struct
+{
+	const char *path;
+	u64 file_size, chunk_size;
+	u32 nb_chunks, next_chunk;
+	u8 *digests;
+	GF_Mutex *mx;
+	GF_Err e;
+} SHA1ChunkJob;
+
+static u32 sha1_chunk_worker(void *par)
+{
+	SHA1ChunkJob *job = (SHA1ChunkJob *) par;
+	FILE *f;
+	u8 *buf;
+
+	f = gf_f64_open(job->path, "rb");
+	buf = (u8 *) gf_malloc(SHA1_FILE_BUFFER_SIZE);
+	if (!f || !buf) {
+		gf_mx_p(job->mx);
+		job->e = f ? GF_OUT_OF_MEM : GF_IO_ERR;
+		gf_mx_v(job->mx);
+		if (f) fclose(f);
+		if (buf) gf_free(buf);
+		return 0;
+	}
+
+	while (1) {
+		GF_SHA1Context *ctx;
+		u32 idx;
+		u64 remain;
+
+		gf_mx_p(job->mx);
+		idx = job->next_chunk;
+		if (!job->e) job->next_chunk++;
+		gf_mx_v(job->mx);
+		if (job->e || (idx >= job->nb_chunks)) break;
+
+		remain = job->file_size - (u64) idx * job->chunk_size;
+		if (remain > job->chunk_size) remain = job->chunk_size;
+
+		gf_f64_seek(f, (u64) idx * job->chunk_size, SEEK_SET);
+		ctx = gf_sha1_starts();
+		while (remain) {
+			u32 to_read = (remain > SHA1_FILE_BUFFER_SIZE) ? SHA1_FILE_BUFFER_SIZE : (u32) remain;
+			u32 read = (u32) fread(buf, 1, to_read, f);
+			if (read != to_read) {
+				gf_mx_p(job->mx);
+				job->e = GF_IO_ERR;
+				gf_mx_v(job->mx);
+				break;
+			}
+			gf_sha1_update(ctx, buf, read);
+			remain -= read;
+		}
+		gf_sha1_finish(ctx, job->digests + 20*idx);
+	}
+	gf_free(buf);
+	fclose(f);
+	return 0;
+}
+
+GF_EXPORT
+GF_Err gf_sha1_file_chunks(const char *path, u64 chunk_size, u32 nb_threads, u8 **chunk_digests, u32 *nb_chunks, u8 tree_digest[20])
+{
+	u32 i;
+	FILE *f;
+	SHA1ChunkJob job;
+	GF_Thread **threads;
+
+	if (!path || !chunk_size || !chunk_digests || !nb_chunks) return GF_BAD_PARAM;
+	*chunk_digests = NULL;
+	*nb_chunks = 0;
+
+	f = gf_f64_open(path, "rb");
+	if (!f) return GF_URL_ERROR;
+	gf_f64_seek(f, 0, SEEK_END);
+	memset(&job, 0, sizeof(SHA1ChunkJob));
+	job.file_size = gf_f64_tell(f);
+	fclose(f);
+
+	job.path = path;
+	job.chunk_size = chunk_size;
+	job.nb_chunks = (u32) ((job.file_size + chunk_size - 1) / chunk_size);
+	/*empty file: one empty chunk*/
+	if (!job.nb_chunks) job.nb_chunks = 1;
+	job.digests = (u8 *) gf_malloc(sizeof(u8) * 20 * job.nb_chunks);
+	if (!job.digests) return GF_OUT_OF_MEM;
+	job.mx = gf_mx_new("SHA1Chunks");
+
+	if (!nb_threads) nb_threads = 1;
+	if (nb_threads > job.nb_chunks) nb_threads = job.nb_chunks;
+
+	/*the calling thread is one of the workers*/
+	threads = (GF_Thread **) gf_malloc(sizeof(GF_Thread *) * nb_threads);
+	for (i=1; i<nb_threads; i++) {
+		threads[i] = gf_th_new("SHA1Chunks");
+		gf_th_run(threads[i], sha1_chunk_worker, &job);
+	}
+	sha1_chunk_worker(&job);
+	for (i=1; i<nb_threads; i++) {
+		gf_th_del(threads[i]);
+	}
+	gf_free(threads);
+	gf_mx_del(job.mx);
+
+	if (job.e) {
+		gf_free(job.digests);
+		return job.e;
+	}
+	if (tree_digest) gf_sha1_csum(job.digests, 20 * job.nb_chunks, tree_digest);
+	*chunk_digests = job.digests;
+	*nb_chunks = job.nb_chunks;
+	return GF_OK;
+}
+
 /*
  * Output = SHA-1( input buffer )
  */
@@ -1553,6 +1553,18 @@ u32 gf_xml_sax_get_node_end_pos(GF_SAXParser *parser)
 	return parser->elt_end_pos;
 }
 
+/*arena blocks used in DOM arena mode - allocations bigger than a block get their own block*/
+#define DOM_ARENA_BLOCK_SIZE	(64*1024)
+
+typedef struct __dom_arena_block
+{
+	struct __dom_arena_block *next;
+	u32 size, used;
+} DOMArenaBlock;
+
+/*block header size, keeping 8-bytes alignment of block data*/
+#define DOM_ARENA_HDR_SIZE	((sizeof(DOMArenaBlock) + 7) & ~7)
+
 struct _tag_dom_parser
 {
 	GF_SAXParser *parser;
@@ -1562,16 +1574,74 @@ struct _tag_dom_parser
 
 	void (*OnProgress)(void *cbck, u64 done, u64 tot);
 	void *cbk;
+
+	Bool use_arena;
+	DOMArenaBlock *arena;
 };
 
+static void *dom_arena_alloc(GF_DOMParser *par, u32 size)
+{
+	u8 *ptr;
+	DOMArenaBlock *blk = par->arena;
+	size = (size + 7) & ~7;
+	if (!blk || (blk->used + size > blk->size)) {
+		u32 blk_size = (size > DOM_ARENA_BLOCK_SIZE) ? size : DOM_ARENA_BLOCK_SIZE;
+		DOMArenaBlock *new_blk = (DOMArenaBlock *) gf_malloc(DOM_ARENA_HDR_SIZE + blk_size);
+		if (!new_blk) return NULL;
+		new_blk->size = blk_size;
+		new_blk->used = 0;
+		/*dedicated block for big allocations, keep filling the current one*/
+		if (blk && (blk_size > DOM_ARENA_BLOCK_SIZE)) {
+			new_blk->next = blk->next;
+			blk->next = new_blk;
+		} else {
+			new_blk->next = blk;
+			par->arena = new_blk;
+		}
+		blk = new_blk;
+	}
+	ptr = (u8 *) blk + DOM_ARENA_HDR_SIZE + blk->used;
+	blk->used += size;
+	return ptr;
+}
+
+static char *dom_strdup(GF_DOMParser *par, const char *str)
+{
+	char *res;
+	u32 len;
+	if (!par->use_arena) return gf_strdup(str);
+	len = (u32) strlen(str) + 1;
+	res = (char *) dom_arena_alloc(par, len);
+	if (res) memcpy(res, str, len);
+	return res;
+}
+
+static void *dom_alloc(GF_DOMParser *par, u32 size)
+{
+	void *ptr = par->use_arena ? dom_arena_alloc(par, size) : gf_malloc(size);
+	if (ptr) memset(ptr, 0, size);
+	return ptr;
+}
+
+static void dom_arena_del(GF_DOMParser *par)
+{
+	while (par->arena) {
+		DOMArenaBlock *blk = par->arena;
+		par->arena = blk->next;
+		gf_free(blk);
+	}
+}
+
 
 GF_EXPORT
 void gf_xml_dom_node_del(GF_XMLNode *node)
 {
+	u32 i;
+	/*single forward walk, removing from the tail of the (linked) lists is linear per item*/
 	if (node->attributes) {
-		while (gf_list_count(node->attributes)) {
-			GF_XMLAttribute *att = (GF_XMLAttribute *)gf_list_last(node->attributes);
-			gf_list_rem_last(node->attributes);
+		GF_XMLAttribute *att;
+		i = 0;
+		while (!node->in_arena && (att = (GF_XMLAttribute *)gf_list_enum(node->attributes, &i))) {
 			if (att->name) gf_free(att->name);
 			if (att->value) gf_free(att->value);
 			gf_free(att);
@@ -1579,13 +1649,15 @@ void gf_xml_dom_node_del(GF_XMLNode *node)
 		gf_list_del(node->attributes);
 	}
 	if (node->content) {
-		while (gf_list_count(node->content)) {
-			GF_XMLNode *child = (GF_XMLNode *)gf_list_last(node->content);
-			gf_list_rem_last(node->content);
+		GF_XMLNode *child;
+		i = 0;
+		while ((child = (GF_XMLNode *)gf_list_enum(node->content, &i))) {
 			gf_xml_dom_node_del(child);
 		}
 		gf_list_del(node->content);
 	}
+	/*memory released with the arena*/
+	if (node->in_arena) return;
 	if (node->ns) gf_free(node->ns);
 	if (node->name) gf_free(node->name);
 	gf_free(node);
@@ -1602,18 +1674,18 @@ static void on_dom_node_start(void *cbk, const char *name, const char *ns, const
 		return;
 	}
 
-	GF_SAFEALLOC(node, GF_XMLNode);
+	node = (GF_XMLNode *) dom_alloc(par, sizeof(GF_XMLNode));
+	node->in_arena = par->use_arena;
 	node->attributes = gf_list_new();
 	for (i=0; i<nb_attributes; i++) {
-		GF_XMLAttribute *att;
-		GF_SAFEALLOC(att, GF_XMLAttribute);
-		att->name = gf_strdup(attributes[i].name);
-		att->value = gf_strdup(attributes[i].value);
+		GF_XMLAttribute *att = (GF_XMLAttribute *) dom_alloc(par, sizeof(GF_XMLAttribute));
+		att->name = dom_strdup(par, attributes[i].name);
+		att->value = dom_strdup(par, attributes[i].value);
 		gf_list_add(node->attributes, att);
 	}
 	node->content = gf_list_new();
-	node->name = gf_strdup(name);
-	if (ns) node->ns = gf_strdup(ns);
+	node->name = dom_strdup(par, name);
+	if (ns) node->ns = dom_strdup(par, ns);
 	gf_list_add(par->stack, node);
 	if (!par->root) par->root = node;
 }
@@ -1634,7 +1706,6 @@ static void on_dom_node_end(void *cbk, const char *name, const char *ns)
 	if (last != par->root) {
 		GF_XMLNode *node = (GF_XMLNode *)gf_list_last(par->stack);
 		assert(node->content);
-		assert(gf_list_find(node->content, last) == -1);
 		gf_list_add(node->content, last);
 	}
 }
@@ -1647,9 +1718,10 @@ static void on_dom_text_content(void *cbk, const char *content, Bool is_cdata)
 	if (!last) return;
 	assert(last->content);
 
-	GF_SAFEALLOC(node, GF_XMLNode);
+	node = (GF_XMLNode *) dom_alloc(par, sizeof(GF_XMLNode));
+	node->in_arena = par->use_arena;
 	node->type = is_cdata ? GF_XML_CDATA_TYPE : GF_XML_TEXT_TYPE;
-	node->name = gf_strdup(content);
+	node->name = dom_strdup(par, content);
 	gf_list_add(last->content, node);
 }
 
@@ -1682,6 +1754,7 @@ static void gf_xml_dom_reset(GF_DOMParser *dom, Bool full_reset)
 		gf_xml_dom_node_del(dom->root);
 		dom->root = NULL;
 	}
+	if (full_reset) dom_arena_del(dom);
 }
 
 GF_EXPORT
@@ -1695,10 +1768,20 @@ GF_EXPORT
 GF_XMLNode *gf_xml_dom_detach_root(GF_DOMParser *parser)
 {
 	GF_XMLNode *root = parser->root;
+	if (root && root->in_arena) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_PARSER, ("[XML] Cannot detach DOM root in arena mode\n"));
+		return NULL;
+	}
 	parser->root = NULL;
 	return root;
 }
 
+GF_EXPORT
+void gf_xml_dom_use_arena(GF_DOMParser *parser, Bool use_arena)
+{
+	parser->use_arena = use_arena;
+}
+
 static void dom_on_progress(void *cbck, u64 done, u64 tot)
 {
 	GF_DOMParser *dom = (GF_DOMParser *)cbck;